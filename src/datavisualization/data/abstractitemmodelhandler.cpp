@@ -28,14 +28,198 @@
 ****************************************************************************/
 
 #include "abstractitemmodelhandler_p.h"
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
+ItemModelRoleMapping::ItemModelRoleMapping()
+    : role(-1),
+      havePattern(false),
+      haveRegularExpression(false)
+{
+}
+
+void ItemModelRoleMapping::setPattern(const QRegExp &pattern, const QString &replace)
+{
+    this->pattern = pattern;
+    this->replace = replace;
+    havePattern = !pattern.isEmpty() && pattern.isValid();
+
+    // QRegularExpression matches faster than QRegExp, so patterns with an equivalent are
+    // converted and compiled once here. Wildcard patterns keep using QRegExp, as their
+    // matching rules differ.
+    haveRegularExpression = false;
+    if (havePattern) {
+        QRegularExpression::PatternOptions options = QRegularExpression::DotMatchesEverythingOption;
+        if (pattern.caseSensitivity() == Qt::CaseInsensitive)
+            options |= QRegularExpression::CaseInsensitiveOption;
+        if (pattern.isMinimal())
+            options |= QRegularExpression::InvertedGreedinessOption;
+        switch (pattern.patternSyntax()) {
+        case QRegExp::RegExp:
+        case QRegExp::RegExp2:
+            regularExpression = QRegularExpression(pattern.pattern(), options);
+            haveRegularExpression = regularExpression.isValid();
+            break;
+        case QRegExp::FixedString:
+            regularExpression = QRegularExpression(QRegularExpression::escape(pattern.pattern()),
+                                                   options);
+            haveRegularExpression = regularExpression.isValid();
+            break;
+        default:
+            break;
+        }
+        if (haveRegularExpression)
+            regularExpression.optimize();
+    }
+}
+
+float ItemModelRoleMapping::toFloat(const QVariant &value) const
+{
+    if (havePattern)
+        return toString(value).toFloat();
+
+    // Common numeric types are read directly, skipping the generic variant conversion
+    switch (value.userType()) {
+    case QMetaType::Float:
+        return *static_cast<const float *>(value.constData());
+    case QMetaType::Double:
+        return float(*static_cast<const double *>(value.constData()));
+    case QMetaType::Int:
+        return float(*static_cast<const int *>(value.constData()));
+    default:
+        return value.toFloat();
+    }
+}
+
+QString ItemModelRoleMapping::toString(const QVariant &value) const
+{
+    QString string = value.toString();
+    if (haveRegularExpression)
+        string.replace(regularExpression, replace);
+    else if (havePattern)
+        string.replace(pattern, replace);
+    return string;
+}
+
+ItemModelSnapshot::ItemModelSnapshot()
+    : m_rowCount(0),
+      m_columnCount(0)
+{
+}
+
+// Copies the values of the given roles for all items, and the header data if headers is true.
+// Invalid roles are skipped, data() returns an invalid variant for them like the model does.
+void ItemModelSnapshot::take(const QAbstractItemModel *model, const QVector<int> &roles,
+                             bool headers)
+{
+    m_roles.clear();
+    for (int i = 0; i < roles.size(); i++) {
+        if (roles.at(i) >= 0 && !m_roles.contains(roles.at(i)))
+            m_roles.append(roles.at(i));
+    }
+
+    m_rowCount = model->rowCount();
+    m_columnCount = model->columnCount();
+    const int roleCount = m_roles.size();
+    m_data.resize(m_rowCount * m_columnCount * roleCount);
+    QVariant *values = m_data.data();
+    for (int i = 0; i < m_rowCount; i++) {
+        for (int j = 0; j < m_columnCount; j++) {
+            QModelIndex index = model->index(i, j);
+            for (int k = 0; k < roleCount; k++)
+                *values++ = index.data(m_roles.at(k));
+        }
+    }
+
+    m_rowHeaders.clear();
+    m_columnHeaders.clear();
+    if (headers) {
+        m_rowHeaders.reserve(m_rowCount);
+        for (int i = 0; i < m_rowCount; i++)
+            m_rowHeaders.append(model->headerData(i, Qt::Vertical));
+        m_columnHeaders.reserve(m_columnCount);
+        for (int i = 0; i < m_columnCount; i++)
+            m_columnHeaders.append(model->headerData(i, Qt::Horizontal));
+    }
+}
+
+QVariant ItemModelSnapshot::data(int row, int column, int role) const
+{
+    int roleIndex = m_roles.indexOf(role);
+    if (roleIndex < 0)
+        return QVariant();
+    return m_data.at((row * m_columnCount + column) * m_roles.size() + roleIndex);
+}
+
+QVariant ItemModelSnapshot::headerData(int section, Qt::Orientation orientation) const
+{
+    const QVector<QVariant> &headers = (orientation == Qt::Vertical) ? m_rowHeaders
+                                                                     : m_columnHeaders;
+    if (section < 0 || section >= headers.size())
+        return QVariant();
+    return headers.at(section);
+}
+
+// Shared between the handler and its background resolves, so that a finished resolve can
+// check whether the handler still exists.
+class ItemModelResolveTarget
+{
+public:
+    QMutex mutex;
+    AbstractItemModelHandler *handler;
+};
+
+// Resolves have their own pool, so that they don't hold up the row blocks that the renderers
+// process in parallel in the global thread pool
+Q_GLOBAL_STATIC(QThreadPool, resolveThreadPool)
+
+class ItemModelResolveTask : public QRunnable
+{
+public:
+    ItemModelResolveTask(const QSharedPointer<ItemModelResolveJob> &job,
+                         const QSharedPointer<ItemModelResolveTarget> &target, int generation)
+        : m_job(job),
+          m_target(target),
+          m_generation(generation)
+    {
+    }
+
+    void run()
+    {
+        m_job->run();
+
+        // Handler can't be destroyed while the result is queued to it, and if it is destroyed
+        // before the result gets delivered, the queued call is discarded with it.
+        QMutexLocker locker(&m_target->mutex);
+        AbstractItemModelHandler *handler = m_target->handler;
+        if (handler) {
+            QSharedPointer<ItemModelResolveJob> job = m_job;
+            int generation = m_generation;
+            QMetaObject::invokeMethod(handler, [handler, job, generation]() {
+                handler->handleResolveFinished(job.data(), generation);
+            }, Qt::QueuedConnection);
+        }
+    }
+
+private:
+    QSharedPointer<ItemModelResolveJob> m_job;
+    QSharedPointer<ItemModelResolveTarget> m_target;
+    int m_generation;
+};
+
 AbstractItemModelHandler::AbstractItemModelHandler(QObject *parent)
     : QObject(parent),
       resolvePending(0),
-      m_fullReset(true)
+      m_fullReset(true),
+      m_resolving(false),
+      m_backgroundResolveEnabled(false),
+      m_resolveGeneration(0),
+      m_resolveTarget(new ItemModelResolveTarget)
 {
+    m_resolveTarget->handler = this;
     m_resolveTimer.setSingleShot(true);
     QObject::connect(&m_resolveTimer, &QTimer::timeout,
                      this, &AbstractItemModelHandler::handlePendingResolve);
@@ -43,6 +227,8 @@ AbstractItemModelHandler::AbstractItemModelHandler(QObject *parent)
 
 AbstractItemModelHandler::~AbstractItemModelHandler()
 {
+    QMutexLocker locker(&m_resolveTarget->mutex);
+    m_resolveTarget->handler = 0;
 }
 
 void AbstractItemModelHandler::setItemModel(QAbstractItemModel *itemModel)
@@ -85,6 +271,16 @@ QAbstractItemModel *AbstractItemModelHandler::itemModel() const
     return m_itemModel.data();
 }
 
+void AbstractItemModelHandler::setBackgroundResolveEnabled(bool enable)
+{
+    m_backgroundResolveEnabled = enable;
+}
+
+bool AbstractItemModelHandler::isBackgroundResolveEnabled() const
+{
+    return m_backgroundResolveEnabled;
+}
+
 void AbstractItemModelHandler::handleColumnsInserted(const QModelIndex &parent,
                                                      int start, int end)
 {
@@ -233,8 +429,38 @@ void AbstractItemModelHandler::handleMappingChanged()
 
 void AbstractItemModelHandler::handlePendingResolve()
 {
+    // Any resolve still running in the background is superseded by this one
+    m_resolveGeneration++;
+    m_resolving = false;
     resolveModel();
     m_fullReset = false;
 }
 
+// Runs the job and applies its result. If background resolving is enabled, the job is run in
+// the resolve thread pool instead, and the result is applied once it is finished.
+// Takes ownership of the job.
+void AbstractItemModelHandler::startResolve(ItemModelResolveJob *job)
+{
+    if (!m_backgroundResolveEnabled) {
+        job->run();
+        applyResolve(job);
+        delete job;
+        return;
+    }
+
+    m_resolving = true;
+    resolveThreadPool()->start(
+                new ItemModelResolveTask(QSharedPointer<ItemModelResolveJob>(job),
+                                         m_resolveTarget, m_resolveGeneration));
+}
+
+void AbstractItemModelHandler::handleResolveFinished(ItemModelResolveJob *job, int generation)
+{
+    // Results of superseded resolves are dropped
+    if (generation == m_resolveGeneration) {
+        m_resolving = false;
+        applyResolve(job);
+    }
+}
+
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -43,10 +43,68 @@
 #include "datavisualizationglobal_p.h"
 #include <QtCore/QAbstractItemModel>
 #include <QtCore/QPointer>
+#include <QtCore/QRegExp>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSharedPointer>
 #include <QtCore/QTimer>
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
+class ItemModelResolveTarget;
+
+// Mapping of one role to a data item value
+class ItemModelRoleMapping
+{
+public:
+    ItemModelRoleMapping();
+
+    void setPattern(const QRegExp &pattern, const QString &replace);
+    float toFloat(const QVariant &value) const;
+    QString toString(const QVariant &value) const;
+
+    int role;
+    QRegExp pattern;
+    QString replace;
+    bool havePattern;
+    QRegularExpression regularExpression; // Compiled pattern, if it has an equivalent
+    bool haveRegularExpression;
+};
+
+// Copy of the item model data a resolve needs. Item models can only be accessed in the thread
+// they live in, so the data is converted from the snapshot instead of the model.
+class ItemModelSnapshot
+{
+public:
+    ItemModelSnapshot();
+
+    void take(const QAbstractItemModel *model, const QVector<int> &roles, bool headers);
+
+    inline int rowCount() const { return m_rowCount; }
+    inline int columnCount() const { return m_columnCount; }
+    QVariant data(int row, int column, int role) const;
+    QVariant headerData(int section, Qt::Orientation orientation) const;
+
+private:
+    int m_rowCount;
+    int m_columnCount;
+    QVector<int> m_roles;
+    QVector<QVariant> m_data; // Values of all roles of an item are consecutive
+    QVector<QVariant> m_rowHeaders;
+    QVector<QVariant> m_columnHeaders;
+};
+
+// Converts a snapshot into a data array without accessing the model or the proxy,
+// so that it can be run in a worker thread.
+class ItemModelResolveJob
+{
+public:
+    virtual ~ItemModelResolveJob() {}
+
+    virtual void run() = 0;
+
+    ItemModelSnapshot snapshot;
+};
+
 class AbstractItemModelHandler : public QObject
 {
     Q_OBJECT
@@ -57,6 +115,9 @@ public:
     virtual void setItemModel(QAbstractItemModel *itemModel);
     virtual QAbstractItemModel *itemModel() const;
 
+    void setBackgroundResolveEnabled(bool enable);
+    bool isBackgroundResolveEnabled() const;
+
 public Q_SLOTS:
     virtual void handleColumnsInserted(const QModelIndex &parent, int start, int end);
     virtual void handleColumnsMoved(const QModelIndex &sourceParent, int sourceStart,
@@ -81,14 +142,25 @@ Q_SIGNALS:
 
 protected:
     virtual void resolveModel() = 0;
+    virtual void applyResolve(ItemModelResolveJob *job) = 0;
+    void startResolve(ItemModelResolveJob *job);
 
     QPointer<QAbstractItemModel> m_itemModel;  // Not owned
     bool resolvePending;
     QTimer m_resolveTimer;
     bool m_fullReset;
+    bool m_resolving; // Resolve running in the background, changes must wait for its result
 
 private:
+    void handleResolveFinished(ItemModelResolveJob *job, int generation);
+
+    bool m_backgroundResolveEnabled;
+    int m_resolveGeneration;
+    QSharedPointer<ItemModelResolveTarget> m_resolveTarget;
+
     Q_DISABLE_COPY(AbstractItemModelHandler)
+
+    friend class ItemModelResolveTask;
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
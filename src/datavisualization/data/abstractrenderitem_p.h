@@ -48,7 +48,7 @@
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
-class AbstractRenderItem
+class QT_DATAVISUALIZATION_EXPORT AbstractRenderItem
 {
 public:
     AbstractRenderItem();
@@ -37,11 +37,7 @@ BarItemModelHandler::BarItemModelHandler(QItemModelBarDataProxy *proxy, QObject
     : AbstractItemModelHandler(parent),
       m_proxy(proxy),
       m_proxyArray(0),
-      m_columnCount(0),
-      m_valueRole(noRoleIndex),
-      m_rotationRole(noRoleIndex),
-      m_haveValuePattern(false),
-      m_haveRotationPattern(false)
+      m_columnCount(0)
 {
 }
 
@@ -55,8 +51,10 @@ void BarItemModelHandler::handleDataChanged(const QModelIndex &topLeft,
 {
     // Do nothing if full reset already pending
     if (!m_fullReset) {
-        if (!m_proxy->useModelCategories()) {
-            // If the data model doesn't directly map rows and columns, we cannot optimize
+        if (m_resolving || !m_proxy->useModelCategories()) {
+            // If the data model doesn't directly map rows and columns, we cannot optimize.
+            // Changes made while a resolve is running in the background would be overwritten
+            // by its result, so those need a full reset, too.
             AbstractItemModelHandler::handleDataChanged(topLeft, bottomRight, roles);
         } else {
             int startRow = qMin(topLeft.row(), bottomRight.row());
@@ -68,24 +66,9 @@ void BarItemModelHandler::handleDataChanged(const QModelIndex &topLeft,
                 for (int j = startCol; j <= endCol; j++) {
                     QModelIndex index = m_itemModel->index(i, j);
                     QBarDataItem item;
-                    QVariant valueVar = index.data(m_valueRole);
-                    float value;
-                    if (m_haveValuePattern)
-                        value = valueVar.toString().replace(m_valuePattern, m_valueReplace).toFloat();
-                    else
-                        value = valueVar.toFloat();
-                    item.setValue(value);
-                    if (m_rotationRole != noRoleIndex) {
-                        QVariant rotationVar = index.data(m_rotationRole);
-                        float rotation;
-                        if (m_haveRotationPattern) {
-                            rotation = rotationVar.toString().replace(m_rotationPattern,
-                                                                      m_rotationReplace).toFloat();
-                        } else {
-                            rotation = rotationVar.toFloat();
-                        }
-                        item.setRotation(rotation);
-                    }
+                    item.setValue(m_value.toFloat(index.data(m_value.role)));
+                    if (m_rotation.role != noRoleIndex)
+                        item.setRotation(m_rotation.toFloat(index.data(m_rotation.role)));
                     m_proxy->setItem(i, j, item);
                 }
             }
@@ -93,93 +76,85 @@ void BarItemModelHandler::handleDataChanged(const QModelIndex &topLeft,
     }
 }
 
-// Resolve entire item model into QBarDataArray.
-void BarItemModelHandler::resolveModel()
+class BarResolveJob : public ItemModelResolveJob
 {
-    if (m_itemModel.isNull()) {
-        m_proxy->resetArray(0);
-        return;
+public:
+    BarResolveJob()
+        : array(0),
+          arrayColumnCount(0),
+          useModelCategories(false),
+          generateRows(false),
+          generateColumns(false),
+          multiMatchBehavior(QItemModelBarDataProxy::MMBLast)
+    {
     }
 
-    if (!m_proxy->useModelCategories()
-            && (m_proxy->rowRole().isEmpty() || m_proxy->columnRole().isEmpty())) {
-        m_proxy->resetArray(0);
-        return;
+    ~BarResolveJob()
+    {
+        delete array;
     }
 
-    // Value and rotation patterns can be reused on single item changes,
-    // so store them to member variables.
-    QRegExp rowPattern(m_proxy->rowRolePattern());
-    QRegExp colPattern(m_proxy->columnRolePattern());
-    m_valuePattern = m_proxy->valueRolePattern();
-    m_rotationPattern = m_proxy->rotationRolePattern();
-    QString rowReplace = m_proxy->rowRoleReplace();
-    QString colReplace = m_proxy->columnRoleReplace();
-    m_valueReplace = m_proxy->valueRoleReplace();
-    m_rotationReplace = m_proxy->rotationRoleReplace();
-    bool haveRowPattern = !rowPattern.isEmpty() && rowPattern.isValid();
-    bool haveColPattern = !colPattern.isEmpty() && colPattern.isValid();
-    m_haveValuePattern = !m_valuePattern.isEmpty() && m_valuePattern.isValid();
-    m_haveRotationPattern = !m_rotationPattern.isEmpty() && m_rotationPattern.isValid();
-
-    QStringList rowLabels;
-    QStringList columnLabels;
-
-    QHash<int, QByteArray> roleHash = m_itemModel->roleNames();
+    void run()
+    {
+        if (useModelCategories)
+            resolveModelCategories();
+        else
+            resolveRoleCategories();
+    }
 
-    // Default value role to display role if no mapping
-    m_valueRole = roleHash.key(m_proxy->valueRole().toLatin1(), Qt::DisplayRole);
-    m_rotationRole = roleHash.key(m_proxy->rotationRole().toLatin1(), noRoleIndex);
-    int rowCount = m_itemModel->rowCount();
-    int columnCount = m_itemModel->columnCount();
+    QBarDataArray *array; // Array to reuse if dimensions match, and the result
+    int arrayColumnCount;
+    ItemModelRoleMapping value;
+    ItemModelRoleMapping rotation;
+    ItemModelRoleMapping row;
+    ItemModelRoleMapping column;
+    bool useModelCategories;
+    bool generateRows;
+    bool generateColumns;
+    QItemModelBarDataProxy::MultiMatchBehavior multiMatchBehavior;
+    QStringList rowList; // Given categories if not generated, and the resulting labels
+    QStringList columnList;
 
-    if (m_proxy->useModelCategories()) {
+private:
+    void prepareArray(int rowCount, int columnCount)
+    {
         // If dimensions have changed, recreate the array
-        if (m_proxyArray != m_proxy->array() || columnCount != m_columnCount
-                || rowCount != m_proxyArray->size()) {
-            m_proxyArray = new QBarDataArray;
-            m_proxyArray->reserve(rowCount);
+        if (!array || columnCount != arrayColumnCount || rowCount != array->size()) {
+            array = new QBarDataArray;
+            array->reserve(rowCount);
             for (int i = 0; i < rowCount; i++)
-                m_proxyArray->append(new QBarDataRow(columnCount));
+                array->append(new QBarDataRow(columnCount));
         }
+        arrayColumnCount = columnCount;
+    }
+
+    void resolveModelCategories()
+    {
+        int rowCount = snapshot.rowCount();
+        int columnCount = snapshot.columnCount();
+        prepareArray(rowCount, columnCount);
         for (int i = 0; i < rowCount; i++) {
-            QBarDataRow &newProxyRow = *m_proxyArray->at(i);
+            QBarDataRow &newProxyRow = *array->at(i);
             for (int j = 0; j < columnCount; j++) {
-                QModelIndex index = m_itemModel->index(i, j);
-                QVariant valueVar = index.data(m_valueRole);
-                float value;
-                if (m_haveValuePattern)
-                    value = valueVar.toString().replace(m_valuePattern, m_valueReplace).toFloat();
-                else
-                    value = valueVar.toFloat();
-                newProxyRow[j].setValue(value);
-                if (m_rotationRole != noRoleIndex) {
-                    QVariant rotationVar = index.data(m_rotationRole);
-                    float rotation;
-                    if (m_haveRotationPattern) {
-                        rotation = rotationVar.toString().replace(m_rotationPattern,
-                                                                  m_rotationReplace).toFloat();
-                    } else {
-                        rotation = rotationVar.toFloat();
-                    }
-                    newProxyRow[j].setRotation(rotation);
-                }
+                newProxyRow[j].setValue(value.toFloat(snapshot.data(i, j, value.role)));
+                if (rotation.role != noRoleIndex)
+                    newProxyRow[j].setRotation(rotation.toFloat(snapshot.data(i, j, rotation.role)));
             }
         }
         // Generate labels from headers if using model rows/columns
+        rowList.clear();
+        columnList.clear();
         for (int i = 0; i < rowCount; i++)
-            rowLabels << m_itemModel->headerData(i, Qt::Vertical).toString();
+            rowList << snapshot.headerData(i, Qt::Vertical).toString();
         for (int i = 0; i < columnCount; i++)
-            columnLabels << m_itemModel->headerData(i, Qt::Horizontal).toString();
-        m_columnCount = columnCount;
-    } else {
-        int rowRole = roleHash.key(m_proxy->rowRole().toLatin1());
-        int columnRole = roleHash.key(m_proxy->columnRole().toLatin1());
+            columnList << snapshot.headerData(i, Qt::Horizontal).toString();
+    }
+
+    void resolveRoleCategories()
+    {
+        int rowCount = snapshot.rowCount();
+        int columnCount = snapshot.columnCount();
 
-        bool generateRows = m_proxy->autoRowCategories();
-        bool generateColumns = m_proxy->autoColumnCategories();
-        QStringList rowList;
-        QStringList columnList;
         // For detecting duplicates in categories generation, using QHashes should be faster than
         // simple QStringList::contains() check.
         QHash<QString, bool> rowListHash;
@@ -190,57 +165,40 @@ void BarItemModelHandler::resolveModel()
         QHash<QString, ColumnValueMap> itemValueMap;
         QHash<QString, ColumnValueMap> itemRotationMap;
 
-        bool cumulative = m_proxy->multiMatchBehavior() == QItemModelBarDataProxy::MMBAverage
-                || m_proxy->multiMatchBehavior() == QItemModelBarDataProxy::MMBCumulative;
-        bool countMatches = m_proxy->multiMatchBehavior() == QItemModelBarDataProxy::MMBAverage;
-        bool takeFirst = m_proxy->multiMatchBehavior() == QItemModelBarDataProxy::MMBFirst;
+        bool cumulative = multiMatchBehavior == QItemModelBarDataProxy::MMBAverage
+                || multiMatchBehavior == QItemModelBarDataProxy::MMBCumulative;
+        bool countMatches = multiMatchBehavior == QItemModelBarDataProxy::MMBAverage;
+        bool takeFirst = multiMatchBehavior == QItemModelBarDataProxy::MMBFirst;
         QHash<QString, QHash<QString, int> > *matchCountMap = 0;
         if (countMatches)
             matchCountMap = new QHash<QString, QHash<QString, int> >;
 
         for (int i = 0; i < rowCount; i++) {
             for (int j = 0; j < columnCount; j++) {
-                QModelIndex index = m_itemModel->index(i, j);
-                QString rowRoleStr = index.data(rowRole).toString();
-                if (haveRowPattern)
-                    rowRoleStr.replace(rowPattern, rowReplace);
-                QString columnRoleStr = index.data(columnRole).toString();
-                if (haveColPattern)
-                    columnRoleStr.replace(colPattern, colReplace);
-                QVariant valueVar = index.data(m_valueRole);
-                float value;
-                if (m_haveValuePattern)
-                    value = valueVar.toString().replace(m_valuePattern, m_valueReplace).toFloat();
-                else
-                    value = valueVar.toFloat();
+                QString rowRoleStr = row.toString(snapshot.data(i, j, row.role));
+                QString columnRoleStr = column.toString(snapshot.data(i, j, column.role));
+                float itemValue = value.toFloat(snapshot.data(i, j, value.role));
                 if (countMatches)
                     (*matchCountMap)[rowRoleStr][columnRoleStr]++;
 
                 if (cumulative) {
-                    itemValueMap[rowRoleStr][columnRoleStr] += value;
+                    itemValueMap[rowRoleStr][columnRoleStr] += itemValue;
                 } else {
                     if (takeFirst && itemValueMap.contains(rowRoleStr)) {
                         if (itemValueMap.value(rowRoleStr).contains(columnRoleStr))
                             continue; // We already have a value for this row/column combo
                     }
-                    itemValueMap[rowRoleStr][columnRoleStr] = value;
+                    itemValueMap[rowRoleStr][columnRoleStr] = itemValue;
                 }
 
-                if (m_rotationRole != noRoleIndex) {
-                    QVariant rotationVar = index.data(m_rotationRole);
-                    float rotation;
-                    if (m_haveRotationPattern) {
-                        rotation = rotationVar.toString().replace(m_rotationPattern,
-                                                                  m_rotationReplace).toFloat();
-                    } else {
-                        rotation = rotationVar.toFloat();
-                    }
+                if (rotation.role != noRoleIndex) {
+                    float itemRotation = rotation.toFloat(snapshot.data(i, j, rotation.role));
                     if (cumulative) {
-                        itemRotationMap[rowRoleStr][columnRoleStr] += rotation;
+                        itemRotationMap[rowRoleStr][columnRoleStr] += itemRotation;
                     } else {
                         // We know we are in take last mode if we get here,
                         // as take first mode skips to next loop already earlier
-                        itemRotationMap[rowRoleStr][columnRoleStr] = rotation;
+                        itemRotationMap[rowRoleStr][columnRoleStr] = itemRotation;
                     }
                 }
                 if (generateRows && !rowListHash.value(rowRoleStr, false)) {
@@ -254,34 +212,17 @@ void BarItemModelHandler::resolveModel()
             }
         }
 
-        if (generateRows)
-            m_proxy->dptr()->m_rowCategories = rowList;
-        else
-            rowList = m_proxy->rowCategories();
-
-        if (generateColumns)
-            m_proxy->dptr()->m_columnCategories = columnList;
-        else
-            columnList = m_proxy->columnCategories();
-
-        // If dimensions have changed, recreate the array
-        if (m_proxyArray != m_proxy->array() || columnList.size() != m_columnCount
-                || rowList.size() != m_proxyArray->size()) {
-            m_proxyArray = new QBarDataArray;
-            m_proxyArray->reserve(rowList.size());
-            for (int i = 0; i < rowList.size(); i++)
-                m_proxyArray->append(new QBarDataRow(columnList.size()));
-        }
+        prepareArray(rowList.size(), columnList.size());
         // Create new data array from itemValueMap
         for (int i = 0; i < rowList.size(); i++) {
             QString rowKey = rowList.at(i);
-            QBarDataRow &newProxyRow = *m_proxyArray->at(i);
+            QBarDataRow &newProxyRow = *array->at(i);
             for (int j = 0; j < columnList.size(); j++) {
-                float value = itemValueMap[rowKey][columnList.at(j)];
+                float itemValue = itemValueMap[rowKey][columnList.at(j)];
                 if (countMatches)
-                    value /= float((*matchCountMap)[rowKey][columnList.at(j)]);
-                newProxyRow[j].setValue(value);
-                if (m_rotationRole != noRoleIndex) {
+                    itemValue /= float((*matchCountMap)[rowKey][columnList.at(j)]);
+                newProxyRow[j].setValue(itemValue);
+                if (rotation.role != noRoleIndex) {
                     float angle = itemRotationMap[rowKey][columnList.at(j)];
                     if (countMatches)
                         angle /= float((*matchCountMap)[rowKey][columnList.at(j)]);
@@ -290,14 +231,81 @@ void BarItemModelHandler::resolveModel()
             }
         }
 
-        rowLabels = rowList;
-        columnLabels = columnList;
-        m_columnCount = columnList.size();
-
         delete matchCountMap;
     }
+};
+
+// Resolve entire item model into QBarDataArray.
+void BarItemModelHandler::resolveModel()
+{
+    if (m_itemModel.isNull()) {
+        m_proxy->resetArray(0);
+        return;
+    }
+
+    if (!m_proxy->useModelCategories()
+            && (m_proxy->rowRole().isEmpty() || m_proxy->columnRole().isEmpty())) {
+        m_proxy->resetArray(0);
+        return;
+    }
+
+    // Value and rotation mappings can be reused on single item changes,
+    // so store them to member variables.
+    m_value.setPattern(m_proxy->valueRolePattern(), m_proxy->valueRoleReplace());
+    m_rotation.setPattern(m_proxy->rotationRolePattern(), m_proxy->rotationRoleReplace());
+
+    QHash<int, QByteArray> roleHash = m_itemModel->roleNames();
+
+    // Default value role to display role if no mapping
+    m_value.role = roleHash.key(m_proxy->valueRole().toLatin1(), Qt::DisplayRole);
+    m_rotation.role = roleHash.key(m_proxy->rotationRole().toLatin1(), noRoleIndex);
+
+    BarResolveJob *job = new BarResolveJob;
+    job->value = m_value;
+    job->rotation = m_rotation;
+    job->useModelCategories = m_proxy->useModelCategories();
+    if (job->useModelCategories) {
+        job->snapshot.take(m_itemModel.data(), QVector<int>() << m_value.role << m_rotation.role,
+                           true);
+    } else {
+        job->row.role = roleHash.key(m_proxy->rowRole().toLatin1());
+        job->row.setPattern(m_proxy->rowRolePattern(), m_proxy->rowRoleReplace());
+        job->column.role = roleHash.key(m_proxy->columnRole().toLatin1());
+        job->column.setPattern(m_proxy->columnRolePattern(), m_proxy->columnRoleReplace());
+        job->generateRows = m_proxy->autoRowCategories();
+        job->generateColumns = m_proxy->autoColumnCategories();
+        if (!job->generateRows)
+            job->rowList = m_proxy->rowCategories();
+        if (!job->generateColumns)
+            job->columnList = m_proxy->columnCategories();
+        job->multiMatchBehavior = m_proxy->multiMatchBehavior();
+        job->snapshot.take(m_itemModel.data(), QVector<int>() << job->row.role
+                           << job->column.role << m_value.role << m_rotation.role, false);
+    }
+
+    // Background resolves can't write to the array in use
+    if (!isBackgroundResolveEnabled() && m_proxyArray == m_proxy->array()) {
+        job->array = m_proxyArray;
+        job->arrayColumnCount = m_columnCount;
+    }
+
+    startResolve(job);
+}
+
+void BarItemModelHandler::applyResolve(ItemModelResolveJob *job)
+{
+    BarResolveJob *barJob = static_cast<BarResolveJob *>(job);
+    if (!barJob->useModelCategories) {
+        if (barJob->generateRows)
+            m_proxy->dptr()->m_rowCategories = barJob->rowList;
+        if (barJob->generateColumns)
+            m_proxy->dptr()->m_columnCategories = barJob->columnList;
+    }
+    m_proxyArray = barJob->array;
+    m_columnCount = barJob->arrayColumnCount;
+    barJob->array = 0;
 
-    m_proxy->resetArray(m_proxyArray, rowLabels, columnLabels);
+    m_proxy->resetArray(m_proxyArray, barJob->rowList, barJob->columnList);
 }
 
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -58,18 +58,13 @@ public Q_SLOTS:
 
 protected:
     void virtual resolveModel();
+    void virtual applyResolve(ItemModelResolveJob *job);
 
     QItemModelBarDataProxy *m_proxy; // Not owned
     QBarDataArray *m_proxyArray; // Not owned
     int m_columnCount;
-    int m_valueRole;
-    int m_rotationRole;
-    QRegExp m_valuePattern;
-    QRegExp m_rotationPattern;
-    QString m_valueReplace;
-    QString m_rotationReplace;
-    bool m_haveValuePattern;
-    bool m_haveRotationPattern;
+    ItemModelRoleMapping m_value;
+    ItemModelRoleMapping m_rotation;
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
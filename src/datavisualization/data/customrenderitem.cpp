@@ -58,14 +58,24 @@ CustomRenderItem::CustomRenderItem()
       m_preserveOpacity(true),
       m_useHighDefShader(true),
       m_drawSlices(false),
-      m_drawSliceFrames(false)
+      m_drawSliceFrames(false),
+      m_brickSize(0),
+      m_brickCountX(0),
+      m_brickCountY(0),
+      m_brickCountZ(0),
+      m_occupancyTexture(0),
+      m_occupancyWidth(0),
+      m_occupancyHeight(0),
+      m_occupancyDepth(0)
 
 {
 }
 
 CustomRenderItem::~CustomRenderItem()
 {
-    ObjectHelper::releaseObjectHelper(m_renderer, m_object);
+    // Items that never got a mesh have no renderer to release it from
+    if (m_object)
+        ObjectHelper::releaseObjectHelper(m_renderer, m_object);
 }
 
 void CustomRenderItem::setMesh(const QString &meshFile)
@@ -107,6 +117,53 @@ void CustomRenderItem::setMaxBounds(const QVector3D &bounds)
     m_maxBoundsNormal = 0.5f * (m_maxBoundsNormal + oneVector);
 }
 
+// Splits the volume into bricks of brickSize texels. Textures of the previous bricks
+// must have been released by the renderer.
+void CustomRenderItem::createBricks()
+{
+    m_bricks.clear();
+    m_brickCountX = 0;
+    m_brickCountY = 0;
+    m_brickCountZ = 0;
+    if (m_brickSize <= 0 || !textureSize())
+        return;
+
+    m_brickCountX = (m_textureWidth + m_brickSize - 1) / m_brickSize;
+    m_brickCountY = (m_textureHeight + m_brickSize - 1) / m_brickSize;
+    m_brickCountZ = (m_textureDepth + m_brickSize - 1) / m_brickSize;
+    m_bricks.resize(m_brickCountX * m_brickCountY * m_brickCountZ);
+
+    // Bricks are ordered x fastest, then y, then z
+    int index = 0;
+    for (int k = 0; k < m_brickCountZ; k++) {
+        for (int j = 0; j < m_brickCountY; j++) {
+            for (int i = 0; i < m_brickCountX; i++) {
+                VolumeBrick &brick = m_bricks[index++];
+                brick.x = i * m_brickSize;
+                brick.y = j * m_brickSize;
+                brick.z = k * m_brickSize;
+                brick.width = qMin(m_brickSize, m_textureWidth - brick.x);
+                brick.height = qMin(m_brickSize, m_textureHeight - brick.y);
+                brick.depth = qMin(m_brickSize, m_textureDepth - brick.z);
+                brick.texture = 0;
+                brick.empty = false;
+                brick.requested = false;
+                brick.lastUsedFrame = 0;
+            }
+        }
+    }
+}
+
+// Sizes the occupancy grid so that each cell covers cellSize texels per dimension.
+// The occupancy texture must have been released by the renderer.
+void CustomRenderItem::createOccupancy(int cellSize)
+{
+    m_occupancyWidth = (m_textureWidth + cellSize - 1) / cellSize;
+    m_occupancyHeight = (m_textureHeight + cellSize - 1) / cellSize;
+    m_occupancyDepth = (m_textureDepth + cellSize - 1) / cellSize;
+    m_occupancy.fill(0, m_occupancyWidth * m_occupancyHeight * m_occupancyDepth);
+}
+
 void CustomRenderItem::setSliceFrameColor(const QColor &color)
 {
     const QRgb &rgb = color.rgba();
@@ -51,7 +51,22 @@ QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 class QCustom3DItem;
 class Abstract3DRenderer;
 
-class CustomRenderItem : public AbstractRenderItem
+// A box of texels of a bricked volume, rendered from its own 3D texture
+struct VolumeBrick
+{
+    int x;
+    int y;
+    int z;
+    int width;
+    int height;
+    int depth;
+    GLuint texture;
+    bool empty;
+    bool requested;
+    uint lastUsedFrame;
+};
+
+class QT_DATAVISUALIZATION_EXPORT CustomRenderItem : public AbstractRenderItem
 {
 public:
     CustomRenderItem();
@@ -149,6 +164,20 @@ public:
     inline const QVector3D &sliceFrameGaps() const { return m_sliceFrameGaps; }
     inline void setSliceFrameThicknesses(const QVector3D &thicknesses) { m_sliceFrameThicknesses = thicknesses; }
     inline const QVector3D &sliceFrameThicknesses() const { return m_sliceFrameThicknesses; }
+    inline void setBrickSize(int size) { m_brickSize = size; }
+    inline int brickSize() const { return m_brickSize; }
+    inline QVector<VolumeBrick> &bricks() { return m_bricks; }
+    inline int brickCountX() const { return m_brickCountX; }
+    inline int brickCountY() const { return m_brickCountY; }
+    inline int brickCountZ() const { return m_brickCountZ; }
+    void createBricks();
+    inline void setOccupancyTexture(GLuint texture) { m_occupancyTexture = texture; }
+    inline GLuint occupancyTexture() const { return m_occupancyTexture; }
+    inline QVector<uchar> &occupancy() { return m_occupancy; }
+    inline int occupancyWidth() const { return m_occupancyWidth; }
+    inline int occupancyHeight() const { return m_occupancyHeight; }
+    inline int occupancyDepth() const { return m_occupancyDepth; }
+    void createOccupancy(int cellSize);
 
 private:
     Q_DISABLE_COPY(CustomRenderItem)
@@ -195,6 +224,16 @@ private:
     QVector3D m_sliceFrameWidths;
     QVector3D m_sliceFrameGaps;
     QVector3D m_sliceFrameThicknesses;
+    int m_brickSize;
+    QVector<VolumeBrick> m_bricks;
+    int m_brickCountX;
+    int m_brickCountY;
+    int m_brickCountZ;
+    GLuint m_occupancyTexture;
+    QVector<uchar> m_occupancy;
+    int m_occupancyWidth;
+    int m_occupancyHeight;
+    int m_occupancyDepth;
 };
 typedef QHash<QCustom3DItem *, CustomRenderItem *> CustomRenderItemArray;
 
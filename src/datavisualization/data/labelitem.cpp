@@ -54,10 +54,18 @@ QSize LabelItem::size() const
 
 void LabelItem::setTextureId(GLuint textureId)
 {
-    QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_textureId);
+    releaseTexture();
     m_textureId = textureId;
 }
 
+void LabelItem::setSharedTexture(const QSharedPointer<LabelTextureCache> &cache,
+                                 GLuint textureId)
+{
+    releaseTexture();
+    m_textureId = textureId;
+    m_textureCache = cache;
+}
+
 GLuint LabelItem::textureId() const
 {
     return m_textureId;
@@ -65,10 +73,21 @@ GLuint LabelItem::textureId() const
 
 void LabelItem::clear()
 {
-    if (m_textureId && QOpenGLContext::currentContext())
-        QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_textureId);
+    if (m_textureId && (m_textureCache || QOpenGLContext::currentContext()))
+        releaseTexture();
     m_textureId = 0;
     m_size = QSize(0, 0);
 }
 
+void LabelItem::releaseTexture()
+{
+    if (m_textureCache) {
+        // Shared textures are deleted by the cache
+        m_textureCache->release(m_textureId);
+        m_textureCache.clear();
+    } else {
+        QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_textureId);
+    }
+}
+
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -41,7 +41,9 @@
 #define LABELITEM_P_H
 
 #include "datavisualizationglobal_p.h"
+#include "labeltexturecache_p.h"
 #include <QtCore/QSize>
+#include <QtCore/QSharedPointer>
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
@@ -54,14 +56,18 @@ public:
     void setSize(const QSize &size);
     QSize size() const;
     void setTextureId(GLuint textureId);
+    void setSharedTexture(const QSharedPointer<LabelTextureCache> &cache, GLuint textureId);
     GLuint textureId() const;
     void clear();
 
 private:
     Q_DISABLE_COPY(LabelItem)
 
+    void releaseTexture();
+
     QSize m_size;
     GLuint m_textureId;
+    QSharedPointer<LabelTextureCache> m_textureCache; // Set if the texture is shared
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
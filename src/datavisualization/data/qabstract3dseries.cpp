@@ -688,6 +688,11 @@ QAbstractDataProxy *QAbstract3DSeriesPrivate::dataProxy() const
     return m_dataProxy;
 }
 
+QAbstractDataProxyPrivate *QAbstract3DSeriesPrivate::dataProxyPrivate() const
+{
+    return m_dataProxy->d_ptr.data();
+}
+
 void QAbstract3DSeriesPrivate::setDataProxy(QAbstractDataProxy *proxy)
 {
     Q_ASSERT(proxy && proxy != m_dataProxy && !proxy->d_ptr->series());
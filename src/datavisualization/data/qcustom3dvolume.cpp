@@ -262,6 +262,18 @@ QT_BEGIN_NAMESPACE_DATAVISUALIZATION
  * \sa drawSliceFrames
  */
 
+/*!
+ * \qmlproperty int Custom3DVolume::brickSize
+ * \since QtDataVisualization 1.4
+ *
+ * The edge length of the bricks the volume is split into for rendering, in texels.
+ * If this property value is \c{0}, the volume is rendered from a single 3D texture.
+ *
+ * Defaults to \c{0}.
+ *
+ * \sa QCustom3DVolume::brickSize
+ */
+
 /*!
  * Constructs a custom 3D volume with the given \a parent.
  */
@@ -678,6 +690,10 @@ QVector<uchar> *QCustom3DVolume::textureData() const
  * The \a data is expected to be ordered similarly to the data in images
  * produced by the renderSlice() method along the same axis.
  *
+ * Only the changed subtextures are uploaded to the graphics hardware on the
+ * next render, so streaming a volume slice by slice does not require
+ * re-uploading the whole texture.
+ *
  * \note Each x-dimension line of the data needs to be 32-bit aligned when
  * targeting the y-axis or z-axis. If textureFormat is QImage::Format_Indexed8
  * and the textureWidth value is not divisible by four, padding bytes might need
@@ -740,7 +756,8 @@ void QCustom3DVolume::setSubTextureData(Qt::Axis axis, int index, const uchar *d
                 void *subTexPtr = dataPtr + targetIndex;
                 memcpy(subTexPtr, static_cast<const void *>(data), frameSize);
             }
-            dptr()->m_dirtyBitsVolume.textureDataDirty = true;
+            // Only the changed slab is uploaded to the existing texture
+            dptr()->markSubTextureDirty(axis, index);
             emit textureDataChanged(dptr()->m_textureData);
             emit dptr()->needUpdate();
         }
@@ -1122,6 +1139,48 @@ QVector3D QCustom3DVolume::sliceFrameThicknesses() const
     return dptrc()->m_sliceFrameThicknesses;
 }
 
+/*!
+ * \property QCustom3DVolume::brickSize
+ * \since QtDataVisualization 5.13
+ *
+ * \brief The edge length of the bricks the volume is split into for rendering,
+ * in texels.
+ *
+ * If this property value is greater than zero, the volume is split into bricks
+ * of at most this many texels along each dimension, and each brick gets its own
+ * 3D texture. Bricks that are fully transparent after the color table is
+ * applied are never uploaded or rendered. Other bricks are uploaded only when
+ * they are within the view and, when drawing slices, contain one of the active
+ * slices. Bricks that have not been rendered recently are released when the
+ * textures of all bricked volumes exceed the graphics memory budget of the
+ * graph.
+ *
+ * This allows rendering volumes that do not fit into a single texture, and
+ * makes rendering faster for volumes with large empty regions. Bricks that
+ * are not yet uploaded appear on the following frames.
+ *
+ * If this property value is \c{0}, the whole volume is rendered from a single
+ * 3D texture. Negative values are treated as \c{0}.
+ *
+ * Defaults to \c{0}.
+ */
+void QCustom3DVolume::setBrickSize(int size)
+{
+    if (size < 0)
+        size = 0;
+    if (dptr()->m_brickSize != size) {
+        dptr()->m_brickSize = size;
+        dptr()->m_dirtyBitsVolume.brickSizeDirty = true;
+        emit brickSizeChanged(size);
+        emit dptr()->needUpdate();
+    }
+}
+
+int QCustom3DVolume::brickSize() const
+{
+    return dptrc()->m_brickSize;
+}
+
 /*!
  * Renders the slice specified by \a index along the axis specified by \a axis
  * into an image.
@@ -1171,10 +1230,12 @@ QCustom3DVolumePrivate::QCustom3DVolumePrivate(QCustom3DVolume *q) :
     m_sliceFrameColor(Qt::black),
     m_sliceFrameWidths(QVector3D(0.01f, 0.01f, 0.01f)),
     m_sliceFrameGaps(QVector3D(0.01f, 0.01f, 0.01f)),
-    m_sliceFrameThicknesses(QVector3D(0.01f, 0.01f, 0.01f))
+    m_sliceFrameThicknesses(QVector3D(0.01f, 0.01f, 0.01f)),
+    m_brickSize(0)
 {
     m_isVolumeItem = true;
     m_meshFile = QStringLiteral(":/defaultMeshes/barFull");
+    clearDirtySubTextures();
 }
 
 QCustom3DVolumePrivate::QCustom3DVolumePrivate(QCustom3DVolume *q, const QVector3D &position,
@@ -1202,7 +1263,8 @@ QCustom3DVolumePrivate::QCustom3DVolumePrivate(QCustom3DVolume *q, const QVector
     m_sliceFrameColor(Qt::black),
     m_sliceFrameWidths(QVector3D(0.01f, 0.01f, 0.01f)),
     m_sliceFrameGaps(QVector3D(0.01f, 0.01f, 0.01f)),
-    m_sliceFrameThicknesses(QVector3D(0.01f, 0.01f, 0.01f))
+    m_sliceFrameThicknesses(QVector3D(0.01f, 0.01f, 0.01f)),
+    m_brickSize(0)
 {
     m_isVolumeItem = true;
     m_shadowCasting = false;
@@ -1217,6 +1279,7 @@ QCustom3DVolumePrivate::QCustom3DVolumePrivate(QCustom3DVolume *q, const QVector
     if (m_textureFormat != QImage::Format_Indexed8)
         m_textureFormat = QImage::Format_ARGB32;
 
+    clearDirtySubTextures();
 }
 
 QCustom3DVolumePrivate::~QCustom3DVolumePrivate()
@@ -1235,6 +1298,34 @@ void QCustom3DVolumePrivate::resetDirtyBits()
     m_dirtyBitsVolume.textureFormatDirty = false;
     m_dirtyBitsVolume.alphaDirty = false;
     m_dirtyBitsVolume.shaderDirty = false;
+    m_dirtyBitsVolume.brickSizeDirty = false;
+    clearDirtySubTextures();
+}
+
+void QCustom3DVolumePrivate::markSubTextureDirty(Qt::Axis axis, int index)
+{
+    int axisIndex = (axis == Qt::XAxis) ? 0 : (axis == Qt::YAxis) ? 1 : 2;
+    if (m_dirtySubTextureFirst[axisIndex] < 0) {
+        m_dirtySubTextureFirst[axisIndex] = index;
+        m_dirtySubTextureLast[axisIndex] = index;
+    } else {
+        m_dirtySubTextureFirst[axisIndex] = qMin(m_dirtySubTextureFirst[axisIndex], index);
+        m_dirtySubTextureLast[axisIndex] = qMax(m_dirtySubTextureLast[axisIndex], index);
+    }
+}
+
+bool QCustom3DVolumePrivate::hasDirtySubTextures() const
+{
+    return m_dirtySubTextureFirst[0] >= 0 || m_dirtySubTextureFirst[1] >= 0
+            || m_dirtySubTextureFirst[2] >= 0;
+}
+
+void QCustom3DVolumePrivate::clearDirtySubTextures()
+{
+    for (int i = 0; i < 3; i++) {
+        m_dirtySubTextureFirst[i] = -1;
+        m_dirtySubTextureLast[i] = -1;
+    }
 }
 
 QImage QCustom3DVolumePrivate::renderSlice(Qt::Axis axis, int index)
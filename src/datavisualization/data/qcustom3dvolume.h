@@ -59,6 +59,7 @@ class QT_DATAVISUALIZATION_EXPORT QCustom3DVolume : public QCustom3DItem
     Q_PROPERTY(QVector3D sliceFrameWidths READ sliceFrameWidths WRITE setSliceFrameWidths NOTIFY sliceFrameWidthsChanged)
     Q_PROPERTY(QVector3D sliceFrameGaps READ sliceFrameGaps WRITE setSliceFrameGaps NOTIFY sliceFrameGapsChanged)
     Q_PROPERTY(QVector3D sliceFrameThicknesses READ sliceFrameThicknesses WRITE setSliceFrameThicknesses NOTIFY sliceFrameThicknessesChanged)
+    Q_PROPERTY(int brickSize READ brickSize WRITE setBrickSize NOTIFY brickSizeChanged REVISION 1)
 
 public:
 
@@ -121,6 +122,9 @@ public:
     void setSliceFrameThicknesses(const QVector3D &values);
     QVector3D sliceFrameThicknesses() const;
 
+    void setBrickSize(int size);
+    int brickSize() const;
+
     QImage renderSlice(Qt::Axis axis, int index);
 
 Q_SIGNALS:
@@ -142,6 +146,7 @@ Q_SIGNALS:
     void sliceFrameWidthsChanged(const QVector3D &values);
     void sliceFrameGapsChanged(const QVector3D &values);
     void sliceFrameThicknessesChanged(const QVector3D &values);
+    Q_REVISION(1) void brickSizeChanged(int size);
 
 protected:
     QCustom3DVolumePrivate *dptr();
@@ -53,6 +53,7 @@ struct QCustomVolumeDirtyBitField {
     bool textureFormatDirty     : 1;
     bool alphaDirty             : 1;
     bool shaderDirty            : 1;
+    bool brickSizeDirty         : 1;
 
     QCustomVolumeDirtyBitField()
         : textureDimensionsDirty(false),
@@ -61,12 +62,13 @@ struct QCustomVolumeDirtyBitField {
           textureDataDirty(false),
           textureFormatDirty(false),
           alphaDirty(false),
-          shaderDirty(false)
+          shaderDirty(false),
+          brickSizeDirty(false)
     {
     }
 };
 
-class QCustom3DVolumePrivate : public QCustom3DItemPrivate
+class QT_DATAVISUALIZATION_EXPORT QCustom3DVolumePrivate : public QCustom3DItemPrivate
 {
     Q_OBJECT
 
@@ -81,6 +83,10 @@ public:
     void resetDirtyBits();
     QImage renderSlice(Qt::Axis axis, int index);
 
+    void markSubTextureDirty(Qt::Axis axis, int index);
+    bool hasDirtySubTextures() const;
+    void clearDirtySubTextures();
+
     QCustom3DVolume *qptr();
 
 public:
@@ -105,9 +111,15 @@ public:
     QVector3D m_sliceFrameWidths;
     QVector3D m_sliceFrameGaps;
     QVector3D m_sliceFrameThicknesses;
+    int m_brickSize;
 
     QCustomVolumeDirtyBitField m_dirtyBitsVolume;
 
+    // Inclusive ranges of subtextures changed by setSubTextureData() since the last sync,
+    // indexed by axis (x, y, z). A negative first index means the axis has no changes.
+    int m_dirtySubTextureFirst[3];
+    int m_dirtySubTextureLast[3];
+
 private:
     int multipliedAlphaValue(int alpha);
 
@@ -28,12 +28,16 @@
 ****************************************************************************/
 
 #include "qheightmapsurfacedataproxy_p.h"
+#include "rowblocks_p.h"
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
 // Default ranges correspond value axis defaults
 const float defaultMinValue = 0.0f;
 const float defaultMaxValue = 10.0f;
+// Height map conversion is split into row blocks of at least this many pixels, as smaller
+// blocks don't gain enough from the worker threads to cover the cost of starting them
+const int minPixelsPerRowBlock = 65536;
 
 /*!
  * \class QHeightMapSurfaceDataProxy
@@ -79,12 +83,14 @@ const float defaultMaxValue = 10.0f;
  * format, a conversion is made.
  *
  * \note If the result seems wrong, the automatic conversion failed
- * and you should try converting the image yourself before setting it. Preferred format is
- * QImage::Format_RGB32 in grayscale.
+ * and you should try converting the image yourself before setting it. Preferred formats are
+ * QImage::Format_Grayscale8, QImage::Format_Grayscale16, and QImage::Format_RGB32, which are
+ * read without conversion.
  *
- * The height of the image is read from the red component of the pixels if the image is in grayscale,
- * otherwise it is an average calculated from red, green and blue components of the pixels. Using
- * grayscale images may improve data conversion speed for large images.
+ * The height of a grayscale image is the gray value of the pixels, so 16-bit images give heights
+ * from \c 0 to \c 65535. For other formats the height is an average calculated from red, green,
+ * and blue components of the pixels. Using grayscale formats may improve data conversion speed
+ * for large images.
  *
  * Since height maps do not contain values for X or Z axes, those values need to be given
  * separately using minXValue, maxXValue, minZValue, and maxZValue properties. X-value corresponds
@@ -187,12 +193,14 @@ QHeightMapSurfaceDataProxy::~QHeightMapSurfaceDataProxy()
  * format, a conversion is made.
  *
  * \note If the result seems wrong, the automatic conversion failed
- * and you should try converting the \a image yourself before setting it. Preferred format is
- * QImage::Format_RGB32 in grayscale.
+ * and you should try converting the \a image yourself before setting it. Preferred formats are
+ * QImage::Format_Grayscale8, QImage::Format_Grayscale16, and QImage::Format_RGB32, which are
+ * read without conversion.
  *
- * The height of the \a image is read from the red component of the pixels if the \a image is in
- * grayscale, otherwise it is an average calculated from red, green, and blue components of the
- * pixels. Using grayscale images may improve data conversion speed for large images.
+ * The height of a QImage::Format_Grayscale8 or QImage::Format_Grayscale16 \a image is the gray
+ * value of the pixels, so 16-bit images give heights from \c 0 to \c 65535. For other formats
+ * the height is an average calculated from red, green, and blue components of the pixels.
+ * Using grayscale formats may improve data conversion speed for large images.
  *
  * Not recommended formats: all mono formats (for example QImage::Format_Mono).
  *
@@ -202,6 +210,8 @@ QHeightMapSurfaceDataProxy::~QHeightMapSurfaceDataProxy()
 void QHeightMapSurfaceDataProxy::setHeightMap(const QImage &image)
 {
     dptr()->m_heightMap = image;
+    dptr()->m_heightData.clear();
+    dptr()->m_heightDataWidth = 0;
 
     // We do resolving asynchronously to make qml onArrayReset handlers actually get the initial reset
     if (!dptr()->m_resolveTimer.isActive())
@@ -237,6 +247,38 @@ QString QHeightMapSurfaceDataProxy::heightMapFile() const
     return dptrc()->m_heightMapFile;
 }
 
+/*!
+ * \since QtDataVisualization 5.13
+ *
+ * Replaces current data with the raw height values in \a heights. The values are laid out
+ * like the lines of a height map image: \a width values per row, with the first row
+ * corresponding to the maximum Z value. The values are used as the heights as they are,
+ * which avoids any conversion when visualizing elevation data that is already in memory.
+ *
+ * The size of \a heights must be a multiple of \a width. Setting height data clears
+ * the heightMap image.
+ *
+ * The height data is resolved asynchronously. QSurfaceDataProxy::arrayReset() is emitted when
+ * the data has been resolved.
+ *
+ * \sa heightMap
+ */
+void QHeightMapSurfaceDataProxy::setHeightData(const QVector<float> &heights, int width)
+{
+    if (!heights.isEmpty() && (width <= 0 || heights.size() % width)) {
+        qWarning() << "Warning: Tried to set height data with invalid width:" << width
+                   << "for" << heights.size() << "values.";
+        return;
+    }
+
+    dptr()->m_heightMap = QImage();
+    dptr()->m_heightData = heights;
+    dptr()->m_heightDataWidth = heights.isEmpty() ? 0 : width;
+
+    if (!dptr()->m_resolveTimer.isActive())
+        dptr()->m_resolveTimer.start(0);
+}
+
 /*!
  * A convenience function for setting all minimum (\a minX and \a minZ) and maximum
  * (\a maxX and \a maxZ) values at the same time. The minimum values must be smaller than the
@@ -347,6 +389,7 @@ const QHeightMapSurfaceDataProxyPrivate *QHeightMapSurfaceDataProxy::dptrc() con
 
 QHeightMapSurfaceDataProxyPrivate::QHeightMapSurfaceDataProxyPrivate(QHeightMapSurfaceDataProxy *q)
     : QSurfaceDataProxyPrivate(q),
+      m_heightDataWidth(0),
       m_minXValue(defaultMinValue),
       m_maxXValue(defaultMaxValue),
       m_minZValue(defaultMinValue),
@@ -507,29 +550,31 @@ void QHeightMapSurfaceDataProxyPrivate::setMaxZValue(float max)
 
 void QHeightMapSurfaceDataProxyPrivate::handlePendingResolve()
 {
-    QImage heightImage = m_heightMap;
-
-    // Convert to RGB32 to be sure we're reading the right bytes
-    if (heightImage.format() != QImage::Format_RGB32)
-        heightImage = heightImage.convertToFormat(QImage::Format_RGB32);
-
-    uchar *bits = heightImage.bits();
-
-    int imageHeight = heightImage.height();
-    int imageWidth = heightImage.width();
-    int bitCount = imageWidth * 4 * (imageHeight - 1);
-    int widthBits = imageWidth * 4;
-    float height = 0;
+    QImage heightImage;
+    const float *heightData = nullptr;
+    int imageWidth;
+    int imageHeight;
+    if (m_heightDataWidth > 0) {
+        heightData = m_heightData.constData();
+        imageWidth = m_heightDataWidth;
+        imageHeight = m_heightData.size() / m_heightDataWidth;
+    } else {
+        heightImage = m_heightMap;
+        // Convert other formats to RGB32 to be sure we're reading the right bytes
+        if (!isDirectlyReadable(heightImage.format()))
+            heightImage = heightImage.convertToFormat(QImage::Format_RGB32);
+        imageWidth = heightImage.width();
+        imageHeight = heightImage.height();
+    }
 
     // Do not recreate array if dimensions have not changed
     QSurfaceDataArray *dataArray = m_dataArray;
-    if (imageWidth != qptr()->columnCount() || imageHeight != dataArray->size()) {
-        dataArray = new QSurfaceDataArray;
-        dataArray->reserve(imageHeight);
-        for (int i = 0; i < imageHeight; i++) {
-            QSurfaceDataRow *newProxyRow = new QSurfaceDataRow(imageWidth);
-            dataArray->append(newProxyRow);
-        }
+    bool newArray = imageWidth != qptr()->columnCount() || imageHeight != dataArray->size();
+    QVector<QSurfaceDataRow *> rowVector(imageHeight);
+    QSurfaceDataRow **rows = rowVector.data();
+    if (!newArray) {
+        for (int i = 0; i < imageHeight; i++)
+            rows[i] = dataArray->at(i);
     }
 
     float xMul = (m_maxXValue - m_minXValue) / float(imageWidth - 1);
@@ -542,56 +587,102 @@ void QHeightMapSurfaceDataProxyPrivate::handlePendingResolve()
     int lastRow = imageHeight - 1;
     int lastCol = imageWidth - 1;
 
-    if (heightImage.isGrayscale()) {
-        // Grayscale, it's enough to read Red byte
-        for (int i = 0; i < imageHeight; i++, bitCount -= widthBits) {
-            QSurfaceDataRow &newRow = *dataArray->at(i);
-            float zVal;
-            if (i == lastRow)
-                zVal = m_maxZValue;
-            else
-                zVal = (float(i) * zMul) + m_minZValue;
-            int j = 0;
-            for (; j < lastCol; j++)
-                newRow[j].setPosition(QVector3D((float(j) * xMul) + m_minXValue,
-                                                float(bits[bitCount + (j * 4)]),
-                                      zVal));
-            newRow[j].setPosition(QVector3D(m_maxXValue,
-                                            float(bits[bitCount + (j * 4)]),
-                                  zVal));
-        }
-    } else {
-        // Not grayscale, we'll need to calculate height from RGB
-        for (int i = 0; i < imageHeight; i++, bitCount -= widthBits) {
-            QSurfaceDataRow &newRow = *dataArray->at(i);
+    // X values are the same for every row
+    QVector<float> xVector(imageWidth);
+    float *xValues = xVector.data();
+    for (int j = 0; j < lastCol; j++)
+        xValues[j] = (float(j) * xMul) + m_minXValue;
+    if (imageWidth)
+        xValues[lastCol] = m_maxXValue;
+
+    // The first row of the array is the last line of the image, so that image top is at max Z.
+    // Rows are independent of each other, so they are converted in parallel blocks.
+    int blockCount = qMin(QThreadPool::globalInstance()->maxThreadCount() + 1,
+                          (imageWidth * imageHeight) / minPixelsPerRowBlock);
+    blockCount = qBound(1, blockCount, qMax(1, imageHeight));
+    forEachRowBlock(imageHeight, blockCount, [&](int block, int startRow, int endRow) {
+        Q_UNUSED(block)
+        QVector<float> lineVector(heightData ? 0 : imageWidth);
+        float *lineHeights = lineVector.data();
+        for (int i = startRow; i < endRow; i++) {
+            int line = lastRow - i;
+            const float *heights;
+            if (heightData) {
+                heights = heightData + line * imageWidth;
+            } else {
+                readImageLine(heightImage, line, lineHeights);
+                heights = lineHeights;
+            }
+
+            if (newArray)
+                rows[i] = new QSurfaceDataRow(imageWidth);
+            QSurfaceDataItem *items = rows[i]->data();
             float zVal;
             if (i == lastRow)
                 zVal = m_maxZValue;
             else
                 zVal = (float(i) * zMul) + m_minZValue;
-            int j = 0;
-            int nextpixel = 0;
-            for (; j < lastCol; j++) {
-                nextpixel = j * 4;
-                height = (float(bits[bitCount + nextpixel])
-                        + float(bits[1 + bitCount + nextpixel])
-                        + float(bits[2 + bitCount + nextpixel]));
-                newRow[j].setPosition(QVector3D((float(j) * xMul) + m_minXValue,
-                                                height / 3.0f,
-                                                zVal));
-            }
-            nextpixel = j * 4;
-            height = (float(bits[bitCount + nextpixel])
-                    + float(bits[1 + bitCount + nextpixel])
-                    + float(bits[2 + bitCount + nextpixel]));
-            newRow[j].setPosition(QVector3D(m_maxXValue,
-                                            height / 3.0f,
-                                            zVal));
+            for (int j = 0; j < imageWidth; j++)
+                items[j].setPosition(QVector3D(xValues[j], heights[j], zVal));
         }
+    });
+
+    if (newArray) {
+        dataArray = new QSurfaceDataArray;
+        dataArray->reserve(imageHeight);
+        for (int i = 0; i < imageHeight; i++)
+            dataArray->append(rows[i]);
     }
 
     qptr()->resetArray(dataArray);
-    emit qptr()->heightMapChanged(m_heightMap);
+    // Height data has no height map to report
+    if (!heightData)
+        emit qptr()->heightMapChanged(m_heightMap);
+}
+
+bool QHeightMapSurfaceDataProxyPrivate::isDirectlyReadable(QImage::Format format)
+{
+    switch (format) {
+    case QImage::Format_RGB32:
+    case QImage::Format_Grayscale8:
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    case QImage::Format_Grayscale16:
+#endif
+        return true;
+    default:
+        return false;
+    }
+}
+
+void QHeightMapSurfaceDataProxyPrivate::readImageLine(const QImage &image, int line,
+                                                      float *heights)
+{
+    // The loops are kept free of branches so that the compiler can vectorize them
+    const int width = image.width();
+    switch (image.format()) {
+    case QImage::Format_Grayscale8: {
+        const uchar *bits = image.constScanLine(line);
+        for (int j = 0; j < width; j++)
+            heights[j] = float(bits[j]);
+        break;
+    }
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    case QImage::Format_Grayscale16: {
+        const quint16 *bits = reinterpret_cast<const quint16 *>(image.constScanLine(line));
+        for (int j = 0; j < width; j++)
+            heights[j] = float(bits[j]);
+        break;
+    }
+#endif
+    default: {
+        // RGB32, height is the average of the red, green, and blue components. For grayscale
+        // pixels this is the same as the red component.
+        const QRgb *bits = reinterpret_cast<const QRgb *>(image.constScanLine(line));
+        for (int j = 0; j < width; j++)
+            heights[j] = float(qRed(bits[j]) + qGreen(bits[j]) + qBlue(bits[j])) / 3.0f;
+        break;
+    }
+    }
 }
 
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -33,6 +33,7 @@
 #include <QtDataVisualization/qsurfacedataproxy.h>
 #include <QtGui/QImage>
 #include <QtCore/QString>
+#include <QtCore/QVector>
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
@@ -59,6 +60,7 @@ public:
     QImage heightMap() const;
     void setHeightMapFile(const QString &filename);
     QString heightMapFile() const;
+    void setHeightData(const QVector<float> &heights, int width);
 
     void setValueRanges(float minX, float maxX, float minZ, float maxZ);
     void setMinXValue(float min);
@@ -62,9 +62,13 @@ public:
 private:
     QHeightMapSurfaceDataProxy *qptr();
     void handlePendingResolve();
+    static bool isDirectlyReadable(QImage::Format format);
+    static void readImageLine(const QImage &image, int line, float *heights);
 
     QImage m_heightMap;
     QString m_heightMapFile;
+    QVector<float> m_heightData;
+    int m_heightDataWidth;
     QTimer m_resolveTimer;
 
     float m_minXValue;
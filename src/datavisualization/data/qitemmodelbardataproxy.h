@@ -61,6 +61,7 @@ class QT_DATAVISUALIZATION_EXPORT QItemModelBarDataProxy : public QBarDataProxy
     Q_PROPERTY(QString valueRoleReplace READ valueRoleReplace WRITE setValueRoleReplace NOTIFY valueRoleReplaceChanged REVISION 1)
     Q_PROPERTY(QString rotationRoleReplace READ rotationRoleReplace WRITE setRotationRoleReplace NOTIFY rotationRoleReplaceChanged REVISION 1)
     Q_PROPERTY(MultiMatchBehavior multiMatchBehavior READ multiMatchBehavior WRITE setMultiMatchBehavior NOTIFY multiMatchBehaviorChanged REVISION 1)
+    Q_PROPERTY(bool backgroundResolveEnabled READ isBackgroundResolveEnabled WRITE setBackgroundResolveEnabled NOTIFY backgroundResolveEnabledChanged REVISION 2)
 
 public:
     enum MultiMatchBehavior {
@@ -143,6 +144,9 @@ public:
     void setMultiMatchBehavior(MultiMatchBehavior behavior);
     MultiMatchBehavior multiMatchBehavior() const;
 
+    void setBackgroundResolveEnabled(bool enable);
+    bool isBackgroundResolveEnabled() const;
+
 Q_SIGNALS:
     void itemModelChanged(const QAbstractItemModel* itemModel);
     void rowRoleChanged(const QString &role);
@@ -163,6 +167,7 @@ Q_SIGNALS:
     Q_REVISION(1) void valueRoleReplaceChanged(const QString &replace);
     Q_REVISION(1) void rotationRoleReplaceChanged(const QString &replace);
     Q_REVISION(1) void multiMatchBehaviorChanged(MultiMatchBehavior behavior);
+    Q_REVISION(2) void backgroundResolveEnabledChanged(bool enable);
 
 protected:
     QItemModelBarDataProxyPrivate *dptr();
@@ -208,6 +208,15 @@ QT_BEGIN_NAMESPACE_DATAVISUALIZATION
  * \sa rotationRole, rotationRolePattern
  */
 
+/*!
+ * \qmlproperty bool ItemModelScatterDataProxy::backgroundResolveEnabled
+ * \since QtDataVisualization 1.4
+ *
+ * Whether the data is converted in a background thread. Defaults to \c false.
+ *
+ * \sa QItemModelScatterDataProxy::backgroundResolveEnabled
+ */
+
 /*!
  * Constructs QItemModelScatterDataProxy with optional \a parent.
  */
@@ -583,6 +592,33 @@ void QItemModelScatterDataProxy::remap(const QString &xPosRole, const QString &y
     setRotationRole(rotationRole);
 }
 
+/*!
+ * \property QItemModelScatterDataProxy::backgroundResolveEnabled
+ * \since QtDataVisualization 5.13
+ *
+ * \brief Whether the data is converted in a background thread.
+ *
+ * When enabled, the proxy copies the mapped data out of the item model whenever the model or the
+ * mapping changes, and converts the copy into the data array in a background thread that the
+ * proxies share. The array is reset once the conversion is finished. This keeps the application
+ * responsive while large models are resolved. Changes to the model made during a conversion
+ * start a new one.
+ *
+ * Defaults to \c false.
+ */
+void QItemModelScatterDataProxy::setBackgroundResolveEnabled(bool enable)
+{
+    if (dptr()->m_itemModelHandler->isBackgroundResolveEnabled() != enable) {
+        dptr()->m_itemModelHandler->setBackgroundResolveEnabled(enable);
+        emit backgroundResolveEnabledChanged(enable);
+    }
+}
+
+bool QItemModelScatterDataProxy::isBackgroundResolveEnabled() const
+{
+    return dptrc()->m_itemModelHandler->isBackgroundResolveEnabled();
+}
+
 /*!
  * \internal
  */
@@ -55,6 +55,7 @@ class QT_DATAVISUALIZATION_EXPORT QItemModelScatterDataProxy : public QScatterDa
     Q_PROPERTY(QString yPosRoleReplace READ yPosRoleReplace WRITE setYPosRoleReplace NOTIFY yPosRoleReplaceChanged REVISION 1)
     Q_PROPERTY(QString zPosRoleReplace READ zPosRoleReplace WRITE setZPosRoleReplace NOTIFY zPosRoleReplaceChanged REVISION 1)
     Q_PROPERTY(QString rotationRoleReplace READ rotationRoleReplace WRITE setRotationRoleReplace NOTIFY rotationRoleReplaceChanged REVISION 1)
+    Q_PROPERTY(bool backgroundResolveEnabled READ isBackgroundResolveEnabled WRITE setBackgroundResolveEnabled NOTIFY backgroundResolveEnabledChanged REVISION 2)
 
 public:
     explicit QItemModelScatterDataProxy(QObject *parent = nullptr);
@@ -101,6 +102,9 @@ public:
     void setRotationRoleReplace(const QString &replace);
     QString rotationRoleReplace() const;
 
+    void setBackgroundResolveEnabled(bool enable);
+    bool isBackgroundResolveEnabled() const;
+
 Q_SIGNALS:
     void itemModelChanged(const QAbstractItemModel* itemModel);
     void xPosRoleChanged(const QString &role);
@@ -115,6 +119,7 @@ Q_SIGNALS:
     Q_REVISION(1) void xPosRoleReplaceChanged(const QString &replace);
     Q_REVISION(1) void yPosRoleReplaceChanged(const QString &replace);
     Q_REVISION(1) void zPosRoleReplaceChanged(const QString &replace);
+    Q_REVISION(2) void backgroundResolveEnabledChanged(bool enable);
 
 protected:
     QItemModelScatterDataProxyPrivate *dptr();
@@ -336,6 +336,15 @@ QT_BEGIN_NAMESPACE_DATAVISUALIZATION
  *         instead of averaged and the total is used as the surface point Y position.
  */
 
+/*!
+ * \qmlproperty bool ItemModelSurfaceDataProxy::backgroundResolveEnabled
+ * \since QtDataVisualization 1.4
+ *
+ * Whether the data is converted in a background thread. Defaults to \c false.
+ *
+ * \sa QItemModelSurfaceDataProxy::backgroundResolveEnabled
+ */
+
 /*!
  * Constructs QItemModelSurfaceDataProxy with optional \a parent.
  */
@@ -1038,6 +1047,33 @@ QItemModelSurfaceDataProxy::MultiMatchBehavior QItemModelSurfaceDataProxy::multi
     return dptrc()->m_multiMatchBehavior;
 }
 
+/*!
+ * \property QItemModelSurfaceDataProxy::backgroundResolveEnabled
+ * \since QtDataVisualization 5.13
+ *
+ * \brief Whether the data is converted in a background thread.
+ *
+ * When enabled, the proxy copies the mapped data out of the item model whenever the model or the
+ * mapping changes, and converts the copy into the data array in a background thread that the
+ * proxies share. The array is reset once the conversion is finished. This keeps the application
+ * responsive while large models are resolved. Changes to the model made during a conversion
+ * start a new one.
+ *
+ * Defaults to \c false.
+ */
+void QItemModelSurfaceDataProxy::setBackgroundResolveEnabled(bool enable)
+{
+    if (dptr()->m_itemModelHandler->isBackgroundResolveEnabled() != enable) {
+        dptr()->m_itemModelHandler->setBackgroundResolveEnabled(enable);
+        emit backgroundResolveEnabledChanged(enable);
+    }
+}
+
+bool QItemModelSurfaceDataProxy::isBackgroundResolveEnabled() const
+{
+    return dptrc()->m_itemModelHandler->isBackgroundResolveEnabled();
+}
+
 /*!
  * \internal
  */
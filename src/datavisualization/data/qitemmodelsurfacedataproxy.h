@@ -65,6 +65,7 @@ class QT_DATAVISUALIZATION_EXPORT QItemModelSurfaceDataProxy : public QSurfaceDa
     Q_PROPERTY(QString yPosRoleReplace READ yPosRoleReplace WRITE setYPosRoleReplace NOTIFY yPosRoleReplaceChanged REVISION 1)
     Q_PROPERTY(QString zPosRoleReplace READ zPosRoleReplace WRITE setZPosRoleReplace NOTIFY zPosRoleReplaceChanged REVISION 1)
     Q_PROPERTY(MultiMatchBehavior multiMatchBehavior READ multiMatchBehavior WRITE setMultiMatchBehavior NOTIFY multiMatchBehaviorChanged REVISION 1)
+    Q_PROPERTY(bool backgroundResolveEnabled READ isBackgroundResolveEnabled WRITE setBackgroundResolveEnabled NOTIFY backgroundResolveEnabledChanged REVISION 2)
 
 public:
     enum MultiMatchBehavior {
@@ -157,6 +158,9 @@ public:
     void setMultiMatchBehavior(MultiMatchBehavior behavior);
     MultiMatchBehavior multiMatchBehavior() const;
 
+    void setBackgroundResolveEnabled(bool enable);
+    bool isBackgroundResolveEnabled() const;
+
 Q_SIGNALS:
     void itemModelChanged(const QAbstractItemModel* itemModel);
     void rowRoleChanged(const QString &role);
@@ -180,6 +184,7 @@ Q_SIGNALS:
     Q_REVISION(1) void yPosRoleReplaceChanged(const QString &replace);
     Q_REVISION(1) void zPosRoleReplaceChanged(const QString &replace);
     Q_REVISION(1) void multiMatchBehaviorChanged(MultiMatchBehavior behavior);
+    Q_REVISION(2) void backgroundResolveEnabledChanged(bool enable);
 
 protected:
     QItemModelSurfaceDataProxyPrivate *dptr();
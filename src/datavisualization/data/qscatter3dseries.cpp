@@ -29,6 +29,7 @@
 
 #include "qscatter3dseries_p.h"
 #include "scatter3dcontroller_p.h"
+#include "qscatterdataproxy_p.h"
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
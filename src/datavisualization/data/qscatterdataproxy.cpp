@@ -33,6 +33,9 @@
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
+// Number of items in a block of cached value limits
+static const int limitBlockSize = 1024;
+
 /*!
  * \class QScatterDataProxy
  * \inmodule QtDataVisualization
@@ -46,6 +49,10 @@ QT_BEGIN_NAMESPACE_DATAVISUALIZATION
  * QtDataVisualization::QScatterDataArray and QScatterDataItem objects passed to
  * it.
  *
+ * Large data sets can also be given as separate, caller-owned arrays of coordinates
+ * without copying them. See resetArray(const float *, const float *, const float *, int,
+ * const QQuaternion *).
+ *
  * \sa {Qt Data Visualization Data Handling}
  */
 
@@ -89,6 +96,7 @@ QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 QScatterDataProxy::QScatterDataProxy(QObject *parent) :
     QAbstractDataProxy(new QScatterDataProxyPrivate(this), parent)
 {
+    dptr()->connectDataCaches();
 }
 
 /*!
@@ -97,6 +105,7 @@ QScatterDataProxy::QScatterDataProxy(QObject *parent) :
 QScatterDataProxy::QScatterDataProxy(QScatterDataProxyPrivate *d, QObject *parent) :
     QAbstractDataProxy(d, parent)
 {
+    dptr()->connectDataCaches();
 }
 
 /*!
@@ -125,13 +134,41 @@ QScatter3DSeries *QScatterDataProxy::series() const
  */
 void QScatterDataProxy::resetArray(QScatterDataArray *newArray)
 {
-    if (dptr()->m_dataArray != newArray)
+    if (dptr()->m_dataArray != newArray || dptr()->m_xValues)
         dptr()->resetArray(newArray);
 
     emit arrayReset();
     emit itemCountChanged(itemCount());
 }
 
+/*!
+ * \overload
+ * \since QtDataVisualization 5.13
+ *
+ * Replaces the data with \a count items whose coordinates are read from the arrays
+ * \a xValues, \a yValues, and \a zValues, and rotations from the optional array
+ * \a rotations. Items without a rotations array have no rotation.
+ *
+ * The arrays are not copied, and the proxy does not take ownership of them. They must
+ * stay valid until the data is reset again or the proxy is deleted. If the values in
+ * the arrays are changed, emit itemsChanged() for the changed items, or call this
+ * function again with the same arrays if most of the items changed.
+ *
+ * While the proxy uses external arrays, itemAt() returns a copy of the requested item,
+ * and array() returns a copy of all items that is created on first use. Any call that adds,
+ * changes, inserts, or removes individual items first copies the external data into a new
+ * array owned by the proxy.
+ */
+void QScatterDataProxy::resetArray(const float *xValues, const float *yValues,
+                                   const float *zValues, int count,
+                                   const QQuaternion *rotations)
+{
+    dptr()->resetArray(xValues, yValues, zValues, count, rotations);
+
+    emit arrayReset();
+    emit itemCountChanged(itemCount());
+}
+
 /*!
  * Replaces the item at the position \a index with the item \a item.
  */
@@ -206,7 +243,7 @@ void QScatterDataProxy::insertItems(int index, const QScatterDataArray &items)
  */
 void QScatterDataProxy::removeItems(int index, int removeCount)
 {
-    if (index >= dptr()->m_dataArray->size())
+    if (index >= itemCount())
         return;
 
     dptr()->removeItems(index, removeCount);
@@ -221,24 +258,40 @@ void QScatterDataProxy::removeItems(int index, int removeCount)
  */
 int QScatterDataProxy::itemCount() const
 {
-    return dptrc()->m_dataArray->size();
+    return dptrc()->itemCount();
 }
 
 /*!
  * Returns the pointer to the data array.
+ *
+ * If the data is given as external arrays, the returned array is a copy of the external
+ * data. The copy is made on the first call after the data is reset, and it is kept up to
+ * date when itemsChanged() is emitted for the changed items. Avoid calling this function
+ * for large external data sets, as the copy needs as much memory as an array owned by
+ * the proxy.
  */
 const QScatterDataArray *QScatterDataProxy::array() const
 {
-    return dptrc()->m_dataArray;
+    return dptrc()->externalArray();
 }
 
 /*!
  * Returns the pointer to the item at the index \a index. It is guaranteed to be
  * valid only until the next call that modifies data.
+ *
+ * If the data is given as external arrays, the returned item is a copy of the external
+ * data, and it is valid only until the next call to this function.
  */
 const QScatterDataItem *QScatterDataProxy::itemAt(int index) const
 {
-    return &dptrc()->m_dataArray->at(index);
+    const QScatterDataProxyPrivate *d = dptrc();
+    if (d->m_xValues) {
+        Q_ASSERT(index >= 0 && index < d->m_externalCount);
+        d->m_externalItem = QScatterDataItem(d->itemPosition(index), d->itemRotation(index));
+        return &d->m_externalItem;
+    }
+
+    return &d->m_dataArray->at(index);
 }
 
 /*!
@@ -306,7 +359,15 @@ const QScatterDataProxyPrivate *QScatterDataProxy::dptrc() const
 
 QScatterDataProxyPrivate::QScatterDataProxyPrivate(QScatterDataProxy *q)
     : QAbstractDataProxyPrivate(q, QAbstractDataProxy::DataTypeScatter),
-      m_dataArray(new QScatterDataArray)
+      m_dataArray(new QScatterDataArray),
+      m_xValues(0),
+      m_yValues(0),
+      m_zValues(0),
+      m_rotations(0),
+      m_externalCount(0),
+      m_externalArrayValid(false),
+      m_limitItemCount(0),
+      m_limitBlocksValid(false)
 {
 }
 
@@ -326,16 +387,71 @@ void QScatterDataProxyPrivate::resetArray(QScatterDataArray *newArray)
         delete m_dataArray;
         m_dataArray = newArray;
     }
+
+    m_xValues = 0;
+    m_yValues = 0;
+    m_zValues = 0;
+    m_rotations = 0;
+    m_externalCount = 0;
+    m_externalArrayValid = false;
+}
+
+void QScatterDataProxyPrivate::resetArray(const float *xValues, const float *yValues,
+                                          const float *zValues, int count,
+                                          const QQuaternion *rotations)
+{
+    if (!xValues || !yValues || !zValues || count <= 0) {
+        resetArray(0);
+        return;
+    }
+
+    m_dataArray->clear();
+    m_xValues = xValues;
+    m_yValues = yValues;
+    m_zValues = zValues;
+    m_rotations = rotations;
+    m_externalCount = count;
+    m_externalArrayValid = false;
+}
+
+// Copies the external data to the proxy's own array, so that items can be modified
+void QScatterDataProxyPrivate::detachExternalData()
+{
+    if (!m_xValues)
+        return;
+
+    externalArray();
+
+    m_xValues = 0;
+    m_yValues = 0;
+    m_zValues = 0;
+    m_rotations = 0;
+    m_externalCount = 0;
+    m_externalArrayValid = false;
+}
+
+// Returns the data array, which holds a copy of the external data if there is any
+QScatterDataArray *QScatterDataProxyPrivate::externalArray() const
+{
+    if (m_xValues && !m_externalArrayValid) {
+        m_dataArray->resize(m_externalCount);
+        for (int i = 0; i < m_externalCount; i++)
+            (*m_dataArray)[i] = QScatterDataItem(itemPosition(i), itemRotation(i));
+        m_externalArrayValid = true;
+    }
+    return m_dataArray;
 }
 
 void QScatterDataProxyPrivate::setItem(int index, const QScatterDataItem &item)
 {
+    detachExternalData();
     Q_ASSERT(index >= 0 && index < m_dataArray->size());
     (*m_dataArray)[index] = item;
 }
 
 void QScatterDataProxyPrivate::setItems(int index, const QScatterDataArray &items)
 {
+    detachExternalData();
     Q_ASSERT(index >= 0 && (index + items.size()) <= m_dataArray->size());
     for (int i = 0; i < items.size(); i++)
         (*m_dataArray)[index++] = items[i];
@@ -343,6 +459,7 @@ void QScatterDataProxyPrivate::setItems(int index, const QScatterDataArray &item
 
 int QScatterDataProxyPrivate::addItem(const QScatterDataItem &item)
 {
+    detachExternalData();
     int currentSize = m_dataArray->size();
     m_dataArray->append(item);
     return currentSize;
@@ -350,6 +467,7 @@ int QScatterDataProxyPrivate::addItem(const QScatterDataItem &item)
 
 int QScatterDataProxyPrivate::addItems(const QScatterDataArray &items)
 {
+    detachExternalData();
     int currentSize = m_dataArray->size();
     (*m_dataArray) += items;
     return currentSize;
@@ -357,12 +475,14 @@ int QScatterDataProxyPrivate::addItems(const QScatterDataArray &items)
 
 void QScatterDataProxyPrivate::insertItem(int index, const QScatterDataItem &item)
 {
+    detachExternalData();
     Q_ASSERT(index >= 0 && index <= m_dataArray->size());
     m_dataArray->insert(index, item);
 }
 
 void QScatterDataProxyPrivate::insertItems(int index, const QScatterDataArray &items)
 {
+    detachExternalData();
     Q_ASSERT(index >= 0 && index <= m_dataArray->size());
     for (int i = 0; i < items.size(); i++)
         m_dataArray->insert(index++, items.at(i));
@@ -370,6 +490,7 @@ void QScatterDataProxyPrivate::insertItems(int index, const QScatterDataArray &i
 
 void QScatterDataProxyPrivate::removeItems(int index, int removeCount)
 {
+    detachExternalData();
     Q_ASSERT(index >= 0);
     int maxRemoveCount = m_dataArray->size() - index;
     removeCount = qMin(removeCount, maxRemoveCount);
@@ -380,63 +501,56 @@ void QScatterDataProxyPrivate::limitValues(QVector3D &minValues, QVector3D &maxV
                                            QAbstract3DAxis *axisX, QAbstract3DAxis *axisY,
                                            QAbstract3DAxis *axisZ) const
 {
-    if (m_dataArray->isEmpty())
+    const int count = itemCount();
+    if (!count)
         return;
 
-    const QVector3D &firstPos = m_dataArray->at(0).position();
-
-    float minX = firstPos.x();
-    float maxX = minX;
-    float minY = firstPos.y();
-    float maxY = minY;
-    float minZ = firstPos.z();
-    float maxZ = minZ;
-
-    if (m_dataArray->size() > 1) {
-        for (int i = 1; i < m_dataArray->size(); i++) {
-            const QVector3D &pos = m_dataArray->at(i).position();
-
-            float value = pos.x();
-            if (qIsNaN(value) || qIsInf(value))
-                continue;
-            if (isValidValue(minX, value, axisX))
-                minX = value;
-            if (maxX < value)
-                maxX = value;
-
-            value = pos.y();
-            if (qIsNaN(value) || qIsInf(value))
-                continue;
-            if (isValidValue(minY, value, axisY))
-                minY = value;
-            if (maxY < value)
-                maxY = value;
-
-            value = pos.z();
-            if (qIsNaN(value) || qIsInf(value))
-                continue;
-            if (isValidValue(minZ, value, axisZ))
-                minZ = value;
-            if (maxZ < value)
-                maxZ = value;
+    // Rebuild the blocks if they have not been tracked or do not match the data anymore
+    if (!m_limitBlocksValid || m_limitItemCount != count) {
+        const int blockCount = (count + limitBlockSize - 1) / limitBlockSize;
+        m_limitBlocks.resize(blockCount);
+        for (int i = 0; i < blockCount; i++) {
+            m_limitBlocks[i].count = qMin(limitBlockSize, count - i * limitBlockSize);
+            m_limitBlocks[i].dirty = true;
         }
+        m_limitItemCount = count;
+        m_limitBlocksValid = true;
     }
 
-    minValues.setX(minX);
-    minValues.setY(minY);
-    minValues.setZ(minZ);
+    // The first item initializes the limits, the rest are combined from the blocks
+    const QVector3D firstPos = itemPosition(0);
+    float minimums[3] = { firstPos.x(), firstPos.y(), firstPos.z() };
+    float maximums[3] = { firstPos.x(), firstPos.y(), firstPos.z() };
+    QAbstract3DAxis *axes[3] = { axisX, axisY, axisZ };
+
+    int blockStart = 0;
+    const int blockCount = m_limitBlocks.size();
+    for (int i = 0; i < blockCount; i++) {
+        ScatterLimitBlock &block = m_limitBlocks[i];
+        if (block.dirty)
+            updateLimitBlock(block, blockStart);
+        blockStart += block.count;
+
+        for (int axis = 0; axis < 3; axis++) {
+            const ValueLimits &limits = block.limits[axis];
+            float minimum;
+            if (limits.minimum(axes[axis]->d_ptr->allowNegatives(),
+                               axes[axis]->d_ptr->allowZero(), minimum)
+                    && minimums[axis] > minimum) {
+                minimums[axis] = minimum;
+            }
+            if (limits.hasMaximum() && maximums[axis] < limits.max)
+                maximums[axis] = limits.max;
+        }
+    }
 
-    maxValues.setX(maxX);
-    maxValues.setY(maxY);
-    maxValues.setZ(maxZ);
-}
+    minValues.setX(minimums[0]);
+    minValues.setY(minimums[1]);
+    minValues.setZ(minimums[2]);
 
-bool QScatterDataProxyPrivate::isValidValue(float axisValue, float value,
-                                            QAbstract3DAxis *axis) const
-{
-    return (axisValue > value && (value > 0.0f
-                                  || (value == 0.0f && axis->d_ptr->allowZero())
-                                  || (value < 0.0f && axis->d_ptr->allowNegatives())));
+    maxValues.setX(maximums[0]);
+    maxValues.setY(maximums[1]);
+    maxValues.setZ(maximums[2]);
 }
 
 void QScatterDataProxyPrivate::setSeries(QAbstract3DSeries *series)
@@ -451,4 +565,163 @@ QScatterDataProxy *QScatterDataProxyPrivate::qptr()
     return static_cast<QScatterDataProxy *>(q_ptr);
 }
 
+// The limit blocks follow the signals instead of the modifying functions, as the signals are
+// also emitted for changes made directly to the data.
+void QScatterDataProxyPrivate::connectDataCaches()
+{
+    QObject::connect(qptr(), &QScatterDataProxy::arrayReset, this,
+                     &QScatterDataProxyPrivate::handleLimitsReset);
+    QObject::connect(qptr(), &QScatterDataProxy::itemsAdded, this,
+                     &QScatterDataProxyPrivate::handleLimitItemsInserted);
+    QObject::connect(qptr(), &QScatterDataProxy::itemsChanged, this,
+                     &QScatterDataProxyPrivate::handleLimitItemsChanged);
+    QObject::connect(qptr(), &QScatterDataProxy::itemsRemoved, this,
+                     &QScatterDataProxyPrivate::handleLimitItemsRemoved);
+    QObject::connect(qptr(), &QScatterDataProxy::itemsInserted, this,
+                     &QScatterDataProxyPrivate::handleLimitItemsInserted);
+    QObject::connect(qptr(), &QScatterDataProxy::itemsChanged, this,
+                     &QScatterDataProxyPrivate::handleExternalItemsChanged);
+}
+
+void QScatterDataProxyPrivate::handleExternalItemsChanged(int startIndex, int count)
+{
+    if (!m_externalArrayValid)
+        return;
+
+    const int endIndex = qMin(startIndex + count, m_externalCount);
+    for (int i = qMax(startIndex, 0); i < endIndex; i++)
+        (*m_dataArray)[i] = QScatterDataItem(itemPosition(i), itemRotation(i));
+}
+
+void QScatterDataProxyPrivate::handleLimitsReset()
+{
+    m_limitBlocks.clear();
+    m_limitItemCount = 0;
+    m_limitBlocksValid = false;
+}
+
+void QScatterDataProxyPrivate::handleLimitItemsChanged(int startIndex, int count)
+{
+    if (!m_limitBlocksValid)
+        return;
+
+    const int endIndex = startIndex + count;
+    int blockStart = 0;
+    for (int i = 0; i < m_limitBlocks.size() && blockStart < endIndex; i++) {
+        ScatterLimitBlock &block = m_limitBlocks[i];
+        if (blockStart + block.count > startIndex)
+            block.dirty = true;
+        blockStart += block.count;
+    }
+}
+
+void QScatterDataProxyPrivate::handleLimitItemsInserted(int startIndex, int count)
+{
+    if (!m_limitBlocksValid || count <= 0)
+        return;
+
+    if (startIndex < 0 || startIndex > m_limitItemCount) {
+        handleLimitsReset();
+        return;
+    }
+
+    // Grow the block containing the insertion point, or the last block when appending
+    int index = 0;
+    int blockStart = 0;
+    while (index < m_limitBlocks.size() - 1
+           && blockStart + m_limitBlocks.at(index).count <= startIndex) {
+        blockStart += m_limitBlocks.at(index).count;
+        index++;
+    }
+
+    ScatterLimitBlock newBlock;
+    newBlock.count = count;
+    newBlock.dirty = true;
+    if (m_limitBlocks.isEmpty())
+        m_limitBlocks.append(newBlock);
+    else
+        m_limitBlocks[index].count += count;
+    m_limitBlocks[index].dirty = true;
+    m_limitItemCount += count;
+
+    // Split the grown block to keep the blocks cheap to rescan
+    int blockCount = m_limitBlocks.at(index).count;
+    if (blockCount > 2 * limitBlockSize) {
+        const int splitCount = (blockCount - 1) / limitBlockSize;
+        m_limitBlocks[index].count = limitBlockSize;
+        blockCount -= limitBlockSize;
+        newBlock.count = limitBlockSize;
+        m_limitBlocks.insert(index + 1, splitCount, newBlock);
+        m_limitBlocks[index + splitCount].count = blockCount - (splitCount - 1) * limitBlockSize;
+    }
+}
+
+void QScatterDataProxyPrivate::handleLimitItemsRemoved(int startIndex, int count)
+{
+    if (!m_limitBlocksValid || count <= 0 || startIndex >= m_limitItemCount)
+        return;
+
+    if (startIndex < 0) {
+        handleLimitsReset();
+        return;
+    }
+
+    count = qMin(count, m_limitItemCount - startIndex);
+    m_limitItemCount -= count;
+
+    // Shrink the blocks overlapping the removed items and drop the emptied ones
+    const int endIndex = startIndex + count;
+    int blockStart = 0;
+    int i = 0;
+    while (i < m_limitBlocks.size() && blockStart < endIndex) {
+        ScatterLimitBlock &block = m_limitBlocks[i];
+        const int blockEnd = blockStart + block.count;
+        const int overlap = qMin(blockEnd, endIndex) - qMax(blockStart, startIndex);
+        if (overlap > 0) {
+            block.count -= overlap;
+            block.dirty = true;
+        }
+        if (block.count)
+            i++;
+        else
+            m_limitBlocks.remove(i);
+        blockStart = blockEnd;
+    }
+}
+
+// Scans the items of a block. Like in the full scan, an item with an invalid coordinate is
+// ignored for that axis and the axes after it, and the first item is not included.
+void QScatterDataProxyPrivate::updateLimitBlock(ScatterLimitBlock &block, int startIndex) const
+{
+    for (int axis = 0; axis < 3; axis++)
+        block.limits[axis].reset();
+
+    const int firstIndex = qMax(startIndex, 1);
+    const int endIndex = startIndex + block.count;
+    if (m_xValues) {
+        const float *values[3] = { m_xValues + firstIndex, m_yValues + firstIndex,
+                                   m_zValues + firstIndex };
+        ValueLimits::scan(values, 3, endIndex - firstIndex, block.limits);
+    } else {
+        // Copy the positions to separate arrays in chunks for scanning
+        const int chunkSize = 256;
+        float x[chunkSize];
+        float y[chunkSize];
+        float z[chunkSize];
+        const float *values[3] = { x, y, z };
+        const QScatterDataItem *items = m_dataArray->constData();
+        for (int i = firstIndex; i < endIndex; i += chunkSize) {
+            const int count = qMin(chunkSize, endIndex - i);
+            for (int j = 0; j < count; j++) {
+                const QScatterDataItem &item = items[i + j];
+                x[j] = item.x();
+                y[j] = item.y();
+                z[j] = item.z();
+            }
+            ValueLimits::scan(values, 3, count, block.limits);
+        }
+    }
+    block.dirty = false;
+}
+
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -57,6 +57,8 @@ public:
     const QScatterDataItem *itemAt(int index) const;
 
     void resetArray(QScatterDataArray *newArray);
+    void resetArray(const float *xValues, const float *yValues, const float *zValues, int count,
+                    const QQuaternion *rotations = nullptr);
 
     void setItem(int index, const QScatterDataItem &item);
     void setItems(int index, const QScatterDataArray &items);
@@ -43,11 +43,19 @@
 #include "qscatterdataproxy.h"
 #include "qabstractdataproxy_p.h"
 #include "qscatterdataitem.h"
+#include "valuelimits_p.h"
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
 class QAbstract3DAxis;
 
+struct ScatterLimitBlock
+{
+    int count;
+    bool dirty;
+    ValueLimits limits[3];
+};
+
 class QScatterDataProxyPrivate : public QAbstractDataProxyPrivate
 {
     Q_OBJECT
@@ -56,6 +64,10 @@ public:
     virtual ~QScatterDataProxyPrivate();
 
     void resetArray(QScatterDataArray *newArray);
+    void resetArray(const float *xValues, const float *yValues, const float *zValues, int count,
+                    const QQuaternion *rotations);
+    void detachExternalData();
+    QScatterDataArray *externalArray() const;
     void setItem(int index, const QScatterDataItem &item);
     void setItems(int index, const QScatterDataArray &items);
     int addItem(const QScatterDataItem &item);
@@ -65,12 +77,49 @@ public:
     void removeItems(int index, int removeCount);
     void limitValues(QVector3D &minValues, QVector3D &maxValues, QAbstract3DAxis *axisX,
                      QAbstract3DAxis *axisY, QAbstract3DAxis *axisZ) const;
-    bool isValidValue(float axisValue, float value, QAbstract3DAxis *axis) const;
+    inline bool hasExternalData() const { return m_xValues; }
+    inline int itemCount() const
+    {
+        return m_xValues ? m_externalCount : m_dataArray->size();
+    }
+    inline QVector3D itemPosition(int index) const
+    {
+        if (m_xValues)
+            return QVector3D(m_xValues[index], m_yValues[index], m_zValues[index]);
+        return m_dataArray->at(index).position();
+    }
+    inline QQuaternion itemRotation(int index) const
+    {
+        if (m_xValues)
+            return m_rotations ? m_rotations[index] : QQuaternion();
+        return m_dataArray->at(index).rotation();
+    }
 
     virtual void setSeries(QAbstract3DSeries *series);
 private:
     QScatterDataProxy *qptr();
+    void connectDataCaches();
+    void handleExternalItemsChanged(int startIndex, int count);
+    void handleLimitsReset();
+    void handleLimitItemsChanged(int startIndex, int count);
+    void handleLimitItemsInserted(int startIndex, int count);
+    void handleLimitItemsRemoved(int startIndex, int count);
+    void updateLimitBlock(ScatterLimitBlock &block, int startIndex) const;
+
     QScatterDataArray *m_dataArray;
+    // Caller-owned structure-of-arrays data, used instead of m_dataArray when set
+    const float *m_xValues;
+    const float *m_yValues;
+    const float *m_zValues;
+    const QQuaternion *m_rotations;
+    int m_externalCount;
+    // Copies of the external data returned by QScatterDataProxy::array() and itemAt()
+    mutable bool m_externalArrayValid;
+    mutable QScatterDataItem m_externalItem;
+    // Limits are cached in blocks of items, so that only the changed blocks need rescanning
+    mutable QVector<ScatterLimitBlock> m_limitBlocks;
+    mutable int m_limitItemCount;
+    mutable bool m_limitBlocksValid;
 
     friend class QScatterDataProxy;
 };
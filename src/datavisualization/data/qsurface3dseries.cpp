@@ -165,6 +165,16 @@ QT_BEGIN_NAMESPACE_DATAVISUALIZATION
  * file name is set.
  */
 
+/*!
+ * \qmlproperty bool Surface3DSeries::levelOfDetailEnabled
+ * \since QtDataVisualization 1.4
+ *
+ * Whether the surface is automatically decimated to match the resolution it
+ * is displayed at. Defaults to \c false.
+ *
+ * \sa QSurface3DSeries::levelOfDetailEnabled
+ */
+
 
 /*!
  * \enum QSurface3DSeries::DrawFlag
@@ -393,6 +403,39 @@ void QSurface3DSeries::setTextureFile(const QString &filename)
     }
 }
 
+/*!
+ * \property QSurface3DSeries::levelOfDetailEnabled
+ * \since QtDataVisualization 5.13
+ *
+ * \brief Whether the surface is automatically decimated to match the
+ * resolution it is displayed at.
+ *
+ * When enabled, the graph keeps a pyramid of decimated versions of the data
+ * array and draws the coarsest level that still has about one data point
+ * per pixel of the graph viewport, taking the camera zoom level into account.
+ * A finer level is picked when the graph is zoomed in. This allows showing
+ * very large data arrays without exceeding the graphics memory.
+ *
+ * Each point of a decimated level takes the minimum or the maximum value of
+ * the data points it covers, whichever deviates more from their mean, so that
+ * peaks are not lost. Selecting a point of a decimated surface selects the
+ * data point at the corresponding vertex.
+ *
+ * Defaults to \c false.
+ */
+void QSurface3DSeries::setLevelOfDetailEnabled(bool enabled)
+{
+    if (dptr()->m_levelOfDetailEnabled != enabled) {
+        dptr()->m_levelOfDetailEnabled = enabled;
+        emit levelOfDetailEnabledChanged(enabled);
+    }
+}
+
+bool QSurface3DSeries::isLevelOfDetailEnabled() const
+{
+    return dptrc()->m_levelOfDetailEnabled;
+}
+
 QString QSurface3DSeries::textureFile() const
 {
     return dptrc()->m_textureFile;
@@ -420,7 +463,8 @@ QSurface3DSeriesPrivate::QSurface3DSeriesPrivate(QSurface3DSeries *q)
     : QAbstract3DSeriesPrivate(q, QAbstract3DSeries::SeriesTypeSurface),
       m_selectedPoint(Surface3DController::invalidSelectionPosition()),
       m_flatShadingEnabled(true),
-      m_drawMode(QSurface3DSeries::DrawSurfaceAndWireframe)
+      m_drawMode(QSurface3DSeries::DrawSurfaceAndWireframe),
+      m_levelOfDetailEnabled(false)
 {
     m_itemLabelFormat = QStringLiteral("@xLabel, @yLabel, @zLabel");
     m_mesh = QAbstract3DSeries::MeshSphere;
@@ -469,8 +513,12 @@ void QSurface3DSeriesPrivate::connectControllerAndProxy(Abstract3DController *ne
                          &Surface3DController::handleRowsInserted);
         QObject::connect(surfaceDataProxy, &QSurfaceDataProxy::itemChanged, controller,
                          &Surface3DController::handleItemChanged);
+        QObject::connect(surfaceDataProxy, &QSurfaceDataProxy::rowsScrolled, controller,
+                         &Surface3DController::handleRowsScrolled);
         QObject::connect(qptr(), &QSurface3DSeries::dataProxyChanged, controller,
                          &Surface3DController::handleArrayReset);
+        QObject::connect(qptr(), &QSurface3DSeries::levelOfDetailEnabledChanged, controller,
+                         &Surface3DController::handleArrayReset);
     }
 }
 
@@ -48,6 +48,7 @@ class QT_DATAVISUALIZATION_EXPORT QSurface3DSeries : public QAbstract3DSeries
     Q_PROPERTY(DrawFlags drawMode READ drawMode WRITE setDrawMode NOTIFY drawModeChanged)
     Q_PROPERTY(QImage texture READ texture WRITE setTexture NOTIFY textureChanged)
     Q_PROPERTY(QString textureFile READ textureFile WRITE setTextureFile NOTIFY textureFileChanged)
+    Q_PROPERTY(bool levelOfDetailEnabled READ isLevelOfDetailEnabled WRITE setLevelOfDetailEnabled NOTIFY levelOfDetailEnabledChanged REVISION 1)
 
 public:
     enum DrawFlag {
@@ -81,6 +82,9 @@ public:
     void setTextureFile(const QString &filename);
     QString textureFile() const;
 
+    void setLevelOfDetailEnabled(bool enabled);
+    bool isLevelOfDetailEnabled() const;
+
 Q_SIGNALS:
     void dataProxyChanged(QSurfaceDataProxy *proxy);
     void selectedPointChanged(const QPoint &position);
@@ -89,6 +93,7 @@ Q_SIGNALS:
     void drawModeChanged(QSurface3DSeries::DrawFlags mode);
     void textureChanged(const QImage &image);
     void textureFileChanged(const QString &filename);
+    Q_REVISION(1) void levelOfDetailEnabledChanged(bool enabled);
 
 protected:
     explicit QSurface3DSeries(QSurface3DSeriesPrivate *d, QObject *parent = nullptr);
@@ -69,6 +69,7 @@ private:
     QSurface3DSeries::DrawFlags m_drawMode;
     QImage m_texture;
     QString m_textureFile;
+    bool m_levelOfDetailEnabled;
 
 private:
     friend class QSurface3DSeries;
@@ -30,6 +30,7 @@
 #include "qsurfacedataproxy_p.h"
 #include "qsurface3dseries_p.h"
 #include "qabstract3daxis_p.h"
+#include "valuelimits_p.h"
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
@@ -288,6 +289,50 @@ void QSurfaceDataProxy::removeRows(int rowIndex, int removeCount)
     }
 }
 
+/*!
+ * \since QtDataVisualization 5.13
+ *
+ * Adds the new row \a row to the end of the array and removes the first row,
+ * keeping the row count unchanged. This is intended for waterfall and
+ * spectrogram style data, where the oldest row is dropped whenever a new one
+ * arrives. The new row must have the same number of columns as the rows in the
+ * array, otherwise it is discarded with a warning and the array is not changed.
+ *
+ * Unlike calling addRow() and removeRows(), scrolling lets the graph keep the
+ * existing surface geometry and only process the new row, provided that the
+ * sample area of the surface and the axis ranges, other than a shift of the
+ * z-axis range, stay the same. Otherwise the surface is rebuilt as usual.
+ *
+ * \sa scrollRows(), rowsScrolled()
+ */
+void QSurfaceDataProxy::scrollRow(QSurfaceDataRow *row)
+{
+    QSurfaceDataArray rows;
+    rows.append(row);
+    scrollRows(rows);
+}
+
+/*!
+ * \since QtDataVisualization 5.13
+ *
+ * Adds new \a rows to the end of the array and removes the same number of rows
+ * from the beginning of it, keeping the row count unchanged. The new rows must
+ * have the same number of columns as the rows in the array; rows that do not
+ * are discarded with a warning. If there are more new rows than there are rows
+ * in the array, the array is reset to contain only the last ones of the new rows.
+ *
+ * \sa scrollRow(), rowsScrolled()
+ */
+void QSurfaceDataProxy::scrollRows(const QSurfaceDataArray &rows)
+{
+    if (rows.isEmpty())
+        return;
+
+    int scrollCount = dptr()->scrollRows(rows);
+    if (scrollCount)
+        emit rowsScrolled(scrollCount);
+}
+
 /*!
  * Returns the pointer to the data array.
  */
@@ -415,6 +460,17 @@ const QSurfaceDataProxyPrivate *QSurfaceDataProxy::dptrc() const
  * this signal needs to be emitted to update the graph.
  */
 
+/*!
+ * \fn void QSurfaceDataProxy::rowsScrolled(int count)
+ * \since QtDataVisualization 5.13
+ *
+ * This signal is emitted when the number of rows specified by \a count is
+ * added to the end of the array and the same number of rows is removed from
+ * the beginning of it.
+ * If the array is scrolled without calling scrollRow() or scrollRows(),
+ * this signal needs to be emitted to update the graph.
+ */
+
 //  QSurfaceDataProxyPrivate
 
 QSurfaceDataProxyPrivate::QSurfaceDataProxyPrivate(QSurfaceDataProxy *q)
@@ -508,6 +564,47 @@ void QSurfaceDataProxyPrivate::insertRows(int rowIndex, const QSurfaceDataArray
     }
 }
 
+int QSurfaceDataProxyPrivate::scrollRows(const QSurfaceDataArray &rows)
+{
+    int rowCount = m_dataArray->size();
+    if (!rowCount) {
+        // Nothing to scroll, so discard the new rows to keep the ownership semantics
+        for (int i = 0; i < rows.size(); i++)
+            delete rows.at(i);
+        return 0;
+    }
+
+    // Rows with a different column count would break the surface, so they are rejected
+    int columnCount = m_dataArray->at(0)->size();
+    QSurfaceDataArray validRows;
+    validRows.reserve(rows.size());
+    for (int i = 0; i < rows.size(); i++) {
+        QSurfaceDataRow *row = rows.at(i);
+        if (row && row->size() == columnCount) {
+            validRows.append(row);
+        } else {
+            qWarning("QSurfaceDataProxy: Scrolled row has %d columns instead of %d, row discarded.",
+                     row ? row->size() : 0, columnCount);
+            delete row;
+        }
+    }
+
+    // Only the last rows that fit in the array are kept
+    int firstNewRow = qMax(0, validRows.size() - rowCount);
+    for (int i = 0; i < firstNewRow; i++)
+        delete validRows.at(i);
+
+    int scrollCount = validRows.size() - firstNewRow;
+    for (int i = 0; i < scrollCount; i++) {
+        clearRow(0);
+        m_dataArray->removeFirst();
+    }
+    for (int i = firstNewRow; i < validRows.size(); i++)
+        m_dataArray->append(validRows.at(i));
+
+    return scrollCount;
+}
+
 void QSurfaceDataProxyPrivate::removeRows(int rowIndex, int removeCount)
 {
     Q_ASSERT(rowIndex >= 0);
@@ -541,21 +638,33 @@ void QSurfaceDataProxyPrivate::limitValues(QVector3D &minValues, QVector3D &maxV
         max = m_dataArray->at(0)->at(0).y();
     }
 
+    // Heights are copied to a separate array in chunks for scanning
+    const int chunkSize = 256;
+    float heights[chunkSize];
+    const float *values[1] = { heights };
+    ValueLimits limits;
+    limits.reset();
     for (int i = 0; i < rows; i++) {
         QSurfaceDataRow *row = m_dataArray->at(i);
         if (row) {
-            for (int j = 0; j < columns; j++) {
-                float itemValue = m_dataArray->at(i)->at(j).y();
-                if (qIsNaN(itemValue) || qIsInf(itemValue))
-                    continue;
-                if (min > itemValue && isValidValue(itemValue, axisY))
-                    min = itemValue;
-                if (max < itemValue)
-                    max = itemValue;
+            const QSurfaceDataItem *items = row->constData();
+            for (int j = 0; j < columns; j += chunkSize) {
+                const int count = qMin(chunkSize, columns - j);
+                for (int k = 0; k < count; k++)
+                    heights[k] = items[j + k].y();
+                ValueLimits::scan(values, 1, count, &limits);
             }
         }
     }
 
+    float limitMin;
+    if (limits.minimum(axisY->d_ptr->allowNegatives(), axisY->d_ptr->allowZero(), limitMin)
+            && min > limitMin) {
+        min = limitMin;
+    }
+    if (limits.hasMaximum() && max < limits.max)
+        max = limits.max;
+
     minValues.setY(min);
     maxValues.setY(max);
 
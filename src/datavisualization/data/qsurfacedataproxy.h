@@ -76,6 +76,9 @@ public:
 
     void removeRows(int rowIndex, int removeCount);
 
+    void scrollRow(QSurfaceDataRow *row);
+    void scrollRows(const QSurfaceDataArray &rows);
+
 Q_SIGNALS:
     void arrayReset();
     void rowsAdded(int startIndex, int count);
@@ -83,6 +86,7 @@ Q_SIGNALS:
     void rowsRemoved(int startIndex, int count);
     void rowsInserted(int startIndex, int count);
     void itemChanged(int rowIndex, int columnIndex);
+    void rowsScrolled(int count);
 
     void rowCountChanged(int count);
     void columnCountChanged(int count);
@@ -63,6 +63,7 @@ public:
     void insertRow(int rowIndex, QSurfaceDataRow *row);
     void insertRows(int rowIndex, const QSurfaceDataArray &rows);
     void removeRows(int rowIndex, int removeCount);
+    int scrollRows(const QSurfaceDataArray &rows);
     void limitValues(QVector3D &minValues, QVector3D &maxValues, QAbstract3DAxis *axisX,
                      QAbstract3DAxis *axisY, QAbstract3DAxis *axisZ) const;
     bool isValidValue(float value, QAbstract3DAxis *axis) const;
@@ -36,15 +36,7 @@ static const int noRoleIndex = -1;
 ScatterItemModelHandler::ScatterItemModelHandler(QItemModelScatterDataProxy *proxy, QObject *parent)
     : AbstractItemModelHandler(parent),
       m_proxy(proxy),
-      m_proxyArray(0),
-      m_xPosRole(noRoleIndex),
-      m_yPosRole(noRoleIndex),
-      m_zPosRole(noRoleIndex),
-      m_rotationRole(noRoleIndex),
-      m_haveXPosPattern(false),
-      m_haveYPosPattern(false),
-      m_haveZPosPattern(false),
-      m_haveRotationPattern(false)
+      m_proxyArray(0)
 {
 }
 
@@ -52,25 +44,44 @@ ScatterItemModelHandler::~ScatterItemModelHandler()
 {
 }
 
+// Model items map to consecutive scatter items row by row, so the items of a model row
+// are at row * columnCount. Incremental changes are only possible if the proxy array still
+// has an item for each model item, so that must be checked against the model sizes from
+// before the change.
+
 void ScatterItemModelHandler::handleDataChanged(const QModelIndex &topLeft,
                                                 const QModelIndex &bottomRight,
                                                 const QVector<int> &roles)
 {
     // Do nothing if full reset already pending
     if (!m_fullReset) {
-        if (m_itemModel->columnCount() > 1) {
-            // If the data model is multi-column, do full asynchronous reset to simplify things
+        const int columnCount = m_itemModel->columnCount();
+        if (m_resolving
+                || m_proxy->itemCount() != m_itemModel->rowCount() * columnCount) {
+            // Changes made while a resolve is running in the background would be overwritten
+            // by its result, so do full asynchronous reset.
             AbstractItemModelHandler::handleDataChanged(topLeft, bottomRight, roles);
         } else {
-            int start = qMin(topLeft.row(), bottomRight.row());
-            int end = qMax(topLeft.row(), bottomRight.row());
+            int startRow = qMin(topLeft.row(), bottomRight.row());
+            int endRow = qMax(topLeft.row(), bottomRight.row());
+            int startCol = qMin(topLeft.column(), bottomRight.column());
+            int endCol = qMax(topLeft.column(), bottomRight.column());
+
+            // Changes spanning multiple rows are set as whole rows, so that they are a single
+            // consecutive range of items
+            if (startRow != endRow) {
+                startCol = 0;
+                endCol = columnCount - 1;
+            }
 
-            QScatterDataArray array(end - start + 1);
+            QScatterDataArray array((endRow - startRow + 1) * (endCol - startCol + 1));
             int count = 0;
-            for (int i = start; i <= end; i++)
-                modelPosToScatterItem(i, 0, array[count++]);
+            for (int i = startRow; i <= endRow; i++) {
+                for (int j = startCol; j <= endCol; j++)
+                    modelPosToScatterItem(i, j, array[count++]);
+            }
 
-            m_proxy->setItems(start, array);
+            m_proxy->setItems(startRow * columnCount + startCol, array);
         }
     }
 }
@@ -79,33 +90,37 @@ void ScatterItemModelHandler::handleRowsInserted(const QModelIndex &parent, int
 {
     // Do nothing if full reset already pending
     if (!m_fullReset) {
-        if (!m_proxy->itemCount() || m_itemModel->columnCount() > 1) {
+        const int columnCount = m_itemModel->columnCount();
+        const int insertCount = end - start + 1;
+        if (m_resolving || !m_proxy->itemCount()
+                || m_proxy->itemCount() != (m_itemModel->rowCount() - insertCount) * columnCount) {
             // If inserting into an empty array, do full asynchronous reset to avoid multiple
             // separate inserts when initializing the model.
-            // If the data model is multi-column, do full asynchronous reset to simplify things
             AbstractItemModelHandler::handleRowsInserted(parent, start, end);
         } else {
-            QScatterDataArray array(end - start + 1);
+            QScatterDataArray array(insertCount * columnCount);
             int count = 0;
-            for (int i = start; i <= end; i++)
-                modelPosToScatterItem(i, 0, array[count++]);
+            for (int i = start; i <= end; i++) {
+                for (int j = 0; j < columnCount; j++)
+                    modelPosToScatterItem(i, j, array[count++]);
+            }
 
-            m_proxy->insertItems(start, array);
+            m_proxy->insertItems(start * columnCount, array);
         }
     }
 }
 
 void ScatterItemModelHandler::handleRowsRemoved(const QModelIndex &parent, int start, int end)
 {
-    Q_UNUSED(parent)
-
     // Do nothing if full reset already pending
     if (!m_fullReset) {
-        if (m_itemModel->columnCount() > 1) {
-            // If the data model is multi-column, do full asynchronous reset to simplify things
+        const int columnCount = m_itemModel->columnCount();
+        const int removeCount = end - start + 1;
+        if (m_resolving
+                || m_proxy->itemCount() != (m_itemModel->rowCount() + removeCount) * columnCount) {
             AbstractItemModelHandler::handleRowsRemoved(parent, start, end);
         } else {
-            m_proxy->removeItems(start, end - start + 1);
+            m_proxy->removeItems(start * columnCount, removeCount * columnCount);
         }
     }
 }
@@ -145,53 +160,75 @@ static inline QQuaternion toQuaternion(const QVariant &variant)
     return QQuaternion();
 }
 
-void ScatterItemModelHandler::modelPosToScatterItem(int modelRow, int modelColumn,
-                                                    QScatterDataItem &item)
+static void toScatterItem(const QVariant &xValue, const QVariant &yValue,
+                          const QVariant &zValue, const QVariant &rotationValue,
+                          const ItemModelRoleMapping &xMapping,
+                          const ItemModelRoleMapping &yMapping,
+                          const ItemModelRoleMapping &zMapping,
+                          const ItemModelRoleMapping &rotationMapping,
+                          QScatterDataItem &item)
 {
-    QModelIndex index = m_itemModel->index(modelRow, modelColumn);
-    float xPos;
-    float yPos;
-    float zPos;
-    if (m_xPosRole != noRoleIndex) {
-        QVariant xValueVar = index.data(m_xPosRole);
-        if (m_haveXPosPattern)
-            xPos = xValueVar.toString().replace(m_xPosPattern, m_xPosReplace).toFloat();
+    float xPos = (xMapping.role != noRoleIndex) ? xMapping.toFloat(xValue) : 0.0f;
+    float yPos = (yMapping.role != noRoleIndex) ? yMapping.toFloat(yValue) : 0.0f;
+    float zPos = (zMapping.role != noRoleIndex) ? zMapping.toFloat(zValue) : 0.0f;
+    if (rotationMapping.role != noRoleIndex) {
+        if (rotationMapping.havePattern)
+            item.setRotation(toQuaternion(QVariant(rotationMapping.toString(rotationValue))));
         else
-            xPos = xValueVar.toFloat();
-    } else {
-        xPos = 0.0f;
+            item.setRotation(toQuaternion(rotationValue));
     }
-    if (m_yPosRole != noRoleIndex) {
-        QVariant yValueVar = index.data(m_yPosRole);
-        if (m_haveYPosPattern)
-            yPos = yValueVar.toString().replace(m_yPosPattern, m_yPosReplace).toFloat();
-        else
-            yPos = yValueVar.toFloat();
-    } else {
-        yPos = 0.0f;
+
+    item.setPosition(QVector3D(xPos, yPos, zPos));
+}
+
+class ScatterResolveJob : public ItemModelResolveJob
+{
+public:
+    ScatterResolveJob()
+        : array(0)
+    {
     }
-    if (m_zPosRole != noRoleIndex) {
-        QVariant zValueVar = index.data(m_zPosRole);
-        if (m_haveZPosPattern)
-            zPos = zValueVar.toString().replace(m_zPosPattern, m_zPosReplace).toFloat();
-        else
-            zPos = zValueVar.toFloat();
-    } else {
-        zPos = 0.0f;
+
+    ~ScatterResolveJob()
+    {
+        delete array;
     }
-    if (m_rotationRole != noRoleIndex) {
-        QVariant rotationVar = index.data(m_rotationRole);
-        if (m_haveRotationPattern) {
-            item.setRotation(
-                        toQuaternion(
-                            QVariant(rotationVar.toString().replace(m_rotationPattern,
-                                                                    m_rotationReplace))));
-        } else {
-            item.setRotation(toQuaternion(rotationVar));
+
+    void run()
+    {
+        const int columnCount = snapshot.columnCount();
+        const int rowCount = snapshot.rowCount();
+        const int totalCount = rowCount * columnCount;
+        int runningCount = 0;
+
+        // If dimensions have changed, recreate the array
+        if (!array || totalCount != array->size())
+            array = new QScatterDataArray(totalCount);
+
+        // Parse data into the array
+        for (int i = 0; i < rowCount; i++) {
+            for (int j = 0; j < columnCount; j++) {
+                toScatterItem(snapshot.data(i, j, xPos.role), snapshot.data(i, j, yPos.role),
+                              snapshot.data(i, j, zPos.role), snapshot.data(i, j, rotation.role),
+                              xPos, yPos, zPos, rotation, (*array)[runningCount]);
+                runningCount++;
+            }
         }
     }
 
-    item.setPosition(QVector3D(xPos, yPos, zPos));
+    QScatterDataArray *array; // Array to reuse if dimensions match, and the result
+    ItemModelRoleMapping xPos;
+    ItemModelRoleMapping yPos;
+    ItemModelRoleMapping zPos;
+    ItemModelRoleMapping rotation;
+};
+
+void ScatterItemModelHandler::modelPosToScatterItem(int modelRow, int modelColumn,
+                                                    QScatterDataItem &item)
+{
+    QModelIndex index = m_itemModel->index(modelRow, modelColumn);
+    toScatterItem(index.data(m_xPos.role), index.data(m_yPos.role), index.data(m_zPos.role),
+                  index.data(m_rotation.role), m_xPos, m_yPos, m_zPos, m_rotation, item);
 }
 
 // Resolve entire item model into QScatterDataArray.
@@ -203,40 +240,36 @@ void ScatterItemModelHandler::resolveModel()
         return;
     }
 
-    m_xPosPattern = m_proxy->xPosRolePattern();
-    m_yPosPattern = m_proxy->yPosRolePattern();
-    m_zPosPattern = m_proxy->zPosRolePattern();
-    m_rotationPattern = m_proxy->rotationRolePattern();
-    m_xPosReplace = m_proxy->xPosRoleReplace();
-    m_yPosReplace = m_proxy->yPosRoleReplace();
-    m_zPosReplace = m_proxy->zPosRoleReplace();
-    m_rotationReplace = m_proxy->rotationRoleReplace();
-    m_haveXPosPattern = !m_xPosPattern.isEmpty() && m_xPosPattern.isValid();
-    m_haveYPosPattern = !m_yPosPattern.isEmpty() && m_yPosPattern.isValid();
-    m_haveZPosPattern = !m_zPosPattern.isEmpty() && m_zPosPattern.isValid();
-    m_haveRotationPattern = !m_rotationPattern.isEmpty() && m_rotationPattern.isValid();
+    m_xPos.setPattern(m_proxy->xPosRolePattern(), m_proxy->xPosRoleReplace());
+    m_yPos.setPattern(m_proxy->yPosRolePattern(), m_proxy->yPosRoleReplace());
+    m_zPos.setPattern(m_proxy->zPosRolePattern(), m_proxy->zPosRoleReplace());
+    m_rotation.setPattern(m_proxy->rotationRolePattern(), m_proxy->rotationRoleReplace());
 
     QHash<int, QByteArray> roleHash = m_itemModel->roleNames();
-    m_xPosRole = roleHash.key(m_proxy->xPosRole().toLatin1(), noRoleIndex);
-    m_yPosRole = roleHash.key(m_proxy->yPosRole().toLatin1(), noRoleIndex);
-    m_zPosRole = roleHash.key(m_proxy->zPosRole().toLatin1(), noRoleIndex);
-    m_rotationRole = roleHash.key(m_proxy->rotationRole().toLatin1(), noRoleIndex);
-    const int columnCount = m_itemModel->columnCount();
-    const int rowCount = m_itemModel->rowCount();
-    const int totalCount = rowCount * columnCount;
-    int runningCount = 0;
-
-    // If dimensions have changed, recreate the array
-    if (m_proxyArray != m_proxy->array() || totalCount != m_proxyArray->size())
-        m_proxyArray = new QScatterDataArray(totalCount);
-
-    // Parse data into newProxyArray
-    for (int i = 0; i < rowCount; i++) {
-        for (int j = 0; j < columnCount; j++) {
-            modelPosToScatterItem(i, j, (*m_proxyArray)[runningCount]);
-            runningCount++;
-        }
-    }
+    m_xPos.role = roleHash.key(m_proxy->xPosRole().toLatin1(), noRoleIndex);
+    m_yPos.role = roleHash.key(m_proxy->yPosRole().toLatin1(), noRoleIndex);
+    m_zPos.role = roleHash.key(m_proxy->zPosRole().toLatin1(), noRoleIndex);
+    m_rotation.role = roleHash.key(m_proxy->rotationRole().toLatin1(), noRoleIndex);
+
+    ScatterResolveJob *job = new ScatterResolveJob;
+    job->xPos = m_xPos;
+    job->yPos = m_yPos;
+    job->zPos = m_zPos;
+    job->rotation = m_rotation;
+    job->snapshot.take(m_itemModel.data(), QVector<int>() << m_xPos.role << m_yPos.role
+                       << m_zPos.role << m_rotation.role, false);
+    // Background resolves can't write to the array in use
+    if (!isBackgroundResolveEnabled() && m_proxyArray == m_proxy->array())
+        job->array = m_proxyArray;
+
+    startResolve(job);
+}
+
+void ScatterItemModelHandler::applyResolve(ItemModelResolveJob *job)
+{
+    ScatterResolveJob *scatterJob = static_cast<ScatterResolveJob *>(job);
+    m_proxyArray = scatterJob->array;
+    scatterJob->array = 0;
 
     m_proxy->resetArray(m_proxyArray);
 }
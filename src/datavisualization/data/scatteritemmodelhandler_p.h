@@ -60,28 +60,17 @@ public Q_SLOTS:
 
 protected:
     void virtual resolveModel();
+    void virtual applyResolve(ItemModelResolveJob *job);
 
 private:
     void modelPosToScatterItem(int modelRow, int modelColumn, QScatterDataItem &item);
 
     QItemModelScatterDataProxy *m_proxy; // Not owned
     QScatterDataArray *m_proxyArray; // Not owned
-    int m_xPosRole;
-    int m_yPosRole;
-    int m_zPosRole;
-    int m_rotationRole;
-    QRegExp m_xPosPattern;
-    QRegExp m_yPosPattern;
-    QRegExp m_zPosPattern;
-    QRegExp m_rotationPattern;
-    QString m_xPosReplace;
-    QString m_yPosReplace;
-    QString m_zPosReplace;
-    QString m_rotationReplace;
-    bool m_haveXPosPattern;
-    bool m_haveYPosPattern;
-    bool m_haveZPosPattern;
-    bool m_haveRotationPattern;
+    ItemModelRoleMapping m_xPos;
+    ItemModelRoleMapping m_yPos;
+    ItemModelRoleMapping m_zPos;
+    ItemModelRoleMapping m_rotation;
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
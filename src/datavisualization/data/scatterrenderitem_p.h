@@ -44,7 +44,7 @@
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
-class ScatterRenderItem : public AbstractRenderItem
+class QT_DATAVISUALIZATION_EXPORT ScatterRenderItem : public AbstractRenderItem
 {
 public:
     ScatterRenderItem();
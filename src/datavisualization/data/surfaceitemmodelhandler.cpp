@@ -36,13 +36,7 @@ static const int noRoleIndex = -1;
 SurfaceItemModelHandler::SurfaceItemModelHandler(QItemModelSurfaceDataProxy *proxy, QObject *parent)
     : AbstractItemModelHandler(parent),
       m_proxy(proxy),
-      m_proxyArray(0),
-      m_xPosRole(noRoleIndex),
-      m_yPosRole(noRoleIndex),
-      m_zPosRole(noRoleIndex),
-      m_haveXPosPattern(false),
-      m_haveYPosPattern(false),
-      m_haveZPosPattern(false)
+      m_proxyArray(0)
 {
 }
 
@@ -56,8 +50,10 @@ void SurfaceItemModelHandler::handleDataChanged(const QModelIndex &topLeft,
 {
     // Do nothing if full reset already pending
     if (!m_fullReset) {
-        if (!m_proxy->useModelCategories()) {
-            // If the data model doesn't directly map rows and columns, we cannot optimize
+        if (m_resolving || !m_proxy->useModelCategories()) {
+            // If the data model doesn't directly map rows and columns, we cannot optimize.
+            // Changes made while a resolve is running in the background would be overwritten
+            // by its result, so those need a full reset, too.
             AbstractItemModelHandler::handleDataChanged(topLeft, bottomRight, roles);
         } else {
             int startRow = qMin(topLeft.row(), bottomRight.row());
@@ -69,35 +65,24 @@ void SurfaceItemModelHandler::handleDataChanged(const QModelIndex &topLeft,
                 for (int j = startCol; j <= endCol; j++) {
                     QModelIndex index = m_itemModel->index(i, j);
                     QSurfaceDataItem item;
-                    QVariant xValueVar = index.data(m_xPosRole);
-                    QVariant yValueVar = index.data(m_yPosRole);
-                    QVariant zValueVar = index.data(m_zPosRole);
+                    QVariant xValueVar = index.data(m_xPos.role);
+                    QVariant yValueVar = index.data(m_yPos.role);
+                    QVariant zValueVar = index.data(m_zPos.role);
                     const QSurfaceDataItem *oldItem = m_proxy->itemAt(i, j);
                     float xPos;
                     float yPos;
                     float zPos;
-                    if (m_xPosRole != noRoleIndex) {
-                        if (m_haveXPosPattern)
-                            xPos = xValueVar.toString().replace(m_xPosPattern, m_xPosReplace).toFloat();
-                        else
-                            xPos = xValueVar.toFloat();
-                    } else {
+                    if (m_xPos.role != noRoleIndex)
+                        xPos = m_xPos.toFloat(xValueVar);
+                    else
                         xPos = oldItem->x();
-                    }
 
-                    if (m_haveYPosPattern)
-                        yPos = yValueVar.toString().replace(m_yPosPattern, m_yPosReplace).toFloat();
+                    yPos = m_yPos.toFloat(yValueVar);
+
+                    if (m_zPos.role != noRoleIndex)
+                        zPos = m_zPos.toFloat(zValueVar);
                     else
-                        yPos = yValueVar.toFloat();
-
-                    if (m_zPosRole != noRoleIndex) {
-                        if (m_haveZPosPattern)
-                            zPos = zValueVar.toString().replace(m_zPosPattern, m_zPosReplace).toFloat();
-                        else
-                            zPos = zValueVar.toFloat();
-                    } else {
                         zPos = oldItem->z();
-                    }
                     item.setPosition(QVector3D(xPos, yPos, zPos));
                     m_proxy->setItem(i, j, item);
                 }
@@ -106,127 +91,125 @@ void SurfaceItemModelHandler::handleDataChanged(const QModelIndex &topLeft,
     }
 }
 
-// Resolve entire item model into QSurfaceDataArray.
-void SurfaceItemModelHandler::resolveModel()
+static float headerToFloat(const QVariant &header, int section)
 {
-    if (m_itemModel.isNull()) {
-        m_proxy->resetArray(0);
-        m_proxyArray = 0;
-        return;
-    }
+    bool ok = false;
+    float headerValue = header.toString().toFloat(&ok);
+    if (ok)
+        return headerValue;
+    else
+        return float(section);
+}
 
-    if (!m_proxy->useModelCategories()
-            && (m_proxy->rowRole().isEmpty() || m_proxy->columnRole().isEmpty())) {
-        m_proxy->resetArray(0);
-        m_proxyArray = 0;
-        return;
+class SurfaceResolveJob : public ItemModelResolveJob
+{
+public:
+    SurfaceResolveJob()
+        : array(0),
+          arrayColumnCount(0),
+          useModelCategories(false),
+          generateRows(false),
+          generateColumns(false),
+          multiMatchBehavior(QItemModelSurfaceDataProxy::MMBLast)
+    {
     }
 
-    // Position patterns can be reused on single item changes, so store them to member variables.
-    QRegExp rowPattern(m_proxy->rowRolePattern());
-    QRegExp colPattern(m_proxy->columnRolePattern());
-    m_xPosPattern = m_proxy->xPosRolePattern();
-    m_yPosPattern = m_proxy->yPosRolePattern();
-    m_zPosPattern = m_proxy->zPosRolePattern();
-    QString rowReplace = m_proxy->rowRoleReplace();
-    QString colReplace = m_proxy->columnRoleReplace();
-    m_xPosReplace = m_proxy->xPosRoleReplace();
-    m_yPosReplace = m_proxy->yPosRoleReplace();
-    m_zPosReplace = m_proxy->zPosRoleReplace();
-    bool haveRowPattern = !rowPattern.isEmpty() && rowPattern.isValid();
-    bool haveColPattern = !colPattern.isEmpty() && colPattern.isValid();
-    m_haveXPosPattern = !m_xPosPattern.isEmpty() && m_xPosPattern.isValid();
-    m_haveYPosPattern = !m_yPosPattern.isEmpty() && m_yPosPattern.isValid();
-    m_haveZPosPattern = !m_zPosPattern.isEmpty() && m_zPosPattern.isValid();
-
-    QHash<int, QByteArray> roleHash = m_itemModel->roleNames();
+    ~SurfaceResolveJob()
+    {
+        delete array;
+    }
 
-    // Default to display role if no mapping
-    m_xPosRole = roleHash.key(m_proxy->xPosRole().toLatin1(), noRoleIndex);
-    m_yPosRole = roleHash.key(m_proxy->yPosRole().toLatin1(), Qt::DisplayRole);
-    m_zPosRole = roleHash.key(m_proxy->zPosRole().toLatin1(), noRoleIndex);
-    int rowCount = m_itemModel->rowCount();
-    int columnCount = m_itemModel->columnCount();
+    void run()
+    {
+        if (useModelCategories)
+            resolveModelCategories();
+        else
+            resolveRoleCategories();
+    }
 
-    if (m_proxy->useModelCategories()) {
+    QSurfaceDataArray *array; // Array to reuse if dimensions match, and the result
+    int arrayColumnCount;
+    ItemModelRoleMapping xPos;
+    ItemModelRoleMapping yPos;
+    ItemModelRoleMapping zPos;
+    ItemModelRoleMapping row;
+    ItemModelRoleMapping column;
+    bool useModelCategories;
+    bool generateRows;
+    bool generateColumns;
+    QItemModelSurfaceDataProxy::MultiMatchBehavior multiMatchBehavior;
+    QStringList rowList; // Given categories if not generated, and the result
+    QStringList columnList;
+
+private:
+    void prepareArray(int rowCount, int columnCount)
+    {
         // If dimensions have changed, recreate the array
-        if (m_proxyArray != m_proxy->array() || columnCount != m_proxy->columnCount()
-                || rowCount != m_proxyArray->size()) {
-            m_proxyArray = new QSurfaceDataArray;
-            m_proxyArray->reserve(rowCount);
+        if (!array || columnCount != arrayColumnCount || rowCount != array->size()) {
+            array = new QSurfaceDataArray;
+            array->reserve(rowCount);
             for (int i = 0; i < rowCount; i++)
-                m_proxyArray->append(new QSurfaceDataRow(columnCount));
+                array->append(new QSurfaceDataRow(columnCount));
+        }
+    }
+
+    void resolveModelCategories()
+    {
+        int rowCount = snapshot.rowCount();
+        int columnCount = snapshot.columnCount();
+        prepareArray(rowCount, columnCount);
+
+        // Positions taken from the headers are the same for every row or column
+        QVector<float> headerXValues;
+        QVector<float> headerZValues;
+        if (xPos.role == noRoleIndex) {
+            headerXValues.resize(columnCount);
+            for (int j = 0; j < columnCount; j++)
+                headerXValues[j] = headerToFloat(snapshot.headerData(j, Qt::Horizontal), j);
         }
+        if (zPos.role == noRoleIndex) {
+            headerZValues.resize(rowCount);
+            for (int i = 0; i < rowCount; i++)
+                headerZValues[i] = headerToFloat(snapshot.headerData(i, Qt::Vertical), i);
+        }
+
         for (int i = 0; i < rowCount; i++) {
-            QSurfaceDataRow &newProxyRow = *m_proxyArray->at(i);
+            QSurfaceDataRow &newProxyRow = *array->at(i);
             for (int j = 0; j < columnCount; j++) {
-                QModelIndex index = m_itemModel->index(i, j);
-                QVariant xValueVar = index.data(m_xPosRole);
-                QVariant yValueVar = index.data(m_yPosRole);
-                QVariant zValueVar = index.data(m_zPosRole);
-                float xPos;
-                float yPos;
-                float zPos;
-                if (m_xPosRole != noRoleIndex) {
-                    if (m_haveXPosPattern)
-                        xPos = xValueVar.toString().replace(m_xPosPattern, m_xPosReplace).toFloat();
-                    else
-                        xPos = xValueVar.toFloat();
-                } else {
-                    QString header = m_itemModel->headerData(j, Qt::Horizontal).toString();
-                    bool ok = false;
-                    float headerValue = header.toFloat(&ok);
-                    if (ok)
-                        xPos = headerValue;
-                    else
-                        xPos = float(j);
-                }
-
-                if (m_haveYPosPattern)
-                    yPos = yValueVar.toString().replace(m_yPosPattern, m_yPosReplace).toFloat();
+                float xValue;
+                float yValue;
+                float zValue;
+                if (xPos.role != noRoleIndex)
+                    xValue = xPos.toFloat(snapshot.data(i, j, xPos.role));
                 else
-                    yPos = yValueVar.toFloat();
+                    xValue = headerXValues.at(j);
 
-                if (m_zPosRole != noRoleIndex) {
-                    if (m_haveZPosPattern)
-                        zPos = zValueVar.toString().replace(m_zPosPattern, m_zPosReplace).toFloat();
-                    else
-                        zPos = zValueVar.toFloat();
-                } else {
-                    QString header = m_itemModel->headerData(i, Qt::Vertical).toString();
-                    bool ok = false;
-                    float headerValue = header.toFloat(&ok);
-                    if (ok)
-                        zPos = headerValue;
-                    else
-                        zPos = float(i);
-                }
+                yValue = yPos.toFloat(snapshot.data(i, j, yPos.role));
 
-                newProxyRow[j].setPosition(QVector3D(xPos, yPos, zPos));
+                if (zPos.role != noRoleIndex)
+                    zValue = zPos.toFloat(snapshot.data(i, j, zPos.role));
+                else
+                    zValue = headerZValues.at(i);
+
+                newProxyRow[j].setPosition(QVector3D(xValue, yValue, zValue));
             }
         }
-    } else {
-        int rowRole = roleHash.key(m_proxy->rowRole().toLatin1());
-        int columnRole = roleHash.key(m_proxy->columnRole().toLatin1());
-        if (m_xPosRole == noRoleIndex)
-            m_xPosRole = columnRole;
-        if (m_zPosRole == noRoleIndex)
-            m_zPosRole = rowRole;
-
-        bool generateRows = m_proxy->autoRowCategories();
-        bool generateColumns = m_proxy->autoColumnCategories();
-
-        QStringList rowList;
-        QStringList columnList;
+    }
+
+    void resolveRoleCategories()
+    {
+        int rowCount = snapshot.rowCount();
+        int columnCount = snapshot.columnCount();
+
         // For detecting duplicates in categories generation, using QHashes should be faster than
         // simple QStringList::contains() check.
         QHash<QString, bool> rowListHash;
         QHash<QString, bool> columnListHash;
 
-        bool cumulative = m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBAverage
-                || m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBCumulativeY;
-        bool average = m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBAverage;
-        bool takeFirst = m_proxy->multiMatchBehavior() == QItemModelSurfaceDataProxy::MMBFirst;
+        bool cumulative = multiMatchBehavior == QItemModelSurfaceDataProxy::MMBAverage
+                || multiMatchBehavior == QItemModelSurfaceDataProxy::MMBCumulativeY;
+        bool average = multiMatchBehavior == QItemModelSurfaceDataProxy::MMBAverage;
+        bool takeFirst = multiMatchBehavior == QItemModelSurfaceDataProxy::MMBFirst;
         QHash<QString, QHash<QString, int> > *matchCountMap = 0;
         if (cumulative)
             matchCountMap = new QHash<QString, QHash<QString, int> >;
@@ -236,33 +219,11 @@ void SurfaceItemModelHandler::resolveModel()
         QHash <QString, ColumnValueMap> itemValueMap;
         for (int i = 0; i < rowCount; i++) {
             for (int j = 0; j < columnCount; j++) {
-                QModelIndex index = m_itemModel->index(i, j);
-                QString rowRoleStr = index.data(rowRole).toString();
-                if (haveRowPattern)
-                    rowRoleStr.replace(rowPattern, rowReplace);
-                QString columnRoleStr = index.data(columnRole).toString();
-                if (haveColPattern)
-                    columnRoleStr.replace(colPattern, colReplace);
-                QVariant xValueVar = index.data(m_xPosRole);
-                QVariant yValueVar = index.data(m_yPosRole);
-                QVariant zValueVar = index.data(m_zPosRole);
-                float xPos;
-                float yPos;
-                float zPos;
-                if (m_haveXPosPattern)
-                    xPos = xValueVar.toString().replace(m_xPosPattern, m_xPosReplace).toFloat();
-                else
-                    xPos = xValueVar.toFloat();
-                if (m_haveYPosPattern)
-                    yPos = yValueVar.toString().replace(m_yPosPattern, m_yPosReplace).toFloat();
-                else
-                    yPos = yValueVar.toFloat();
-                if (m_haveZPosPattern)
-                    zPos = zValueVar.toString().replace(m_zPosPattern, m_zPosReplace).toFloat();
-                else
-                    zPos = zValueVar.toFloat();
-
-                QVector3D itemPos(xPos, yPos, zPos);
+                QString rowRoleStr = row.toString(snapshot.data(i, j, row.role));
+                QString columnRoleStr = column.toString(snapshot.data(i, j, column.role));
+                QVector3D itemPos(xPos.toFloat(snapshot.data(i, j, xPos.role)),
+                                  yPos.toFloat(snapshot.data(i, j, yPos.role)),
+                                  zPos.toFloat(snapshot.data(i, j, zPos.role)));
 
                 if (cumulative)
                     (*matchCountMap)[rowRoleStr][columnRoleStr]++;
@@ -288,28 +249,11 @@ void SurfaceItemModelHandler::resolveModel()
             }
         }
 
-        if (generateRows)
-            m_proxy->dptr()->m_rowCategories = rowList;
-        else
-            rowList = m_proxy->rowCategories();
-
-        if (generateColumns)
-            m_proxy->dptr()->m_columnCategories = columnList;
-        else
-            columnList = m_proxy->columnCategories();
-
-        // If dimensions have changed, recreate the array
-        if (m_proxyArray != m_proxy->array() || columnList.size() != m_proxy->columnCount()
-                || rowList.size() != m_proxyArray->size()) {
-            m_proxyArray = new QSurfaceDataArray;
-            m_proxyArray->reserve(rowList.size());
-            for (int i = 0; i < rowList.size(); i++)
-                m_proxyArray->append(new QSurfaceDataRow(columnList.size()));
-        }
+        prepareArray(rowList.size(), columnList.size());
         // Create data array from itemValueMap
         for (int i = 0; i < rowList.size(); i++) {
             QString rowKey = rowList.at(i);
-            QSurfaceDataRow &newProxyRow = *m_proxyArray->at(i);
+            QSurfaceDataRow &newProxyRow = *array->at(i);
             for (int j = 0; j < columnList.size(); j++) {
                 QVector3D &itemPos = itemValueMap[rowKey][columnList.at(j)];
                 if (cumulative) {
@@ -327,6 +271,86 @@ void SurfaceItemModelHandler::resolveModel()
 
         delete matchCountMap;
     }
+};
+
+// Resolve entire item model into QSurfaceDataArray.
+void SurfaceItemModelHandler::resolveModel()
+{
+    if (m_itemModel.isNull()) {
+        m_proxy->resetArray(0);
+        m_proxyArray = 0;
+        return;
+    }
+
+    if (!m_proxy->useModelCategories()
+            && (m_proxy->rowRole().isEmpty() || m_proxy->columnRole().isEmpty())) {
+        m_proxy->resetArray(0);
+        m_proxyArray = 0;
+        return;
+    }
+
+    // Position mappings can be reused on single item changes, so store them to member variables.
+    m_xPos.setPattern(m_proxy->xPosRolePattern(), m_proxy->xPosRoleReplace());
+    m_yPos.setPattern(m_proxy->yPosRolePattern(), m_proxy->yPosRoleReplace());
+    m_zPos.setPattern(m_proxy->zPosRolePattern(), m_proxy->zPosRoleReplace());
+
+    QHash<int, QByteArray> roleHash = m_itemModel->roleNames();
+
+    // Default to display role if no mapping
+    m_xPos.role = roleHash.key(m_proxy->xPosRole().toLatin1(), noRoleIndex);
+    m_yPos.role = roleHash.key(m_proxy->yPosRole().toLatin1(), Qt::DisplayRole);
+    m_zPos.role = roleHash.key(m_proxy->zPosRole().toLatin1(), noRoleIndex);
+
+    SurfaceResolveJob *job = new SurfaceResolveJob;
+    job->useModelCategories = m_proxy->useModelCategories();
+    if (job->useModelCategories) {
+        job->snapshot.take(m_itemModel.data(), QVector<int>() << m_xPos.role << m_yPos.role
+                           << m_zPos.role, true);
+    } else {
+        job->row.role = roleHash.key(m_proxy->rowRole().toLatin1());
+        job->row.setPattern(m_proxy->rowRolePattern(), m_proxy->rowRoleReplace());
+        job->column.role = roleHash.key(m_proxy->columnRole().toLatin1());
+        job->column.setPattern(m_proxy->columnRolePattern(), m_proxy->columnRoleReplace());
+        if (m_xPos.role == noRoleIndex)
+            m_xPos.role = job->column.role;
+        if (m_zPos.role == noRoleIndex)
+            m_zPos.role = job->row.role;
+
+        job->generateRows = m_proxy->autoRowCategories();
+        job->generateColumns = m_proxy->autoColumnCategories();
+        if (!job->generateRows)
+            job->rowList = m_proxy->rowCategories();
+        if (!job->generateColumns)
+            job->columnList = m_proxy->columnCategories();
+        job->multiMatchBehavior = m_proxy->multiMatchBehavior();
+        job->snapshot.take(m_itemModel.data(), QVector<int>() << job->row.role
+                           << job->column.role << m_xPos.role << m_yPos.role << m_zPos.role,
+                           false);
+    }
+    job->xPos = m_xPos;
+    job->yPos = m_yPos;
+    job->zPos = m_zPos;
+
+    // Background resolves can't write to the array in use
+    if (!isBackgroundResolveEnabled() && m_proxyArray == m_proxy->array()) {
+        job->array = m_proxyArray;
+        job->arrayColumnCount = m_proxy->columnCount();
+    }
+
+    startResolve(job);
+}
+
+void SurfaceItemModelHandler::applyResolve(ItemModelResolveJob *job)
+{
+    SurfaceResolveJob *surfaceJob = static_cast<SurfaceResolveJob *>(job);
+    if (!surfaceJob->useModelCategories) {
+        if (surfaceJob->generateRows)
+            m_proxy->dptr()->m_rowCategories = surfaceJob->rowList;
+        if (surfaceJob->generateColumns)
+            m_proxy->dptr()->m_columnCategories = surfaceJob->columnList;
+    }
+    m_proxyArray = surfaceJob->array;
+    surfaceJob->array = 0;
 
     m_proxy->resetArray(m_proxyArray);
 }
@@ -58,21 +58,13 @@ public Q_SLOTS:
 
 protected:
     void virtual resolveModel();
+    void virtual applyResolve(ItemModelResolveJob *job);
 
     QItemModelSurfaceDataProxy *m_proxy; // Not owned
     QSurfaceDataArray *m_proxyArray; // Not owned
-    int m_xPosRole;
-    int m_yPosRole;
-    int m_zPosRole;
-    QRegExp m_xPosPattern;
-    QRegExp m_yPosPattern;
-    QRegExp m_zPosPattern;
-    QString m_xPosReplace;
-    QString m_yPosReplace;
-    QString m_zPosReplace;
-    bool m_haveXPosPattern;
-    bool m_haveYPosPattern;
-    bool m_haveZPosPattern;
+    ItemModelRoleMapping m_xPos;
+    ItemModelRoleMapping m_yPos;
+    ItemModelRoleMapping m_zPos;
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -67,6 +67,8 @@ Abstract3DController::Abstract3DController(QRect initialViewport, Q3DScene *scen
     m_isCustomItemDirty(true),
     m_isSeriesVisualsDirty(true),
     m_renderPending(false),
+    m_isFrameDirty(true),
+    m_isFrameChanged(true),
     m_isPolar(false),
     m_radialLabelOffset(1.0f),
     m_measureFps(false),
@@ -96,6 +98,9 @@ Abstract3DController::Abstract3DController(QRect initialViewport, Q3DScene *scen
     setActiveInputHandler(inputHandler);
     connect(m_scene->d_ptr.data(), &Q3DScenePrivate::needRender, this,
             &Abstract3DController::emitNeedRender);
+    // Every change that affects the rendered frame ends up requesting a render
+    connect(this, &Abstract3DController::needRender, this,
+            &Abstract3DController::markFrameDirty);
 }
 
 Abstract3DController::~Abstract3DController()
@@ -191,6 +196,10 @@ void Abstract3DController::synchDataToRenderer()
     // Subclass implementations check for renderer validity already, so no need to check here.
 
     m_renderPending = false;
+    if (m_isFrameDirty) {
+        m_isFrameChanged = true;
+        m_isFrameDirty = false;
+    }
 
     // If there are pending queries, handle those first
     if (m_renderer->isGraphPositionQueryResolved())
@@ -532,6 +541,8 @@ void Abstract3DController::synchDataToRenderer()
         m_renderer->updateCustomItems();
         m_isCustomItemDirty = false;
     }
+
+    m_renderer->loadVolumeBricks();
 }
 
 void Abstract3DController::render(const GLuint defaultFboHandle)
@@ -557,6 +568,9 @@ void Abstract3DController::render(const GLuint defaultFboHandle)
     }
 
     m_renderer->render(defaultFboHandle);
+    m_isFrameChanged = false;
+
+    emit frameRendered();
 }
 
 void Abstract3DController::mouseDoubleClickEvent(QMouseEvent *event)
@@ -1505,6 +1519,11 @@ void Abstract3DController::emitNeedRender()
     }
 }
 
+void Abstract3DController::markFrameDirty()
+{
+    m_isFrameDirty = true;
+}
+
 void Abstract3DController::handlePendingClick()
 {
     m_clickedType = m_renderer->clickedType();
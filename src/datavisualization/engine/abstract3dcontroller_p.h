@@ -205,6 +205,8 @@ protected:
     bool m_isCustomItemDirty;
     bool m_isSeriesVisualsDirty;
     bool m_renderPending;
+    bool m_isFrameDirty;
+    bool m_isFrameChanged;
     bool m_isPolar;
     float m_radialLabelOffset;
 
@@ -234,6 +236,8 @@ public:
     inline bool isInitialized() { return (m_renderer != 0); }
     virtual void synchDataToRenderer();
     virtual void render(const GLuint defaultFboHandle = 0);
+    // False when the previously rendered frame is still up to date
+    inline bool isFrameChanged() const { return m_isFrameChanged || m_measureFps; }
     virtual void initializeOpenGL() = 0;
     void setRenderer(Abstract3DRenderer *renderer);
 
@@ -395,6 +399,7 @@ public Q_SLOTS:
     void handleRequestShadowQuality(QAbstract3DGraph::ShadowQuality quality);
 
     void updateCustomItem();
+    void markFrameDirty();
 
 Q_SIGNALS:
     void shadowQualityChanged(QAbstract3DGraph::ShadowQuality quality);
@@ -419,6 +424,7 @@ Q_SIGNALS:
     void localeChanged(const QLocale &locale);
     void queriedGraphPositionChanged(const QVector3D &data);
     void marginChanged(qreal margin);
+    void frameRendered();
 
 protected:
     virtual QAbstract3DAxis *createDefaultAxis(QAbstract3DAxis::AxisOrientation orientation);
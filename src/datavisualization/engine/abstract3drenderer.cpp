@@ -40,6 +40,7 @@
 
 #include <QtCore/qmath.h>
 #include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLExtraFunctions>
 #include <QtCore/QThread>
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
@@ -52,6 +53,12 @@ const int polarGridRoundness(64);
 const qreal polarGridAngle(doublePi / qreal(polarGridRoundness));
 const float polarGridAngleDegrees(float(360.0 / qreal(polarGridRoundness)));
 const qreal polarGridHalfAngle(polarGridAngle / 2.0);
+// Texture memory that the bricks of all bricked volumes of a graph are allowed to keep
+// resident before bricks that were not drawn on the previous frame are released
+const qint64 volumeBrickMemoryBudget(Q_INT64_C(512) * 1024 * 1024);
+// Edge length in texels of the volume regions that the ray marching shaders can leap over
+// when they are fully transparent
+const int volumeOccupancyCellSize(8);
 
 Abstract3DRenderer::Abstract3DRenderer(Abstract3DController *controller)
     : QObject(0),
@@ -83,10 +90,12 @@ Abstract3DRenderer::Abstract3DRenderer(Abstract3DController *controller)
       m_volumeTextureLowDefShader(0),
       m_volumeTextureSliceShader(0),
       m_volumeSliceFrameShader(0),
+      m_volumeBrickFrame(0),
+      m_volumeBrickMemory(0),
+      m_volumeBricksPending(false),
+      m_selectionReadbackBuffer(0),
+      m_selectionReadbackPending(false),
       m_labelShader(0),
-      m_cursorPositionShader(0),
-      m_cursorPositionFrameBuffer(0),
-      m_cursorPositionTexture(0),
       m_useOrthoProjection(false),
       m_xFlipped(false),
       m_yFlipped(false),
@@ -95,7 +104,6 @@ Abstract3DRenderer::Abstract3DRenderer(Abstract3DController *controller)
       m_backgroundObj(0),
       m_gridLineObj(0),
       m_labelObj(0),
-      m_positionMapperObj(0),
       m_graphAspectRatio(2.0f),
       m_graphHorizontalAspectRatio(0.0f),
       m_polarGraph(false),
@@ -163,7 +171,6 @@ Abstract3DRenderer::~Abstract3DRenderer()
     delete m_volumeSliceFrameShader;
     delete m_volumeTextureSliceShader;
     delete m_labelShader;
-    delete m_cursorPositionShader;
 
     foreach (SeriesRenderCache *cache, m_renderCacheList) {
         cache->cleanup(m_textureHelper);
@@ -174,6 +181,9 @@ Abstract3DRenderer::~Abstract3DRenderer()
     foreach (CustomRenderItem *item, m_customRenderCache) {
         GLuint texture = item->texture();
         m_textureHelper->deleteTexture(&texture);
+        texture = item->occupancyTexture();
+        m_textureHelper->deleteTexture(&texture);
+        releaseVolumeBricks(item);
         delete item;
     }
     m_customRenderCache.clear();
@@ -181,18 +191,15 @@ Abstract3DRenderer::~Abstract3DRenderer()
     ObjectHelper::releaseObjectHelper(this, m_backgroundObj);
     ObjectHelper::releaseObjectHelper(this, m_gridLineObj);
     ObjectHelper::releaseObjectHelper(this, m_labelObj);
-    ObjectHelper::releaseObjectHelper(this, m_positionMapperObj);
 
     if (m_textureHelper) {
         m_textureHelper->deleteTexture(&m_depthTexture);
-        m_textureHelper->deleteTexture(&m_cursorPositionTexture);
-
-        if (QOpenGLContext::currentContext())
-            m_textureHelper->glDeleteFramebuffers(1, &m_cursorPositionFrameBuffer);
-
         delete m_textureHelper;
     }
 
+    if (m_selectionReadbackBuffer)
+        glDeleteBuffers(1, &m_selectionReadbackBuffer);
+
     m_axisCacheX.clearLabels();
     m_axisCacheY.clearLabels();
     m_axisCacheZ.clearLabels();
@@ -228,11 +235,7 @@ void Abstract3DRenderer::initializeOpenGL()
     initLabelShaders(QStringLiteral(":/shaders/vertexLabel"),
                      QStringLiteral(":/shaders/fragmentLabel"));
 
-    initCursorPositionShaders(QStringLiteral(":/shaders/vertexPosition"),
-                              QStringLiteral(":/shaders/fragmentPositionMap"));
-
     loadLabelMesh();
-    loadPositionMapperMesh();
 }
 
 void Abstract3DRenderer::render(const GLuint defaultFboHandle)
@@ -327,29 +330,6 @@ void Abstract3DRenderer::initLabelShaders(const QString &vertexShader, const QSt
     m_labelShader->initialize();
 }
 
-void Abstract3DRenderer::initCursorPositionShaders(const QString &vertexShader,
-                                                   const QString &fragmentShader)
-{
-    // Init the shader
-    delete m_cursorPositionShader;
-    m_cursorPositionShader = new ShaderHelper(this, vertexShader, fragmentShader);
-    m_cursorPositionShader->initialize();
-}
-
-void Abstract3DRenderer::initCursorPositionBuffer()
-{
-    m_textureHelper->deleteTexture(&m_cursorPositionTexture);
-    m_textureHelper->glDeleteFramebuffers(1, &m_cursorPositionFrameBuffer);
-    m_cursorPositionFrameBuffer = 0;
-
-    if (m_primarySubViewport.size().isEmpty())
-        return;
-
-    m_cursorPositionTexture =
-            m_textureHelper->createCursorPositionTexture(m_primarySubViewport.size(),
-                                                         m_cursorPositionFrameBuffer);
-}
-
 void Abstract3DRenderer::updateTheme(Q3DTheme *theme)
 {
     // Synchronize the controller theme with renderer
@@ -564,13 +544,68 @@ void Abstract3DRenderer::handleResize()
     // Recalculate zoom
     calculateZoomLevel();
 
-    // Re-init selection buffer
+    // Re-init selection buffer. A readback from the old buffer no longer matches the viewport.
     initSelectionBuffer();
+    m_selectionReadbackPending = false;
 
     // Re-init depth buffer
     updateDepthBuffer();
+}
+
+// Reads the selection color under the queried position from the bound selection framebuffer.
+// With OptimizationAsyncSelection the color is only copied to a pixel buffer, so that reading it
+// doesn't wait for the GPU. False is returned in that case, and the color can be taken with
+// takeSelectionReadback() when the next frame is rendered.
+bool Abstract3DRenderer::readSelectionColor(QVector4D &color)
+{
+    if (!m_cachedOptimizationHint.testFlag(QAbstract3DGraph::OptimizationAsyncSelection)
+            || !Utils::isBufferMappingSupported()) {
+        color = Utils::getSelection(m_inputPosition, m_viewport.height());
+        return true;
+    }
+
+    if (!m_selectionReadbackBuffer) {
+        glGenBuffers(1, &m_selectionReadbackBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_selectionReadbackBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4, 0, GL_STREAM_READ);
+    } else {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_selectionReadbackBuffer);
+    }
+    glReadPixels(m_inputPosition.x(), m_viewport.height() - m_inputPosition.y(), 1, 1,
+                 GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_selectionReadbackPending = true;
+    m_selectionReadbackPosition = m_inputPosition;
+
+    // Make sure there is a next frame to resolve the selection in
+    emit needRender();
+
+    return false;
+}
+
+// Returns the selection color read back on the previous frame, if it is still for the current
+// selection query.
+bool Abstract3DRenderer::takeSelectionReadback(QVector4D &color)
+{
+    if (!m_selectionReadbackPending)
+        return false;
+
+    m_selectionReadbackPending = false;
+    if (m_selectionState != SelectOnScene || m_selectionReadbackPosition != m_inputPosition)
+        return false;
+
+    QOpenGLExtraFunctions *extraFuncs = QOpenGLContext::currentContext()->extraFunctions();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_selectionReadbackBuffer);
+    const GLubyte *pixel = static_cast<const GLubyte *>(
+                extraFuncs->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4, GL_MAP_READ_BIT));
+    if (pixel) {
+        color = QVector4D(pixel[0], pixel[1], pixel[2], pixel[3]);
+        extraFuncs->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-    initCursorPositionBuffer();
+    return pixel != 0;
 }
 
 void Abstract3DRenderer::calculateZoomLevel()
@@ -752,6 +787,9 @@ void Abstract3DRenderer::updateCustomData(const QList<QCustom3DItem *> &customIt
             m_customRenderCache.remove(renderItem->itemPointer());
             GLuint texture = renderItem->texture();
             m_textureHelper->deleteTexture(&texture);
+            texture = renderItem->occupancyTexture();
+            m_textureHelper->deleteTexture(&texture);
+            releaseVolumeBricks(renderItem);
             delete renderItem;
         }
     }
@@ -1069,12 +1107,6 @@ void Abstract3DRenderer::loadLabelMesh()
                                     QStringLiteral(":/defaultMeshes/plane"));
 }
 
-void Abstract3DRenderer::loadPositionMapperMesh()
-{
-    ObjectHelper::resetObjectHelper(this, m_positionMapperObj,
-                                    QStringLiteral(":/defaultMeshes/barFull"));
-}
-
 void Abstract3DRenderer::generateBaseColorTexture(const QColor &color, GLuint *texture)
 {
     m_textureHelper->deleteTexture(texture);
@@ -1166,11 +1198,17 @@ CustomRenderItem *Abstract3DRenderer::addCustomItem(QCustom3DItem *item)
         newItem->setTextureFormat(volumeItem->textureFormat());
         newItem->setVolume(true);
         newItem->setBlendNeeded(true);
-        texture = m_textureHelper->create3DTexture(volumeItem->textureData(),
-                                                   volumeItem->textureWidth(),
-                                                   volumeItem->textureHeight(),
-                                                   volumeItem->textureDepth(),
-                                                   volumeItem->textureFormat());
+        newItem->setBrickSize(volumeItem->brickSize());
+        createVolumeOccupancy(newItem);
+        if (newItem->brickSize() > 0) {
+            createVolumeBricks(newItem);
+        } else {
+            texture = m_textureHelper->create3DTexture(volumeItem->textureData(),
+                                                       volumeItem->textureWidth(),
+                                                       volumeItem->textureHeight(),
+                                                       volumeItem->textureDepth(),
+                                                       volumeItem->textureFormat());
+        }
         newItem->setSliceIndexX(volumeItem->sliceIndexX());
         newItem->setSliceIndexY(volumeItem->sliceIndexY());
         newItem->setSliceIndexZ(volumeItem->sliceIndexZ());
@@ -1361,26 +1399,64 @@ void Abstract3DRenderer::updateCustomItem(CustomRenderItem *renderItem)
         QCustom3DVolume *volumeItem = static_cast<QCustom3DVolume *>(item);
         if (volumeItem->dptr()->m_dirtyBitsVolume.colorTableDirty) {
             renderItem->setColorTable(volumeItem->colorTable());
+            // Bricks that are transparent depend on the color table
+            if (renderItem->textureFormat() == QImage::Format_Indexed8) {
+                refreshVolumeBricks(renderItem, Qt::ZAxis, 0, renderItem->textureDepth() - 1,
+                                    false);
+                updateVolumeOccupancy(renderItem, Qt::ZAxis, 0, renderItem->textureDepth() - 1);
+            }
             volumeItem->dptr()->m_dirtyBitsVolume.colorTableDirty = false;
         }
         if (volumeItem->dptr()->m_dirtyBitsVolume.textureDimensionsDirty
                 || volumeItem->dptr()->m_dirtyBitsVolume.textureDataDirty
-                || volumeItem->dptr()->m_dirtyBitsVolume.textureFormatDirty) {
+                || volumeItem->dptr()->m_dirtyBitsVolume.textureFormatDirty
+                || volumeItem->dptr()->m_dirtyBitsVolume.brickSizeDirty) {
             GLuint oldTexture = renderItem->texture();
             m_textureHelper->deleteTexture(&oldTexture);
-            GLuint texture = m_textureHelper->create3DTexture(volumeItem->textureData(),
-                                                              volumeItem->textureWidth(),
-                                                              volumeItem->textureHeight(),
-                                                              volumeItem->textureDepth(),
-                                                              volumeItem->textureFormat());
-            renderItem->setTexture(texture);
+            releaseVolumeBricks(renderItem);
             renderItem->setTextureWidth(volumeItem->textureWidth());
             renderItem->setTextureHeight(volumeItem->textureHeight());
             renderItem->setTextureDepth(volumeItem->textureDepth());
             renderItem->setTextureFormat(volumeItem->textureFormat());
+            renderItem->setBrickSize(volumeItem->brickSize());
+            createVolumeOccupancy(renderItem);
+            createVolumeBricks(renderItem);
+            GLuint texture = 0;
+            if (!renderItem->brickSize()) {
+                texture = m_textureHelper->create3DTexture(volumeItem->textureData(),
+                                                           volumeItem->textureWidth(),
+                                                           volumeItem->textureHeight(),
+                                                           volumeItem->textureDepth(),
+                                                           volumeItem->textureFormat());
+            }
+            renderItem->setTexture(texture);
             volumeItem->dptr()->m_dirtyBitsVolume.textureDimensionsDirty = false;
             volumeItem->dptr()->m_dirtyBitsVolume.textureDataDirty = false;
             volumeItem->dptr()->m_dirtyBitsVolume.textureFormatDirty = false;
+            volumeItem->dptr()->m_dirtyBitsVolume.brickSizeDirty = false;
+            volumeItem->dptr()->clearDirtySubTextures();
+        } else if (volumeItem->dptr()->hasDirtySubTextures()) {
+            const Qt::Axis axes[3] = { Qt::XAxis, Qt::YAxis, Qt::ZAxis };
+            for (int i = 0; i < 3; i++) {
+                int first = volumeItem->dptr()->m_dirtySubTextureFirst[i];
+                int last = volumeItem->dptr()->m_dirtySubTextureLast[i];
+                if (first >= 0)
+                    updateVolumeOccupancy(renderItem, axes[i], first, last);
+                if (renderItem->brickSize()) {
+                    if (first >= 0)
+                        refreshVolumeBricks(renderItem, axes[i], first, last, true);
+                } else {
+                    m_textureHelper->update3DSubTexture(renderItem->texture(),
+                                                        volumeItem->textureData(),
+                                                        volumeItem->textureDataWidth(),
+                                                        volumeItem->textureWidth(),
+                                                        volumeItem->textureHeight(),
+                                                        volumeItem->textureDepth(),
+                                                        volumeItem->textureFormat(), axes[i],
+                                                        first, last);
+                }
+            }
+            volumeItem->dptr()->clearDirtySubTextures();
         }
         if (volumeItem->dptr()->m_dirtyBitsVolume.slicesDirty) {
             renderItem->setDrawSlices(volumeItem->drawSlices());
@@ -1560,6 +1636,7 @@ void Abstract3DRenderer::drawCustomItems(RenderingState state,
                 } else {
                     // Set shadowless shader bindings
                     if (item->isVolume() && !m_isOpenGLES) {
+                        GLuint occupancyTexture = 0;
                         QVector3D cameraPos = m_cachedScene->activeCamera()->position();
                         cameraPos = MVPMatrix.inverted().map(cameraPos);
                         // Adjust camera position according to min/max bounds
@@ -1579,6 +1656,8 @@ void Abstract3DRenderer::drawCustomItems(RenderingState state,
 
                         shader->setUniformValue(shader->minBounds(), item->minBounds());
                         shader->setUniformValue(shader->maxBounds(), item->maxBounds());
+                        shader->setUniformValue(shader->brickOffset(), zeroVector);
+                        shader->setUniformValue(shader->brickScale(), oneVector);
 
                         if (shader == m_volumeTextureSliceShader) {
                             shader->setUniformValue(shader->volumeSliceIndices(),
@@ -1605,6 +1684,21 @@ void Abstract3DRenderer::drawCustomItems(RenderingState state,
                             }
                             shader->setUniformValue(shader->textureDimensions(), textureDimensions);
                             shader->setUniformValue(shader->sampleCount(), sampleCount);
+
+                            // Zero cell size disables empty space skipping in the shaders
+                            QVector3D occupancyCellSize = zeroVector;
+                            QVector3D occupancyScale = zeroVector;
+                            if (item->occupancyTexture()) {
+                                occupancyCellSize = textureDimensions
+                                        * float(volumeOccupancyCellSize);
+                                occupancyScale = QVector3D(
+                                            1.0f / (occupancyCellSize.x() * item->occupancyWidth()),
+                                            1.0f / (occupancyCellSize.y() * item->occupancyHeight()),
+                                            1.0f / (occupancyCellSize.z() * item->occupancyDepth()));
+                                occupancyTexture = item->occupancyTexture();
+                            }
+                            shader->setUniformValue(shader->occupancyCellSize(), occupancyCellSize);
+                            shader->setUniformValue(shader->occupancyScale(), occupancyScale);
                         }
                         if (item->drawSliceFrames()) {
                             // Set up the slice frame shader
@@ -1624,7 +1718,26 @@ void Abstract3DRenderer::drawCustomItems(RenderingState state,
                             glEnable(GL_CULL_FACE);
                             shader->bind();
                         }
-                        m_drawer->drawObject(shader, item->mesh(), 0, 0, item->texture());
+#if !defined(QT_OPENGL_ES_2)
+                        if (occupancyTexture) {
+                            glActiveTexture(GL_TEXTURE3);
+                            glBindTexture(GL_TEXTURE_3D, occupancyTexture);
+                            shader->setUniformValue(shader->occupancy(), 3);
+                        }
+#endif
+                        if (item->brickSize()) {
+                            drawVolumeBricks(item, shader, modelMatrix, projectionViewMatrix,
+                                             viewMatrix.inverted().map(zeroVector));
+                        } else {
+                            m_drawer->drawObject(shader, item->mesh(), 0, 0, item->texture());
+                        }
+#if !defined(QT_OPENGL_ES_2)
+                        if (occupancyTexture) {
+                            glActiveTexture(GL_TEXTURE3);
+                            glBindTexture(GL_TEXTURE_3D, 0);
+                            glActiveTexture(GL_TEXTURE0);
+                        }
+#endif
                     } else {
                         shader->setUniformValue(shader->lightS(), m_cachedTheme->lightStrength());
                         m_drawer->drawObject(shader, item->mesh(), item->texture());
@@ -1655,6 +1768,408 @@ void Abstract3DRenderer::drawCustomItems(RenderingState state,
     }
 }
 
+// Fills the table of color indexes that are fully transparent in the color table
+static void resolveTransparentColors(const QVector<QVector4D> &colorTable, bool *transparent)
+{
+    for (int i = 0; i < 256; i++)
+        transparent[i] = (i >= colorTable.size() || colorTable.at(i).w() <= 0.0f);
+}
+
+// Returns true if all texels of the box are fully transparent. The transparent table is
+// only used for indexed data.
+static bool isVolumeBoxEmpty(const QVector<uchar> *data, int lineSize, int frameHeight,
+                             QImage::Format format, const bool *transparent,
+                             int x, int y, int z, int width, int height, int depth)
+{
+    const uchar *bits = data->constData();
+    if (format == QImage::Format_Indexed8) {
+        for (int k = z; k < z + depth; k++) {
+            for (int j = y; j < y + height; j++) {
+                const uchar *line = bits + (k * frameHeight + j) * lineSize + x;
+                for (int i = 0; i < width; i++) {
+                    if (!transparent[line[i]])
+                        return false;
+                }
+            }
+        }
+    } else {
+        for (int k = z; k < z + depth; k++) {
+            for (int j = y; j < y + height; j++) {
+                // Alpha is the last byte of each BGRA texel
+                const uchar *line = bits + (k * frameHeight + j) * lineSize + x * 4 + 3;
+                for (int i = 0; i < width; i++) {
+                    if (line[i * 4])
+                        return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static bool isUnitCubeVisible(const QMatrix4x4 &mvpMatrix)
+{
+    int outside = 0x3f;
+    for (int corner = 0; corner < 8; corner++) {
+        QVector4D clip = mvpMatrix * QVector4D((corner & 1) ? 1.0f : -1.0f,
+                                               (corner & 2) ? 1.0f : -1.0f,
+                                               (corner & 4) ? 1.0f : -1.0f, 1.0f);
+        int mask = 0;
+        if (clip.x() < -clip.w())
+            mask |= 0x01;
+        if (clip.x() > clip.w())
+            mask |= 0x02;
+        if (clip.y() < -clip.w())
+            mask |= 0x04;
+        if (clip.y() > clip.w())
+            mask |= 0x08;
+        if (clip.z() < -clip.w())
+            mask |= 0x10;
+        if (clip.z() > clip.w())
+            mask |= 0x20;
+        outside &= mask;
+        if (!outside)
+            return true;
+    }
+    return false;
+}
+
+void Abstract3DRenderer::createVolumeOccupancy(CustomRenderItem *item)
+{
+    GLuint texture = item->occupancyTexture();
+    m_textureHelper->deleteTexture(&texture);
+    item->setOccupancyTexture(0);
+    item->createOccupancy(volumeOccupancyCellSize);
+    updateVolumeOccupancy(item, Qt::ZAxis, 0, item->textureDepth() - 1);
+}
+
+// Recalculates which occupancy cells overlapping the slices first..last along the axis contain
+// visible texels, and uploads the occupancy texture again
+void Abstract3DRenderer::updateVolumeOccupancy(CustomRenderItem *item, Qt::Axis axis,
+                                               int first, int last)
+{
+    QVector<uchar> &occupancy = item->occupancy();
+    if (occupancy.isEmpty())
+        return;
+
+    GLuint texture = item->occupancyTexture();
+    m_textureHelper->deleteTexture(&texture);
+    item->setOccupancyTexture(0);
+
+    QCustom3DVolume *volumeItem = static_cast<QCustom3DVolume *>(item->itemPointer());
+    const QVector<uchar> *data = volumeItem->textureData();
+    int lineSize = volumeItem->textureDataWidth();
+    int width = item->textureWidth();
+    int height = item->textureHeight();
+    int depth = item->textureDepth();
+    if (!data || data->size() < lineSize * height * depth)
+        return;
+
+    bool transparent[256];
+    resolveTransparentColors(item->colorTable(), transparent);
+    int firstCell = first / volumeOccupancyCellSize;
+    int lastCell = last / volumeOccupancyCellSize;
+    uchar *cells = occupancy.data();
+    int index = 0;
+    for (int k = 0; k < item->occupancyDepth(); k++) {
+        for (int j = 0; j < item->occupancyHeight(); j++) {
+            for (int i = 0; i < item->occupancyWidth(); i++, index++) {
+                int cell = (axis == Qt::XAxis) ? i : (axis == Qt::YAxis) ? j : k;
+                if (cell < firstCell || cell > lastCell)
+                    continue;
+                int x = i * volumeOccupancyCellSize;
+                int y = j * volumeOccupancyCellSize;
+                int z = k * volumeOccupancyCellSize;
+                bool empty = isVolumeBoxEmpty(data, lineSize, height, item->textureFormat(),
+                                              transparent, x, y, z,
+                                              qMin(volumeOccupancyCellSize, width - x),
+                                              qMin(volumeOccupancyCellSize, height - y),
+                                              qMin(volumeOccupancyCellSize, depth - z));
+                cells[index] = empty ? 0 : 255;
+            }
+        }
+    }
+
+    item->setOccupancyTexture(m_textureHelper->create3DTexture(&occupancy,
+                                                               item->occupancyWidth(),
+                                                               item->occupancyHeight(),
+                                                               QImage::Format_Indexed8,
+                                                               0, 0, 0,
+                                                               item->occupancyWidth(),
+                                                               item->occupancyHeight(),
+                                                               item->occupancyDepth()));
+}
+
+void Abstract3DRenderer::createVolumeBricks(CustomRenderItem *item)
+{
+    releaseVolumeBricks(item);
+    item->createBricks();
+    refreshVolumeBricks(item, Qt::ZAxis, 0, item->textureDepth() - 1, false);
+}
+
+// Recalculates which bricks overlapping the slices first..last along the axis are empty.
+// If reload is true, the textures of the resident bricks are uploaded again.
+void Abstract3DRenderer::refreshVolumeBricks(CustomRenderItem *item, Qt::Axis axis,
+                                             int first, int last, bool reload)
+{
+    QVector<VolumeBrick> &bricks = item->bricks();
+    if (bricks.isEmpty())
+        return;
+
+    QCustom3DVolume *volumeItem = static_cast<QCustom3DVolume *>(item->itemPointer());
+    const QVector<uchar> *data = volumeItem->textureData();
+    int lineSize = volumeItem->textureDataWidth();
+    int frameHeight = item->textureHeight();
+    bool validData = data && data->size() >= lineSize * frameHeight * item->textureDepth();
+    int pixelWidth = (item->textureFormat() == QImage::Format_Indexed8) ? 1 : 4;
+    bool transparent[256];
+    resolveTransparentColors(item->colorTable(), transparent);
+
+    for (int i = 0; i < bricks.size(); i++) {
+        VolumeBrick &brick = bricks[i];
+        int start = brick.z;
+        int size = brick.depth;
+        if (axis == Qt::XAxis) {
+            start = brick.x;
+            size = brick.width;
+        } else if (axis == Qt::YAxis) {
+            start = brick.y;
+            size = brick.height;
+        }
+        if (start + size <= first || start > last)
+            continue;
+
+        brick.empty = !validData || isVolumeBoxEmpty(data, lineSize, frameHeight,
+                                                     item->textureFormat(), transparent,
+                                                     brick.x, brick.y, brick.z,
+                                                     brick.width, brick.height, brick.depth);
+        if (brick.texture && (reload || brick.empty)) {
+            qint64 brickMemory = qint64(brick.width) * brick.height * brick.depth * pixelWidth;
+            m_textureHelper->deleteTexture(&brick.texture);
+            m_volumeBrickMemory -= brickMemory;
+            if (!brick.empty) {
+                brick.texture = m_textureHelper->create3DTexture(data, lineSize, frameHeight,
+                                                                 item->textureFormat(),
+                                                                 brick.x, brick.y, brick.z,
+                                                                 brick.width, brick.height,
+                                                                 brick.depth);
+                if (brick.texture)
+                    m_volumeBrickMemory += brickMemory;
+            }
+        }
+    }
+}
+
+void Abstract3DRenderer::releaseVolumeBricks(CustomRenderItem *item)
+{
+    int pixelWidth = (item->textureFormat() == QImage::Format_Indexed8) ? 1 : 4;
+    QVector<VolumeBrick> &bricks = item->bricks();
+    for (int i = 0; i < bricks.size(); i++) {
+        VolumeBrick &brick = bricks[i];
+        if (brick.texture) {
+            m_textureHelper->deleteTexture(&brick.texture);
+            m_volumeBrickMemory -= qint64(brick.width) * brick.height * brick.depth * pixelWidth;
+        }
+        brick.requested = false;
+    }
+}
+
+// Releases the least recently drawn bricks that were not drawn on the previous frame
+// until at least the given amount of texture memory is freed
+void Abstract3DRenderer::evictVolumeBricks(qint64 memory)
+{
+    while (memory > 0) {
+        VolumeBrick *oldestBrick = 0;
+        CustomRenderItem *oldestItem = 0;
+        foreach (CustomRenderItem *item, m_customRenderCache) {
+            QVector<VolumeBrick> &bricks = item->bricks();
+            for (int i = 0; i < bricks.size(); i++) {
+                VolumeBrick &brick = bricks[i];
+                if (brick.texture && brick.lastUsedFrame + 1 < m_volumeBrickFrame
+                        && (!oldestBrick || brick.lastUsedFrame < oldestBrick->lastUsedFrame)) {
+                    oldestBrick = &brick;
+                    oldestItem = item;
+                }
+            }
+        }
+        if (!oldestBrick)
+            return;
+
+        int pixelWidth = (oldestItem->textureFormat() == QImage::Format_Indexed8) ? 1 : 4;
+        qint64 brickMemory = qint64(oldestBrick->width) * oldestBrick->height
+                * oldestBrick->depth * pixelWidth;
+        m_textureHelper->deleteTexture(&oldestBrick->texture);
+        m_volumeBrickMemory -= brickMemory;
+        memory -= brickMemory;
+    }
+}
+
+// Uploads the bricks that were found missing while drawing the previous frame. Called when
+// synchronizing with the controller, as the volume data must not be read while rendering.
+void Abstract3DRenderer::loadVolumeBricks()
+{
+    m_volumeBrickFrame++;
+    if (!m_volumeBricksPending)
+        return;
+    m_volumeBricksPending = false;
+
+    foreach (CustomRenderItem *item, m_customRenderCache) {
+        QVector<VolumeBrick> &bricks = item->bricks();
+        if (bricks.isEmpty())
+            continue;
+
+        QCustom3DVolume *volumeItem = static_cast<QCustom3DVolume *>(item->itemPointer());
+        int pixelWidth = (item->textureFormat() == QImage::Format_Indexed8) ? 1 : 4;
+        for (int i = 0; i < bricks.size(); i++) {
+            VolumeBrick &brick = bricks[i];
+            if (!brick.requested)
+                continue;
+            brick.requested = false;
+            if (brick.texture || brick.empty)
+                continue;
+
+            qint64 brickMemory = qint64(brick.width) * brick.height * brick.depth * pixelWidth;
+            if (m_volumeBrickMemory + brickMemory > volumeBrickMemoryBudget)
+                evictVolumeBricks(m_volumeBrickMemory + brickMemory - volumeBrickMemoryBudget);
+            brick.texture = m_textureHelper->create3DTexture(volumeItem->textureData(),
+                                                             volumeItem->textureDataWidth(),
+                                                             item->textureHeight(),
+                                                             item->textureFormat(),
+                                                             brick.x, brick.y, brick.z,
+                                                             brick.width, brick.height,
+                                                             brick.depth);
+            // Do not request a brick that cannot be uploaded again on every frame
+            if (brick.texture)
+                m_volumeBrickMemory += brickMemory;
+            else
+                brick.empty = true;
+        }
+    }
+}
+
+void Abstract3DRenderer::drawVolumeBricks(CustomRenderItem *item, ShaderHelper *shader,
+                                          const QMatrix4x4 &modelMatrix,
+                                          const QMatrix4x4 &projectionViewMatrix,
+                                          const QVector3D &eyePosition)
+{
+    QVector<VolumeBrick> &bricks = item->bricks();
+    if (bricks.isEmpty())
+        return;
+
+    // Bricks are clipped to the visible part of the volume. The bounds are normalized to [0,1],
+    // with y and z increasing upwards and towards the viewer like in the model space.
+    const QVector3D &minNormal = item->minBoundsNormal();
+    const QVector3D &maxNormal = item->maxBoundsNormal();
+    QVector3D extents = maxNormal - minNormal;
+    if (extents.x() <= 0.0f || extents.y() <= 0.0f || extents.z() <= 0.0f)
+        return;
+
+    float width = float(item->textureWidth());
+    float height = float(item->textureHeight());
+    float depth = float(item->textureDepth());
+    int brickSize = item->brickSize();
+    int countX = item->brickCountX();
+    int countY = item->brickCountY();
+    int countZ = item->brickCountZ();
+
+    // Find the brick the eye is in or closest to. Ordering the bricks by descending distance
+    // from it in whole bricks along each axis draws them back to front.
+    QVector3D eye = modelMatrix.inverted().map(eyePosition);
+    eye = minNormal + (eye + oneVector) / 2.0f * extents;
+    int eyeX = qBound(0, int(eye.x() * width / float(brickSize)), countX - 1);
+    int eyeY = qBound(0, int((1.0f - eye.y()) * height / float(brickSize)), countY - 1);
+    int eyeZ = qBound(0, int((1.0f - eye.z()) * depth / float(brickSize)), countZ - 1);
+
+    int maxDistance = countX + countY + countZ;
+    QVector<int> distanceOffsets(maxDistance + 1, 0);
+    QVector<int> distances(bricks.size());
+    int index = 0;
+    for (int k = 0; k < countZ; k++) {
+        for (int j = 0; j < countY; j++) {
+            for (int i = 0; i < countX; i++) {
+                int distance = qAbs(i - eyeX) + qAbs(j - eyeY) + qAbs(k - eyeZ);
+                distances[index++] = distance;
+                distanceOffsets[distance]++;
+            }
+        }
+    }
+    int offset = 0;
+    for (int distance = maxDistance; distance >= 0; distance--) {
+        int count = distanceOffsets.at(distance);
+        distanceOffsets[distance] = offset;
+        offset += count;
+    }
+    QVector<int> order(bricks.size());
+    for (int i = 0; i < bricks.size(); i++)
+        order[distanceOffsets[distances.at(i)]++] = i;
+
+    bool drawSlices = (shader == m_volumeTextureSliceShader);
+    bool bricksMissing = false;
+    for (int n = 0; n < order.size(); n++) {
+        VolumeBrick &brick = bricks[order.at(n)];
+        if (brick.empty)
+            continue;
+        if (drawSlices
+                && !(item->sliceIndexX() >= brick.x && item->sliceIndexX() < brick.x + brick.width)
+                && !(item->sliceIndexY() >= brick.y && item->sliceIndexY() < brick.y + brick.height)
+                && !(item->sliceIndexZ() >= brick.z && item->sliceIndexZ() < brick.z + brick.depth)) {
+            continue;
+        }
+
+        QVector3D brickMin(qMax(minNormal.x(), float(brick.x) / width),
+                           qMax(minNormal.y(), 1.0f - float(brick.y + brick.height) / height),
+                           qMax(minNormal.z(), 1.0f - float(brick.z + brick.depth) / depth));
+        QVector3D brickMax(qMin(maxNormal.x(), float(brick.x + brick.width) / width),
+                           qMin(maxNormal.y(), 1.0f - float(brick.y) / height),
+                           qMin(maxNormal.z(), 1.0f - float(brick.z) / depth));
+        if (brickMin.x() >= brickMax.x() || brickMin.y() >= brickMax.y()
+                || brickMin.z() >= brickMax.z()) {
+            continue;
+        }
+
+        // Fit the unit cube mesh to the brick
+        QVector3D localMin = (brickMin - minNormal) / extents * 2.0f - oneVector;
+        QVector3D localMax = (brickMax - minNormal) / extents * 2.0f - oneVector;
+        QMatrix4x4 brickModelMatrix = modelMatrix;
+        brickModelMatrix.translate((localMin + localMax) / 2.0f);
+        brickModelMatrix.scale((localMax - localMin) / 2.0f);
+        QMatrix4x4 MVPMatrix = projectionViewMatrix * brickModelMatrix;
+        if (!isUnitCubeVisible(MVPMatrix))
+            continue;
+
+        brick.lastUsedFrame = m_volumeBrickFrame;
+        if (!brick.texture) {
+            brick.requested = true;
+            bricksMissing = true;
+            continue;
+        }
+
+        // Bounds are given to the shaders in [-1,1] with y and z flipped
+        shader->setUniformValue(shader->MVP(), MVPMatrix);
+        shader->setUniformValue(shader->minBounds(),
+                                QVector3D(brickMin.x() * 2.0f - 1.0f,
+                                          1.0f - brickMin.y() * 2.0f,
+                                          1.0f - brickMin.z() * 2.0f));
+        shader->setUniformValue(shader->maxBounds(),
+                                QVector3D(brickMax.x() * 2.0f - 1.0f,
+                                          1.0f - brickMax.y() * 2.0f,
+                                          1.0f - brickMax.z() * 2.0f));
+        shader->setUniformValue(shader->brickOffset(),
+                                QVector3D(float(brick.x) / width, float(brick.y) / height,
+                                          float(brick.z) / depth));
+        shader->setUniformValue(shader->brickScale(),
+                                QVector3D(width / float(brick.width),
+                                          height / float(brick.height),
+                                          depth / float(brick.depth)));
+        m_drawer->drawObject(shader, item->mesh(), 0, 0, brick.texture);
+    }
+
+    if (bricksMissing) {
+        m_volumeBricksPending = true;
+        emit needRender();
+    }
+}
+
 void Abstract3DRenderer::drawVolumeSliceFrame(const CustomRenderItem *item, Qt::Axis axis,
                                               const QMatrix4x4 &projectionViewMatrix)
 {
@@ -1755,63 +2270,84 @@ void Abstract3DRenderer::drawVolumeSliceFrame(const CustomRenderItem *item, Qt::
 }
 
 void Abstract3DRenderer::queriedGraphPosition(const QMatrix4x4 &projectionViewMatrix,
-                                              const QVector3D &scaling,
-                                              GLuint defaultFboHandle)
-{
-    m_cursorPositionShader->bind();
-
-    // Set up mapper framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, m_cursorPositionFrameBuffer);
-    glViewport(0, 0,
-               m_primarySubViewport.width(),
-               m_primarySubViewport.height());
-    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    glDisable(GL_DITHER); // Dither may affect colors if enabled
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_FRONT);
-
-    // Draw a cube scaled to the graph dimensions
-    QMatrix4x4 modelMatrix;
-    QMatrix4x4 MVPMatrix;
+                                              const QVector3D &scaling)
+{
+    QVector<QPoint> points(1, m_graphPositionQuery);
+    QVector<QVector3D> positions;
+    graphPositionsAt(projectionViewMatrix, scaling, points, positions);
 
-    modelMatrix.scale(scaling);
+    m_queriedGraphPosition = positions.at(0);
+    m_graphPositionQueryResolved = true;
+    m_graphPositionQueryPending = false;
+}
 
-    MVPMatrix = projectionViewMatrix * modelMatrix;
-    m_cursorPositionShader->setUniformValue(m_cursorPositionShader->MVP(), MVPMatrix);
-    m_drawer->drawObject(m_cursorPositionShader, m_positionMapperObj);
+// Maps positions in the primary subviewport to normalized graph positions by intersecting the
+// view rays with the inner sides of the box surrounding the graph. Positions outside the box
+// are mapped well outside the graph boundaries.
+void Abstract3DRenderer::graphPositionsAt(const QMatrix4x4 &projectionViewMatrix,
+                                          const QVector3D &scaling,
+                                          const QVector<QPoint> &points,
+                                          QVector<QVector3D> &positions) const
+{
+    static const QVector3D outsidePosition(-20001.0f, -20001.0f, -20001.0f);
+
+    const int pointCount = points.size();
+    positions.resize(pointCount);
+
+    bool invertible = false;
+    const QMatrix4x4 inverseMatrix = projectionViewMatrix.inverted(&invertible);
+    const float width = float(m_primarySubViewport.width());
+    const float height = float(m_primarySubViewport.height());
+    const float bounds[3] = { qAbs(scaling.x()), qAbs(scaling.y()), qAbs(scaling.z()) };
+
+    for (int i = 0; i < pointCount; i++) {
+        const QPoint &point = points.at(i);
+        positions[i] = outsidePosition;
+        if (!invertible || point.x() < 0 || point.y() < 0
+                || point.x() >= m_primarySubViewport.width()
+                || point.y() >= m_primarySubViewport.height()) {
+            continue;
+        }
 
-    QVector4D dataColor = Utils::getSelection(m_graphPositionQuery,
-                                              m_primarySubViewport.height());
-    if (dataColor.w() > 0.0f) {
-        // If position is outside the graph, set the position well outside the graph boundaries
-        dataColor = QVector4D(-10000.0f, -10000.0f, -10000.0f, 0.0f);
-    } else {
-        // Normalize to range [0.0, 1.0]
-        dataColor /= 255.0f;
+        // Ray from the near plane to the far plane through the pixel center
+        const float ndcX = (2.0f * (float(point.x()) + 0.5f)) / width - 1.0f;
+        const float ndcY = 1.0f - (2.0f * (float(point.y()) + 0.5f)) / height;
+        const QVector3D nearPoint = inverseMatrix.map(QVector3D(ndcX, ndcY, -1.0f));
+        const QVector3D direction = inverseMatrix.map(QVector3D(ndcX, ndcY, 1.0f)) - nearPoint;
+
+        // The inner side of the box is where the ray exits it. Ray parameters outside [0, 1]
+        // are beyond the clipping planes.
+        float entry = 0.0f;
+        float exit = 2.0f;
+        bool hit = true;
+        for (int axis = 0; hit && axis < 3; axis++) {
+            const float origin = nearPoint[axis];
+            const float dir = direction[axis];
+            if (qFuzzyIsNull(dir)) {
+                hit = (origin >= -bounds[axis] && origin <= bounds[axis]);
+            } else {
+                float t1 = (-bounds[axis] - origin) / dir;
+                float t2 = (bounds[axis] - origin) / dir;
+                if (t1 > t2)
+                    qSwap(t1, t2);
+                entry = qMax(entry, t1);
+                exit = qMin(exit, t2);
+                hit = (entry <= exit);
+            }
+        }
+        if (!hit || exit > 1.0f)
+            continue;
+
+        const QVector3D exitPoint = nearPoint + direction * exit;
+        QVector3D &position = positions[i];
+        for (int axis = 0; axis < 3; axis++) {
+            if (bounds[axis] > 0.0f)
+                position[axis] = qBound(-1.0f, exitPoint[axis] / bounds[axis], 1.0f);
+            else
+                position[axis] = 0.0f;
+        }
+        position.setZ(-position.z());
     }
-
-    // Restore state
-    glEnable(GL_DITHER);
-    glCullFace(GL_BACK);
-
-    // Note: Zeroing the frame buffer before resetting it is a workaround for flickering that occurs
-    // during zoom in some environments.
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    glBindFramebuffer(GL_FRAMEBUFFER, defaultFboHandle);
-    glViewport(m_primarySubViewport.x(),
-               m_primarySubViewport.y(),
-               m_primarySubViewport.width(),
-               m_primarySubViewport.height());
-
-    QVector3D normalizedValues = dataColor.toVector3D() * 2.0f;
-    normalizedValues -= oneVector;
-    m_queriedGraphPosition = QVector3D(normalizedValues.x(),
-                                       normalizedValues.y(),
-                                       normalizedValues.z());
-    m_graphPositionQueryResolved = true;
-    m_graphPositionQueryPending = false;
 }
 
 void Abstract3DRenderer::fixContextBeforeDelete()
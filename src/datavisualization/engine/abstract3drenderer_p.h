@@ -115,9 +115,6 @@ public:
                                           const QString &sliceFrameVertexShader,
                                           const QString &sliceFrameShader);
     virtual void initLabelShaders(const QString &vertexShader, const QString &fragmentShader);
-    virtual void initCursorPositionShaders(const QString &vertexShader,
-                                           const QString &fragmentShader);
-    virtual void initCursorPositionBuffer();
 
     virtual void updateAxisType(QAbstract3DAxis::AxisOrientation orientation,
                                 QAbstract3DAxis::AxisType type);
@@ -148,6 +145,7 @@ public:
 
     virtual CustomRenderItem *addCustomItem(QCustom3DItem *item);
     virtual void updateCustomItem(CustomRenderItem *renderItem);
+    void loadVolumeBricks();
 
     virtual void updateAspectRatio(float ratio);
     virtual void updateHorizontalAspectRatio(float ratio);
@@ -201,6 +199,9 @@ protected:
 
     virtual void lowerShadowQuality();
 
+    bool readSelectionColor(QVector4D &color);
+    bool takeSelectionReadback(QVector4D &color);
+
     void fixGradient(QLinearGradient *gradient, GLuint *gradientTexture);
 
     void calculateZoomLevel();
@@ -224,7 +225,6 @@ protected:
 
     void loadGridLineMesh();
     void loadLabelMesh();
-    void loadPositionMapperMesh();
 
     void drawRadialGrid(ShaderHelper *shader, float yFloorLinePos,
                         const QMatrix4x4 &projectionViewMatrix, const QMatrix4x4 &depthMatrix);
@@ -237,10 +237,21 @@ protected:
 
     void recalculateCustomItemScalingAndPos(CustomRenderItem *item);
     virtual void getVisibleItemBounds(QVector3D &minBounds, QVector3D &maxBounds) = 0;
+    void createVolumeOccupancy(CustomRenderItem *item);
+    void updateVolumeOccupancy(CustomRenderItem *item, Qt::Axis axis, int first, int last);
+    void createVolumeBricks(CustomRenderItem *item);
+    void refreshVolumeBricks(CustomRenderItem *item, Qt::Axis axis, int first, int last,
+                             bool reload);
+    void releaseVolumeBricks(CustomRenderItem *item);
+    void evictVolumeBricks(qint64 memory);
+    void drawVolumeBricks(CustomRenderItem *item, ShaderHelper *shader,
+                          const QMatrix4x4 &modelMatrix, const QMatrix4x4 &projectionViewMatrix,
+                          const QVector3D &eyePosition);
     void drawVolumeSliceFrame(const CustomRenderItem *item, Qt::Axis axis,
                               const QMatrix4x4 &projectionViewMatrix);
-    void queriedGraphPosition(const QMatrix4x4 &projectionViewMatrix, const QVector3D &scaling,
-                              GLuint defaultFboHandle);
+    void queriedGraphPosition(const QMatrix4x4 &projectionViewMatrix, const QVector3D &scaling);
+    void graphPositionsAt(const QMatrix4x4 &projectionViewMatrix, const QVector3D &scaling,
+                          const QVector<QPoint> &points, QVector<QVector3D> &positions) const;
 
     void fixContextBeforeDelete();
     void restoreContextAfterDelete();
@@ -291,10 +302,13 @@ protected:
     ShaderHelper *m_volumeTextureLowDefShader;
     ShaderHelper *m_volumeTextureSliceShader;
     ShaderHelper *m_volumeSliceFrameShader;
+    uint m_volumeBrickFrame;
+    qint64 m_volumeBrickMemory;
+    bool m_volumeBricksPending;
+    GLuint m_selectionReadbackBuffer;
+    bool m_selectionReadbackPending;
+    QPoint m_selectionReadbackPosition;
     ShaderHelper *m_labelShader;
-    ShaderHelper *m_cursorPositionShader;
-    GLuint m_cursorPositionFrameBuffer;
-    GLuint m_cursorPositionTexture;
 
     bool m_useOrthoProjection;
     bool m_xFlipped;
@@ -305,7 +319,6 @@ protected:
     ObjectHelper *m_backgroundObj; // Shared reference
     ObjectHelper *m_gridLineObj; // Shared reference
     ObjectHelper *m_labelObj; // Shared reference
-    ObjectHelper *m_positionMapperObj; // Shared reference
 
     float m_graphAspectRatio;
     float m_graphHorizontalAspectRatio;
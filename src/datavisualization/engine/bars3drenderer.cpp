@@ -33,6 +33,7 @@
 #include "texturehelper_p.h"
 #include "utils_p.h"
 #include "barseriesrendercache_p.h"
+#include "barinstancebufferhelper_p.h"
 
 #include <QtCore/qmath.h>
 
@@ -58,6 +59,11 @@ Bars3DRenderer::Bars3DRenderer(Bars3DController *controller)
       m_depthShader(0),
       m_selectionShader(0),
       m_backgroundShader(0),
+      m_barInstancedShader(0),
+      m_barGradientInstancedShader(0),
+      m_depthInstancedShader(0),
+      m_selectionInstancedShader(0),
+      m_useInstancing(false),
       m_bgrTexture(0),
       m_selectionTexture(0),
       m_depthFrameBuffer(0),
@@ -115,6 +121,10 @@ Bars3DRenderer::~Bars3DRenderer()
     delete m_depthShader;
     delete m_selectionShader;
     delete m_backgroundShader;
+    delete m_barInstancedShader;
+    delete m_barGradientInstancedShader;
+    delete m_depthInstancedShader;
+    delete m_selectionInstancedShader;
 }
 
 void Bars3DRenderer::initializeOpenGL()
@@ -255,6 +265,8 @@ void Bars3DRenderer::updateData()
         }
     }
 
+    invalidateInstanceData();
+
     // Reset selected bar to update selection
     updateSelectedBar(m_selectedBarPos,
                       m_selectedSeriesCache ? m_selectedSeriesCache->series() : 0);
@@ -348,6 +360,8 @@ void Bars3DRenderer::updateSeries(const QList<QAbstract3DSeries *> &seriesList)
             m_selectionLabelDirty = true;
         m_selectedSeriesCache = 0;
     }
+
+    invalidateInstanceData();
 }
 
 SeriesRenderCache *Bars3DRenderer::createNewCache(QAbstract3DSeries *series)
@@ -379,6 +393,7 @@ void Bars3DRenderer::updateRows(const QVector<Bars3DController::ChangeRow> &rows
         }
         if (cache->isVisible()) {
             updateRenderRow(dataArray->at(row), cache->renderArray()[row - minRow]);
+            cache->setInstanceDataDirty(true);
             if (m_cachedIsSlicingActivated
                     && cache == m_selectedSeriesCache
                     && m_selectedBarPos.x() == row) {
@@ -416,6 +431,7 @@ void Bars3DRenderer::updateItems(const QVector<Bars3DController::ChangeItem> &it
         if (cache->isVisible()) {
             updateRenderItem(dataArray->at(row)->at(col),
                              cache->renderArray()[row - minRow][col - minCol]);
+            cache->setInstanceDataDirty(true);
             if (m_cachedIsSlicingActivated
                     && cache == m_selectedSeriesCache
                     && m_selectedBarPos == QPoint(row, col)) {
@@ -1079,12 +1095,50 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                 ObjectHelper *barObj = cache->object();
                 QQuaternion seriesRotation(cache->meshRotation());
                 const BarRenderItemArray &renderArray = cache->renderArray();
+                bool instanced = m_depthInstancedShader && useInstancing(cache);
+                if (instanced) {
+                    BarInstanceBufferHelper *instances = cache->instanceBuffer();
+                    QMatrix4x4 rotationMatrix;
+                    if (!seriesRotation.isIdentity())
+                        rotationMatrix.rotate(seriesRotation);
+                    m_depthInstancedShader->bind();
+                    m_depthInstancedShader->setUniformValue(m_depthInstancedShader->MVP(),
+                                                            depthProjectionViewMatrix);
+                    m_depthInstancedShader->setUniformValue(m_depthInstancedShader->model(),
+                                                            rotationMatrix);
+                    bool skipOtherSide = m_cachedTheme->isBackgroundEnabled()
+                            && m_reflectionEnabled;
+                    if (instances->positiveCount() && !(skipOtherSide && m_yFlipped)) {
+                        glCullFace(GL_BACK);
+                        m_depthInstancedShader->setUniformValue(
+                                    m_depthInstancedShader->instanceScale(),
+                                    QVector4D(shadowScaler.x(), 1.0f, shadowScaler.z(),
+                                              m_yFlipped ? 0.015f : 0.0f));
+                        m_drawer->drawObjectInstanced(m_depthInstancedShader, barObj, instances,
+                                                      0, instances->positiveCount());
+                    }
+                    if (instances->negativeCount() && !(skipOtherSide && !m_yFlipped)) {
+                        glCullFace(GL_FRONT);
+                        m_depthInstancedShader->setUniformValue(
+                                    m_depthInstancedShader->instanceScale(),
+                                    QVector4D(shadowScaler.x(), 1.0f, shadowScaler.z(),
+                                              m_yFlipped ? 0.0f : -0.015f));
+                        m_drawer->drawObjectInstanced(m_depthInstancedShader, barObj, instances,
+                                                      instances->negativeStart(),
+                                                      instances->negativeCount());
+                    }
+                    m_depthShader->bind();
+                    if (!cache->hasIndividualBars())
+                        continue;
+                }
                 for (int row = startRow; row != stopRow; row += stepRow) {
                     const BarRenderItemRow &renderRow = renderArray.at(row);
                     for (int bar = startBar; bar != stopBar; bar += stepBar) {
                         const BarRenderItem &item = renderRow.at(bar);
                         if (!item.value())
                             continue;
+                        if (instanced && isInstancedBar(row, bar, item, cache))
+                            continue;
                         GLfloat shadowOffset = 0.0f;
                         // Set front face culling for negative valued bars and back face culling
                         // for positive valued bars to remove peter-panning issues
@@ -1169,15 +1223,20 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
     // Do position mapping when necessary
     if (m_graphPositionQueryPending) {
         QVector3D graphDimensions(m_xScaleFactor, 0.0f, m_zScaleFactor);
-        queriedGraphPosition(projectionViewMatrix, graphDimensions, defaultFboHandle);
+        queriedGraphPosition(projectionViewMatrix, graphDimensions);
 
         // Y is always at floor level
         m_queriedGraphPosition.setY(0.0f);
         emit needRender();
     }
 
+    // A selection read back asynchronously on the previous frame doesn't need another pass
+    QVector4D clickedColor;
+    bool selectionRead = takeSelectionReadback(clickedColor);
+
     // Skip selection mode drawing if we're slicing or have no selection mode
-    if (!m_cachedIsSlicingActivated && m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
+    if (!selectionRead && !m_cachedIsSlicingActivated
+            && m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
             && m_selectionState == SelectOnScene
             && (m_visibleSeriesCount > 0 || !m_customRenderCache.isEmpty())
             && m_selectionTexture) {
@@ -1201,12 +1260,50 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                 ObjectHelper *barObj = cache->object();
                 QQuaternion seriesRotation(cache->meshRotation());
                 const BarRenderItemArray &renderArray = cache->renderArray();
+                bool instanced = useInstancing(cache);
+                if (instanced) {
+                    BarInstanceBufferHelper *instances = cache->instanceBuffer();
+                    QMatrix4x4 rotationMatrix;
+                    if (!seriesRotation.isIdentity())
+                        rotationMatrix.rotate(seriesRotation);
+                    // Row and column of the selection color come from the instance data
+                    QVector4D seriesColor = QVector4D(0.0f, 0.0f,
+                                                      GLfloat(cache->visualIndex()) / 255.0f,
+                                                      itemAlpha);
+                    m_selectionInstancedShader->bind();
+                    m_selectionInstancedShader->setUniformValue(
+                                m_selectionInstancedShader->MVP(), projectionViewMatrix);
+                    m_selectionInstancedShader->setUniformValue(
+                                m_selectionInstancedShader->model(), rotationMatrix);
+                    m_selectionInstancedShader->setUniformValue(
+                                m_selectionInstancedShader->instanceScale(),
+                                QVector4D(m_scaleX * m_seriesScaleX, 1.0f,
+                                          m_scaleZ * m_seriesScaleZ, 0.0f));
+                    m_selectionInstancedShader->setUniformValue(
+                                m_selectionInstancedShader->color(), seriesColor);
+                    if (instances->positiveCount()) {
+                        glCullFace(GL_BACK);
+                        m_drawer->drawObjectInstanced(m_selectionInstancedShader, barObj,
+                                                      instances, 0, instances->positiveCount());
+                    }
+                    if (instances->negativeCount()) {
+                        glCullFace(GL_FRONT);
+                        m_drawer->drawObjectInstanced(m_selectionInstancedShader, barObj,
+                                                      instances, instances->negativeStart(),
+                                                      instances->negativeCount());
+                    }
+                    m_selectionShader->bind();
+                    if (!cache->hasIndividualBars())
+                        continue;
+                }
                 for (int row = startRow; row != stopRow; row += stepRow) {
                     const BarRenderItemRow &renderRow = renderArray.at(row);
                     for (int bar = startBar; bar != stopBar; bar += stepBar) {
                         const BarRenderItem &item = renderRow.at(bar);
                         if (!item.value())
                             continue;
+                        if (instanced && isInstancedBar(row, bar, item, cache))
+                            continue;
 
                         if (item.height() < 0)
                             glCullFace(GL_FRONT);
@@ -1254,12 +1351,7 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
         glEnable(GL_DITHER);
 
         // Read color under cursor
-        QVector4D clickedColor = Utils::getSelection(m_inputPosition, m_viewport.height());
-        m_clickedPosition = selectionColorToArrayPosition(clickedColor);
-        m_clickedSeries = selectionColorToSeries(clickedColor);
-        m_clickResolved = true;
-
-        emit needRender();
+        selectionRead = readSelectionColor(clickedColor);
 
         // Revert to original render target and viewport
         glBindFramebuffer(GL_FRAMEBUFFER, defaultFboHandle);
@@ -1269,6 +1361,14 @@ void Bars3DRenderer::drawScene(GLuint defaultFboHandle)
                    m_primarySubViewport.height());
     }
 
+    if (selectionRead) {
+        m_clickedPosition = selectionColorToArrayPosition(clickedColor);
+        m_clickedSeries = selectionColorToSeries(clickedColor);
+        m_clickResolved = true;
+
+        emit needRender();
+    }
+
     if (m_reflectionEnabled) {
         //
         // Draw reflections
@@ -1491,10 +1591,22 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
             }
 
             previousColorStyle = colorStyle;
+
+            bool instanced = useInstancing(cache);
+            if (instanced) {
+                drawInstancedBars(cache, depthProjectionViewMatrix, projectionViewMatrix,
+                                  viewMatrix, reflection);
+                barShader->bind();
+                if (!cache->hasIndividualBars())
+                    continue;
+            }
+
             for (int row = startRow; row != stopRow; row += stepRow) {
                 BarRenderItemRow &renderRow = renderArray[row];
                 for (int bar = startBar; bar != stopBar; bar += stepBar) {
                     BarRenderItem &item = renderRow[bar];
+                    if (instanced && isInstancedBar(row, bar, item, cache))
+                        continue;
                     float adjustedHeight = reflection * item.height();
                     if (adjustedHeight < 0)
                         glCullFace(GL_FRONT);
@@ -1689,6 +1801,92 @@ bool Bars3DRenderer::drawBars(BarRenderItem **selectedBar,
     return barSelectionFound;
 }
 
+void Bars3DRenderer::drawInstancedBars(BarSeriesRenderCache *cache,
+                                       const QMatrix4x4 &depthProjectionViewMatrix,
+                                       const QMatrix4x4 &projectionViewMatrix,
+                                       const QMatrix4x4 &viewMatrix, GLfloat reflection)
+{
+    BarInstanceBufferHelper *instances = cache->instanceBuffer();
+
+    // Only bars on the same side of the floor as the camera are reflected
+    bool drawPositive = instances->positiveCount()
+            && (!m_reflectionEnabled || reflection == 1.0f || !m_yFlipped);
+    bool drawNegative = instances->negativeCount()
+            && (!m_reflectionEnabled || reflection == 1.0f || m_yFlipped);
+    if (!drawPositive && !drawNegative)
+        return;
+
+    bool colorStyleIsUniform = (cache->colorStyle() == Q3DTheme::ColorStyleUniform);
+    ShaderHelper *shader = colorStyleIsUniform ? m_barInstancedShader
+                                               : m_barGradientInstancedShader;
+    QMatrix4x4 rotationMatrix;
+    if (!cache->meshRotation().isIdentity())
+        rotationMatrix.rotate(cache->meshRotation());
+    GLuint gradientTexture = 0;
+
+    shader->bind();
+    shader->setUniformValue(shader->lightP(), m_cachedScene->activeLight()->position());
+    shader->setUniformValue(shader->view(), viewMatrix);
+    shader->setUniformValue(shader->ambientS(), m_cachedTheme->ambientLightStrength());
+    shader->setUniformValue(shader->lightColor(),
+                            Utils::vectorFromColor(m_cachedTheme->lightColor()));
+    shader->setUniformValue(shader->model(), rotationMatrix);
+#ifdef SHOW_DEPTH_TEXTURE_SCENE
+    shader->setUniformValue(shader->MVP(), depthProjectionViewMatrix);
+#else
+    shader->setUniformValue(shader->MVP(), projectionViewMatrix);
+#endif
+    shader->setUniformValue(shader->instanceScale(),
+                            QVector4D(m_scaleX * m_seriesScaleX, reflection,
+                                      m_scaleZ * m_seriesScaleZ, 0.0f));
+    if (colorStyleIsUniform) {
+        shader->setUniformValue(shader->color(), cache->baseColor());
+    } else {
+        gradientTexture = cache->baseGradientTexture();
+        shader->setUniformValue(shader->gradientMin(), 0.0f);
+        if (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient) {
+            // Bar height is applied to the gradient coordinates per instance in the shader
+            shader->setUniformValue(shader->instanceGradient(), 1.0f);
+            shader->setUniformValue(shader->gradientHeight(), 1.0f / m_gradientFraction);
+        } else {
+            shader->setUniformValue(shader->instanceGradient(), 0.0f);
+            shader->setUniformValue(shader->gradientHeight(), 0.5f);
+        }
+    }
+
+    GLuint depthTexture = 0;
+    GLfloat adjustedLightStrength = m_cachedTheme->lightStrength() / 10.0f;
+    if (((m_reflectionEnabled && reflection == 1.0f
+          && m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone)
+         || m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone)
+            && !m_isOpenGLES) {
+        // Set shadow shader bindings
+        shader->setUniformValue(shader->shadowQ(), m_shadowQualityToShader);
+        shader->setUniformValue(shader->depth(), depthProjectionViewMatrix);
+        shader->setUniformValue(shader->lightS(), adjustedLightStrength);
+        depthTexture = m_depthTexture;
+    } else if (m_reflectionEnabled && reflection != 1.0f
+               && m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone) {
+        shader->setUniformValue(shader->lightS(), adjustedLightStrength);
+    } else {
+        shader->setUniformValue(shader->lightS(), m_cachedTheme->lightStrength());
+    }
+
+    // Culling is flipped for bars that end up below the floor after reflection
+    if (drawPositive) {
+        glCullFace(reflection < 0.0f ? GL_FRONT : GL_BACK);
+        m_drawer->drawObjectInstanced(shader, cache->object(), instances,
+                                      0, instances->positiveCount(),
+                                      gradientTexture, depthTexture);
+    }
+    if (drawNegative) {
+        glCullFace(reflection < 0.0f ? GL_BACK : GL_FRONT);
+        m_drawer->drawObjectInstanced(shader, cache->object(), instances,
+                                      instances->negativeStart(), instances->negativeCount(),
+                                      gradientTexture, depthTexture);
+    }
+}
+
 void Bars3DRenderer::drawBackground(GLfloat backgroundRotation,
                                     const QMatrix4x4 &depthProjectionViewMatrix,
                                     const QMatrix4x4 &projectionViewMatrix,
@@ -2482,6 +2680,9 @@ void Bars3DRenderer::updateSelectedBar(const QPoint &position, QBar3DSeries *ser
     m_selectionDirty = true;
     m_selectionLabelDirty = true;
 
+    // Highlighted bars are drawn individually, so the instanced bars change with the selection
+    invalidateInstanceData();
+
     if (!m_selectedSeriesCache
             || !m_selectedSeriesCache->isVisible()
             || m_selectedSeriesCache->renderArray().isEmpty()) {
@@ -2606,6 +2807,8 @@ void Bars3DRenderer::calculateSceneScalingFactors()
     m_scaleYWithBackground = 1.0f + m_vBackgroundMargin;
     m_scaleZWithBackground = m_zScaleFactor + m_hBackgroundMargin;
 
+    invalidateInstanceData();
+
     updateCameraViewport();
     updateCustomItemPositions();
 }
@@ -2653,6 +2856,83 @@ void Bars3DRenderer::calculateHeightAdjustment()
     }
 }
 
+bool Bars3DRenderer::isInstancedBar(int row, int bar, const BarRenderItem &item,
+                                    const BarSeriesRenderCache *cache)
+{
+    // Highlighted and individually rotated bars are drawn one by one
+    if (!item.rotation().isIdentity())
+        return false;
+
+    if (m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
+            && m_visualSelectedBarPos != Bars3DController::invalidSelectionPosition()) {
+        return isSelected(row, bar, cache) == Bars3DController::SelectionNone;
+    }
+
+    return true;
+}
+
+bool Bars3DRenderer::useInstancing(BarSeriesRenderCache *cache)
+{
+    if (!m_useInstancing || !m_barInstancedShader || !m_barGradientInstancedShader)
+        return false;
+
+    // The instances are not in the camera dependent drawing order, so series with
+    // transparent colors are drawn one bar at a time
+    if (!cache->isBaseOpaque())
+        return false;
+
+    if (!cache->instanceBuffer()) {
+        cache->setInstanceBuffer(new BarInstanceBufferHelper());
+        cache->setInstanceDataDirty(true);
+    }
+
+    if (cache->instanceDataDirty()) {
+        float seriesPos = m_seriesStart + m_seriesStep * cache->visualIndex() + 0.5f;
+        const BarRenderItemArray &renderArray = cache->renderArray();
+        QVector<BarInstance> instances;
+        QVector<BarInstance> negativeInstances;
+        bool hasIndividualBars = false;
+        BarInstance instance;
+        for (int row = 0; row < renderArray.size(); row++) {
+            const BarRenderItemRow &renderRow = renderArray.at(row);
+            instance.row = GLfloat(row);
+            instance.z = (m_columnDepth - ((row + 0.5f) * m_cachedBarSpacing.height()))
+                    / m_scaleFactor;
+            for (int bar = 0; bar < renderRow.size(); bar++) {
+                const BarRenderItem &item = renderRow.at(bar);
+                if (!isInstancedBar(row, bar, item, cache)) {
+                    hasIndividualBars = true;
+                    continue;
+                }
+                if (item.height() == 0.0f)
+                    continue;
+                instance.x = (((bar + seriesPos) * m_cachedBarSpacing.width()) - m_rowWidth)
+                        / m_scaleFactor;
+                instance.height = item.height();
+                instance.column = GLfloat(bar);
+                // Negative bars are stored last, as they are drawn with front face culling
+                if (item.height() > 0.0f)
+                    instances.append(instance);
+                else
+                    negativeInstances.append(instance);
+            }
+        }
+        int negativeStart = instances.size();
+        instances += negativeInstances;
+        cache->instanceBuffer()->load(instances, negativeStart);
+        cache->setHasIndividualBars(hasIndividualBars);
+        cache->setInstanceDataDirty(false);
+    }
+
+    return true;
+}
+
+void Bars3DRenderer::invalidateInstanceData()
+{
+    foreach (SeriesRenderCache *baseCache, m_renderCacheList)
+        static_cast<BarSeriesRenderCache *>(baseCache)->setInstanceDataDirty(true);
+}
+
 Bars3DController::SelectionType Bars3DRenderer::isSelected(int row, int bar,
                                                            const BarSeriesRenderCache *cache)
 {
@@ -2749,7 +3029,6 @@ void Bars3DRenderer::updateSlicingActive(bool isSlicing)
     if (!m_cachedIsSlicingActivated) {
         // We need to re-init selection buffer in case there has been a resize
         initSelectionBuffer();
-        initCursorPositionBuffer();
     }
 
     updateDepthBuffer(); // Re-init depth buffer as well
@@ -2762,6 +3041,8 @@ void Bars3DRenderer::initShaders(const QString &vertexShader, const QString &fra
         delete m_barShader;
     m_barShader = new ShaderHelper(this, vertexShader, fragmentShader);
     m_barShader->initialize();
+
+    initInstancedShaders(vertexShader, fragmentShader, m_barInstancedShader);
 }
 
 void Bars3DRenderer::initGradientShaders(const QString &vertexShader, const QString &fragmentShader)
@@ -2770,6 +3051,28 @@ void Bars3DRenderer::initGradientShaders(const QString &vertexShader, const QStr
         delete m_barGradientShader;
     m_barGradientShader = new ShaderHelper(this, vertexShader, fragmentShader);
     m_barGradientShader->initialize();
+
+    initInstancedShaders(vertexShader, fragmentShader, m_barGradientInstancedShader);
+}
+
+void Bars3DRenderer::initInstancedShaders(const QString &vertexShader,
+                                          const QString &fragmentShader,
+                                          ShaderHelper *&shader)
+{
+    if (!Utils::isInstancingSupported())
+        return;
+
+    // Instanced vertex shaders produce the same outputs as the regular ones
+    QString instancedVertexShader;
+    if (vertexShader == QStringLiteral(":/shaders/vertexShadow"))
+        instancedVertexShader = QStringLiteral(":/shaders/vertexShadowInstanced");
+    else
+        instancedVertexShader = QStringLiteral(":/shaders/vertexInstanced");
+
+    if (shader)
+        delete shader;
+    shader = new ShaderHelper(this, instancedVertexShader, fragmentShader);
+    shader->initialize();
 }
 
 void Bars3DRenderer::initSelectionShader()
@@ -2779,6 +3082,15 @@ void Bars3DRenderer::initSelectionShader()
     m_selectionShader = new ShaderHelper(this, QStringLiteral(":/shaders/vertexPlainColor"),
                                          QStringLiteral(":/shaders/fragmentPlainColor"));
     m_selectionShader->initialize();
+
+    if (Utils::isInstancingSupported()) {
+        if (m_selectionInstancedShader)
+            delete m_selectionInstancedShader;
+        m_selectionInstancedShader =
+                new ShaderHelper(this, QStringLiteral(":/shaders/vertexPlainColorInstanced"),
+                                 QStringLiteral(":/shaders/fragmentPlainColorInstanced"));
+        m_selectionInstancedShader->initialize();
+    }
 }
 
 void Bars3DRenderer::initSelectionBuffer()
@@ -2801,6 +3113,15 @@ void Bars3DRenderer::initDepthShader()
         m_depthShader = new ShaderHelper(this, QStringLiteral(":/shaders/vertexDepth"),
                                          QStringLiteral(":/shaders/fragmentDepth"));
         m_depthShader->initialize();
+
+        if (Utils::isInstancingSupported()) {
+            if (m_depthInstancedShader)
+                delete m_depthInstancedShader;
+            m_depthInstancedShader =
+                    new ShaderHelper(this, QStringLiteral(":/shaders/vertexDepthInstanced"),
+                                     QStringLiteral(":/shaders/fragmentDepth"));
+            m_depthInstancedShader->initialize();
+        }
     }
 }
 
@@ -2871,4 +3192,20 @@ void Bars3DRenderer::updateMargin(float margin)
     calculateSceneScalingFactors();
 }
 
+void Bars3DRenderer::updateOptimizationHint(QAbstract3DGraph::OptimizationHints hint)
+{
+    Abstract3DRenderer::updateOptimizationHint(hint);
+
+    m_useInstancing = hint.testFlag(QAbstract3DGraph::OptimizationInstanced)
+            && Utils::isInstancingSupported();
+    invalidateInstanceData();
+}
+
+void Bars3DRenderer::updateSelectionMode(QAbstract3DGraph::SelectionFlags newMode)
+{
+    Abstract3DRenderer::updateSelectionMode(newMode);
+
+    invalidateInstanceData();
+}
+
 QT_END_NAMESPACE_DATAVISUALIZATION
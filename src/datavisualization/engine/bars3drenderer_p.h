@@ -79,6 +79,11 @@ private:
     ShaderHelper *m_depthShader;
     ShaderHelper *m_selectionShader;
     ShaderHelper *m_backgroundShader;
+    ShaderHelper *m_barInstancedShader;
+    ShaderHelper *m_barGradientInstancedShader;
+    ShaderHelper *m_depthInstancedShader;
+    ShaderHelper *m_selectionInstancedShader;
+    bool m_useInstancing;
     GLuint m_bgrTexture;
     GLuint m_selectionTexture;
     GLuint m_depthFrameBuffer;
@@ -132,6 +137,8 @@ public:
     void updateAspectRatio(float ratio);
     void updateFloorLevel(float level);
     void updateMargin(float margin);
+    void updateOptimizationHint(QAbstract3DGraph::OptimizationHints hint);
+    void updateSelectionMode(QAbstract3DGraph::SelectionFlags newMode);
 
 protected:
     virtual void initializeOpenGL();
@@ -170,6 +177,10 @@ private:
                   const QMatrix4x4 &projectionViewMatrix, const QMatrix4x4 &viewMatrix,
                   GLint startRow, GLint stopRow, GLint stepRow,
                   GLint startBar, GLint stopBar, GLint stepBar, GLfloat reflection = 1.0f);
+    void drawInstancedBars(BarSeriesRenderCache *cache,
+                           const QMatrix4x4 &depthProjectionViewMatrix,
+                           const QMatrix4x4 &projectionViewMatrix, const QMatrix4x4 &viewMatrix,
+                           GLfloat reflection);
     void drawBackground(GLfloat backgroundRotation, const QMatrix4x4 &depthProjectionViewMatrix,
                         const QMatrix4x4 &projectionViewMatrix, const QMatrix4x4 &viewMatrix,
                         bool reflectingDraw = false, bool drawingSelectionBuffer = false);
@@ -189,6 +200,12 @@ private:
                                                    const BarSeriesRenderCache *cache);
     QPoint selectionColorToArrayPosition(const QVector4D &selectionColor);
     QBar3DSeries *selectionColorToSeries(const QVector4D &selectionColor);
+    bool isInstancedBar(int row, int bar, const BarRenderItem &item,
+                        const BarSeriesRenderCache *cache);
+    bool useInstancing(BarSeriesRenderCache *cache);
+    void invalidateInstanceData();
+    void initInstancedShaders(const QString &vertexShader, const QString &fragmentShader,
+                              ShaderHelper *&shader);
 
     inline void updateRenderRow(const QBarDataRow *dataRow, BarRenderItemRow &renderRow);
     inline void updateRenderItem(const QBarDataItem &dataItem, BarRenderItem &renderItem);
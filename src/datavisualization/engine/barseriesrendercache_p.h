@@ -47,6 +47,8 @@
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
+class BarInstanceBufferHelper;
+
 class BarSeriesRenderCache : public SeriesRenderCache
 {
 public:
@@ -60,11 +62,20 @@ public:
     inline QVector<BarRenderSliceItem> &sliceArray() { return m_sliceArray; }
     inline void setVisualIndex(int index) { m_visualIndex = index; }
     inline int visualIndex() {return m_visualIndex; }
+    inline BarInstanceBufferHelper *instanceBuffer() const { return m_instanceBuffer; }
+    inline void setInstanceBuffer(BarInstanceBufferHelper *buffer) { m_instanceBuffer = buffer; }
+    inline void setInstanceDataDirty(bool state) { m_instanceDataDirty = state; }
+    inline bool instanceDataDirty() const { return m_instanceDataDirty; }
+    inline void setHasIndividualBars(bool state) { m_hasIndividualBars = state; }
+    inline bool hasIndividualBars() const { return m_hasIndividualBars; }
 
 protected:
     BarRenderItemArray m_renderArray;
     QVector<BarRenderSliceItem> m_sliceArray;
     int m_visualIndex; // order of the series is relevant
+    BarInstanceBufferHelper *m_instanceBuffer; // Owned, only exists in instanced mode
+    bool m_instanceDataDirty;
+    bool m_hasIndividualBars; // Highlighted or rotated bars that are not in the instance buffer
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -34,8 +34,11 @@
 #include "texturehelper_p.h"
 #include "abstract3drenderer_p.h"
 #include "scatterpointbufferhelper_p.h"
+#include "barinstancebufferhelper_p.h"
+#include "scatterinstancebufferhelper_p.h"
 
 #include <QtGui/QMatrix4x4>
+#include <QtGui/QOpenGLExtraFunctions>
 #include <QtCore/qmath.h>
 
 // Resources need to be explicitly initialized when building as static library
@@ -63,6 +66,7 @@ const GLfloat line_data[] = {
 Drawer::Drawer(Q3DTheme *theme)
     : m_theme(theme),
       m_textureHelper(0),
+      m_labelTextureCache(new LabelTextureCache),
       m_pointbuffer(0),
       m_linebuffer(0),
       m_scaledFontSize(0.0f)
@@ -194,6 +198,212 @@ void Drawer::drawSelectionObject(ShaderHelper *shader, AbstractObjectHelper *obj
     glDisableVertexAttribArray(shader->posAtt());
 }
 
+void Drawer::drawObjectInstanced(ShaderHelper *shader, AbstractObjectHelper *object,
+                                 BarInstanceBufferHelper *instances, int firstInstance,
+                                 int instanceCount, GLuint textureId, GLuint depthTextureId)
+{
+    QOpenGLExtraFunctions *extraFuncs = QOpenGLContext::currentContext()->extraFunctions();
+
+    // Per-instance attribute buffers : translation and height, selection indexes
+    const GLsizei stride = sizeof(BarInstance);
+    const char *instanceOffset = (const char *)0 + firstInstance * stride;
+    glBindBuffer(GL_ARRAY_BUFFER, instances->instanceBuf());
+    glEnableVertexAttribArray(shader->instanceAtt());
+    glVertexAttribPointer(shader->instanceAtt(), 3, GL_FLOAT, GL_FALSE, stride,
+                          (void *)instanceOffset);
+    extraFuncs->glVertexAttribDivisor(shader->instanceAtt(), 1);
+    if (shader->instanceIndexAtt() >= 0) {
+        glEnableVertexAttribArray(shader->instanceIndexAtt());
+        glVertexAttribPointer(shader->instanceIndexAtt(), 2, GL_FLOAT, GL_FALSE, stride,
+                              (void *)(instanceOffset + 3 * sizeof(GLfloat)));
+        extraFuncs->glVertexAttribDivisor(shader->instanceIndexAtt(), 1);
+    }
+
+    drawInstances(shader, object, instanceCount, textureId, depthTextureId);
+
+    // Divisors are not part of the shader state, so reset them for non-instanced draws
+    if (shader->instanceIndexAtt() >= 0) {
+        extraFuncs->glVertexAttribDivisor(shader->instanceIndexAtt(), 0);
+        glDisableVertexAttribArray(shader->instanceIndexAtt());
+    }
+    extraFuncs->glVertexAttribDivisor(shader->instanceAtt(), 0);
+    glDisableVertexAttribArray(shader->instanceAtt());
+}
+
+void Drawer::drawObjectInstanced(ShaderHelper *shader, AbstractObjectHelper *object,
+                                 ScatterInstanceBufferHelper *instances, GLuint textureId,
+                                 GLuint depthTextureId)
+{
+    QOpenGLExtraFunctions *extraFuncs = QOpenGLContext::currentContext()->extraFunctions();
+
+    // Per-instance attribute buffers : translation, rotation and scale, selection index
+    const GLsizei stride = sizeof(ScatterInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, instances->instanceBuf());
+    glEnableVertexAttribArray(shader->instanceAtt());
+    glVertexAttribPointer(shader->instanceAtt(), 4, GL_FLOAT, GL_FALSE, stride, (void *)0);
+    extraFuncs->glVertexAttribDivisor(shader->instanceAtt(), 1);
+    if (shader->instanceRotationAtt() >= 0) {
+        glEnableVertexAttribArray(shader->instanceRotationAtt());
+        glVertexAttribPointer(shader->instanceRotationAtt(), 4, GL_FLOAT, GL_FALSE, stride,
+                              (void *)(4 * sizeof(GLfloat)));
+        extraFuncs->glVertexAttribDivisor(shader->instanceRotationAtt(), 1);
+    }
+    if (shader->instanceIndexAtt() >= 0) {
+        glEnableVertexAttribArray(shader->instanceIndexAtt());
+        glVertexAttribPointer(shader->instanceIndexAtt(), 1, GL_FLOAT, GL_FALSE, stride,
+                              (void *)(8 * sizeof(GLfloat)));
+        extraFuncs->glVertexAttribDivisor(shader->instanceIndexAtt(), 1);
+    }
+
+    drawInstances(shader, object, instances->instanceCount(), textureId, depthTextureId);
+
+    if (shader->instanceIndexAtt() >= 0) {
+        extraFuncs->glVertexAttribDivisor(shader->instanceIndexAtt(), 0);
+        glDisableVertexAttribArray(shader->instanceIndexAtt());
+    }
+    if (shader->instanceRotationAtt() >= 0) {
+        extraFuncs->glVertexAttribDivisor(shader->instanceRotationAtt(), 0);
+        glDisableVertexAttribArray(shader->instanceRotationAtt());
+    }
+    extraFuncs->glVertexAttribDivisor(shader->instanceAtt(), 0);
+    glDisableVertexAttribArray(shader->instanceAtt());
+}
+
+void Drawer::drawInstances(ShaderHelper *shader, AbstractObjectHelper *object, int instanceCount,
+                           GLuint textureId, GLuint depthTextureId)
+{
+    if (textureId) {
+        // Activate texture
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        shader->setUniformValue(shader->texture(), 0);
+    }
+
+    if (depthTextureId) {
+        // Activate depth texture
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, depthTextureId);
+        shader->setUniformValue(shader->shadow(), 1);
+    }
+
+    // 1st attribute buffer : vertices
+    glEnableVertexAttribArray(shader->posAtt());
+    glBindBuffer(GL_ARRAY_BUFFER, object->vertexBuf());
+    glVertexAttribPointer(shader->posAtt(), 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+
+    // 2nd attribute buffer : normals
+    if (shader->normalAtt() >= 0) {
+        glEnableVertexAttribArray(shader->normalAtt());
+        glBindBuffer(GL_ARRAY_BUFFER, object->normalBuf());
+        glVertexAttribPointer(shader->normalAtt(), 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+    }
+
+    // 3rd attribute buffer : UVs
+    if (shader->uvAtt() >= 0) {
+        glEnableVertexAttribArray(shader->uvAtt());
+        glBindBuffer(GL_ARRAY_BUFFER, object->uvBuf());
+        glVertexAttribPointer(shader->uvAtt(), 2, GL_FLOAT, GL_FALSE, 0, (void *)0);
+    }
+
+    // Index buffer
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->elementBuf());
+
+    // Draw the triangles of all instances
+    QOpenGLContext::currentContext()->extraFunctions()->glDrawElementsInstanced(
+                GL_TRIANGLES, object->indexCount(), GL_UNSIGNED_INT, (void *)0, instanceCount);
+
+    // Free buffers
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    if (shader->uvAtt() >= 0)
+        glDisableVertexAttribArray(shader->uvAtt());
+    if (shader->normalAtt() >= 0)
+        glDisableVertexAttribArray(shader->normalAtt());
+    glDisableVertexAttribArray(shader->posAtt());
+
+    // Release textures
+    if (depthTextureId) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    if (textureId) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}
+
+void Drawer::drawSurface(ShaderHelper *shader, SurfaceObject *object,
+                         const QMatrix4x4 &mvpMatrix, GLuint textureId, GLuint depthTextureId)
+{
+    // Only the tiles inside the view frustum are drawn
+    const QVector<QPair<int, int> > &indexRanges = object->visibleIndexRanges(mvpMatrix);
+    if (indexRanges.isEmpty())
+        return;
+
+    if (textureId) {
+        // Activate texture
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        shader->setUniformValue(shader->texture(), 0);
+    }
+
+    if (depthTextureId) {
+        // Activate depth texture
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, depthTextureId);
+        shader->setUniformValue(shader->shadow(), 1);
+    }
+
+    // 1st attribute buffer : vertices
+    glEnableVertexAttribArray(shader->posAtt());
+    glBindBuffer(GL_ARRAY_BUFFER, object->vertexBuf());
+    glVertexAttribPointer(shader->posAtt(), 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+    // 2nd attribute buffer : normals
+    if (shader->normalAtt() >= 0) {
+        glEnableVertexAttribArray(shader->normalAtt());
+        glBindBuffer(GL_ARRAY_BUFFER, object->normalBuf());
+        glVertexAttribPointer(shader->normalAtt(), 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    }
+
+    // 3rd attribute buffer : UVs
+    if (shader->uvAtt() >= 0) {
+        glEnableVertexAttribArray(shader->uvAtt());
+        glBindBuffer(GL_ARRAY_BUFFER, object->uvBuf());
+        glVertexAttribPointer(shader->uvAtt(), 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    }
+
+    // Index buffer
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->elementBuf());
+
+    // Draw the triangles
+    foreach (const QPair<int, int> &range, indexRanges) {
+        glDrawElements(GL_TRIANGLES, range.second, GL_UNSIGNED_INT,
+                       (void *)(range.first * sizeof(GLint)));
+    }
+
+    // Free buffers
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    if (shader->uvAtt() >= 0)
+        glDisableVertexAttribArray(shader->uvAtt());
+    if (shader->normalAtt() >= 0)
+        glDisableVertexAttribArray(shader->normalAtt());
+    glDisableVertexAttribArray(shader->posAtt());
+
+    // Release textures
+    if (depthTextureId) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    if (textureId) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+}
+
 void Drawer::drawSurfaceGrid(ShaderHelper *shader, SurfaceObject *object)
 {
     // 1st attribute buffer : vertices
@@ -434,21 +644,43 @@ void Drawer::generateLabelItem(LabelItem &item, const QString &text, int widestL
     item.clear();
 
     if (!text.isEmpty()) {
-        // Create labels
-        // Print label into a QImage using QPainter
-        QImage label = Utils::printTextToImage(m_theme->font(),
-                                               text,
-                                               m_theme->labelBackgroundColor(),
-                                               m_theme->labelTextColor(),
-                                               m_theme->isLabelBackgroundEnabled(),
-                                               m_theme->isLabelBorderEnabled(),
-                                               widestLabel);
+        // Labels with the same text and style share a texture, so only new strings need to
+        // be rasterized
+        const QString key = labelTextureKey(text, widestLabel);
+        QSize size;
+        GLuint textureId = m_labelTextureCache->acquire(key, size);
+        if (!textureId) {
+            // Create labels
+            // Print label into a QImage using QPainter
+            QImage label = Utils::printTextToImage(m_theme->font(),
+                                                   text,
+                                                   m_theme->labelBackgroundColor(),
+                                                   m_theme->labelTextColor(),
+                                                   m_theme->isLabelBackgroundEnabled(),
+                                                   m_theme->isLabelBorderEnabled(),
+                                                   widestLabel);
+            size = label.size();
+            textureId = m_textureHelper->create2DTexture(label, true, true);
+            m_labelTextureCache->insert(key, textureId, size);
+        }
 
         // Set label size
-        item.setSize(label.size());
-        // Insert text texture into label (also deletes the old texture)
-        item.setTextureId(m_textureHelper->create2DTexture(label, true, true));
+        item.setSize(size);
+        // Insert text texture into label
+        item.setSharedTexture(m_labelTextureCache, textureId);
     }
 }
 
+QString Drawer::labelTextureKey(const QString &text, int widestLabel) const
+{
+    // Everything that affects the label image
+    return QString::number(widestLabel) + QLatin1Char('|')
+            + m_theme->font().key() + QLatin1Char('|')
+            + QString::number(m_theme->labelBackgroundColor().rgba()) + QLatin1Char('|')
+            + QString::number(m_theme->labelTextColor().rgba()) + QLatin1Char('|')
+            + QString::number(int(m_theme->isLabelBackgroundEnabled())
+                              | int(m_theme->isLabelBorderEnabled()) << 1)
+            + QLatin1Char('|') + text;
+}
+
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -44,7 +44,9 @@
 #include "q3dbars.h"
 #include "q3dtheme.h"
 #include "labelitem_p.h"
+#include "labeltexturecache_p.h"
 #include "abstractrenderitem_p.h"
+#include <QtCore/QSharedPointer>
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
@@ -56,6 +58,8 @@ class TextureHelper;
 class Q3DCamera;
 class Abstract3DRenderer;
 class ScatterPointBufferHelper;
+class BarInstanceBufferHelper;
+class ScatterInstanceBufferHelper;
 
 class Drawer : public QObject, public QOpenGLFunctions
 {
@@ -88,6 +92,14 @@ public:
     void drawObject(ShaderHelper *shader, AbstractObjectHelper *object, GLuint textureId = 0,
                     GLuint depthTextureId = 0, GLuint textureId3D = 0);
     void drawSelectionObject(ShaderHelper *shader, AbstractObjectHelper *object);
+    void drawObjectInstanced(ShaderHelper *shader, AbstractObjectHelper *object,
+                             BarInstanceBufferHelper *instances, int firstInstance,
+                             int instanceCount, GLuint textureId = 0, GLuint depthTextureId = 0);
+    void drawObjectInstanced(ShaderHelper *shader, AbstractObjectHelper *object,
+                             ScatterInstanceBufferHelper *instances, GLuint textureId = 0,
+                             GLuint depthTextureId = 0);
+    void drawSurface(ShaderHelper *shader, SurfaceObject *object, const QMatrix4x4 &mvpMatrix,
+                     GLuint textureId = 0, GLuint depthTextureId = 0);
     void drawSurfaceGrid(ShaderHelper *shader, SurfaceObject *object);
     void drawPoint(ShaderHelper *shader);
     void drawPoints(ShaderHelper *shader, ScatterPointBufferHelper *object, GLuint textureId);
@@ -108,8 +120,13 @@ Q_SIGNALS:
     void drawerChanged();
 
 private:
+    QString labelTextureKey(const QString &text, int widestLabel) const;
+    void drawInstances(ShaderHelper *shader, AbstractObjectHelper *object, int instanceCount,
+                       GLuint textureId, GLuint depthTextureId);
+
     Q3DTheme *m_theme;
     TextureHelper *m_textureHelper;
+    QSharedPointer<LabelTextureCache> m_labelTextureCache;
     GLuint m_pointbuffer;
     GLuint m_linebuffer;
     GLfloat m_scaledFontSize;
@@ -40,11 +40,22 @@
 #include <QtGui/QOpenGLPaintDevice>
 #include <QtGui/QPainter>
 #include <QtGui/QOpenGLFramebufferObject>
+#include <QtGui/QOpenGLExtraFunctions>
 #include <QtGui/QOffscreenSurface>
 #if defined(Q_OS_OSX)
 #include <qpa/qplatformnativeinterface.h>
 #endif
 
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
 /*!
@@ -164,6 +175,16 @@ QT_BEGIN_NAMESPACE_DATAVISUALIZATION
            Provides the full feature set at a reasonable performance.
     \value OptimizationStatic
            Optimizes the rendering of static data sets at the expense of some features.
+    \value OptimizationInstanced
+           Draws all items of a series with a single instanced draw call per rendering pass.
+           Requires OpenGL 3.3 or OpenGL ES 3.0, otherwise the default rendering is used.
+           This value was added in Qt Data Visualization 5.13.
+    \value OptimizationAsyncSelection
+           Reads the item under a selection query back from the GPU without waiting for it.
+           The selection is resolved, and the selection signals are emitted, one frame later.
+           Requires buffer mapping support, such as OpenGL 3.0 or OpenGL ES 3.0, otherwise
+           the selection is read immediately.
+           This value was added in Qt Data Visualization 5.13.
 */
 
 /*!
@@ -612,6 +633,51 @@ QImage QAbstract3DGraph::renderToImage(int msaaSamples, const QSize &imageSize)
     return d_ptr->renderToImage(msaaSamples, renderSize);
 }
 
+/*!
+ * Renders current frame to an image of \a imageSize without waiting for the image to be read
+ * back from the GPU. Default size is the window size. Image is rendered with antialiasing level
+ * given in \a msaaSamples. Default level is \c{0}.
+ *
+ * The image is delivered later with the imageRendered() signal, at the latest when control
+ * returns to the event loop. Images are delivered in the order they were requested. This allows
+ * the rendering of the next image to overlap the read back of the previous one, which makes
+ * capturing a series of images considerably faster than calling renderToImage() repeatedly.
+ * The offscreen targets are reused between images of the same size, and the graph does not
+ * need to be shown, so a hidden graph can render a batch of images with, for example, different
+ * camera positions or data set between the calls.
+ *
+ * If the OpenGL context does not support pixel buffer objects, the image is read back
+ * immediately, but it is still delivered with the signal.
+ *
+ * \since QtDataVisualization 5.13
+ *
+ * \note OpenGL ES2 does not support antialiasing, so \a msaaSamples is always forced to \c{0}.
+ *
+ * \sa renderToImage(), imageRendered()
+ */
+void QAbstract3DGraph::renderToImageAsync(int msaaSamples, const QSize &imageSize)
+{
+    QSize renderSize = imageSize;
+    if (renderSize.isEmpty())
+        renderSize = size();
+    d_ptr->renderToImageAsync(msaaSamples, renderSize);
+}
+
+/*!
+ * \fn void QAbstract3DGraph::imageRendered(const QImage &image)
+ * \since QtDataVisualization 5.13
+ *
+ * This signal is emitted when an \a image requested with renderToImageAsync() is ready.
+ * The image is null if rendering it failed.
+ */
+
+/*!
+ * \fn void QAbstract3DGraph::frameRendered()
+ * \since QtDataVisualization 5.13
+ *
+ * This signal is emitted each time the graph has rendered a frame.
+ */
+
 /*!
  * \property QAbstract3DGraph::measureFps
  * \since QtDataVisualization 1.1
@@ -709,6 +775,18 @@ qreal QAbstract3DGraph::aspectRatio() const
  * large non-changing data sets. It is slower with dynamic data changes and item rotations.
  * Selection is not optimized, so using the static mode with massive data sets is not advisable.
  * Static optimization works only on scatter graphs.
+ * The instanced mode uploads the per-item transformations of a series into a single buffer
+ * and draws the whole series with one instanced draw call per rendering pass, which makes
+ * the item count nearly free on the CPU side. Highlighted and individually rotated bars
+ * are still drawn one by one, and so are all bars of a series whose base color or base
+ * gradient is not fully opaque, as the instances are not sorted by the camera. On scatter graphs, the item mesh is uploaded only once and
+ * item rotations and data changes update just the affected instances, while point meshes
+ * keep using the default or static drawing. Instanced optimization works on bar and
+ * scatter graphs. If both static and instanced modes are set, scatter item meshes are
+ * drawn instanced.
+ * The asynchronous selection mode can be combined with the other modes. It reads the
+ * selection back from the GPU without stalling rendering, and resolves the selection
+ * one frame later.
  * Defaults to \l{OptimizationDefault}.
  *
  * \note On some environments, large graphs using static optimization may not render, because
@@ -1042,6 +1120,11 @@ void QAbstract3DGraph::wheelEvent(QWheelEvent *event)
 }
 #endif
 
+// Number of images that can be read back in the background before waiting for the oldest one
+static const int maxPendingImageReadbacks = 2;
+// Number of offscreen targets kept for rendering images. Multisampled images need two.
+static const int maxImageFramebuffers = 3;
+
 QAbstract3DGraphPrivate::QAbstract3DGraphPrivate(QAbstract3DGraph *q)
     : QObject(0),
       q_ptr(q),
@@ -1049,7 +1132,8 @@ QAbstract3DGraphPrivate::QAbstract3DGraphPrivate(QAbstract3DGraph *q)
       m_visualController(0),
       m_devicePixelRatio(1.f),
       m_offscreenSurface(0),
-      m_initialized(false)
+      m_initialized(false),
+      m_readbackFinishQueued(false)
 {
 }
 
@@ -1059,9 +1143,19 @@ QAbstract3DGraphPrivate::~QAbstract3DGraphPrivate()
         m_offscreenSurface->destroy();
         delete m_offscreenSurface;
     }
-    if (m_context)
+    if (m_context) {
         m_context->makeCurrent(q_ptr);
 
+        releaseImageFramebuffers();
+
+        // Unfinished image readbacks are discarded
+        m_freeReadbacks << m_pendingReadbacks.toVector();
+        foreach (const ImageReadback &readback, m_freeReadbacks) {
+            if (readback.buffer)
+                m_context->functions()->glDeleteBuffers(1, &readback.buffer);
+        }
+    }
+
     delete m_visualController;
 }
 
@@ -1119,6 +1213,8 @@ void QAbstract3DGraphPrivate::setVisualController(Abstract3DController *controll
                      &QAbstract3DGraph::queriedGraphPositionChanged);
     QObject::connect(m_visualController, &Abstract3DController::marginChanged, q_ptr,
                      &QAbstract3DGraph::marginChanged);
+    QObject::connect(m_visualController, &Abstract3DController::frameRendered, q_ptr,
+                     &QAbstract3DGraph::frameRendered);
 }
 
 void QAbstract3DGraphPrivate::handleDevicePixelRatioChange()
@@ -1162,38 +1258,216 @@ void QAbstract3DGraphPrivate::renderNow()
 QImage QAbstract3DGraphPrivate::renderToImage(int msaaSamples, const QSize &imageSize)
 {
     QImage image;
-    QOpenGLFramebufferObject *fbo;
-    QOpenGLFramebufferObjectFormat fboFormat;
+    // Render the wanted frame offscreen
+    makeOffscreenCurrent();
+    QOpenGLFramebufferObject *fbo = imageFramebuffer(msaaSamples, imageSize);
+    if (fbo) {
+        renderToFramebuffer(fbo, imageSize);
+        image = fbo->toImage();
+        fbo->release();
+    }
+    m_context->makeCurrent(q_ptr);
+
+    return image;
+}
+
+void QAbstract3DGraphPrivate::renderToImageAsync(int msaaSamples, const QSize &imageSize)
+{
+    QImage finishedImage;
+    bool imageFinished = false;
+
+    makeOffscreenCurrent();
+
+    // Only wait for the oldest readback if there are too many of them in flight
+    if (m_pendingReadbacks.size() >= maxPendingImageReadbacks) {
+        finishedImage = finishImageReadback();
+        imageFinished = true;
+    }
+
+    QOpenGLFramebufferObject *fbo = imageFramebuffer(msaaSamples, imageSize);
+    if (fbo) {
+        renderToFramebuffer(fbo, imageSize);
+        startImageReadback(fbo, imageSize);
+        fbo->release();
+    } else {
+        // Failed images are delivered as null images to keep the images in order
+        ImageReadback readback = { 0, 0, imageSize, QImage() };
+        m_pendingReadbacks.append(readback);
+    }
+    m_context->makeCurrent(q_ptr);
+
+    if (!m_readbackFinishQueued) {
+        m_readbackFinishQueued = true;
+        QMetaObject::invokeMethod(this, "finishImageReadbacks", Qt::QueuedConnection);
+    }
+
+    if (imageFinished)
+        emit q_ptr->imageRendered(finishedImage);
+}
+
+void QAbstract3DGraphPrivate::finishImageReadbacks()
+{
+    m_readbackFinishQueued = false;
+    if (m_pendingReadbacks.isEmpty())
+        return;
+
+    QVector<QImage> images;
+    images.reserve(m_pendingReadbacks.size());
+    makeOffscreenCurrent();
+    while (!m_pendingReadbacks.isEmpty())
+        images.append(finishImageReadback());
+    m_context->makeCurrent(q_ptr);
+
+    foreach (const QImage &image, images)
+        emit q_ptr->imageRendered(image);
+}
+
+void QAbstract3DGraphPrivate::makeOffscreenCurrent()
+{
     if (!m_offscreenSurface) {
         // Create an offscreen surface for rendering to images without rendering on screen
         m_offscreenSurface = new QOffscreenSurface(q_ptr->screen());
         m_offscreenSurface->setFormat(q_ptr->requestedFormat());
         m_offscreenSurface->create();
     }
-    // Render the wanted frame offscreen
     m_context->makeCurrent(m_offscreenSurface);
+}
+
+// Returns an offscreen target for rendering images. The most recently used targets are kept,
+// so rendering a series of images doesn't allocate a new framebuffer for each image.
+QOpenGLFramebufferObject *QAbstract3DGraphPrivate::imageFramebuffer(int msaaSamples,
+                                                                    const QSize &imageSize)
+{
+    for (int i = 0; i < m_imageFramebuffers.size(); i++) {
+        const ImageFramebuffer target = m_imageFramebuffers.at(i);
+        if (target.samples == msaaSamples && target.fbo->size() == imageSize) {
+            m_imageFramebuffers.move(i, 0);
+            return target.fbo;
+        }
+    }
+
+    QOpenGLFramebufferObjectFormat fboFormat;
     fboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
     if (!Utils::isOpenGLES()) {
         fboFormat.setInternalTextureFormat(GL_RGB);
         fboFormat.setSamples(msaaSamples);
     }
-    fbo = new QOpenGLFramebufferObject(imageSize, fboFormat);
-    if (fbo->isValid()) {
-        QRect originalViewport = m_visualController->m_scene->viewport();
-        m_visualController->m_scene->d_ptr->setWindowSize(imageSize);
-        m_visualController->m_scene->d_ptr->setViewport(QRect(0, 0,
-                                                              imageSize.width(),
-                                                              imageSize.height()));
-        m_visualController->synchDataToRenderer();
+    ImageFramebuffer target = { new QOpenGLFramebufferObject(imageSize, fboFormat), msaaSamples };
+    if (!target.fbo->isValid()) {
+        delete target.fbo;
+        return 0;
+    }
+
+    if (m_imageFramebuffers.size() >= maxImageFramebuffers)
+        delete m_imageFramebuffers.takeLast().fbo;
+    m_imageFramebuffers.prepend(target);
+
+    return target.fbo;
+}
+
+void QAbstract3DGraphPrivate::releaseImageFramebuffers()
+{
+    foreach (const ImageFramebuffer &target, m_imageFramebuffers)
+        delete target.fbo;
+    m_imageFramebuffers.clear();
+}
+
+// Renders the current frame to the framebuffer, leaving it bound
+void QAbstract3DGraphPrivate::renderToFramebuffer(QOpenGLFramebufferObject *fbo,
+                                                  const QSize &imageSize)
+{
+    QRect originalViewport = m_visualController->m_scene->viewport();
+    m_visualController->m_scene->d_ptr->setWindowSize(imageSize);
+    m_visualController->m_scene->d_ptr->setViewport(QRect(0, 0,
+                                                          imageSize.width(),
+                                                          imageSize.height()));
+    m_visualController->synchDataToRenderer();
+    fbo->bind();
+    m_visualController->requestRender(fbo);
+    m_visualController->m_scene->d_ptr->setWindowSize(originalViewport.size());
+    m_visualController->m_scene->d_ptr->setViewport(originalViewport);
+}
+
+// Starts copying the pixels of the bound framebuffer to a pixel buffer. The copy is done by
+// the GPU in the background, so it doesn't have to finish before the next frame is rendered.
+void QAbstract3DGraphPrivate::startImageReadback(QOpenGLFramebufferObject *fbo,
+                                                 const QSize &imageSize)
+{
+    ImageReadback readback = { 0, 0, imageSize, QImage() };
+    if (!m_freeReadbacks.isEmpty()) {
+        readback.buffer = m_freeReadbacks.last().buffer;
+        readback.bufferSize = m_freeReadbacks.last().bufferSize;
+        m_freeReadbacks.removeLast();
+    }
+
+    if (!Utils::isBufferMappingSupported()) {
+        readback.image = fbo->toImage();
+        m_pendingReadbacks.append(readback);
+        return;
+    }
+
+    // Multisampled framebuffers can't be read directly, so they are resolved first
+    QOpenGLFramebufferObject *resolvedFbo = 0;
+    if (fbo->format().samples() > 0) {
+        resolvedFbo = imageFramebuffer(0, imageSize);
+        if (resolvedFbo) {
+            QOpenGLFramebufferObject::blitFramebuffer(resolvedFbo, fbo);
+            resolvedFbo->bind();
+        }
+    }
+
+    QOpenGLFunctions *funcs = m_context->functions();
+    const int dataSize = imageSize.width() * imageSize.height() * 4;
+    if (!readback.buffer)
+        funcs->glGenBuffers(1, &readback.buffer);
+    funcs->glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    if (readback.bufferSize != dataSize) {
+        funcs->glBufferData(GL_PIXEL_PACK_BUFFER, dataSize, 0, GL_STREAM_READ);
+        readback.bufferSize = dataSize;
+    }
+    funcs->glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    funcs->glReadPixels(0, 0, imageSize.width(), imageSize.height(), GL_RGBA, GL_UNSIGNED_BYTE,
+                        0);
+    funcs->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (resolvedFbo)
         fbo->bind();
-        m_visualController->requestRender(fbo);
-        image = fbo->toImage();
-        fbo->release();
-        m_visualController->m_scene->d_ptr->setWindowSize(originalViewport.size());
-        m_visualController->m_scene->d_ptr->setViewport(originalViewport);
+
+    m_pendingReadbacks.append(readback);
+}
+
+// Converts the oldest pending readback to an image. Waits for the GPU if the copy is not ready.
+QImage QAbstract3DGraphPrivate::finishImageReadback()
+{
+    ImageReadback readback = m_pendingReadbacks.takeFirst();
+    QImage image = readback.image;
+    readback.image = QImage();
+
+    if (readback.buffer) {
+        QOpenGLExtraFunctions *extraFuncs = m_context->extraFunctions();
+        extraFuncs->glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        const uchar *data = static_cast<const uchar *>(
+                    extraFuncs->glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback.bufferSize,
+                                                 GL_MAP_READ_BIT));
+        if (data) {
+            const int width = readback.imageSize.width();
+            const int height = readback.imageSize.height();
+            const int bytesPerLine = width * 4;
+            image = QImage(readback.imageSize, Utils::isOpenGLES()
+                           ? QImage::Format_RGBA8888_Premultiplied
+                           : QImage::Format_RGBX8888);
+            // OpenGL rows are bottom up
+            for (int row = 0; row < height; row++) {
+                memcpy(image.scanLine(row), data + (height - row - 1) * bytesPerLine,
+                       bytesPerLine);
+            }
+            extraFuncs->glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        extraFuncs->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
     }
-    delete fbo;
-    m_context->makeCurrent(q_ptr);
+
+    if (readback.buffer)
+        m_freeReadbacks.append(readback);
 
     return image;
 }
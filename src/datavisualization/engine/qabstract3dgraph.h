@@ -110,8 +110,10 @@ public:
     };
 
     enum OptimizationHint {
-        OptimizationDefault = 0,
-        OptimizationStatic  = 1
+        OptimizationDefault   = 0,
+        OptimizationStatic    = 1,
+        OptimizationInstanced = 2,
+        OptimizationAsyncSelection = 4
     };
     Q_DECLARE_FLAGS(OptimizationHints, OptimizationHint)
 
@@ -155,6 +157,7 @@ public:
     QCustom3DItem *selectedCustomItem() const;
 
     QImage renderToImage(int msaaSamples = 0, const QSize &imageSize = QSize());
+    void renderToImageAsync(int msaaSamples = 0, const QSize &imageSize = QSize());
 
     void setMeasureFps(bool enable);
     bool measureFps() const;
@@ -229,6 +232,8 @@ Q_SIGNALS:
     void localeChanged(const QLocale &locale);
     void queriedGraphPositionChanged(const QVector3D &data);
     void marginChanged(qreal margin);
+    void imageRendered(const QImage &image);
+    void frameRendered();
 
 private:
     Q_DISABLE_COPY(QAbstract3DGraph)
@@ -41,10 +41,12 @@
 #define QABSTRACT3DGRAPH_P_H
 
 #include "datavisualizationglobal_p.h"
+#include <QtGui/QImage>
 
 QT_BEGIN_NAMESPACE
 class QOpenGLContext;
 class QOffscreenSurface;
+class QOpenGLFramebufferObject;
 QT_END_NAMESPACE
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
@@ -66,15 +68,37 @@ public:
     void render();
 
     QImage renderToImage(int msaaSamples, const QSize &imageSize);
+    void renderToImageAsync(int msaaSamples, const QSize &imageSize);
 
 public Q_SLOTS:
     void renderLater();
     void renderNow();
+    void finishImageReadbacks();
 
     virtual void handleAxisXChanged(QAbstract3DAxis *axis) = 0;
     virtual void handleAxisYChanged(QAbstract3DAxis *axis) = 0;
     virtual void handleAxisZChanged(QAbstract3DAxis *axis) = 0;
 
+private:
+    struct ImageFramebuffer {
+        QOpenGLFramebufferObject *fbo;
+        int samples;
+    };
+
+    struct ImageReadback {
+        GLuint buffer;
+        int bufferSize;
+        QSize imageSize;
+        QImage image; // Used when pixel buffers are not supported
+    };
+
+    void makeOffscreenCurrent();
+    QOpenGLFramebufferObject *imageFramebuffer(int msaaSamples, const QSize &imageSize);
+    void releaseImageFramebuffers();
+    void renderToFramebuffer(QOpenGLFramebufferObject *fbo, const QSize &imageSize);
+    void startImageReadback(QOpenGLFramebufferObject *fbo, const QSize &imageSize);
+    QImage finishImageReadback();
+
 public:
     QAbstract3DGraph *q_ptr;
 
@@ -84,6 +108,10 @@ public:
     float m_devicePixelRatio;
     QOffscreenSurface *m_offscreenSurface;
     bool m_initialized;
+    QList<ImageFramebuffer> m_imageFramebuffers;
+    QList<ImageReadback> m_pendingReadbacks;
+    QVector<ImageReadback> m_freeReadbacks;
+    bool m_readbackFinishQueued;
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -35,6 +35,9 @@
 #include "scatterseriesrendercache_p.h"
 #include "scatterobjectbufferhelper_p.h"
 #include "scatterpointbufferhelper_p.h"
+#include "scatterinstancebufferhelper_p.h"
+#include "qscatterdataproxy_p.h"
+#include "qscatter3dseries_p.h"
 
 #include <QtCore/qmath.h>
 
@@ -61,6 +64,11 @@ Scatter3DRenderer::Scatter3DRenderer(Scatter3DController *controller)
       m_selectionShader(0),
       m_backgroundShader(0),
       m_staticGradientPointShader(0),
+      m_dotInstancedShader(0),
+      m_dotGradientInstancedShader(0),
+      m_depthInstancedShader(0),
+      m_selectionInstancedShader(0),
+      m_useInstancing(false),
       m_bgrTexture(0),
       m_selectionTexture(0),
       m_depthFrameBuffer(0),
@@ -104,6 +112,10 @@ Scatter3DRenderer::~Scatter3DRenderer()
     delete m_selectionShader;
     delete m_backgroundShader;
     delete m_staticGradientPointShader;
+    delete m_dotInstancedShader;
+    delete m_dotGradientInstancedShader;
+    delete m_depthInstancedShader;
+    delete m_selectionInstancedShader;
 }
 
 void Scatter3DRenderer::initializeOpenGL()
@@ -189,20 +201,33 @@ void Scatter3DRenderer::updateData()
         if (cache->isVisible()) {
             const QScatter3DSeries *currentSeries = cache->series();
             ScatterRenderItemArray &renderArray = cache->renderArray();
-            QScatterDataProxy *dataProxy = currentSeries->dataProxy();
-            const QScatterDataArray &dataArray = *dataProxy->array();
-            int dataSize = dataArray.size();
+            // Items are read through the proxy, as the data may be in caller-owned arrays
+            const QScatterDataProxyPrivate *dataProxy = dataProxyPrivate(currentSeries);
+            int dataSize = dataProxy->itemCount();
             totalDataSize += dataSize;
             if (cache->dataDirty()) {
-                if (dataSize != renderArray.size())
-                    renderArray.resize(dataSize);
+                if (dataProxy->hasExternalData()
+                        && m_cachedOptimizationHint.testFlag(QAbstract3DGraph::OptimizationStatic)
+                        && cache->mesh() == QAbstract3DSeries::MeshPoint) {
+                    // Static points of caller-owned data are buffered straight from the proxy,
+                    // so that no render item needs to be kept for each point
+                    cache->setExternalPoints(dataProxy, dataSize);
+                } else {
+                    cache->setExternalPoints(0, 0);
+                    if (dataSize != renderArray.size())
+                        renderArray.resize(dataSize);
 
-                for (int i = 0; i < dataSize; i++)
-                    updateRenderItem(dataArray.at(i), renderArray[i]);
+                    for (int i = 0; i < dataSize; i++) {
+                        updateRenderItem(dataProxy->itemPosition(i), dataProxy->itemRotation(i),
+                                         renderArray[i]);
+                    }
+                }
 
                 if (m_cachedOptimizationHint.testFlag(QAbstract3DGraph::OptimizationStatic))
                     cache->setStaticBufferDirty(true);
 
+                cache->setInstanceDataDirty(true);
+                cache->setPickIndexDirty(true);
                 cache->setDataDirty(false);
             }
         }
@@ -229,7 +254,14 @@ void Scatter3DRenderer::updateData()
                     }
                     points->setScaleY(m_scaleY);
                     points->load(cache);
-                } else {
+                    if (cache->hasExternalPoints()) {
+                        // External data can't be read while rendering, so the pick index,
+                        // which also draws the points to the selection buffer, is built here
+                        cache->pickIndex().build(cache);
+                        cache->setPickIndexDirty(false);
+                    }
+                } else if (!m_useInstancing) {
+                    // Instanced drawing replaces the static buffers of mesh series
                     ScatterObjectBufferHelper *object = cache->bufferObject();
                     if (!object) {
                         object = new ScatterObjectBufferHelper();
@@ -309,6 +341,9 @@ void Scatter3DRenderer::updateSeries(const QList<QAbstract3DSeries *> &seriesLis
             if (cache->mesh() == QAbstract3DSeries::MeshPoint) {
                 m_havePointSeries = true;
             } else {
+                // Meshes are drawn from render items, which external points don't have
+                if (cache->hasExternalPoints())
+                    cache->setDataDirty(true);
                 m_haveMeshSeries = true;
                 if (cache->colorStyle() == Q3DTheme::ColorStyleUniform)
                     m_haveUniformColorMeshSeries = true;
@@ -317,7 +352,7 @@ void Scatter3DRenderer::updateSeries(const QList<QAbstract3DSeries *> &seriesLis
             }
 
             if (cache->staticBufferDirty()) {
-                if (cache->mesh() != QAbstract3DSeries::MeshPoint) {
+                if (cache->mesh() != QAbstract3DSeries::MeshPoint && cache->bufferObject()) {
                     ScatterObjectBufferHelper *object = cache->bufferObject();
                     object->update(cache, m_dotSizeScale);
                 }
@@ -327,7 +362,7 @@ void Scatter3DRenderer::updateSeries(const QList<QAbstract3DSeries *> &seriesLis
                 if (cache->mesh() == QAbstract3DSeries::MeshPoint) {
                     ScatterPointBufferHelper *object = cache->bufferPoints();
                     object->updateUVs(cache);
-                } else {
+                } else if (cache->bufferObject()) {
                     ScatterObjectBufferHelper *object = cache->bufferObject();
                     object->updateUVs(cache);
                 }
@@ -354,16 +389,20 @@ void Scatter3DRenderer::updateItems(const QVector<Scatter3DController::ChangeIte
 {
     ScatterSeriesRenderCache *cache = 0;
     const QScatter3DSeries *prevSeries = 0;
-    const QScatterDataArray *dataArray = 0;
+    const QScatterDataProxyPrivate *dataProxy = 0;
     const bool optimizationStatic = m_cachedOptimizationHint.testFlag(
                 QAbstract3DGraph::OptimizationStatic);
+    bool trackIndices = false;
 
     foreach (Scatter3DController::ChangeItem item, items) {
         QScatter3DSeries *currentSeries = item.series;
         if (currentSeries != prevSeries) {
             cache = static_cast<ScatterSeriesRenderCache *>(m_renderCacheList.value(currentSeries));
             prevSeries = currentSeries;
-            dataArray = item.series->dataProxy()->array();
+            dataProxy = dataProxyPrivate(item.series);
+            // Changed items are collected for partial buffer updates
+            trackIndices = optimizationStatic
+                    || (m_useInstancing && cache->mesh() != QAbstract3DSeries::MeshPoint);
             // Invisible series render caches are not updated, but instead just marked dirty, so that
             // they can be completely recalculated when they are turned visible.
             if (!cache->isVisible() && !cache->dataDirty())
@@ -371,25 +410,37 @@ void Scatter3DRenderer::updateItems(const QVector<Scatter3DController::ChangeIte
         }
         if (cache->isVisible()) {
             const int index = item.index;
-            if (index >= cache->renderArray().size())
+            if (index >= cache->itemCount())
                 continue; // Items removed from array for same render
+            if (cache->hasExternalPoints()) {
+                // External points are read from the proxy when the buffer is updated
+                cache->setPickIndexDirty(true);
+                cache->updateIndices().append(index);
+                continue;
+            }
             bool oldVisibility;
             ScatterRenderItem &item = cache->renderArray()[index];
-            if (optimizationStatic)
+            if (trackIndices)
                 oldVisibility = item.isVisible();
-            updateRenderItem(dataArray->at(index), item);
-            if (optimizationStatic) {
+            updateRenderItem(dataProxy->itemPosition(index), dataProxy->itemRotation(index),
+                             item);
+            cache->setPickIndexDirty(true);
+            if (trackIndices) {
                 if (!cache->visibilityChanged() && oldVisibility != item.isVisible())
                     cache->setVisibilityChanged(true);
                 cache->updateIndices().append(index);
             }
         }
     }
-    if (optimizationStatic) {
+    if (optimizationStatic || m_useInstancing) {
         foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
             ScatterSeriesRenderCache *cache = static_cast<ScatterSeriesRenderCache *>(baseCache);
             if (cache->isVisible() && cache->updateIndices().size()) {
-                if (cache->mesh() == QAbstract3DSeries::MeshPoint) {
+                if (m_useInstancing && cache->mesh() != QAbstract3DSeries::MeshPoint) {
+                    // Hidden items keep their instance, so visibility changes need no reload
+                    if (cache->instanceBuffer() && !cache->instanceDataDirty())
+                        cache->instanceBuffer()->update(cache);
+                } else if (cache->mesh() == QAbstract3DSeries::MeshPoint) {
                     cache->bufferPoints()->update(cache);
                     if (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient)
                         cache->bufferPoints()->updateUVs(cache);
@@ -408,6 +459,13 @@ void Scatter3DRenderer::updateItems(const QVector<Scatter3DController::ChangeIte
                 cache->updateIndices().clear();
             }
             cache->setVisibilityChanged(false);
+            if (cache->isVisible() && cache->hasExternalPoints() && cache->pickIndexDirty()) {
+                cache->pickIndex().build(cache);
+                cache->setPickIndexDirty(false);
+                // Update the hidden point and the highlighted item of the selection
+                if (cache == m_selectedSeriesCache)
+                    updateSelectedItem(m_selectedItemIndex, cache->series());
+            }
         }
     }
 }
@@ -443,6 +501,10 @@ void Scatter3DRenderer::updateOptimizationHint(QAbstract3DGraph::OptimizationHin
 {
     Abstract3DRenderer::updateOptimizationHint(hint);
 
+    m_useInstancing = hint.testFlag(QAbstract3DGraph::OptimizationInstanced)
+            && Utils::isInstancingSupported();
+    invalidateInstanceData();
+
     Abstract3DRenderer::reInitShaders();
 
     if (m_isOpenGLES && hint.testFlag(QAbstract3DGraph::OptimizationStatic)
@@ -605,6 +667,27 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     }
                     QVector3D modelScaler(itemSize, itemSize, itemSize);
 
+                    if (!drawingPoints && useInstancing(cache)) {
+                        ScatterInstanceBufferHelper *instances = cache->instanceBuffer();
+                        if (m_depthInstancedShader && instances->instanceCount()) {
+                            QMatrix4x4 rotationMatrix;
+                            if (!seriesRotation.isIdentity())
+                                rotationMatrix.rotate(seriesRotation);
+                            m_depthInstancedShader->bind();
+                            m_depthInstancedShader->setUniformValue(
+                                        m_depthInstancedShader->MVP(), depthProjectionViewMatrix);
+                            m_depthInstancedShader->setUniformValue(
+                                        m_depthInstancedShader->model(), rotationMatrix);
+                            m_depthInstancedShader->setUniformValue(
+                                        m_depthInstancedShader->instanceScale(),
+                                        QVector4D(modelScaler, m_scaleY));
+                            m_drawer->drawObjectInstanced(m_depthInstancedShader, dotObj,
+                                                          instances);
+                            m_depthShader->bind();
+                        }
+                        continue;
+                    }
+
                     if (!optimizationDefault
                             && ((drawingPoints && cache->bufferPoints()->indexCount() == 0)
                                 || (!drawingPoints && cache->bufferObject()->indexCount() == 0))) {
@@ -615,14 +698,13 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     if (optimizationDefault)
                         loopCount = renderArraySize;
                     for (int dot = 0; dot < loopCount; dot++) {
-                        const ScatterRenderItem &item = renderArray.at(dot);
-                        if (!item.isVisible() && optimizationDefault)
-                            continue;
-
                         QMatrix4x4 modelMatrix;
                         QMatrix4x4 MVPMatrix;
 
                         if (optimizationDefault) {
+                            const ScatterRenderItem &item = renderArray.at(dot);
+                            if (!item.isVisible())
+                                continue;
                             modelMatrix.translate(item.translation());
                             if (!drawingPoints) {
                                 if (!seriesRotation.isIdentity() || !item.rotation().isIdentity())
@@ -714,12 +796,26 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
     // Do position mapping when necessary
     if (m_graphPositionQueryPending) {
         QVector3D graphDimensions(m_scaleX, m_scaleY, m_scaleZ);
-        queriedGraphPosition(projectionViewMatrix, graphDimensions, defaultFboHandle);
+        queriedGraphPosition(projectionViewMatrix, graphDimensions);
         emit needRender();
     }
 
+    // A selection read back asynchronously on the previous frame doesn't need another pass
+    QVector4D clickedColor;
+    bool selectionRead = takeSelectionReadback(clickedColor);
+
+    // Items are picked on the CPU when possible. The selection buffer is only drawn if no item
+    // is hit, as labels and custom items can only be picked from it.
+    bool itemPicked = false;
+    if (!selectionRead && m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
+            && SelectOnScene == m_selectionState
+            && m_visibleSeriesCount > 0 && m_customRenderCache.isEmpty()) {
+        itemPicked = pickItem(projectionMatrix, projectionViewMatrix);
+    }
+
     // Skip selection mode drawing if we have no selection mode
-    if (m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
+    if (!selectionRead && !itemPicked
+            && m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
             && SelectOnScene == m_selectionState
             && (m_visibleSeriesCount > 0 || !m_customRenderCache.isEmpty())
             && m_selectionTexture) {
@@ -765,6 +861,51 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                     selectionShader->bind();
                 }
                 cache->setSelectionIndexOffset(totalIndex);
+                if (!drawingPoints && useInstancing(cache)) {
+                    ScatterInstanceBufferHelper *instances = cache->instanceBuffer();
+                    if (m_selectionInstancedShader && instances->instanceCount()) {
+                        // Selection colors are calculated from the instance indexes in the shader
+                        QMatrix4x4 rotationMatrix;
+                        if (!seriesRotation.isIdentity())
+                            rotationMatrix.rotate(seriesRotation);
+                        m_selectionInstancedShader->bind();
+                        m_selectionInstancedShader->setUniformValue(
+                                    m_selectionInstancedShader->MVP(), projectionViewMatrix);
+                        m_selectionInstancedShader->setUniformValue(
+                                    m_selectionInstancedShader->model(), rotationMatrix);
+                        m_selectionInstancedShader->setUniformValue(
+                                    m_selectionInstancedShader->instanceScale(),
+                                    QVector4D(modelScaler, m_scaleY));
+                        m_selectionInstancedShader->setUniformValue(
+                                    m_selectionInstancedShader->instanceIndexOffset(),
+                                    GLfloat(totalIndex));
+                        m_drawer->drawObjectInstanced(m_selectionInstancedShader, dotObj,
+                                                      instances);
+                        selectionShader->bind();
+                    }
+                    totalIndex += renderArraySize;
+                    continue;
+                }
+                if (cache->hasExternalPoints()) {
+                    // External points have no render items, the visible ones are in the pick index
+                    const ScatterPickIndex &pickIndex = cache->pickIndex();
+                    const int entryCount = pickIndex.entryCount();
+                    for (int entry = 0; entry < entryCount; entry++) {
+                        QMatrix4x4 modelMatrix;
+                        modelMatrix.translate(pickIndex.entryPosition(entry));
+                        QMatrix4x4 MVPMatrix = projectionViewMatrix * modelMatrix;
+
+                        const int dotIndex = totalIndex + pickIndex.entryItemIndex(entry);
+                        QVector4D dotColor = indexToSelectionColor(dotIndex);
+                        dotColor /= 255.0f;
+
+                        selectionShader->setUniformValue(selectionShader->MVP(), MVPMatrix);
+                        selectionShader->setUniformValue(selectionShader->color(), dotColor);
+                        m_drawer->drawPoint(selectionShader);
+                    }
+                    totalIndex += cache->itemCount();
+                    continue;
+                }
                 for (int dot = 0; dot < renderArraySize; dot++) {
                     const ScatterRenderItem &item = renderArray.at(dot);
                     if (!item.isVisible()) {
@@ -808,12 +949,7 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
         glEnable(GL_DITHER);
 
         // Read color under cursor
-        QVector4D clickedColor = Utils::getSelection(m_inputPosition,
-                                                     m_viewport.height());
-        selectionColorToSeriesAndIndex(clickedColor, m_clickedIndex, m_clickedSeries);
-        m_clickResolved = true;
-
-        emit needRender();
+        selectionRead = readSelectionColor(clickedColor);
 
         // Revert to original fbo and viewport
         glBindFramebuffer(GL_FRAMEBUFFER, defaultFboHandle);
@@ -823,6 +959,13 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
                    m_primarySubViewport.height());
     }
 
+    if (selectionRead) {
+        selectionColorToSeriesAndIndex(clickedColor, m_clickedIndex, m_clickedSeries);
+        m_clickResolved = true;
+
+        emit needRender();
+    }
+
     // Draw dots
     ShaderHelper *dotShader = 0;
     GLuint gradientTexture = 0;
@@ -888,8 +1031,9 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
             QVector3D modelScaler(itemSize, itemSize, itemSize);
             int gradientImageHeight = cache->gradientImage().height();
             int maxGradientPositition = gradientImageHeight - 1;
+            bool instanced = !drawingPoints && useInstancing(cache);
 
-            if (!optimizationDefault
+            if (!optimizationDefault && !instanced
                     && ((drawingPoints && cache->bufferPoints()->indexCount() == 0)
                         || (!drawingPoints && cache->bufferObject()->indexCount() == 0))) {
                 continue;
@@ -943,8 +1087,17 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
             if (optimizationDefault)
                 loopCount = renderArraySize;
 
+            if (instanced) {
+                drawInstancedItems(cache, depthProjectionViewMatrix, projectionViewMatrix,
+                                   viewMatrix);
+                dotShader->bind();
+                loopCount = 0;
+            }
+
             for (int i = 0; i < loopCount; i++) {
-                ScatterRenderItem &item = renderArray[i];
+                // Static external points have no render items, they are drawn from the buffer
+                ScatterRenderItem &item = cache->hasExternalPoints() ? m_dummyRenderItem
+                                                                     : renderArray[i];
                 if (!item.isVisible() && optimizationDefault)
                     continue;
 
@@ -1061,14 +1214,21 @@ void Scatter3DRenderer::drawScene(const GLuint defaultFboHandle)
             }
 
 
-            // Draw the selected item on static optimization
-            if (!optimizationDefault && selectedSeries
+            // Draw the selected item on static and instanced optimization
+            if ((!optimizationDefault || instanced) && selectedSeries
                     && m_selectedItemIndex != Scatter3DController::invalidSelectionIndex()) {
-                ScatterRenderItem &item = renderArray[m_selectedItemIndex];
+                ScatterRenderItem &item = cache->hasExternalPoints()
+                        ? cache->selectedItem() : renderArray[m_selectedItemIndex];
                 if (item.isVisible()) {
                     ShaderHelper *selectionShader;
                     if (drawingPoints) {
                         selectionShader = pointSelectionShader;
+                    } else if (optimizationDefault) {
+                        // Instanced items use the regular shaders for the highlighted item
+                        if (colorStyleIsUniform)
+                            selectionShader = m_dotShader;
+                        else
+                            selectionShader = m_dotGradientShader;
                     } else {
                         if (colorStyleIsUniform)
                             selectionShader = m_staticSelectedItemShader;
@@ -2159,13 +2319,19 @@ void Scatter3DRenderer::updateSelectedItem(int index, QScatter3DSeries *series)
     }
 
     if (m_selectedSeriesCache) {
-        const ScatterRenderItemArray &renderArray = m_selectedSeriesCache->renderArray();
-        if (index < renderArray.size() && index >= 0) {
+        if (index < m_selectedSeriesCache->itemCount() && index >= 0) {
             m_selectedItemIndex = index;
 
+            if (m_selectedSeriesCache->hasExternalPoints()) {
+                const QScatterDataProxyPrivate *dataProxy = dataProxyPrivate(series);
+                updateRenderItem(dataProxy->itemPosition(index), dataProxy->itemRotation(index),
+                                 m_selectedSeriesCache->selectedItem());
+            }
+
             if (m_cachedOptimizationHint.testFlag(QAbstract3DGraph::OptimizationStatic)
                     && m_selectedSeriesCache->mesh() == QAbstract3DSeries::MeshPoint) {
-                m_selectedSeriesCache->bufferPoints()->pushPoint(m_selectedItemIndex);
+                m_selectedSeriesCache->bufferPoints()->pushPoint(m_selectedSeriesCache,
+                                                                  m_selectedItemIndex);
                 m_oldSelectedSeriesCache = m_selectedSeriesCache;
             }
         }
@@ -2323,6 +2489,8 @@ void Scatter3DRenderer::initShaders(const QString &vertexShader, const QString &
     delete m_dotShader;
     m_dotShader = new ShaderHelper(this, vertexShader, fragmentShader);
     m_dotShader->initialize();
+
+    initInstancedShaders();
 }
 
 void Scatter3DRenderer::initGradientShaders(const QString &vertexShader,
@@ -2427,6 +2595,199 @@ void Scatter3DRenderer::initStaticPointShaders(const QString &vertexShader,
     m_staticGradientPointShader->initialize();
 }
 
+void Scatter3DRenderer::initInstancedShaders()
+{
+    if (!m_useInstancing)
+        return;
+
+    // Instanced vertex shaders produce the same outputs as the regular ones
+    QString vertexShader;
+    QString fragmentShader;
+    QString gradientFragmentShader;
+    if (m_isOpenGLES) {
+        vertexShader = QStringLiteral(":/shaders/vertexScatterInstanced");
+        fragmentShader = QStringLiteral(":/shaders/fragmentES2");
+        gradientFragmentShader = QStringLiteral(":/shaders/fragmentColorOnYES2");
+    } else if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone) {
+        vertexShader = QStringLiteral(":/shaders/vertexScatterShadowInstanced");
+        fragmentShader = QStringLiteral(":/shaders/fragmentShadowNoTex");
+        gradientFragmentShader = QStringLiteral(":/shaders/fragmentShadowNoTexColorOnY");
+    } else {
+        vertexShader = QStringLiteral(":/shaders/vertexScatterInstanced");
+        fragmentShader = QStringLiteral(":/shaders/fragment");
+        gradientFragmentShader = QStringLiteral(":/shaders/fragmentColorOnY");
+    }
+
+    delete m_dotInstancedShader;
+    m_dotInstancedShader = new ShaderHelper(this, vertexShader, fragmentShader);
+    m_dotInstancedShader->initialize();
+
+    delete m_dotGradientInstancedShader;
+    m_dotGradientInstancedShader = new ShaderHelper(this, vertexShader, gradientFragmentShader);
+    m_dotGradientInstancedShader->initialize();
+
+    delete m_selectionInstancedShader;
+    m_selectionInstancedShader =
+            new ShaderHelper(this, QStringLiteral(":/shaders/vertexScatterPlainColorInstanced"),
+                             QStringLiteral(":/shaders/fragmentPlainColorInstanced"));
+    m_selectionInstancedShader->initialize();
+
+    if (!m_isOpenGLES) {
+        delete m_depthInstancedShader;
+        m_depthInstancedShader =
+                new ShaderHelper(this, QStringLiteral(":/shaders/vertexScatterDepthInstanced"),
+                                 QStringLiteral(":/shaders/fragmentDepth"));
+        m_depthInstancedShader->initialize();
+    }
+}
+
+bool Scatter3DRenderer::useInstancing(ScatterSeriesRenderCache *cache)
+{
+    if (!m_useInstancing || !m_dotInstancedShader || !m_dotGradientInstancedShader
+            || cache->mesh() == QAbstract3DSeries::MeshPoint) {
+        return false;
+    }
+
+    if (!cache->instanceBuffer()) {
+        cache->setInstanceBuffer(new ScatterInstanceBufferHelper());
+        cache->setInstanceDataDirty(true);
+    }
+
+    if (cache->instanceDataDirty()) {
+        cache->instanceBuffer()->load(cache);
+        cache->setInstanceDataDirty(false);
+    }
+
+    return true;
+}
+
+void Scatter3DRenderer::invalidateInstanceData()
+{
+    foreach (SeriesRenderCache *baseCache, m_renderCacheList)
+        static_cast<ScatterSeriesRenderCache *>(baseCache)->setInstanceDataDirty(true);
+}
+
+void Scatter3DRenderer::drawInstancedItems(ScatterSeriesRenderCache *cache,
+                                           const QMatrix4x4 &depthProjectionViewMatrix,
+                                           const QMatrix4x4 &projectionViewMatrix,
+                                           const QMatrix4x4 &viewMatrix)
+{
+    ScatterInstanceBufferHelper *instances = cache->instanceBuffer();
+    if (!instances->instanceCount())
+        return;
+
+    bool colorStyleIsUniform = (cache->colorStyle() == Q3DTheme::ColorStyleUniform);
+    ShaderHelper *shader = colorStyleIsUniform ? m_dotInstancedShader
+                                               : m_dotGradientInstancedShader;
+    float itemSize = cache->itemSize() / itemScaler;
+    if (itemSize == 0.0f)
+        itemSize = m_dotSizeScale;
+    // Series rotation is applied on top of the item rotations in the shader
+    QMatrix4x4 rotationMatrix;
+    if (!cache->meshRotation().isIdentity())
+        rotationMatrix.rotate(cache->meshRotation());
+    GLuint gradientTexture = 0;
+
+    shader->bind();
+    shader->setUniformValue(shader->lightP(), m_cachedScene->activeLight()->position());
+    shader->setUniformValue(shader->view(), viewMatrix);
+    shader->setUniformValue(shader->ambientS(), m_cachedTheme->ambientLightStrength());
+    shader->setUniformValue(shader->lightColor(),
+                            Utils::vectorFromColor(m_cachedTheme->lightColor()));
+    shader->setUniformValue(shader->model(), rotationMatrix);
+#ifdef SHOW_DEPTH_TEXTURE_SCENE
+    shader->setUniformValue(shader->MVP(), depthProjectionViewMatrix);
+#else
+    shader->setUniformValue(shader->MVP(), projectionViewMatrix);
+#endif
+    shader->setUniformValue(shader->instanceScale(),
+                            QVector4D(itemSize, itemSize, itemSize, m_scaleY));
+    if (colorStyleIsUniform) {
+        shader->setUniformValue(shader->color(), cache->baseColor());
+    } else {
+        gradientTexture = cache->baseGradientTexture();
+        shader->setUniformValue(shader->gradientMin(), 0.0f);
+        shader->setUniformValue(shader->gradientHeight(), 0.5f);
+        // Range gradient coordinates come from the item Y-coordinate per instance in the shader
+        if (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient)
+            shader->setUniformValue(shader->instanceGradient(), 1.0f);
+        else
+            shader->setUniformValue(shader->instanceGradient(), 0.0f);
+    }
+
+    GLuint depthTexture = 0;
+    if (m_cachedShadowQuality > QAbstract3DGraph::ShadowQualityNone && !m_isOpenGLES) {
+        // Set shadow shader bindings
+        shader->setUniformValue(shader->shadowQ(), m_shadowQualityToShader);
+        shader->setUniformValue(shader->depth(), depthProjectionViewMatrix);
+        shader->setUniformValue(shader->lightS(), m_cachedTheme->lightStrength() / 10.0f);
+        depthTexture = m_depthTexture;
+    } else {
+        shader->setUniformValue(shader->lightS(), m_cachedTheme->lightStrength());
+    }
+
+    m_drawer->drawObjectInstanced(shader, cache->object(), instances, gradientTexture,
+                                  depthTexture);
+}
+
+bool Scatter3DRenderer::pickItem(const QMatrix4x4 &projectionMatrix,
+                                 const QMatrix4x4 &projectionViewMatrix)
+{
+    const QSizeF viewportSize(m_primarySubViewport.size());
+    // Same pixel as the one read from the selection buffer
+    const QPointF position(m_inputPosition.x(), m_viewport.height() - m_inputPosition.y());
+    // Pixels per scene unit at w = 1
+    const float pixelScale = projectionMatrix(1, 1) * float(viewportSize.height()) / 2.0f;
+    const float zoomLevel = m_cachedScene->activeCamera()->zoomLevel();
+
+    int pickedIndex = -1;
+    float pickedDepth = 0.0f;
+    ScatterSeriesRenderCache *pickedCache = 0;
+    foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
+        if (!baseCache->isVisible())
+            continue;
+        ScatterSeriesRenderCache *cache = static_cast<ScatterSeriesRenderCache *>(baseCache);
+        if (cache->pickIndexDirty() && !cache->hasExternalPoints()) {
+            cache->pickIndex().build(cache);
+            cache->setPickIndexDirty(false);
+        }
+
+        float itemSize = cache->itemSize() / itemScaler;
+        if (itemSize == 0.0f)
+            itemSize = m_dotSizeScale;
+        float worldRadius = itemSize;
+        float pixelRadius = 0.0f;
+        if (cache->mesh() == QAbstract3DSeries::MeshPoint) {
+            // Points have a fixed size in pixels
+            worldRadius = 0.0f;
+            pixelRadius = m_isOpenGLES ? 2.5f : qMax(itemSize * zoomLevel / 2.0f, 0.5f);
+        }
+
+        float depth = 0.0f;
+        int index = cache->pickIndex().pick(projectionViewMatrix, viewportSize, position,
+                                            pixelScale, worldRadius, pixelRadius, depth);
+        if (index >= 0 && (!pickedCache || depth < pickedDepth)) {
+            pickedIndex = index;
+            pickedDepth = depth;
+            pickedCache = cache;
+        }
+    }
+
+    if (!pickedCache)
+        return false;
+
+    m_clickedIndex = pickedIndex;
+    m_clickedSeries = pickedCache->series();
+    m_clickedType = QAbstract3DGraph::ElementSeries;
+    m_selectedLabelIndex = -1;
+    m_selectedCustomItemIndex = -1;
+    m_clickResolved = true;
+
+    emit needRender();
+
+    return true;
+}
+
 void Scatter3DRenderer::selectionColorToSeriesAndIndex(const QVector4D &color,
                                                        int &index,
                                                        QAbstract3DSeries *&series)
@@ -2468,7 +2829,7 @@ void Scatter3DRenderer::selectionColorToSeriesAndIndex(const QVector4D &color,
                             static_cast<ScatterSeriesRenderCache *>(baseCache);
                     int offset = cache->selectionIndexOffset();
                     if (totalIndex >= offset
-                            && totalIndex < (offset + cache->renderArray().size())) {
+                            && totalIndex < (offset + cache->itemCount())) {
                         index = totalIndex - offset;
                         series = cache->series();
                         m_clickedType = QAbstract3DGraph::ElementSeries;
@@ -2484,17 +2845,21 @@ void Scatter3DRenderer::selectionColorToSeriesAndIndex(const QVector4D &color,
     series = 0;
 }
 
-void Scatter3DRenderer::updateRenderItem(const QScatterDataItem &dataItem,
-                                         ScatterRenderItem &renderItem)
+bool Scatter3DRenderer::isInAxisRanges(const QVector3D &dotPos) const
 {
-    QVector3D dotPos = dataItem.position();
-    if ((dotPos.x() >= m_axisCacheX.min() && dotPos.x() <= m_axisCacheX.max() )
+    return (dotPos.x() >= m_axisCacheX.min() && dotPos.x() <= m_axisCacheX.max())
             && (dotPos.y() >= m_axisCacheY.min() && dotPos.y() <= m_axisCacheY.max())
-            && (dotPos.z() >= m_axisCacheZ.min() && dotPos.z() <= m_axisCacheZ.max())) {
+            && (dotPos.z() >= m_axisCacheZ.min() && dotPos.z() <= m_axisCacheZ.max());
+}
+
+void Scatter3DRenderer::updateRenderItem(const QVector3D &dotPos, const QQuaternion &rotation,
+                                         ScatterRenderItem &renderItem)
+{
+    if (isInAxisRanges(dotPos)) {
         renderItem.setPosition(dotPos);
         renderItem.setVisible(true);
-        if (!dataItem.rotation().isIdentity())
-            renderItem.setRotation(dataItem.rotation().normalized());
+        if (!rotation.isIdentity())
+            renderItem.setRotation(rotation.normalized());
         else
             renderItem.setRotation(identityQuaternion);
         calculateTranslation(renderItem);
@@ -2525,4 +2890,23 @@ QVector3D Scatter3DRenderer::convertPositionToTranslation(const QVector3D &posit
     return QVector3D(xTrans, yTrans, zTrans);
 }
 
+// Calculates the translation of the item at the index, reading it from the proxy.
+// Returns false if the item is outside the axis ranges.
+bool Scatter3DRenderer::itemTranslation(const QScatterDataProxyPrivate *dataProxy, int index,
+                                        QVector3D &translation)
+{
+    const QVector3D dotPos = dataProxy->itemPosition(index);
+    if (!isInAxisRanges(dotPos))
+        return false;
+
+    translation = convertPositionToTranslation(dotPos, false);
+    return true;
+}
+
+const QScatterDataProxyPrivate *Scatter3DRenderer::dataProxyPrivate(
+        const QScatter3DSeries *series)
+{
+    return static_cast<const QScatterDataProxyPrivate *>(series->d_ptr->dataProxyPrivate());
+}
+
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -53,6 +53,7 @@ class ShaderHelper;
 class Q3DScene;
 class ScatterSeriesRenderCache;
 class QScatterDataItem;
+class QScatterDataProxyPrivate;
 
 class QT_DATAVISUALIZATION_EXPORT Scatter3DRenderer : public Abstract3DRenderer
 {
@@ -71,6 +72,11 @@ private:
     ShaderHelper *m_selectionShader;
     ShaderHelper *m_backgroundShader;
     ShaderHelper *m_staticGradientPointShader;
+    ShaderHelper *m_dotInstancedShader;
+    ShaderHelper *m_dotGradientInstancedShader;
+    ShaderHelper *m_depthInstancedShader;
+    ShaderHelper *m_selectionInstancedShader;
+    bool m_useInstancing;
     GLuint m_bgrTexture;
     GLuint m_selectionTexture;
     GLuint m_depthFrameBuffer;
@@ -110,6 +116,8 @@ public:
     void updateMargin(float margin);
 
     QVector3D convertPositionToTranslation(const QVector3D &position, bool isAbsolute);
+    bool itemTranslation(const QScatterDataProxyPrivate *dataProxy, int index,
+                         QVector3D &translation);
 
     inline int clickedIndex() const { return m_clickedIndex; }
     void resetClickedStatus();
@@ -149,10 +157,20 @@ private:
     void initPointShader();
     void calculateTranslation(ScatterRenderItem &item);
     void calculateSceneScalingFactors();
-
+    void initInstancedShaders();
+    bool useInstancing(ScatterSeriesRenderCache *cache);
+    void invalidateInstanceData();
+    void drawInstancedItems(ScatterSeriesRenderCache *cache,
+                            const QMatrix4x4 &depthProjectionViewMatrix,
+                            const QMatrix4x4 &projectionViewMatrix, const QMatrix4x4 &viewMatrix);
+
+    bool pickItem(const QMatrix4x4 &projectionMatrix, const QMatrix4x4 &projectionViewMatrix);
     void selectionColorToSeriesAndIndex(const QVector4D &color, int &index,
                                         QAbstract3DSeries *&series);
-    inline void updateRenderItem(const QScatterDataItem &dataItem, ScatterRenderItem &renderItem);
+    inline bool isInAxisRanges(const QVector3D &dotPos) const;
+    inline void updateRenderItem(const QVector3D &dotPos, const QQuaternion &rotation,
+                                 ScatterRenderItem &renderItem);
+    static const QScatterDataProxyPrivate *dataProxyPrivate(const QScatter3DSeries *series);
 
     Q_DISABLE_COPY(Scatter3DRenderer)
 };
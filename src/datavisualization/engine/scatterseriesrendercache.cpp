@@ -30,6 +30,8 @@
 #include "scatterseriesrendercache_p.h"
 #include "scatterobjectbufferhelper_p.h"
 #include "scatterpointbufferhelper_p.h"
+#include "scatterinstancebufferhelper_p.h"
+#include "scatter3drenderer_p.h"
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
@@ -43,7 +45,12 @@ ScatterSeriesRenderCache::ScatterSeriesRenderCache(QAbstract3DSeries *series,
       m_oldMeshFileName(QString()),
       m_scatterBufferObj(0),
       m_scatterBufferPoints(0),
-      m_visibilityChanged(false)
+      m_instanceBuffer(0),
+      m_instanceDataDirty(true),
+      m_visibilityChanged(false),
+      m_pickIndexDirty(true),
+      m_externalProxy(0),
+      m_externalItemCount(0)
 {
 }
 
@@ -51,13 +58,38 @@ ScatterSeriesRenderCache::~ScatterSeriesRenderCache()
 {
     delete m_scatterBufferObj;
     delete m_scatterBufferPoints;
+    delete m_instanceBuffer;
 }
 
 void ScatterSeriesRenderCache::cleanup(TextureHelper *texHelper)
 {
     m_renderArray.clear();
+    m_pickIndex.clear();
+    m_pickIndexDirty = true;
+    delete m_instanceBuffer;
+    m_instanceBuffer = 0;
+    m_instanceDataDirty = true;
+    m_externalProxy = 0;
+    m_externalItemCount = 0;
 
     SeriesRenderCache::cleanup(texHelper);
 }
 
+void ScatterSeriesRenderCache::setExternalPoints(const QScatterDataProxyPrivate *dataProxy,
+                                                 int itemCount)
+{
+    m_externalProxy = dataProxy;
+    m_externalItemCount = dataProxy ? itemCount : 0;
+    if (dataProxy) {
+        m_renderArray.clear();
+        m_renderArray.squeeze();
+    }
+}
+
+bool ScatterSeriesRenderCache::externalItemTranslation(int index, QVector3D &translation) const
+{
+    return static_cast<Scatter3DRenderer *>(m_renderer)->itemTranslation(m_externalProxy, index,
+                                                                         translation);
+}
+
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -44,13 +44,16 @@
 #include "seriesrendercache_p.h"
 #include "qscatter3dseries_p.h"
 #include "scatterrenderitem_p.h"
+#include "scatterpickindex_p.h"
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
 class ScatterObjectBufferHelper;
 class ScatterPointBufferHelper;
+class ScatterInstanceBufferHelper;
+class QScatterDataProxyPrivate;
 
-class ScatterSeriesRenderCache : public SeriesRenderCache
+class QT_DATAVISUALIZATION_EXPORT ScatterSeriesRenderCache : public SeriesRenderCache
 {
 public:
     ScatterSeriesRenderCache(QAbstract3DSeries *series, Abstract3DRenderer *renderer);
@@ -74,10 +77,33 @@ public:
     inline ScatterObjectBufferHelper *bufferObject() const { return m_scatterBufferObj; }
     inline void setBufferPoints(ScatterPointBufferHelper *object) { m_scatterBufferPoints = object; }
     inline ScatterPointBufferHelper *bufferPoints() const { return m_scatterBufferPoints; }
+    inline ScatterInstanceBufferHelper *instanceBuffer() const { return m_instanceBuffer; }
+    inline void setInstanceBuffer(ScatterInstanceBufferHelper *buffer) { m_instanceBuffer = buffer; }
+    inline void setInstanceDataDirty(bool state) { m_instanceDataDirty = state; }
+    inline bool instanceDataDirty() const { return m_instanceDataDirty; }
     inline QVector<int> &updateIndices() { return m_updateIndices; }
     inline QVector<int> &bufferIndices() { return m_bufferIndices; }
     inline void setVisibilityChanged(bool changed) { m_visibilityChanged = changed; }
     inline bool visibilityChanged() const { return m_visibilityChanged; }
+    inline ScatterPickIndex &pickIndex() { return m_pickIndex; }
+    inline void setPickIndexDirty(bool dirty) { m_pickIndexDirty = dirty; }
+    inline bool pickIndexDirty() const { return m_pickIndexDirty; }
+    void setExternalPoints(const QScatterDataProxyPrivate *dataProxy, int itemCount);
+    inline bool hasExternalPoints() const { return m_externalProxy; }
+    inline int itemCount() const
+    {
+        return m_externalProxy ? m_externalItemCount : m_renderArray.size();
+    }
+    // Returns false if the item is not visible
+    inline bool itemTranslation(int index, QVector3D &translation) const
+    {
+        if (m_externalProxy)
+            return externalItemTranslation(index, translation);
+        const ScatterRenderItem &item = m_renderArray.at(index);
+        translation = item.translation();
+        return item.isVisible();
+    }
+    inline ScatterRenderItem &selectedItem() { return m_selectedItem; }
 
 protected:
     ScatterRenderItemArray m_renderArray;
@@ -88,9 +114,21 @@ protected:
     QString m_oldMeshFileName; // Used to detect if full buffer change needed
     ScatterObjectBufferHelper *m_scatterBufferObj;
     ScatterPointBufferHelper *m_scatterBufferPoints;
+    ScatterInstanceBufferHelper *m_instanceBuffer; // Owned, only exists in instanced mode
+    bool m_instanceDataDirty;
     QVector<int> m_updateIndices; // Used as temporary cache during item updates
     QVector<int> m_bufferIndices; // Cache for mapping renderarray to mesh buffer
     bool m_visibilityChanged; // Used to detect if full buffer change needed
+    ScatterPickIndex m_pickIndex;
+    bool m_pickIndexDirty; // Render array has changed since the pick index was built
+    // Static point series of caller-owned data have no render array, their items are read
+    // through the proxy. The proxy must only be accessed during synchronization.
+    const QScatterDataProxyPrivate *m_externalProxy;
+    int m_externalItemCount;
+    ScatterRenderItem m_selectedItem; // Selected item of external points
+
+private:
+    bool externalItemTranslation(int index, QVector3D &translation) const;
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
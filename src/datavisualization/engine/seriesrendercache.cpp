@@ -40,9 +40,11 @@ SeriesRenderCache::SeriesRenderCache(QAbstract3DSeries *series, Abstract3DRender
     : m_series(series),
       m_object(0),
       m_mesh(QAbstract3DSeries::MeshCube),
+      m_colorStyle(Q3DTheme::ColorStyleUniform),
       m_baseUniformTexture(0),
       m_baseGradientTexture(0),
       m_gradientImage(0),
+      m_baseGradientOpaque(true),
       m_singleHighlightGradientTexture(0),
       m_multiHighlightGradientTexture(0),
       m_valid(false),
@@ -146,6 +148,11 @@ void SeriesRenderCache::populate(bool newSeries)
     if (newSeries || changeTracker.baseGradientChanged) {
         QLinearGradient gradient = m_series->baseGradient();
         m_gradientImage = Utils::getGradientImage(gradient);
+        m_baseGradientOpaque = true;
+        foreach (const QGradientStop &stop, gradient.stops()) {
+            if (stop.second.alpha() < 255)
+                m_baseGradientOpaque = false;
+        }
         m_renderer->fixGradientAndGenerateTexture(&gradient, &m_baseGradientTexture);
         changeTracker.baseGradientChanged = false;
     }
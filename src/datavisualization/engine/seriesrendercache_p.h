@@ -49,7 +49,7 @@ class Abstract3DRenderer;
 class ObjectHelper;
 class TextureHelper;
 
-class SeriesRenderCache
+class QT_DATAVISUALIZATION_EXPORT SeriesRenderCache
 {
 public:
     SeriesRenderCache(QAbstract3DSeries *series, Abstract3DRenderer *renderer);
@@ -71,6 +71,11 @@ public:
     inline const GLuint &baseUniformTexture() const { return m_baseUniformTexture; }
     inline const GLuint &baseGradientTexture() const { return m_baseGradientTexture; }
     inline const QImage &gradientImage() const { return m_gradientImage; }
+    inline bool isBaseOpaque() const
+    {
+        return m_colorStyle == Q3DTheme::ColorStyleUniform ? m_baseColor.w() >= 1.0f
+                                                           : m_baseGradientOpaque;
+    }
     inline const QVector4D &singleHighlightColor() const { return m_singleHighlightColor; }
     inline const GLuint &singleHighlightGradientTexture() const { return m_singleHighlightGradientTexture; }
     inline const QVector4D &multiHighlightColor() const { return m_multiHighlightColor; }
@@ -96,6 +101,7 @@ protected:
     GLuint m_baseUniformTexture;
     GLuint m_baseGradientTexture;
     QImage m_gradientImage;
+    bool m_baseGradientOpaque;
     QVector4D m_singleHighlightColor;
     GLuint m_singleHighlightGradientTexture;
     QVector4D m_multiHighlightColor;
@@ -0,0 +1,14 @@
+uniform highp mat4 MVP;
+uniform highp mat4 M;
+uniform highp vec4 instanceScale;
+
+attribute highp vec3 vertexPosition_mdl;
+attribute highp vec3 instanceData;
+
+void main() {
+    highp float height = instanceData.y * instanceScale.y;
+    highp vec3 scale = vec3(instanceScale.x, height, instanceScale.z);
+    highp vec3 translation = vec3(instanceData.x, height + instanceScale.w, instanceData.z);
+    gl_Position = MVP * vec4(vec4(M * vec4(vertexPosition_mdl * scale, 1.0)).xyz
+                             + translation, 1.0);
+}
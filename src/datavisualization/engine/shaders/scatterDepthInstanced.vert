@@ -0,0 +1,17 @@
+uniform highp mat4 MVP;
+uniform highp mat4 M;
+uniform highp vec4 instanceScale;
+
+attribute highp vec3 vertexPosition_mdl;
+attribute highp vec4 instanceData;
+attribute highp vec4 instanceRotation;
+
+highp vec3 rotate(highp vec4 q, highp vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main() {
+    highp vec3 scaledPosition = vertexPosition_mdl * (instanceScale.x * instanceData.w);
+    gl_Position = MVP * vec4(vec4(M * vec4(rotate(instanceRotation, scaledPosition),
+                                           1.0)).xyz + instanceData.xyz, 1.0);
+}
@@ -0,0 +1,42 @@
+attribute highp vec3 vertexPosition_mdl;
+attribute highp vec2 vertexUV;
+attribute highp vec3 vertexNormal_mdl;
+attribute highp vec4 instanceData;
+attribute highp vec4 instanceRotation;
+
+uniform highp mat4 MVP;
+uniform highp mat4 V;
+uniform highp mat4 M;
+uniform highp vec4 instanceScale;
+uniform highp float instanceGradient;
+uniform highp vec3 lightPosition_wrld;
+
+varying highp vec3 lightPosition_wrld_frag;
+varying highp vec3 position_wrld;
+varying highp vec3 normal_cmr;
+varying highp vec3 eyeDirection_cmr;
+varying highp vec3 lightDirection_cmr;
+varying highp vec2 coords_mdl;
+
+highp vec3 rotate(highp vec4 q, highp vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main() {
+    highp vec3 scaledPosition = vertexPosition_mdl * (instanceScale.x * instanceData.w);
+    highp vec4 vertexPosition = vec4(vec4(M * vec4(rotate(instanceRotation, scaledPosition),
+                                                   1.0)).xyz + instanceData.xyz, 1.0);
+    gl_Position = MVP * vertexPosition;
+    // Range gradient colors the whole item according to its Y-coordinate
+    coords_mdl = vec2(vertexPosition_mdl.x,
+                      mix(vertexPosition_mdl.y,
+                          (instanceData.y + instanceScale.w) / instanceScale.w - 1.0,
+                          instanceGradient));
+    position_wrld = vertexPosition.xyz;
+    vec3 vertexPosition_cmr = vec4(V * vertexPosition).xyz;
+    eyeDirection_cmr = vec3(0.0, 0.0, 0.0) - vertexPosition_cmr;
+    vec3 lightPosition_cmr = vec4(V * vec4(lightPosition_wrld, 1.0)).xyz;
+    lightDirection_cmr = lightPosition_cmr + eyeDirection_cmr;
+    normal_cmr = vec4(V * M * vec4(rotate(instanceRotation, vertexNormal_mdl), 0.0)).xyz;
+    lightPosition_wrld_frag = lightPosition_wrld;
+}
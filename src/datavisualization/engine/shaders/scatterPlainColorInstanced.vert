@@ -0,0 +1,27 @@
+uniform highp mat4 MVP;
+uniform highp mat4 M;
+uniform highp vec4 instanceScale;
+uniform highp float instanceIndexOffset;
+
+attribute highp vec3 vertexPosition_mdl;
+attribute highp vec4 instanceData;
+attribute highp vec4 instanceRotation;
+attribute highp float instanceIndex;
+
+varying highp vec4 color_frag;
+
+highp vec3 rotate(highp vec4 q, highp vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main() {
+    highp vec3 scaledPosition = vertexPosition_mdl * (instanceScale.x * instanceData.w);
+    gl_Position = MVP * vec4(vec4(M * vec4(rotate(instanceRotation, scaledPosition),
+                                           1.0)).xyz + instanceData.xyz, 1.0);
+    // Selection color encodes the item index the same way as indexToSelectionColor()
+    highp float index = instanceIndex + instanceIndexOffset;
+    highp float blue = floor(index / 65536.0);
+    highp float green = floor((index - blue * 65536.0) / 256.0);
+    highp float red = index - blue * 65536.0 - green * 256.0;
+    color_frag = vec4(red, green, blue, 0.0) / 255.0;
+}
@@ -0,0 +1,51 @@
+#version 120
+
+uniform highp mat4 MVP;
+uniform highp mat4 V;
+uniform highp mat4 M;
+uniform highp mat4 depthMVP;
+uniform highp vec4 instanceScale;
+uniform highp float instanceGradient;
+uniform highp vec3 lightPosition_wrld;
+
+attribute highp vec3 vertexPosition_mdl;
+attribute highp vec3 vertexNormal_mdl;
+attribute highp vec2 vertexUV;
+attribute highp vec4 instanceData;
+attribute highp vec4 instanceRotation;
+
+varying highp vec2 UV;
+varying highp vec3 position_wrld;
+varying highp vec3 normal_cmr;
+varying highp vec3 eyeDirection_cmr;
+varying highp vec3 lightDirection_cmr;
+varying highp vec4 shadowCoord;
+varying highp vec2 coords_mdl;
+
+const highp mat4 bias = mat4(0.5, 0.0, 0.0, 0.0,
+                             0.0, 0.5, 0.0, 0.0,
+                             0.0, 0.0, 0.5, 0.0,
+                             0.5, 0.5, 0.5, 1.0);
+
+highp vec3 rotate(highp vec4 q, highp vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main() {
+    highp vec3 scaledPosition = vertexPosition_mdl * (instanceScale.x * instanceData.w);
+    highp vec4 vertexPosition = vec4(vec4(M * vec4(rotate(instanceRotation, scaledPosition),
+                                                   1.0)).xyz + instanceData.xyz, 1.0);
+    gl_Position = MVP * vertexPosition;
+    // Range gradient colors the whole item according to its Y-coordinate
+    coords_mdl = vec2(vertexPosition_mdl.x,
+                      mix(vertexPosition_mdl.y,
+                          (instanceData.y + instanceScale.w) / instanceScale.w - 1.0,
+                          instanceGradient));
+    shadowCoord = bias * depthMVP * vertexPosition;
+    position_wrld = vertexPosition.xyz;
+    vec3 vertexPosition_cmr = vec4(V * vertexPosition).xyz;
+    eyeDirection_cmr = vec3(0.0, 0.0, 0.0) - vertexPosition_cmr;
+    lightDirection_cmr = vec4(V * vec4(lightPosition_wrld, 0.0)).xyz;
+    normal_cmr = vec4(V * M * vec4(rotate(instanceRotation, vertexNormal_mdl), 0.0)).xyz;
+    UV = vertexUV;
+}
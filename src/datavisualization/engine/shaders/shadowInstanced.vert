@@ -0,0 +1,46 @@
+#version 120
+
+uniform highp mat4 MVP;
+uniform highp mat4 V;
+uniform highp mat4 M;
+uniform highp mat4 depthMVP;
+uniform highp vec4 instanceScale;
+uniform highp float instanceGradient;
+uniform highp vec3 lightPosition_wrld;
+
+attribute highp vec3 vertexPosition_mdl;
+attribute highp vec3 vertexNormal_mdl;
+attribute highp vec2 vertexUV;
+attribute highp vec3 instanceData;
+
+varying highp vec2 UV;
+varying highp vec3 position_wrld;
+varying highp vec3 normal_cmr;
+varying highp vec3 eyeDirection_cmr;
+varying highp vec3 lightDirection_cmr;
+varying highp vec4 shadowCoord;
+varying highp vec2 coords_mdl;
+
+const highp mat4 bias = mat4(0.5, 0.0, 0.0, 0.0,
+                             0.0, 0.5, 0.0, 0.0,
+                             0.0, 0.0, 0.5, 0.0,
+                             0.5, 0.5, 0.5, 1.0);
+
+void main() {
+    highp float height = instanceData.y * instanceScale.y;
+    highp vec3 scale = vec3(instanceScale.x, height, instanceScale.z);
+    highp vec3 translation = vec3(instanceData.x, height + instanceScale.w, instanceData.z);
+    highp vec4 vertexPosition = vec4(vec4(M * vec4(vertexPosition_mdl * scale, 1.0)).xyz
+                                     + translation, 1.0);
+    gl_Position = MVP * vertexPosition;
+    coords_mdl = vec2(vertexPosition_mdl.x,
+                      (vertexPosition_mdl.y + 1.0) * mix(1.0, abs(instanceData.y),
+                                                         instanceGradient) - 1.0);
+    shadowCoord = bias * depthMVP * vertexPosition;
+    position_wrld = vertexPosition.xyz;
+    vec3 vertexPosition_cmr = vec4(V * vertexPosition).xyz;
+    eyeDirection_cmr = vec3(0.0, 0.0, 0.0) - vertexPosition_cmr;
+    lightDirection_cmr = vec4(V * vec4(lightPosition_wrld, 0.0)).xyz;
+    normal_cmr = vec4(V * M * vec4(vertexNormal_mdl / scale, 0.0)).xyz;
+    UV = vertexUV;
+}
@@ -12,6 +12,14 @@ uniform highp float alphaMultiplier;
 uniform highp int preserveOpacity;
 uniform highp vec3 minBounds;
 uniform highp vec3 maxBounds;
+// Maps volume texture coordinates to the texture of the brick being drawn
+uniform highp vec3 brickOffset;
+uniform highp vec3 brickScale;
+// Occupancy texture has a nonzero value for each cell of the volume with visible texels.
+// Zero cell size means there is no occupancy texture.
+uniform highp sampler3D occupancySampler;
+uniform highp vec3 occupancyCellSize;
+uniform highp vec3 occupancyScale;
 
 // Ray traveling straight through a single 'alpha thickness' applies 100% of the encountered alpha.
 // Rays traveling shorter distances apply a fraction. This is used to normalize the alpha over
@@ -75,6 +83,8 @@ void main() {
 
     highp vec3 textureSteps = textureDimensions;
     highp vec3 textureOffset = textureDimensions * 0.001;
+    highp vec3 texelLeaps = textureOffset * invAbsRay;
+    highp float leapOffset = min(texelLeaps.x, min(texelLeaps.y, texelLeaps.z));
     if (ray.x > 0) {
         nextEdges.x += textureDimensions.x + textureOffset.x;
     } else {
@@ -96,7 +106,41 @@ void main() {
 
     // Raytrace into volume, need to sample pixels along the eye ray until we hit opacity 1
     for (int i = 0; i < sampleCount; i++) {
-        curColor = texture3D(textureSampler, curPos);
+        if (occupancyCellSize.x > 0.0
+                && texture3D(occupancySampler, curPos * occupancyScale).r == 0.0) {
+            // The cell is fully transparent, so leap to where the ray leaves it
+            highp vec3 cellEdges = floor(curPos / occupancyCellSize) * occupancyCellSize;
+            if (ray.x > 0)
+                cellEdges.x += occupancyCellSize.x;
+            if (ray.y > 0)
+                cellEdges.y += occupancyCellSize.y;
+            if (ray.z > 0)
+                cellEdges.z += occupancyCellSize.z;
+            highp vec3 leaps = abs(cellEdges - curPos) * invAbsRay;
+            highp float leapSize = min(leaps.x, min(leaps.y, leaps.z)) + leapOffset;
+            curPos += leapSize * ray;
+            curLen += leapSize;
+            if (curLen >= 1.0)
+                break;
+
+            // Realign the texel edges to the new position
+            nextEdges = floor(curPos / textureDimensions) * textureDimensions;
+            if (ray.x > 0)
+                nextEdges.x += textureDimensions.x + textureOffset.x;
+            else
+                nextEdges.x -= textureOffset.x;
+            if (ray.y > 0)
+                nextEdges.y += textureDimensions.y + textureOffset.y;
+            else
+                nextEdges.y -= textureOffset.y;
+            if (ray.z > 0)
+                nextEdges.z += textureDimensions.z + textureOffset.z;
+            else
+                nextEdges.z -= textureOffset.z;
+            continue;
+        }
+
+        curColor = texture3D(textureSampler, (curPos - brickOffset) * brickScale);
         if (color8Bit != 0)
             curColor = colorIndex[int(curColor.r * 255.0)];
 
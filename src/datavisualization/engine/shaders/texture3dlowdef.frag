@@ -12,6 +12,14 @@ uniform highp float alphaMultiplier;
 uniform highp int preserveOpacity;
 uniform highp vec3 minBounds;
 uniform highp vec3 maxBounds;
+// Maps volume texture coordinates to the texture of the brick being drawn
+uniform highp vec3 brickOffset;
+uniform highp vec3 brickScale;
+// Occupancy texture has a nonzero value for each cell of the volume with visible texels.
+// Zero cell size means there is no occupancy texture.
+uniform highp sampler3D occupancySampler;
+uniform highp vec3 occupancyCellSize;
+uniform highp vec3 occupancyScale;
 
 // Ray traveling straight through a single 'alpha thickness' applies 100% of the encountered alpha.
 // Rays traveling shorter distances apply a fraction. This is used to normalize the alpha over
@@ -69,7 +77,26 @@ void main() {
 
     // Raytrace into volume, need to sample pixels along the eye ray until we hit opacity 1
     for (int i = 0; i < sampleCount; i++) {
-        curColor = texture3D(textureSampler, curPos);
+        if (occupancyCellSize.x > 0.0
+                && texture3D(occupancySampler, curPos * occupancyScale).r == 0.0) {
+            // The cell is fully transparent, so leap over it in whole steps
+            highp vec3 cellEdges = floor(curPos / occupancyCellSize) * occupancyCellSize;
+            if (step.x > 0.0)
+                cellEdges.x += occupancyCellSize.x;
+            if (step.y > 0.0)
+                cellEdges.y += occupancyCellSize.y;
+            if (step.z > 0.0)
+                cellEdges.z += occupancyCellSize.z;
+            highp vec3 leaps = abs(cellEdges - curPos) / abs(step);
+            highp float leapSteps = max(ceil(min(leaps.x, min(leaps.y, leaps.z))), 1.0);
+            curPos += leapSteps * step;
+            curLen += leapSteps * stepSize;
+            if (curLen >= fullDist)
+                break;
+            continue;
+        }
+
+        curColor = texture3D(textureSampler, (curPos - brickOffset) * brickScale);
         if (color8Bit != 0)
             curColor = colorIndex[int(curColor.r * 255.0)];
 
@@ -11,6 +11,9 @@ uniform highp float alphaMultiplier;
 uniform highp int preserveOpacity;
 uniform highp vec3 minBounds;
 uniform highp vec3 maxBounds;
+// Maps volume texture coordinates to the texture of the brick being drawn
+uniform highp vec3 brickOffset;
+uniform highp vec3 brickScale;
 
 const highp vec3 xPlaneNormal = vec3(1.0, 0, 0);
 const highp vec3 yPlaneNormal = vec3(0, 1.0, 0);
@@ -86,7 +89,7 @@ void main() {
                 && clamp(texelVec.y, maxBounds.y, minBounds.y) == texelVec.y
                 && clamp(texelVec.z, maxBounds.z, minBounds.z) == texelVec.z) {
             texelVec = 0.5 * (texelVec + 1.0);
-            curColor = texture3D(textureSampler, texelVec);
+            curColor = texture3D(textureSampler, (texelVec - brickOffset) * brickScale);
             if (color8Bit != 0)
                 curColor = colorIndex[int(curColor.r * 255.0)];
 
@@ -106,7 +109,7 @@ void main() {
                     && clamp(texelVec.y, maxBounds.y, minBounds.y) == texelVec.y
                     && clamp(texelVec.z, maxBounds.z, minBounds.z) == texelVec.z) {
                 texelVec = 0.5 * (texelVec + 1.0);
-                curColor = texture3D(textureSampler, texelVec);
+                curColor = texture3D(textureSampler, (texelVec - brickOffset) * brickScale);
                 if (color8Bit != 0)
                     curColor = colorIndex[int(curColor.r * 255.0)];
                 if (curColor.a > 0.0) {
@@ -125,7 +128,7 @@ void main() {
                         && clamp(texelVec.y, maxBounds.y, minBounds.y) == texelVec.y
                         && clamp(texelVec.z, maxBounds.z, minBounds.z) == texelVec.z) {
                     texelVec = 0.5 * (texelVec + 1.0);
-                    curColor = texture3D(textureSampler, texelVec);
+                    curColor = texture3D(textureSampler, (texelVec - brickOffset) * brickScale);
                     if (curColor.a > 0.0) {
                         if (color8Bit != 0)
                             curColor = colorIndex[int(curColor.r * 255.0)];
@@ -77,8 +77,24 @@ void Surface3DController::synchDataToRenderer()
     if (!isInitialized())
         return;
 
+    // Scrolls must reach the renderer before the data update they are part of
+    if (m_changeTracker.rowsScrolled) {
+        // Series that are rebuilt anyway have no use for the scroll information
+        for (int i = m_scrolledRows.size() - 1; i >= 0; i--) {
+            if (m_changedSeriesList.contains(m_scrolledRows.at(i).series))
+                m_scrolledRows.remove(i);
+        }
+        m_renderer->updateScrolledRows(m_scrolledRows);
+        m_changeTracker.rowsScrolled = false;
+        m_scrolledRows.clear();
+    }
+
     Abstract3DController::synchDataToRenderer();
 
+    // Zoom or viewport changes may require resampling surfaces with level of detail enabled
+    if (m_renderer->isLevelOfDetailDirty())
+        m_renderer->updateData();
+
     // Notify changes to renderer
     if (m_changeTracker.rowsChanged) {
         m_renderer->updateRows(m_changedRows);
@@ -414,6 +430,63 @@ void Surface3DController::handleItemChanged(int rowIndex, int columnIndex)
     }
 }
 
+void Surface3DController::handleRowsScrolled(int count)
+{
+    QSurface3DSeries *series = static_cast<QSurfaceDataProxy *>(sender())->series();
+    if (series == m_selectedSeries) {
+        // Selection moves with the data, unless the selected row was scrolled out
+        int selectedRow = m_selectedPoint.x();
+        if (selectedRow >= 0) {
+            selectedRow -= count;
+            if (selectedRow < 0)
+                selectedRow = -1;
+            setSelectedPoint(QPoint(selectedRow, m_selectedPoint.y()), m_selectedSeries, false);
+        }
+    }
+
+    // Pending row and item changes refer to row indexes before the scroll
+    for (int i = m_changedRows.size() - 1; i >= 0; i--) {
+        ChangeRow &change = m_changedRows[i];
+        if (change.series == series) {
+            change.row -= count;
+            if (change.row < 0)
+                m_changedRows.remove(i);
+        }
+    }
+    for (int i = m_changedItems.size() - 1; i >= 0; i--) {
+        ChangeItem &change = m_changedItems[i];
+        if (change.series == series) {
+            change.point.rx() -= count;
+            if (change.point.x() < 0)
+                m_changedItems.remove(i);
+        }
+    }
+
+    if (series->isVisible()) {
+        adjustAxisRanges();
+        m_isDataDirty = true;
+
+        bool newScroll = true;
+        for (int i = 0; i < m_scrolledRows.size(); i++) {
+            if (m_scrolledRows.at(i).series == series) {
+                m_scrolledRows[i].count += count;
+                newScroll = false;
+                break;
+            }
+        }
+        if (newScroll) {
+            ChangeScroll newChangeScroll = {series, count};
+            m_scrolledRows.append(newChangeScroll);
+        }
+        m_changeTracker.rowsScrolled = true;
+    } else if (!m_changedSeriesList.contains(series)) {
+        m_changedSeriesList.append(series);
+    }
+
+    series->d_ptr->markItemLabelDirty();
+    emitNeedRender();
+}
+
 void Surface3DController::handleRowsAdded(int startIndex, int count)
 {
     Q_UNUSED(startIndex)
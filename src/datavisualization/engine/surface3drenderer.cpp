@@ -34,6 +34,7 @@
 #include "utils_p.h"
 
 #include <QtCore/qmath.h>
+#include <QtCore/QSet>
 
 static const int ID_TO_RGBA_MASK = 0xff;
 
@@ -76,7 +77,9 @@ Surface3DRenderer::Surface3DRenderer(Surface3DController *controller)
       m_selectedSeries(0),
       m_clickedPosition(Surface3DController::invalidSelectionPosition()),
       m_selectionTexturesDirty(false),
-      m_noShadowTexture(0)
+      m_noShadowTexture(0),
+      m_levelOfDetailDirty(false),
+      m_selectedItemValid(false)
 {
     // Check if flat feature is supported
     ShaderHelper tester(this, QStringLiteral(":/shaders/vertexSurfaceFlat"),
@@ -199,7 +202,19 @@ void Surface3DRenderer::updateData()
 
     foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
         SurfaceSeriesRenderCache *cache = static_cast<SurfaceSeriesRenderCache *>(baseCache);
-        if (cache->isVisible() && cache->dataDirty()) {
+        if (!cache->isVisible() && cache->scrolledRows()) {
+            // Scroll can't be applied later, as the sampled data is no longer in sync with it
+            cache->setScrolledRows(0);
+            cache->setDataDirty(true);
+        }
+        if (cache->isVisible() && (cache->dataDirty() || cache->scrolledRows())) {
+            if (cache->scrolledRows() && scrollObjects(cache)) {
+                cache->setScrolledRows(0);
+                cache->setDataDirty(false);
+                continue;
+            }
+            cache->setScrolledRows(0);
+
             const QSurface3DSeries *currentSeries = cache->series();
             QSurfaceDataProxy *dataProxy = currentSeries->dataProxy();
             const QSurfaceDataArray &array = *dataProxy->array();
@@ -210,6 +225,9 @@ void Surface3DRenderer::updateData()
             if (array.size() >= 2 && array.at(0)->size() >= 2)
                 sampleSpace = calculateSampleRect(array);
 
+            if (cache->isLevelOfDetailEnabled())
+                sampleSpace = sampleLevelOfDetail(cache, array, sampleSpace);
+
             bool dimensionsChanged = false;
             if (cache->sampleSpace() != sampleSpace) {
                 if (sampleSpace.width() >= 2)
@@ -229,10 +247,16 @@ void Surface3DRenderer::updateData()
                     for (int i = 0; i < sampleSpace.height(); i++)
                         dataArray << new QSurfaceDataRow(sampleSpace.width());
                 }
+                int lodLevel = cache->lodLevel();
                 for (int i = 0; i < sampleSpace.height(); i++) {
+                    int row = cache->dataRow(i);
+                    const QSurfaceDataRow &srcRow = *array.at(row);
+                    QSurfaceDataRow &dstRow = *dataArray.at(i);
                     for (int j = 0; j < sampleSpace.width(); j++) {
-                        (*(dataArray.at(i)))[j] = array.at(i + sampleSpace.y())->at(
-                                    j + sampleSpace.x());
+                        int column = cache->dataColumn(j);
+                        dstRow[j] = srcRow.at(column);
+                        if (lodLevel)
+                            dstRow[j].setY(cache->lodPyramid().valueAt(lodLevel, row, column));
                     }
                 }
 
@@ -246,6 +270,8 @@ void Surface3DRenderer::updateData()
         }
     }
 
+    m_levelOfDetailDirty = false;
+
     if (m_selectionTexturesDirty && m_cachedSelectionMode > QAbstract3DGraph::SelectionNone)
         updateSelectionTextures();
 
@@ -347,6 +373,9 @@ void Surface3DRenderer::cleanCache(SeriesRenderCache *cache)
 
 void Surface3DRenderer::updateRows(const QVector<Surface3DController::ChangeRow> &rows)
 {
+    // Changes are uploaded once per surface after all rows have been processed
+    QSet<SurfaceObject *> changedObjects;
+    bool resample = false;
     foreach (Surface3DController::ChangeRow item, rows) {
         SurfaceSeriesRenderCache *cache =
                 static_cast<SurfaceSeriesRenderCache *>(m_renderCacheList.value(item.series));
@@ -358,13 +387,24 @@ void Surface3DRenderer::updateRows(const QVector<Surface3DController::ChangeRow>
         if (dataProxy)
             srcArray = dataProxy->array();
 
+        if (cache && srcArray && cache->isLevelOfDetailEnabled()) {
+            // Decimated vertices depend on several data rows, so resample the whole surface
+            SurfaceLodPyramid &pyramid = cache->lodPyramid();
+            if (!cache->isLodPyramidDirty() && pyramid.isValidFor(*srcArray))
+                pyramid.update(*srcArray, item.row, item.row + 1, 0, srcArray->at(0)->size());
+            else
+                cache->setLodPyramidDirty(true);
+            cache->setDataDirty(true);
+            resample = true;
+            continue;
+        }
+
         if (cache && srcArray->size() >= 2 && srcArray->at(0)->size() >= 2 &&
                 sampleSpace.width() >= 2 && sampleSpace.height() >= 2) {
-            bool updateBuffers = false;
             int sampleSpaceTop = sampleSpace.y() + sampleSpace.height();
             int row = item.row;
             if (row >= sampleSpace.y() && row <= sampleSpaceTop) {
-                updateBuffers = true;
+                changedObjects.insert(cache->surfaceObject());
                 for (int j = 0; j < sampleSpace.width(); j++) {
                     (*(dstArray.at(row - sampleSpace.y())))[j] =
                             srcArray->at(row)->at(j + sampleSpace.x());
@@ -378,16 +418,38 @@ void Surface3DRenderer::updateRows(const QVector<Surface3DController::ChangeRow>
                                                             m_polarGraph);
                 }
             }
-            if (updateBuffers)
-                cache->surfaceObject()->uploadBuffers();
         }
     }
 
+    foreach (SurfaceObject *object, changedObjects)
+        object->uploadBuffers();
+
+    if (resample)
+        updateData();
+
     updateSelectedPoint(m_selectedPoint, m_selectedSeries);
 }
 
+void Surface3DRenderer::updateScrolledRows(
+        const QVector<Surface3DController::ChangeScroll> &scrolls)
+{
+    // Scrolls are applied in updateData(), together with any axis range changes
+    foreach (Surface3DController::ChangeScroll scroll, scrolls) {
+        SurfaceSeriesRenderCache *cache =
+                static_cast<SurfaceSeriesRenderCache *>(m_renderCacheList.value(scroll.series));
+        if (cache) {
+            cache->setScrolledRows(cache->scrolledRows() + scroll.count);
+            if (cache->isLevelOfDetailEnabled())
+                cache->setLodPyramidDirty(true);
+        }
+    }
+}
+
 void Surface3DRenderer::updateItems(const QVector<Surface3DController::ChangeItem> &points)
 {
+    // Changes are uploaded once per surface after all items have been processed
+    QSet<SurfaceObject *> changedObjects;
+    bool resample = false;
     foreach (Surface3DController::ChangeItem item, points) {
         SurfaceSeriesRenderCache *cache =
                 static_cast<SurfaceSeriesRenderCache *>(m_renderCacheList.value(item.series));
@@ -399,17 +461,29 @@ void Surface3DRenderer::updateItems(const QVector<Surface3DController::ChangeIte
         if (dataProxy)
             srcArray = dataProxy->array();
 
+        if (cache && srcArray && cache->isLevelOfDetailEnabled()) {
+            SurfaceLodPyramid &pyramid = cache->lodPyramid();
+            if (!cache->isLodPyramidDirty() && pyramid.isValidFor(*srcArray)) {
+                pyramid.update(*srcArray, item.point.x(), item.point.x() + 1,
+                               item.point.y(), item.point.y() + 1);
+            } else {
+                cache->setLodPyramidDirty(true);
+            }
+            cache->setDataDirty(true);
+            resample = true;
+            continue;
+        }
+
         if (cache && srcArray->size() >= 2 && srcArray->at(0)->size() >= 2 &&
                 sampleSpace.width() >= 2 && sampleSpace.height() >= 2) {
             int sampleSpaceTop = sampleSpace.y() + sampleSpace.height();
             int sampleSpaceRight = sampleSpace.x() + sampleSpace.width();
-            bool updateBuffers = false;
             // Note: Point is (row, column), samplespace is (columns x rows)
             QPoint point = item.point;
 
             if (point.x() <= sampleSpaceTop && point.x() >= sampleSpace.y() &&
                     point.y() <= sampleSpaceRight && point.y() >= sampleSpace.x()) {
-                updateBuffers = true;
+                changedObjects.insert(cache->surfaceObject());
                 int x = point.y() - sampleSpace.x();
                 int y = point.x() - sampleSpace.y();
                 (*(dstArray.at(y)))[x] = srcArray->at(point.x())->at(point.y());
@@ -419,12 +493,15 @@ void Surface3DRenderer::updateItems(const QVector<Surface3DController::ChangeIte
                 else
                     cache->surfaceObject()->updateSmoothItem(dstArray, y, x, m_polarGraph);
             }
-            if (updateBuffers)
-                cache->surfaceObject()->uploadBuffers();
         }
-
     }
 
+    foreach (SurfaceObject *object, changedObjects)
+        object->uploadBuffers();
+
+    if (resample)
+        updateData();
+
     updateSelectedPoint(m_selectedPoint, m_selectedSeries);
 }
 
@@ -746,6 +823,28 @@ void Surface3DRenderer::updateScene(Q3DScene *scene)
     }
 
     updateSlicingActive(scene->isSlicingActive());
+
+    // Zoom and viewport size determine the level of detail of decimated surfaces
+    foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
+        SurfaceSeriesRenderCache *cache = static_cast<SurfaceSeriesRenderCache *>(baseCache);
+        if (cache->isLevelOfDetailEnabled() && cache->isVisible() && !cache->dataDirty()
+                && levelOfDetail(cache, cache->dataSpace()) != cache->lodLevel()) {
+            cache->setDataDirty(true);
+            m_levelOfDetailDirty = true;
+        }
+    }
+}
+
+void Surface3DRenderer::modifiedSeriesList(const QVector<QAbstract3DSeries *> &seriesList)
+{
+    Abstract3DRenderer::modifiedSeriesList(seriesList);
+
+    foreach (QAbstract3DSeries *series, seriesList) {
+        SurfaceSeriesRenderCache *cache =
+                static_cast<SurfaceSeriesRenderCache *>(m_renderCacheList.value(series, 0));
+        if (cache)
+            cache->setLodPyramidDirty(true);
+    }
 }
 
 void Surface3DRenderer::render(GLuint defaultFboHandle)
@@ -1219,9 +1318,10 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
             SurfaceObject *object = cache->surfaceObject();
             if (object->indexCount() && cache->surfaceVisible() && cache->isVisible()
                     && cache->sampleSpace().width() >= 2 && cache->sampleSpace().height() >= 2) {
-                // No translation nor scaling for surfaces, therefore no modelMatrix
-                // Use directly projectionViewMatrix
-                m_depthShader->setUniformValue(m_depthShader->MVP(), depthProjectionViewMatrix);
+                // No scaling for surfaces, and translation only for scrolled surfaces
+                QMatrix4x4 depthMVPMatrix = depthProjectionViewMatrix;
+                depthMVPMatrix.translate(object->positionOffset());
+                m_depthShader->setUniformValue(m_depthShader->MVP(), depthMVPMatrix);
 
                 // 1st attribute buffer : vertices
                 glEnableVertexAttribArray(m_depthShader->posAtt());
@@ -1232,8 +1332,12 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
                 // Index buffer
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->elementBuf());
 
-                // Draw the triangles
-                glDrawElements(GL_TRIANGLES, object->indexCount(), GL_UNSIGNED_INT, (void *)0);
+                // Draw the triangles of the tiles visible to the light
+                foreach (const QPair<int, int> &range,
+                         object->visibleIndexRanges(depthMVPMatrix)) {
+                    glDrawElements(GL_TRIANGLES, range.second, GL_UNSIGNED_INT,
+                                   (void *)(range.first * sizeof(GLint)));
+                }
             }
         }
 
@@ -1268,12 +1372,16 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
     // Do position mapping when necessary
     if (m_graphPositionQueryPending) {
         QVector3D graphDimensions(m_scaleX, m_scaleY, m_scaleZ);
-        queriedGraphPosition(projectionViewMatrix, graphDimensions, defaultFboHandle);
+        queriedGraphPosition(projectionViewMatrix, graphDimensions);
         emit needRender();
     }
 
+    // A selection read back asynchronously on the previous frame doesn't need another pass
+    QVector4D clickedColor;
+    bool selectionRead = takeSelectionReadback(clickedColor);
+
     // Draw selection buffer
-    if (!m_cachedIsSlicingActivated && (!m_renderCacheList.isEmpty()
+    if (!selectionRead && !m_cachedIsSlicingActivated && (!m_renderCacheList.isEmpty()
                                         || !m_customRenderCache.isEmpty())
             && m_selectionState == SelectOnScene
             && m_cachedSelectionMode > QAbstract3DGraph::SelectionNone
@@ -1295,12 +1403,14 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
         foreach (SeriesRenderCache *baseCache, m_renderCacheList) {
             SurfaceSeriesRenderCache *cache = static_cast<SurfaceSeriesRenderCache *>(baseCache);
             if (cache->surfaceObject()->indexCount() && cache->renderable()) {
-                m_selectionShader->setUniformValue(m_selectionShader->MVP(), projectionViewMatrix);
+                QMatrix4x4 MVPMatrix = projectionViewMatrix;
+                MVPMatrix.translate(cache->surfaceObject()->positionOffset());
+                m_selectionShader->setUniformValue(m_selectionShader->MVP(), MVPMatrix);
 
                 cache->surfaceObject()->activateSurfaceTexture(false);
 
-                m_drawer->drawObject(m_selectionShader, cache->surfaceObject(),
-                                     cache->selectionTexture());
+                m_drawer->drawSurface(m_selectionShader, cache->surfaceObject(), MVPMatrix,
+                                      cache->selectionTexture());
             }
         }
         m_surfaceGridShader->bind();
@@ -1312,10 +1422,18 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
 
         glEnable(GL_DITHER);
 
-        QVector4D clickedColor = Utils::getSelection(m_inputPosition, m_viewport.height());
+        selectionRead = readSelectionColor(clickedColor);
 
         glBindFramebuffer(GL_FRAMEBUFFER, defaultFboHandle);
 
+        // Revert to original viewport
+        glViewport(m_primarySubViewport.x(),
+                   m_primarySubViewport.y(),
+                   m_primarySubViewport.width(),
+                   m_primarySubViewport.height());
+    }
+
+    if (selectionRead) {
         // Put the RGBA value back to uint
         uint selectionId = uint(clickedColor.x())
                 + uint(clickedColor.y()) * greenMultiplier
@@ -1326,12 +1444,6 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
         m_clickResolved = true;
 
         emit needRender();
-
-        // Revert to original viewport
-        glViewport(m_primarySubViewport.x(),
-                   m_primarySubViewport.y(),
-                   m_primarySubViewport.width(),
-                   m_primarySubViewport.height());
     }
 
     // Selection handling
@@ -1343,8 +1455,8 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
                         m_renderCacheList.value(const_cast<QSurface3DSeries *>(m_selectedSeries)));
             if (cache && m_selectedPoint != Surface3DController::invalidSelectionPosition()) {
                 const QRect &sampleSpace = cache->sampleSpace();
-                int x = m_selectedPoint.x() - sampleSpace.y();
-                int y = m_selectedPoint.y() - sampleSpace.x();
+                int x = cache->sampleRow(m_selectedPoint.x());
+                int y = cache->sampleColumn(m_selectedPoint.y());
                 if (x >= 0 && y >= 0 && x < sampleSpace.height() && y < sampleSpace.width()
                         && cache->dataArray().size()) {
                     visiblePoint = QPoint(x, y);
@@ -1379,10 +1491,11 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
             QMatrix4x4 MVPMatrix;
             QMatrix4x4 itModelMatrix;
 
+            modelMatrix.translate(cache->surfaceObject()->positionOffset());
 #ifdef SHOW_DEPTH_TEXTURE_SCENE
-            MVPMatrix = depthProjectionViewMatrix;
+            MVPMatrix = depthProjectionViewMatrix * modelMatrix;
 #else
-            MVPMatrix = projectionViewMatrix;
+            MVPMatrix = projectionViewMatrix * modelMatrix;
 #endif
             cache->setMVPMatrix(MVPMatrix);
 
@@ -1454,13 +1567,14 @@ void Surface3DRenderer::drawScene(GLuint defaultFboHandle)
                         shader->setUniformValue(shader->lightS(), adjustedLightStrength);
 
                         // Draw the objects
-                        m_drawer->drawObject(shader, cache->surfaceObject(), texture,
-                                             m_depthTexture);
+                        m_drawer->drawSurface(shader, cache->surfaceObject(), MVPMatrix,
+                                              texture, m_depthTexture);
                     } else {
                         // Set shadowless shader bindings
                         shader->setUniformValue(shader->lightS(), m_cachedTheme->lightStrength());
                         // Draw the objects
-                        m_drawer->drawObject(shader, cache->surfaceObject(), texture);
+                        m_drawer->drawSurface(shader, cache->surfaceObject(), MVPMatrix,
+                                              texture);
                     }
                 }
             }
@@ -2636,11 +2750,101 @@ void Surface3DRenderer::updateObjects(SurfaceSeriesRenderCache *cache, bool dime
     }
 }
 
+bool Surface3DRenderer::scrollObjects(SurfaceSeriesRenderCache *cache)
+{
+    // Only plain smooth surfaces are kept in a ring buffer, other cases are fully rebuilt
+    const QRect &sampleSpace = cache->sampleSpace();
+    int count = cache->scrolledRows();
+    if (m_polarGraph || cache->isFlatShadingEnabled() || cache->surfaceTexture()
+            || cache->isLevelOfDetailEnabled() || sampleSpace.width() < 2 || sampleSpace.height() < 2
+            || count >= sampleSpace.height()) {
+        return false;
+    }
+
+    const QSurfaceDataArray &array = *cache->series()->dataProxy()->array();
+    if (array.size() < 2 || array.at(0)->size() < 2 || calculateSampleRect(array) != sampleSpace)
+        return false;
+
+    // Drop the oldest sampled rows and reuse them for the new ones
+    QSurfaceDataArray &dataArray = cache->dataArray();
+    int firstNewRow = sampleSpace.y() + sampleSpace.height() - count;
+    for (int i = 0; i < count; i++) {
+        QSurfaceDataRow *row = dataArray.takeFirst();
+        const QSurfaceDataRow &srcRow = *array.at(firstNewRow + i);
+        for (int j = 0; j < sampleSpace.width(); j++)
+            (*row)[j] = srcRow.at(j + sampleSpace.x());
+        dataArray.append(row);
+    }
+
+    return cache->surfaceObject()->scrollRows(dataArray, count);
+}
+
+// Picks the data rows or columns from first to last that are drawn at the level of detail
+static void sampleLodIndexes(QVector<int> &indexes, int first, int last, int level)
+{
+    int step = 1 << level;
+    indexes.clear();
+    indexes.reserve((last - first) / step + 3);
+    indexes.append(first);
+    for (int i = (first / step + 1) * step; i < last; i += step)
+        indexes.append(i);
+    indexes.append(last);
+}
+
+QRect Surface3DRenderer::sampleLevelOfDetail(SurfaceSeriesRenderCache *cache,
+                                             const QSurfaceDataArray &array,
+                                             const QRect &dataSpace)
+{
+    SurfaceLodPyramid &pyramid = cache->lodPyramid();
+    if (cache->isLodPyramidDirty() || !pyramid.isValidFor(array)) {
+        pyramid.build(array);
+        cache->setLodPyramidDirty(false);
+    }
+
+    cache->setDataSpace(dataSpace);
+    int level = 0;
+    if (dataSpace.width() >= 2 && dataSpace.height() >= 2)
+        level = levelOfDetail(cache, dataSpace);
+    cache->setLodLevel(level);
+    if (!level)
+        return dataSpace;
+
+    // Vertices are on the cell boundaries of the level, and on the edges of the data space
+    QVector<int> &rows = cache->lodRows();
+    QVector<int> &columns = cache->lodColumns();
+    sampleLodIndexes(rows, dataSpace.top(), dataSpace.bottom(), level);
+    sampleLodIndexes(columns, dataSpace.left(), dataSpace.right(), level);
+
+    return QRect(dataSpace.x(), dataSpace.y(), columns.size(), rows.size());
+}
+
+int Surface3DRenderer::levelOfDetail(SurfaceSeriesRenderCache *cache,
+                                     const QRect &dataSpace) const
+{
+    // About one vertex per pixel is enough. The graph fills the viewport at 100% zoom.
+    float zoom = m_cachedScene->activeCamera()->zoomLevel() / 100.0f;
+    int maxSize = int(float(qMax(m_primarySubViewport.width(), m_primarySubViewport.height()))
+                      * zoom);
+    int size = qMax(dataSpace.width(), dataSpace.height());
+    return cache->lodPyramid().levelFor(size, maxSize);
+}
+
 void Surface3DRenderer::updateSelectedPoint(const QPoint &position, QSurface3DSeries *series)
 {
     m_selectedPoint = position;
     m_selectedSeries = series;
     m_selectionDirty = true;
+
+    m_selectedItemValid = false;
+    if (series && series->isLevelOfDetailEnabled()
+            && position != Surface3DController::invalidSelectionPosition()) {
+        const QSurfaceDataProxy *dataProxy = series->dataProxy();
+        if (dataProxy && position.x() < dataProxy->rowCount()
+                && position.y() < dataProxy->columnCount()) {
+            m_selectedItem = *dataProxy->itemAt(position);
+            m_selectedItemValid = true;
+        }
+    }
 }
 
 void Surface3DRenderer::updateFlipHorizontalGrid(bool flip)
@@ -2748,7 +2952,12 @@ void Surface3DRenderer::updateSelectionPoint(SurfaceSeriesRenderCache *cache, co
     }
 
     QVector3D mainPos;
-    mainPos = cache->surfaceObject()->vertexAt(column, row);
+    if (label && m_selectedItemValid && cache->lodLevel()) {
+        // Point at the selected item itself, as the nearest vertex may be decimated
+        mainPos = cache->surfaceObject()->normalizedVertex(m_selectedItem, m_polarGraph);
+    } else {
+        mainPos = cache->surfaceObject()->vertexAt(column, row);
+    }
     mainPointer->updateBoundingRect(m_primarySubViewport);
     mainPointer->updateSliceData(false, m_autoScaleAdjustment);
     mainPointer->setPosition(mainPos);
@@ -2803,8 +3012,8 @@ QPoint Surface3DRenderer::selectionIdToSurfacePoint(uint id)
 
     uint idInSeries = id - selectedCache->selectionIdStart() + 1;
     const QRect &sampleSpace = selectedCache->sampleSpace();
-    int column = ((idInSeries - 1) % sampleSpace.width()) + sampleSpace.x();
-    int row = ((idInSeries - 1) / sampleSpace.width()) +  sampleSpace.y();
+    int column = selectedCache->dataColumn((idInSeries - 1) % sampleSpace.width());
+    int row = selectedCache->dataRow((idInSeries - 1) / sampleSpace.width());
 
     m_clickedSeries = selectedCache->series();
     m_clickedType = QAbstract3DGraph::ElementSeries;
@@ -2869,7 +3078,6 @@ void Surface3DRenderer::updateSlicingActive(bool isSlicing)
     if (!m_cachedIsSlicingActivated) {
         // We need to re-init selection buffer in case there has been a resize
         initSelectionBuffer();
-        initCursorPositionBuffer();
     }
 
     updateDepthBuffer(); // Re-init depth buffer as well
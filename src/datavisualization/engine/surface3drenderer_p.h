@@ -87,6 +87,10 @@ private:
     bool m_selectionTexturesDirty;
     GLuint m_noShadowTexture;
     bool m_flipHorizontalGrid;
+    bool m_levelOfDetailDirty;
+    // Selected data item of a decimated surface, whose vertices don't have the item values
+    QSurfaceDataItem m_selectedItem;
+    bool m_selectedItemValid;
 
 public:
     explicit Surface3DRenderer(Surface3DController *controller);
@@ -100,7 +104,10 @@ public:
     void updateSelectionMode(QAbstract3DGraph::SelectionFlags mode);
     void updateRows(const QVector<Surface3DController::ChangeRow> &rows);
     void updateItems(const QVector<Surface3DController::ChangeItem> &points);
+    void updateScrolledRows(const QVector<Surface3DController::ChangeScroll> &scrolls);
     void updateScene(Q3DScene *scene);
+    void modifiedSeriesList(const QVector<QAbstract3DSeries *> &seriesList);
+    inline bool isLevelOfDetailDirty() const { return m_levelOfDetailDirty; }
     void updateSlicingActive(bool isSlicing);
     void updateSelectedPoint(const QPoint &position, QSurface3DSeries *series);
     void updateFlipHorizontalGrid(bool flip);
@@ -126,6 +133,10 @@ Q_SIGNALS:
 private:
     void checkFlatSupport(SurfaceSeriesRenderCache *cache);
     void updateObjects(SurfaceSeriesRenderCache *cache, bool dimensionChanged);
+    bool scrollObjects(SurfaceSeriesRenderCache *cache);
+    QRect sampleLevelOfDetail(SurfaceSeriesRenderCache *cache, const QSurfaceDataArray &array,
+                              const QRect &dataSpace);
+    int levelOfDetail(SurfaceSeriesRenderCache *cache, const QRect &dataSpace) const;
     void updateSliceDataModel(const QPoint &point);
     QPoint mapCoordsToSampleSpace(SurfaceSeriesRenderCache *cache, const QPointF &coords);
     void findMatchingRow(float z, int &sample, int direction, QSurfaceDataArray &dataArray);
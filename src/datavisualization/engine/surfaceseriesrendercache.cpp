@@ -51,7 +51,11 @@ SurfaceSeriesRenderCache::SurfaceSeriesRenderCache(QAbstract3DSeries *series,
       m_mainSelectionPointer(0),
       m_slicePointerActive(false),
       m_mainPointerActive(false),
-      m_surfaceTexture(0)
+      m_surfaceTexture(0),
+      m_scrolledRows(0),
+      m_levelOfDetailEnabled(false),
+      m_lodPyramidDirty(true),
+      m_lodLevel(0)
 {
 }
 
@@ -70,6 +74,50 @@ void SurfaceSeriesRenderCache::populate(bool newSeries)
         m_surfaceFlatShading = series()->isFlatShadingEnabled();
         m_flatStatusDirty = true;
     }
+    if (m_levelOfDetailEnabled != series()->isLevelOfDetailEnabled()) {
+        m_levelOfDetailEnabled = series()->isLevelOfDetailEnabled();
+        m_lodPyramid.clear();
+        m_lodPyramidDirty = true;
+        m_lodLevel = 0;
+    }
+}
+
+// Returns the index of the sampled vertex nearest to the data index, or -1 if the data index
+// is outside the sampled indexes.
+static int nearestSampleIndex(const QVector<int> &indexes, int dataIndex)
+{
+    if (dataIndex < indexes.first() || dataIndex > indexes.last())
+        return -1;
+
+    // Find the first sampled index not less than the data index
+    int min = 0;
+    int max = indexes.size() - 1;
+    while (min < max) {
+        int mid = (min + max) / 2;
+        if (indexes.at(mid) < dataIndex)
+            min = mid + 1;
+        else
+            max = mid;
+    }
+    if (indexes.at(min) != dataIndex
+            && dataIndex - indexes.at(min - 1) < indexes.at(min) - dataIndex) {
+        min--;
+    }
+    return min;
+}
+
+int SurfaceSeriesRenderCache::sampleRow(int dataRow) const
+{
+    if (m_lodLevel)
+        return nearestSampleIndex(m_lodRows, dataRow);
+    return dataRow - m_sampleSpace.y();
+}
+
+int SurfaceSeriesRenderCache::sampleColumn(int dataColumn) const
+{
+    if (m_lodLevel)
+        return nearestSampleIndex(m_lodColumns, dataColumn);
+    return dataColumn - m_sampleSpace.x();
 }
 
 void SurfaceSeriesRenderCache::cleanup(TextureHelper *texHelper)
@@ -88,6 +136,7 @@ void SurfaceSeriesRenderCache::cleanup(TextureHelper *texHelper)
     for (int i = 0; i < m_sliceDataArray.size(); i++)
         delete m_sliceDataArray.at(i);
     m_sliceDataArray.clear();
+    m_lodPyramid.clear();
 
     delete m_sliceSelectionPointer;
     delete m_mainSelectionPointer;
@@ -45,6 +45,7 @@
 #include "qsurface3dseries_p.h"
 #include "surfaceobject_p.h"
 #include "selectionpointer_p.h"
+#include "surfacelodpyramid_p.h"
 
 #include <QtGui/QMatrix4x4>
 
@@ -98,6 +99,30 @@ public:
     inline bool mainPointerActive() const { return m_mainPointerActive; }
     inline void setSurfaceTexture(GLuint texture) { m_surfaceTexture = texture; }
     inline GLuint surfaceTexture() const { return m_surfaceTexture; }
+    inline void setScrolledRows(int count) { m_scrolledRows = count; }
+    inline int scrolledRows() const { return m_scrolledRows; }
+
+    inline bool isLevelOfDetailEnabled() const { return m_levelOfDetailEnabled; }
+    inline SurfaceLodPyramid &lodPyramid() { return m_lodPyramid; }
+    inline bool isLodPyramidDirty() const { return m_lodPyramidDirty; }
+    inline void setLodPyramidDirty(bool dirty) { m_lodPyramidDirty = dirty; }
+    inline int lodLevel() const { return m_lodLevel; }
+    inline void setLodLevel(int level) { m_lodLevel = level; }
+    inline const QRect &dataSpace() const { return m_dataSpace; }
+    inline void setDataSpace(const QRect &dataSpace) { m_dataSpace = dataSpace; }
+    inline QVector<int> &lodRows() { return m_lodRows; }
+    inline QVector<int> &lodColumns() { return m_lodColumns; }
+    // Mapping between the sampled vertices and the data array
+    inline int dataRow(int sampleRow) const
+    {
+        return m_lodLevel ? m_lodRows.at(sampleRow) : m_sampleSpace.y() + sampleRow;
+    }
+    inline int dataColumn(int sampleColumn) const
+    {
+        return m_lodLevel ? m_lodColumns.at(sampleColumn) : m_sampleSpace.x() + sampleColumn;
+    }
+    int sampleRow(int dataRow) const;
+    int sampleColumn(int dataColumn) const;
 
 protected:
     bool m_surfaceVisible;
@@ -119,6 +144,15 @@ protected:
     bool m_slicePointerActive;
     bool m_mainPointerActive;
     GLuint m_surfaceTexture;
+    int m_scrolledRows; // Rows scrolled in the proxy since the last data update
+    bool m_levelOfDetailEnabled;
+    SurfaceLodPyramid m_lodPyramid;
+    bool m_lodPyramidDirty;
+    int m_lodLevel; // Level of the sampled data, 0 if not decimated
+    QRect m_dataSpace; // Data array area the samples cover
+    // Data rows and columns of the sampled vertices, when decimated
+    QVector<int> m_lodRows;
+    QVector<int> m_lodColumns;
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -44,7 +44,7 @@
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
-class AbstractObjectHelper: protected QOpenGLFunctions
+class QT_DATAVISUALIZATION_EXPORT AbstractObjectHelper: protected QOpenGLFunctions
 {
 protected:
     AbstractObjectHelper();
@@ -0,0 +1,83 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "barinstancebufferhelper_p.h"
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+BarInstanceBufferHelper::BarInstanceBufferHelper()
+    : m_instanceBuffer(0),
+      m_instanceCount(0),
+      m_bufferCapacity(0),
+      m_negativeStart(0)
+{
+    initializeOpenGLFunctions();
+}
+
+BarInstanceBufferHelper::~BarInstanceBufferHelper()
+{
+    if (QOpenGLContext::currentContext())
+        glDeleteBuffers(1, &m_instanceBuffer);
+}
+
+void BarInstanceBufferHelper::load(const QVector<BarInstance> &instances, int negativeStart)
+{
+    m_instanceCount = instances.size();
+    m_negativeStart = negativeStart;
+
+    if (!m_instanceCount)
+        return;
+
+    if (!m_instanceBuffer)
+        glGenBuffers(1, &m_instanceBuffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+    // Keep the buffer object when the data fits, the instance count rarely grows between loads
+    if (m_instanceCount > m_bufferCapacity) {
+        glBufferData(GL_ARRAY_BUFFER, m_instanceCount * sizeof(BarInstance),
+                     instances.constData(), GL_DYNAMIC_DRAW);
+        m_bufferCapacity = m_instanceCount;
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_instanceCount * sizeof(BarInstance),
+                        instances.constData());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BarInstanceBufferHelper::clear()
+{
+    if (QOpenGLContext::currentContext())
+        glDeleteBuffers(1, &m_instanceBuffer);
+    m_instanceBuffer = 0;
+    m_instanceCount = 0;
+    m_bufferCapacity = 0;
+    m_negativeStart = 0;
+}
+
+QT_END_NAMESPACE_DATAVISUALIZATION
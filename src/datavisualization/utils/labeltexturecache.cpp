@@ -0,0 +1,95 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "labeltexturecache_p.h"
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+// Number of unused textures kept for reuse
+const int maxUnusedLabelTextures = 64;
+
+LabelTextureCache::LabelTextureCache()
+{
+}
+
+LabelTextureCache::~LabelTextureCache()
+{
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (context) {
+        foreach (const Entry &entry, m_entries)
+            context->functions()->glDeleteTextures(1, &entry.textureId);
+    }
+}
+
+// Returns the texture for the key and adds a reference to it, or zero if there is none
+GLuint LabelTextureCache::acquire(const QString &key, QSize &size)
+{
+    QHash<QString, Entry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+        return 0;
+
+    if (!it->refCount++)
+        m_unusedKeys.removeOne(key);
+    size = it->size;
+    return it->textureId;
+}
+
+// Adds a new texture with one reference. Drops the oldest unused textures if there are too many.
+void LabelTextureCache::insert(const QString &key, GLuint textureId, const QSize &size)
+{
+    Entry entry;
+    entry.textureId = textureId;
+    entry.size = size;
+    entry.refCount = 1;
+    m_entries.insert(key, entry);
+    m_keys.insert(textureId, key);
+
+    // Without a current context the textures can't be deleted, so they are kept until the next
+    // insert made with one
+    if (QOpenGLContext *context = QOpenGLContext::currentContext()) {
+        while (m_unusedKeys.size() > maxUnusedLabelTextures) {
+            Entry oldEntry = m_entries.take(m_unusedKeys.takeFirst());
+            m_keys.remove(oldEntry.textureId);
+            context->functions()->glDeleteTextures(1, &oldEntry.textureId);
+        }
+    }
+}
+
+void LabelTextureCache::release(GLuint textureId)
+{
+    QHash<GLuint, QString>::const_iterator keyIt = m_keys.constFind(textureId);
+    if (keyIt == m_keys.constEnd())
+        return;
+
+    Entry &entry = m_entries[keyIt.value()];
+    if (!--entry.refCount)
+        m_unusedKeys.append(keyIt.value());
+}
+
+QT_END_NAMESPACE_DATAVISUALIZATION
@@ -0,0 +1,79 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef LABELTEXTURECACHE_P_H
+#define LABELTEXTURECACHE_P_H
+
+#include "datavisualizationglobal_p.h"
+#include <QtCore/QHash>
+#include <QtCore/QSize>
+#include <QtCore/QStringList>
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+// Label textures shared by all label items that show the same text with the same style.
+// Textures are reference counted, and a few unused ones are kept for a while, so that labels
+// shifting between axis label slots while an axis is dragged don't need to be rasterized again.
+class LabelTextureCache
+{
+public:
+    LabelTextureCache();
+    ~LabelTextureCache();
+
+    GLuint acquire(const QString &key, QSize &size);
+    void insert(const QString &key, GLuint textureId, const QSize &size);
+    void release(GLuint textureId);
+
+private:
+    Q_DISABLE_COPY(LabelTextureCache)
+
+    struct Entry {
+        GLuint textureId;
+        QSize size;
+        int refCount;
+    };
+
+    QHash<QString, Entry> m_entries;
+    QHash<GLuint, QString> m_keys;
+    QStringList m_unusedKeys; // Entries without references, the oldest first
+};
+
+QT_END_NAMESPACE_DATAVISUALIZATION
+
+#endif
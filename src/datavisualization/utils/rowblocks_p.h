@@ -0,0 +1,103 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef ROWBLOCKS_P_H
+#define ROWBLOCKS_P_H
+
+#include "datavisualizationglobal_p.h"
+#include <QtCore/QRunnable>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+template <typename Function>
+class RowBlockTask : public QRunnable
+{
+public:
+    RowBlockTask(const Function &function, int block, int startRow, int endRow,
+                 QSemaphore *finished)
+        : m_function(function),
+          m_block(block),
+          m_startRow(startRow),
+          m_endRow(endRow),
+          m_finished(finished)
+    {
+    }
+
+    void run()
+    {
+        m_function(m_block, m_startRow, m_endRow);
+        m_finished->release();
+    }
+
+private:
+    const Function &m_function;
+    int m_block;
+    int m_startRow;
+    int m_endRow;
+    QSemaphore *m_finished;
+};
+
+// Calls function(block, startRow, endRow) for each of the blocks of rows. The blocks are
+// processed in parallel in the global thread pool, the first one on the calling thread.
+// Returns once all blocks are done.
+template <typename Function>
+static void forEachRowBlock(int rowCount, int blockCount, const Function &function)
+{
+    if (blockCount <= 1) {
+        function(0, 0, rowCount);
+        return;
+    }
+
+    QSemaphore finished;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    for (int block = 1; block < blockCount; block++) {
+        pool->start(new RowBlockTask<Function>(function, block,
+                                               block * rowCount / blockCount,
+                                               (block + 1) * rowCount / blockCount,
+                                               &finished));
+    }
+    function(0, 0, rowCount / blockCount);
+    finished.acquire(blockCount - 1);
+}
+
+QT_END_NAMESPACE_DATAVISUALIZATION
+
+#endif
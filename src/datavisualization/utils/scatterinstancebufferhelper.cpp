@@ -0,0 +1,137 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "scatterinstancebufferhelper_p.h"
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+ScatterInstanceBufferHelper::ScatterInstanceBufferHelper()
+    : m_instanceBuffer(0),
+      m_instanceCount(0),
+      m_bufferCapacity(0)
+{
+    initializeOpenGLFunctions();
+}
+
+ScatterInstanceBufferHelper::~ScatterInstanceBufferHelper()
+{
+    if (QOpenGLContext::currentContext())
+        glDeleteBuffers(1, &m_instanceBuffer);
+}
+
+void ScatterInstanceBufferHelper::load(ScatterSeriesRenderCache *cache)
+{
+    const ScatterRenderItemArray &renderArray = cache->renderArray();
+    m_instanceCount = renderArray.size();
+
+    if (!m_instanceCount)
+        return;
+
+    // Every render item gets an instance, so that the instance of an item is found at its
+    // render array index and single items can be updated in place
+    QVector<ScatterInstance> instances(m_instanceCount);
+    ScatterInstance *instanceData = instances.data();
+    for (int i = 0; i < m_instanceCount; i++)
+        fillInstance(instanceData[i], renderArray.at(i), i);
+
+    if (!m_instanceBuffer)
+        glGenBuffers(1, &m_instanceBuffer);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+    if (m_instanceCount > m_bufferCapacity) {
+        glBufferData(GL_ARRAY_BUFFER, m_instanceCount * sizeof(ScatterInstance),
+                     instances.constData(), GL_DYNAMIC_DRAW);
+        m_bufferCapacity = m_instanceCount;
+    } else {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_instanceCount * sizeof(ScatterInstance),
+                        instances.constData());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ScatterInstanceBufferHelper::update(ScatterSeriesRenderCache *cache)
+{
+    const ScatterRenderItemArray &renderArray = cache->renderArray();
+    const QVector<int> &updateIndices = cache->updateIndices();
+    const int updateSize = updateIndices.size();
+
+    if (!updateSize || !m_instanceBuffer)
+        return;
+
+    if (renderArray.size() != m_instanceCount) {
+        load(cache);
+        return;
+    }
+
+    QVector<ScatterInstance> instances(updateSize);
+    ScatterInstance *instanceData = instances.data();
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+    // Consecutive indexes are uploaded with a single call
+    int runStart = 0;
+    for (int i = 0; i < updateSize; i++) {
+        const int index = updateIndices.at(i);
+        fillInstance(instanceData[i], renderArray.at(index), index);
+        if (i + 1 == updateSize || updateIndices.at(i + 1) != index + 1) {
+            const int firstIndex = updateIndices.at(runStart);
+            glBufferSubData(GL_ARRAY_BUFFER, firstIndex * sizeof(ScatterInstance),
+                            (i + 1 - runStart) * sizeof(ScatterInstance),
+                            instanceData + runStart);
+            runStart = i + 1;
+        }
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ScatterInstanceBufferHelper::clear()
+{
+    if (QOpenGLContext::currentContext())
+        glDeleteBuffers(1, &m_instanceBuffer);
+    m_instanceBuffer = 0;
+    m_instanceCount = 0;
+    m_bufferCapacity = 0;
+}
+
+void ScatterInstanceBufferHelper::fillInstance(ScatterInstance &instance,
+                                               const ScatterRenderItem &item, int index)
+{
+    const QVector3D &translation = item.translation();
+    const QQuaternion rotation = item.rotation().normalized();
+    instance.x = translation.x();
+    instance.y = translation.y();
+    instance.z = translation.z();
+    instance.scale = item.isVisible() ? 1.0f : 0.0f;
+    instance.rotationX = rotation.x();
+    instance.rotationY = rotation.y();
+    instance.rotationZ = rotation.z();
+    instance.rotationScalar = rotation.scalar();
+    instance.index = GLfloat(index);
+}
+
+QT_END_NAMESPACE_DATAVISUALIZATION
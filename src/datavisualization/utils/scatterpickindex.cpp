@@ -0,0 +1,216 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "scatterpickindex_p.h"
+#include "scatterseriesrendercache_p.h"
+#include <QtGui/QVector4D>
+#include <QtCore/qmath.h>
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+// Grid resolution is chosen so that cells have about this many items on average
+const int itemsPerPickCell = 32;
+
+ScatterPickIndex::ScatterPickIndex()
+{
+}
+
+void ScatterPickIndex::build(const ScatterSeriesRenderCache *cache)
+{
+    clear();
+
+    const int itemCount = cache->itemCount();
+    int visibleCount = 0;
+    QVector3D minBounds;
+    QVector3D maxBounds;
+    QVector3D pos;
+    for (int i = 0; i < itemCount; i++) {
+        if (!cache->itemTranslation(i, pos))
+            continue;
+        if (!visibleCount++) {
+            minBounds = pos;
+            maxBounds = pos;
+        } else {
+            minBounds.setX(qMin(pos.x(), minBounds.x()));
+            minBounds.setY(qMin(pos.y(), minBounds.y()));
+            minBounds.setZ(qMin(pos.z(), minBounds.z()));
+            maxBounds.setX(qMax(pos.x(), maxBounds.x()));
+            maxBounds.setY(qMax(pos.y(), maxBounds.y()));
+            maxBounds.setZ(qMax(pos.z(), maxBounds.z()));
+        }
+    }
+    if (!visibleCount)
+        return;
+
+    const int resolution = qMax(1, qRound(qPow(qreal(visibleCount) / itemsPerPickCell,
+                                               1.0 / 3.0)));
+    const QVector3D extent = maxBounds - minBounds;
+    const QVector3D cellScale(extent.x() > 0.0f ? resolution / extent.x() : 0.0f,
+                              extent.y() > 0.0f ? resolution / extent.y() : 0.0f,
+                              extent.z() > 0.0f ? resolution / extent.z() : 0.0f);
+    const int cellCount = resolution * resolution * resolution;
+
+    // Sort the visible items by cell
+    QVector<int> itemCells(itemCount, -1);
+    QVector<int> cellStarts(cellCount + 1, 0);
+    for (int i = 0; i < itemCount; i++) {
+        if (!cache->itemTranslation(i, pos))
+            continue;
+        const QVector3D cellPos = (pos - minBounds) * cellScale;
+        const int x = qMin(int(cellPos.x()), resolution - 1);
+        const int y = qMin(int(cellPos.y()), resolution - 1);
+        const int z = qMin(int(cellPos.z()), resolution - 1);
+        const int cell = (z * resolution + y) * resolution + x;
+        itemCells[i] = cell;
+        cellStarts[cell + 1]++;
+    }
+    for (int cell = 0; cell < cellCount; cell++)
+        cellStarts[cell + 1] += cellStarts[cell];
+
+    m_itemIndices.resize(visibleCount);
+    m_positions.resize(visibleCount);
+    QVector<int> cellEnds = cellStarts;
+    for (int i = 0; i < itemCount; i++) {
+        const int cell = itemCells.at(i);
+        if (cell < 0)
+            continue;
+        const int p = cellEnds[cell]++;
+        m_itemIndices[p] = i;
+        cache->itemTranslation(i, m_positions[p]);
+    }
+
+    // Keep the non-empty cells with the bounds of their items
+    for (int cell = 0; cell < cellCount; cell++) {
+        const int start = cellStarts.at(cell);
+        const int end = cellStarts.at(cell + 1);
+        if (start == end)
+            continue;
+        Cell newCell;
+        newCell.start = start;
+        newCell.count = end - start;
+        newCell.minBounds = m_positions.at(start);
+        newCell.maxBounds = newCell.minBounds;
+        for (int p = start + 1; p < end; p++) {
+            const QVector3D &pos = m_positions.at(p);
+            newCell.minBounds.setX(qMin(pos.x(), newCell.minBounds.x()));
+            newCell.minBounds.setY(qMin(pos.y(), newCell.minBounds.y()));
+            newCell.minBounds.setZ(qMin(pos.z(), newCell.minBounds.z()));
+            newCell.maxBounds.setX(qMax(pos.x(), newCell.maxBounds.x()));
+            newCell.maxBounds.setY(qMax(pos.y(), newCell.maxBounds.y()));
+            newCell.maxBounds.setZ(qMax(pos.z(), newCell.maxBounds.z()));
+        }
+        m_cells.append(newCell);
+    }
+}
+
+void ScatterPickIndex::clear()
+{
+    m_cells.clear();
+    m_itemIndices.clear();
+    m_positions.clear();
+}
+
+// Returns the index of the item closest to the viewer that covers the position, or -1 if there
+// is none. Position and viewport are in pixels, with the origin at the bottom left corner.
+// Items are discs of worldRadius scene units, scaled to pixels by pixelScale / w, plus
+// pixelRadius pixels. The normalized depth of the found item is stored to depth.
+int ScatterPickIndex::pick(const QMatrix4x4 &projectionViewMatrix, const QSizeF &viewportSize,
+                           const QPointF &position, float pixelScale, float worldRadius,
+                           float pixelRadius, float &depth) const
+{
+    const float halfWidth = float(viewportSize.width()) / 2.0f;
+    const float halfHeight = float(viewportSize.height()) / 2.0f;
+    const float cursorX = float(position.x());
+    const float cursorY = float(position.y());
+    const QVector3D radius(worldRadius, worldRadius, worldRadius);
+
+    int pickedIndex = -1;
+    foreach (const Cell &cell, m_cells) {
+        // Screen rectangle of the cell bounds
+        const QVector3D minBounds = cell.minBounds - radius;
+        const QVector3D maxBounds = cell.maxBounds + radius;
+        float minX = 0.0f;
+        float maxX = 0.0f;
+        float minY = 0.0f;
+        float maxY = 0.0f;
+        float maxRadius = 0.0f;
+        bool behindViewer = false;
+        for (int corner = 0; corner < 8 && !behindViewer; corner++) {
+            const QVector4D clip = projectionViewMatrix * QVector4D(
+                        (corner & 1) ? maxBounds.x() : minBounds.x(),
+                        (corner & 2) ? maxBounds.y() : minBounds.y(),
+                        (corner & 4) ? maxBounds.z() : minBounds.z(),
+                        1.0f);
+            if (clip.w() <= 0.0f) {
+                // Screen bounds can't be calculated, so test all items of the cell
+                behindViewer = true;
+                break;
+            }
+            const float x = (clip.x() / clip.w() + 1.0f) * halfWidth;
+            const float y = (clip.y() / clip.w() + 1.0f) * halfHeight;
+            if (!corner) {
+                minX = maxX = x;
+                minY = maxY = y;
+            } else {
+                minX = qMin(x, minX);
+                maxX = qMax(x, maxX);
+                minY = qMin(y, minY);
+                maxY = qMax(y, maxY);
+            }
+            maxRadius = qMax(pixelRadius + worldRadius * pixelScale / clip.w(), maxRadius);
+        }
+        if (!behindViewer && (cursorX < minX - maxRadius || cursorX > maxX + maxRadius
+                              || cursorY < minY - maxRadius || cursorY > maxY + maxRadius)) {
+            continue;
+        }
+
+        const int end = cell.start + cell.count;
+        for (int p = cell.start; p < end; p++) {
+            const QVector4D clip = projectionViewMatrix * QVector4D(m_positions.at(p), 1.0f);
+            if (clip.w() <= 0.0f)
+                continue;
+            const float itemDepth = clip.z() / clip.w();
+            if (itemDepth < -1.0f || itemDepth > 1.0f
+                    || (pickedIndex >= 0 && itemDepth >= depth)) {
+                continue;
+            }
+            const float dx = (clip.x() / clip.w() + 1.0f) * halfWidth - cursorX;
+            const float dy = (clip.y() / clip.w() + 1.0f) * halfHeight - cursorY;
+            const float itemRadius = pixelRadius + worldRadius * pixelScale / clip.w();
+            if (dx * dx + dy * dy <= itemRadius * itemRadius) {
+                pickedIndex = m_itemIndices.at(p);
+                depth = itemDepth;
+            }
+        }
+    }
+
+    return pickedIndex;
+}
+
+QT_END_NAMESPACE_DATAVISUALIZATION
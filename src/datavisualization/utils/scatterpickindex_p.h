@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef SCATTERPICKINDEX_P_H
+#define SCATTERPICKINDEX_P_H
+
+#include "datavisualizationglobal_p.h"
+#include <QtGui/QMatrix4x4>
+#include <QtCore/QPointF>
+#include <QtCore/QSizeF>
+#include <QtCore/QVector>
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+class ScatterSeriesRenderCache;
+
+// Uniform grid of the visible items of a scatter series, used to find the item under a screen
+// position without rendering the selection buffer. Each non-empty grid cell keeps the bounds of
+// its items, so that only the items of the cells covering the screen position are tested.
+class ScatterPickIndex
+{
+public:
+    ScatterPickIndex();
+
+    void build(const ScatterSeriesRenderCache *cache);
+    void clear();
+    inline bool isEmpty() const { return m_cells.isEmpty(); }
+    // Visible items of the index, in cell order
+    inline int entryCount() const { return m_itemIndices.size(); }
+    inline int entryItemIndex(int entry) const { return m_itemIndices.at(entry); }
+    inline const QVector3D &entryPosition(int entry) const { return m_positions.at(entry); }
+
+    int pick(const QMatrix4x4 &projectionViewMatrix, const QSizeF &viewportSize,
+             const QPointF &position, float pixelScale, float worldRadius, float pixelRadius,
+             float &depth) const;
+
+private:
+    struct Cell {
+        int start; // Range of the cell in m_itemIndices and m_positions
+        int count;
+        QVector3D minBounds;
+        QVector3D maxBounds;
+    };
+
+    QVector<Cell> m_cells;
+    QVector<int> m_itemIndices;
+    QVector<QVector3D> m_positions;
+};
+
+QT_END_NAMESPACE_DATAVISUALIZATION
+
+#endif
@@ -28,14 +28,31 @@
 ****************************************************************************/
 
 #include "scatterpointbufferhelper_p.h"
+#include "utils_p.h"
 #include <QtGui/QVector2D>
+#include <QtGui/QOpenGLExtraFunctions>
+
+#include <algorithm>
+
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_INVALIDATE_RANGE_BIT
+#define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+#endif
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
 const QVector3D hiddenPos(-1000.0f, -1000.0f, -1000.0f);
+// Points are converted from the render items to the buffer in chunks of this size, so that
+// no copy of the whole buffer needs to be kept in memory
+const int pointChunkSize = 16384;
+// Updates spanning at most this many points per changed point rewrite the whole span
+const int maxSpanPerUpdatedPoint = 8;
 
 ScatterPointBufferHelper::ScatterPointBufferHelper()
     : m_pointbuffer(0),
+      m_pointCapacity(0),
       m_oldRemoveIndex(-1)
 {
 }
@@ -53,14 +70,14 @@ GLuint ScatterPointBufferHelper::pointBuf()
     return m_pointbuffer;
 }
 
-void ScatterPointBufferHelper::pushPoint(uint pointIndex)
+void ScatterPointBufferHelper::pushPoint(ScatterSeriesRenderCache *cache, uint pointIndex)
 {
     glBindBuffer(GL_ARRAY_BUFFER, m_pointbuffer);
 
     // Pop the previous point if it is still pushed
     if (m_oldRemoveIndex >= 0) {
         glBufferSubData(GL_ARRAY_BUFFER, m_oldRemoveIndex * sizeof(QVector3D),
-                        sizeof(QVector3D), &m_bufferedPoints.at(m_oldRemoveIndex));
+                        sizeof(QVector3D), &m_oldRemovePoint);
     }
 
     glBufferSubData(GL_ARRAY_BUFFER, pointIndex * sizeof(QVector3D),
@@ -70,6 +87,7 @@ void ScatterPointBufferHelper::pushPoint(uint pointIndex)
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
     m_oldRemoveIndex = pointIndex;
+    m_oldRemovePoint = bufferedPoint(cache, pointIndex);
 }
 
 void ScatterPointBufferHelper::popPoint()
@@ -77,7 +95,7 @@ void ScatterPointBufferHelper::popPoint()
     if (m_oldRemoveIndex >= 0) {
         glBindBuffer(GL_ARRAY_BUFFER, m_pointbuffer);
         glBufferSubData(GL_ARRAY_BUFFER, m_oldRemoveIndex * sizeof(QVector3D),
-                        sizeof(QVector3D), &m_bufferedPoints.at(m_oldRemoveIndex));
+                        sizeof(QVector3D), &m_oldRemovePoint);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
@@ -86,47 +104,39 @@ void ScatterPointBufferHelper::popPoint()
 
 void ScatterPointBufferHelper::load(ScatterSeriesRenderCache *cache)
 {
-    ScatterRenderItemArray &renderArray = cache->renderArray();
-    const int renderArraySize = renderArray.size();
+    const int itemCount = cache->itemCount();
     m_indexCount = 0;
 
-    if (m_meshDataLoaded) {
-        // Delete old data
-        glDeleteBuffers(1, &m_pointbuffer);
-        glDeleteBuffers(1, &m_uvbuffer);
-        m_bufferedPoints.clear();
-        m_pointbuffer = 0;
-        m_uvbuffer = 0;
-    }
+    // The new data has all points in place
+    m_oldRemoveIndex = -1;
 
     bool itemsVisible = false;
-    m_bufferedPoints.resize(renderArraySize);
-    for (int i = 0; i < renderArraySize; i++) {
-        const ScatterRenderItem &item = renderArray.at(i);
-        if (!item.isVisible()) {
-            m_bufferedPoints[i] = hiddenPos;
-        } else {
-            itemsVisible = true;
-            m_bufferedPoints[i] = item.translation();
-        }
-    }
+    QVector3D translation;
+    for (int i = 0; i < itemCount && !itemsVisible; i++)
+        itemsVisible = cache->itemTranslation(i, translation);
 
     QVector<QVector2D> buffered_uvs;
     if (itemsVisible)
-        m_indexCount = renderArraySize;
+        m_indexCount = itemCount;
 
     if (m_indexCount > 0) {
         if (cache->colorStyle() == Q3DTheme::ColorStyleRangeGradient)
             createRangeGradientUVs(cache, buffered_uvs);
 
-        glGenBuffers(1, &m_pointbuffer);
+        // Buffer objects are kept over reloads. The point storage is only reallocated when
+        // it is too small, otherwise it is orphaned, so that the driver doesn't need to wait
+        // for draws still using the old contents.
+        if (!m_pointbuffer)
+            glGenBuffers(1, &m_pointbuffer);
         glBindBuffer(GL_ARRAY_BUFFER, m_pointbuffer);
-        glBufferData(GL_ARRAY_BUFFER, m_bufferedPoints.size() * sizeof(QVector3D),
-                     &m_bufferedPoints.at(0),
+        m_pointCapacity = qMax(m_pointCapacity, itemCount);
+        glBufferData(GL_ARRAY_BUFFER, m_pointCapacity * sizeof(QVector3D), 0,
                      GL_DYNAMIC_DRAW);
+        writePoints(cache, 0, itemCount);
 
         if (buffered_uvs.size()) {
-            glGenBuffers(1, &m_uvbuffer);
+            if (!m_uvbuffer)
+                glGenBuffers(1, &m_uvbuffer);
             glBindBuffer(GL_ARRAY_BUFFER, m_uvbuffer);
             glBufferData(GL_ARRAY_BUFFER, buffered_uvs.size() * sizeof(QVector2D),
                          &buffered_uvs.at(0), GL_STATIC_DRAW);
@@ -142,23 +152,42 @@ void ScatterPointBufferHelper::update(ScatterSeriesRenderCache *cache)
 {
     // It may be that the buffer hasn't yet been initialized, in case the entire series was
     // hidden items. No need to update in that case.
-    if (m_indexCount > 0) {
-        const ScatterRenderItemArray &renderArray = cache->renderArray();
-        const int updateSize = cache->updateIndices().size();
+    const QVector<int> &updateIndices = cache->updateIndices();
+    const int updateSize = updateIndices.size();
+    if (m_indexCount > 0 && updateSize) {
+        int first = updateIndices.at(0);
+        int last = first;
+        for (int i = 1; i < updateSize; i++) {
+            first = qMin(first, updateIndices.at(i));
+            last = qMax(last, updateIndices.at(i));
+        }
+        const int span = last - first + 1;
 
         glBindBuffer(GL_ARRAY_BUFFER, m_pointbuffer);
-        for (int i = 0; i < updateSize; i++) {
-            int index = cache->updateIndices().at(i);
-            const ScatterRenderItem &item = renderArray.at(index);
-            if (!item.isVisible())
-                m_bufferedPoints[index] = hiddenPos;
-            else
-                m_bufferedPoints[index] = item.translation();
-
-            if (index != m_oldRemoveIndex) {
-                glBufferSubData(GL_ARRAY_BUFFER, index * sizeof(QVector3D),
-                                sizeof(QVector3D), &m_bufferedPoints.at(index));
+        if (span <= updateSize * maxSpanPerUpdatedPoint) {
+            // Changes are dense enough that rewriting the whole span is cheapest
+            writePoints(cache, first, span);
+        } else {
+            // Sparse changes are written as runs of consecutive points. Mapping the span
+            // without invalidating it would have to wait for the draws still using the buffer.
+            QVector<int> indices = updateIndices;
+            std::sort(indices.begin(), indices.end());
+            QVector<QVector3D> run;
+            int runStart = indices.at(0);
+            for (int i = 0; i < updateSize; i++) {
+                const int index = indices.at(i);
+                if (index == runStart + run.size() - 1)
+                    continue; // Duplicate index
+                if (index != runStart + run.size()) {
+                    glBufferSubData(GL_ARRAY_BUFFER, runStart * sizeof(QVector3D),
+                                    run.size() * sizeof(QVector3D), &run.at(0));
+                    run.clear();
+                    runStart = index;
+                }
+                run.append(bufferPointAt(cache, index));
             }
+            glBufferSubData(GL_ARRAY_BUFFER, runStart * sizeof(QVector3D),
+                            run.size() * sizeof(QVector3D), &run.at(0));
         }
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
@@ -198,21 +227,83 @@ void ScatterPointBufferHelper::updateUVs(ScatterSeriesRenderCache *cache)
 void ScatterPointBufferHelper::createRangeGradientUVs(ScatterSeriesRenderCache *cache,
                                                       QVector<QVector2D> &buffered_uvs)
 {
-    const ScatterRenderItemArray &renderArray = cache->renderArray();
     const bool updateAll = (cache->updateIndices().size() == 0);
-    const int updateSize = updateAll ? renderArray.size() : cache->updateIndices().size();
+    const int updateSize = updateAll ? cache->itemCount() : cache->updateIndices().size();
     buffered_uvs.resize(updateSize);
 
     QVector2D uv;
     uv.setX(0.0f);
+    QVector3D translation;
     for (int i = 0; i < updateSize; i++) {
         int index = updateAll ? i : cache->updateIndices().at(i);
-        const ScatterRenderItem &item = renderArray.at(index);
+        cache->itemTranslation(index, translation);
 
-        float y = ((item.translation().y() + m_scaleY) * 0.5f) / m_scaleY;
+        float y = ((translation.y() + m_scaleY) * 0.5f) / m_scaleY;
         uv.setY(y);
         buffered_uvs[i] = uv;
     }
 }
 
+QVector3D ScatterPointBufferHelper::bufferedPoint(const ScatterSeriesRenderCache *cache,
+                                                  int index)
+{
+    QVector3D translation;
+    return cache->itemTranslation(index, translation) ? translation : hiddenPos;
+}
+
+// Returns the buffer value of the point, the pushed point stays hidden until it is popped
+QVector3D ScatterPointBufferHelper::bufferPointAt(const ScatterSeriesRenderCache *cache,
+                                                 int index)
+{
+    if (index == m_oldRemoveIndex) {
+        m_oldRemovePoint = bufferedPoint(cache, index);
+        return hiddenPos;
+    }
+    return bufferedPoint(cache, index);
+}
+
+// Writes points [start, start + count) to the bound point buffer
+void ScatterPointBufferHelper::writePoints(const ScatterSeriesRenderCache *cache, int start,
+                                           int count)
+{
+    QVector3D *points = mapPoints(start, count, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    if (points) {
+        for (int i = 0; i < count; i++)
+            points[i] = bufferPointAt(cache, start + i);
+        if (unmapPoints())
+            return;
+        // The whole buffer is undefined after a failed unmap, so all points are written again
+        start = 0;
+        count = m_indexCount;
+    }
+
+    QVector<QVector3D> chunk(qMin(count, pointChunkSize));
+    for (int chunkStart = 0; chunkStart < count; chunkStart += pointChunkSize) {
+        int chunkCount = qMin(pointChunkSize, count - chunkStart);
+        for (int i = 0; i < chunkCount; i++)
+            chunk[i] = bufferPointAt(cache, start + chunkStart + i);
+        glBufferSubData(GL_ARRAY_BUFFER, (start + chunkStart) * sizeof(QVector3D),
+                        chunkCount * sizeof(QVector3D), &chunk.at(0));
+    }
+}
+
+// Maps a range of the bound point buffer, returns null if mapping is not supported
+QVector3D *ScatterPointBufferHelper::mapPoints(int start, int count, GLbitfield access)
+{
+    if (!Utils::isBufferMappingSupported())
+        return 0;
+
+    QOpenGLExtraFunctions *extraFuncs = QOpenGLContext::currentContext()->extraFunctions();
+    return static_cast<QVector3D *>(extraFuncs->glMapBufferRange(GL_ARRAY_BUFFER,
+                                                                 start * sizeof(QVector3D),
+                                                                 count * sizeof(QVector3D),
+                                                                 access));
+}
+
+bool ScatterPointBufferHelper::unmapPoints()
+{
+    QOpenGLExtraFunctions *extraFuncs = QOpenGLContext::currentContext()->extraFunctions();
+    return extraFuncs->glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+}
+
 QT_END_NAMESPACE_DATAVISUALIZATION
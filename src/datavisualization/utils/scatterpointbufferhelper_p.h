@@ -46,7 +46,7 @@
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
-class ScatterPointBufferHelper : public AbstractObjectHelper
+class QT_DATAVISUALIZATION_EXPORT ScatterPointBufferHelper : public AbstractObjectHelper
 {
 public:
     ScatterPointBufferHelper();
@@ -54,7 +54,7 @@ public:
 
     GLuint pointBuf();
 
-    void pushPoint(uint pointIndex);
+    void pushPoint(ScatterSeriesRenderCache *cache, uint pointIndex);
     void popPoint();
     void load(ScatterSeriesRenderCache *cache);
     void update(ScatterSeriesRenderCache *cache);
@@ -67,10 +67,16 @@ public:
 private:
     void createRangeGradientUVs(ScatterSeriesRenderCache *cache,
                                 QVector<QVector2D> &buffered_uvs);
+    static inline QVector3D bufferedPoint(const ScatterSeriesRenderCache *cache, int index);
+    inline QVector3D bufferPointAt(const ScatterSeriesRenderCache *cache, int index);
+    void writePoints(const ScatterSeriesRenderCache *cache, int start, int count);
+    QVector3D *mapPoints(int start, int count, GLbitfield access);
+    bool unmapPoints();
 
 private:
-    QVector<QVector3D> m_bufferedPoints;
+    int m_pointCapacity; // Number of points the point buffer storage has room for
     int m_oldRemoveIndex;
+    QVector3D m_oldRemovePoint; // Buffered value of the point hidden by pushPoint()
     float m_scaleY;
 };
 
@@ -55,6 +55,9 @@ ShaderHelper::ShaderHelper(QObject *parent,
       m_positionAttr(0),
       m_uvAttr(0),
       m_normalAttr(0),
+      m_instanceAttr(0),
+      m_instanceIndexAttr(0),
+      m_instanceRotationAttr(0),
       m_colorUniform(0),
       m_viewMatrixUniform(0),
       m_modelMatrixUniform(0),
@@ -80,7 +83,15 @@ ShaderHelper::ShaderHelper(QObject *parent,
       m_preserveOpacityUniform(0),
       m_minBoundsUniform(0),
       m_maxBoundsUniform(0),
+      m_brickOffsetUniform(0),
+      m_brickScaleUniform(0),
+      m_occupancyUniform(0),
+      m_occupancyCellSizeUniform(0),
+      m_occupancyScaleUniform(0),
       m_sliceFrameWidthUniform(0),
+      m_instanceScaleUniform(0),
+      m_instanceGradientUniform(0),
+      m_instanceIndexOffsetUniform(0),
       m_initialized(false)
 {
 }
@@ -118,6 +129,9 @@ void ShaderHelper::initialize()
     m_positionAttr = m_program->attributeLocation("vertexPosition_mdl");
     m_normalAttr = m_program->attributeLocation("vertexNormal_mdl");
     m_uvAttr = m_program->attributeLocation("vertexUV");
+    m_instanceAttr = m_program->attributeLocation("instanceData");
+    m_instanceIndexAttr = m_program->attributeLocation("instanceIndex");
+    m_instanceRotationAttr = m_program->attributeLocation("instanceRotation");
 
     m_mvpMatrixUniform = m_program->uniformLocation("MVP");
     m_viewMatrixUniform = m_program->uniformLocation("V");
@@ -144,7 +158,15 @@ void ShaderHelper::initialize()
     m_preserveOpacityUniform = m_program->uniformLocation("preserveOpacity");
     m_minBoundsUniform = m_program->uniformLocation("minBounds");
     m_maxBoundsUniform = m_program->uniformLocation("maxBounds");
+    m_brickOffsetUniform = m_program->uniformLocation("brickOffset");
+    m_brickScaleUniform = m_program->uniformLocation("brickScale");
+    m_occupancyUniform = m_program->uniformLocation("occupancySampler");
+    m_occupancyCellSizeUniform = m_program->uniformLocation("occupancyCellSize");
+    m_occupancyScaleUniform = m_program->uniformLocation("occupancyScale");
     m_sliceFrameWidthUniform = m_program->uniformLocation("sliceFrameWidth");
+    m_instanceScaleUniform = m_program->uniformLocation("instanceScale");
+    m_instanceGradientUniform = m_program->uniformLocation("instanceGradient");
+    m_instanceIndexOffsetUniform = m_program->uniformLocation("instanceIndexOffset");
     m_initialized = true;
 }
 
@@ -387,6 +409,41 @@ GLint ShaderHelper::minBounds()
     return m_minBoundsUniform;
 }
 
+GLint ShaderHelper::brickOffset()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_brickOffsetUniform;
+}
+
+GLint ShaderHelper::brickScale()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_brickScaleUniform;
+}
+
+GLint ShaderHelper::occupancy()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_occupancyUniform;
+}
+
+GLint ShaderHelper::occupancyCellSize()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_occupancyCellSizeUniform;
+}
+
+GLint ShaderHelper::occupancyScale()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_occupancyScaleUniform;
+}
+
 GLint ShaderHelper::sliceFrameWidth()
 {
 
@@ -395,6 +452,27 @@ GLint ShaderHelper::sliceFrameWidth()
     return m_sliceFrameWidthUniform;
 }
 
+GLint ShaderHelper::instanceScale()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instanceScaleUniform;
+}
+
+GLint ShaderHelper::instanceGradient()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instanceGradientUniform;
+}
+
+GLint ShaderHelper::instanceIndexOffset()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instanceIndexOffsetUniform;
+}
+
 GLint ShaderHelper::posAtt()
 {
     if (!m_initialized)
@@ -416,4 +494,25 @@ GLint ShaderHelper::normalAtt()
     return m_normalAttr;
 }
 
+GLint ShaderHelper::instanceAtt()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instanceAttr;
+}
+
+GLint ShaderHelper::instanceIndexAtt()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instanceIndexAttr;
+}
+
+GLint ShaderHelper::instanceRotationAtt()
+{
+    if (!m_initialized)
+        qFatal("Shader not initialized");
+    return m_instanceRotationAttr;
+}
+
 QT_END_NAMESPACE_DATAVISUALIZATION
@@ -96,11 +96,22 @@ class ShaderHelper
     GLint preserveOpacity();
     GLint maxBounds();
     GLint minBounds();
+    GLint brickOffset();
+    GLint brickScale();
+    GLint occupancy();
+    GLint occupancyCellSize();
+    GLint occupancyScale();
     GLint sliceFrameWidth();
+    GLint instanceScale();
+    GLint instanceGradient();
+    GLint instanceIndexOffset();
 
     GLint posAtt();
     GLint uvAtt();
     GLint normalAtt();
+    GLint instanceAtt();
+    GLint instanceIndexAtt();
+    GLint instanceRotationAtt();
 
     private:
     QObject *m_caller;
@@ -115,6 +126,9 @@ class ShaderHelper
     GLint m_positionAttr;
     GLint m_uvAttr;
     GLint m_normalAttr;
+    GLint m_instanceAttr;
+    GLint m_instanceIndexAttr;
+    GLint m_instanceRotationAttr;
 
     GLint m_colorUniform;
     GLint m_viewMatrixUniform;
@@ -141,7 +155,15 @@ class ShaderHelper
     GLint m_preserveOpacityUniform;
     GLint m_minBoundsUniform;
     GLint m_maxBoundsUniform;
+    GLint m_brickOffsetUniform;
+    GLint m_brickScaleUniform;
+    GLint m_occupancyUniform;
+    GLint m_occupancyCellSizeUniform;
+    GLint m_occupancyScaleUniform;
     GLint m_sliceFrameWidthUniform;
+    GLint m_instanceScaleUniform;
+    GLint m_instanceGradientUniform;
+    GLint m_instanceIndexOffsetUniform;
 
     GLboolean m_initialized;
 };
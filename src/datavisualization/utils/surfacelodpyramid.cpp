@@ -0,0 +1,177 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "surfacelodpyramid_p.h"
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+// Levels smaller than this in either direction are not useful for drawing a surface
+const int minLevelSize = 2;
+
+SurfaceLodPyramid::SurfaceLodPyramid()
+    : m_dataRows(0),
+      m_dataColumns(0)
+{
+}
+
+void SurfaceLodPyramid::build(const QSurfaceDataArray &array)
+{
+    clear();
+    if (array.isEmpty())
+        return;
+
+    m_dataRows = array.size();
+    m_dataColumns = array.at(0)->size();
+
+    int rows = (m_dataRows + 1) / 2;
+    int columns = (m_dataColumns + 1) / 2;
+    while (rows >= minLevelSize && columns >= minLevelSize) {
+        m_levels.append(Level());
+        Level &level = m_levels.last();
+        level.rows = rows;
+        level.columns = columns;
+        level.minY.resize(rows * columns);
+        level.maxY.resize(rows * columns);
+        level.meanY.resize(rows * columns);
+        createCells(array, m_levels.size(), 0, rows, 0, columns);
+
+        rows = (rows + 1) / 2;
+        columns = (columns + 1) / 2;
+    }
+}
+
+void SurfaceLodPyramid::update(const QSurfaceDataArray &array, int startRow, int endRow,
+                               int startColumn, int endColumn)
+{
+    // Only the cells covering the changed items change on each level
+    for (int i = 1; i < levelCount(); i++) {
+        startRow >>= 1;
+        startColumn >>= 1;
+        endRow = (endRow + 1) >> 1;
+        endColumn = (endColumn + 1) >> 1;
+        createCells(array, i, startRow, endRow, startColumn, endColumn);
+    }
+}
+
+void SurfaceLodPyramid::clear()
+{
+    m_levels.clear();
+    m_dataRows = 0;
+    m_dataColumns = 0;
+}
+
+float SurfaceLodPyramid::valueAt(int level, int row, int column) const
+{
+    // Use the extreme further from the mean, so that the most prominent feature is shown
+    const Level &cells = m_levels.at(level - 1);
+    int index = (row >> level) * cells.columns + (column >> level);
+    float maxY = cells.maxY.at(index);
+    float minY = cells.minY.at(index);
+    float meanY = cells.meanY.at(index);
+    if (maxY - meanY >= meanY - minY)
+        return maxY;
+    else
+        return minY;
+}
+
+// Returns the finest level that has no more than one cell per display pixel, when dataSize
+// items are shown across displaySize pixels. Limited to the coarsest level there is.
+int SurfaceLodPyramid::levelFor(int dataSize, int displaySize) const
+{
+    int maxLevel = levelCount() - 1;
+    int level = 0;
+    while (level < maxLevel && (dataSize >> level) > displaySize)
+        level++;
+    return level;
+}
+
+void SurfaceLodPyramid::createCells(const QSurfaceDataArray &array, int level,
+                                    int startRow, int endRow, int startColumn, int endColumn)
+{
+    Level &cells = m_levels[level - 1];
+    endRow = qMin(endRow, cells.rows);
+    endColumn = qMin(endColumn, cells.columns);
+
+    for (int row = startRow; row < endRow; row++) {
+        for (int column = startColumn; column < endColumn; column++) {
+            float minY = 0.0f;
+            float maxY = 0.0f;
+            double sumY = 0.0;
+            int count = 0;
+            int sourceRowEnd = 2 * row + 2;
+            int sourceColumnEnd = 2 * column + 2;
+            if (level == 1) {
+                sourceRowEnd = qMin(sourceRowEnd, m_dataRows);
+                sourceColumnEnd = qMin(sourceColumnEnd, m_dataColumns);
+                for (int i = 2 * row; i < sourceRowEnd; i++) {
+                    const QSurfaceDataRow &dataRow = *array.at(i);
+                    for (int j = 2 * column; j < sourceColumnEnd; j++) {
+                        float y = dataRow.at(j).y();
+                        if (!count) {
+                            minY = y;
+                            maxY = y;
+                        } else {
+                            minY = qMin(y, minY);
+                            maxY = qMax(y, maxY);
+                        }
+                        sumY += y;
+                        count++;
+                    }
+                }
+            } else {
+                // Means of the source cells are weighted by the number of items they cover
+                const Level &source = m_levels.at(level - 2);
+                sourceRowEnd = qMin(sourceRowEnd, source.rows);
+                sourceColumnEnd = qMin(sourceColumnEnd, source.columns);
+                for (int i = 2 * row; i < sourceRowEnd; i++) {
+                    for (int j = 2 * column; j < sourceColumnEnd; j++) {
+                        int index = i * source.columns + j;
+                        int weight = coveredRows(level - 1, i) * coveredColumns(level - 1, j);
+                        if (!count) {
+                            minY = source.minY.at(index);
+                            maxY = source.maxY.at(index);
+                        } else {
+                            minY = qMin(source.minY.at(index), minY);
+                            maxY = qMax(source.maxY.at(index), maxY);
+                        }
+                        sumY += double(source.meanY.at(index)) * weight;
+                        count += weight;
+                    }
+                }
+            }
+
+            int index = row * cells.columns + column;
+            cells.minY[index] = minY;
+            cells.maxY[index] = maxY;
+            cells.meanY[index] = float(sumY / count);
+        }
+    }
+}
+
+QT_END_NAMESPACE_DATAVISUALIZATION
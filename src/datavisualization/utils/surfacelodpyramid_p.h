@@ -0,0 +1,97 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef SURFACELODPYRAMID_P_H
+#define SURFACELODPYRAMID_P_H
+
+#include "datavisualizationglobal_p.h"
+#include "qsurfacedataproxy.h"
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+// Decimated levels of a surface data array. Each cell of level n covers 2^n x 2^n items of the
+// data array and keeps their minimum, maximum, and mean y-value, so that peaks and pits survive
+// the decimation. Level 0 is the data array itself and is not stored.
+class QT_DATAVISUALIZATION_EXPORT SurfaceLodPyramid
+{
+public:
+    SurfaceLodPyramid();
+
+    void build(const QSurfaceDataArray &array);
+    void update(const QSurfaceDataArray &array, int startRow, int endRow,
+                int startColumn, int endColumn);
+    void clear();
+
+    inline int levelCount() const { return m_levels.size() + 1; }
+    inline bool isValidFor(const QSurfaceDataArray &array) const
+    {
+        return array.size() == m_dataRows && (!m_dataRows || array.at(0)->size() == m_dataColumns);
+    }
+    float valueAt(int level, int row, int column) const;
+    int levelFor(int dataSize, int displaySize) const;
+
+private:
+    struct Level
+    {
+        int rows;
+        int columns;
+        QVector<float> minY;
+        QVector<float> maxY;
+        QVector<float> meanY;
+    };
+
+    void createCells(const QSurfaceDataArray &array, int level, int startRow, int endRow,
+                     int startColumn, int endColumn);
+    inline int coveredRows(int level, int row) const
+    {
+        return qMin((row + 1) << level, m_dataRows) - (row << level);
+    }
+    inline int coveredColumns(int level, int column) const
+    {
+        return qMin((column + 1) << level, m_dataColumns) - (column << level);
+    }
+
+    QVector<Level> m_levels;
+    int m_dataRows;
+    int m_dataColumns;
+};
+
+QT_END_NAMESPACE_DATAVISUALIZATION
+
+#endif
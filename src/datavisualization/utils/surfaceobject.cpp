@@ -29,11 +29,22 @@
 
 #include "surfaceobject_p.h"
 #include "surface3drenderer_p.h"
+#include "qlogvalue3daxisformatter.h"
+#include "rowblocks_p.h"
 
 #include <QtGui/QVector2D>
+#include <QtGui/QVector4D>
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
+// Beyond this many separate dirty ranges, a single upload spanning all of them is cheaper
+const int maxDirtyRanges = 16;
+// Surface generation is split into row blocks of at least this many items, as smaller
+// blocks don't gain enough from the worker threads to cover the cost of starting them
+const int minItemsPerRowBlock = 32768;
+// Surfaces are split into tiles of this many quads per side for view frustum culling
+const int surfaceTileSize = 64;
+
 SurfaceObject::SurfaceObject(Surface3DRenderer *renderer)
     : m_surfaceType(Undefined),
       m_columns(0),
@@ -45,7 +56,11 @@ SurfaceObject::SurfaceObject(Surface3DRenderer *renderer)
       m_renderer(renderer),
       m_returnTextureBuffer(false),
       m_dataDimension(0),
-      m_oldDataDimension(-1)
+      m_oldDataDimension(-1),
+      m_ringStart(0),
+      m_ringLayout(false),
+      m_tileColumns(0),
+      m_uvRingStart(0)
 {
     glGenBuffers(1, &m_vertexbuffer);
     glGenBuffers(1, &m_normalbuffer);
@@ -80,34 +95,57 @@ void SurfaceObject::setUpSmoothData(const QSurfaceDataArray &dataArray, const QR
         indicesDirty = true;
     m_oldDataDimension = m_dataDimension;
 
+    // Vertices are rewritten in data order, so ring buffer layout can't be kept
+    bool ringReset = resetRing();
+    if (ringReset)
+        indicesDirty = true;
+
     // Create/populate vertix table
     if (changeGeometry)
         m_vertices.resize(totalSize);
 
     QVector<QVector2D> uvs;
-    if (changeGeometry)
+    if (changeGeometry) {
         uvs.resize(totalSize);
-    int totalIndex = 0;
-
-    // Init min and max to ridiculous values
-    m_minY = 10000000.0;
-    m_maxY = -10000000.0f;
-
-    for (int i = 0; i < m_rows; i++) {
-        const QSurfaceDataRow &p = *dataArray.at(i);
-        for (int j = 0; j < m_columns; j++) {
-            getNormalizedVertex(p.at(j), m_vertices[totalIndex], polar, flipXZ);
-            if (changeGeometry)
-                uvs[totalIndex] = QVector2D(GLfloat(j) * uvX, GLfloat(i) * uvY);
-            totalIndex++;
-        }
+        m_uvRingStart = 0;
     }
 
-    if (flipXZ) {
-        for (int i = 0; i < m_vertices.size(); i++) {
-            m_vertices[i].setX(-m_vertices.at(i).x());
-            m_vertices[i].setZ(-m_vertices.at(i).z());
+    int blockCount = rowBlockCount(totalSize);
+    QVector<float> blockMinY(blockCount);
+    QVector<float> blockMaxY(blockCount);
+    float *minY = blockMinY.data();
+    float *maxY = blockMaxY.data();
+    QVector3D *vertices = m_vertices.data();
+    QVector2D *uvData = uvs.data();
+
+    // Vertices and UVs of each row depend on the data row only
+    forEachRowBlock(m_rows, blockCount, [&](int block, int startRow, int endRow) {
+        // Init min and max to ridiculous values
+        minY[block] = 10000000.0f;
+        maxY[block] = -10000000.0f;
+        for (int i = startRow; i < endRow; i++) {
+            const QSurfaceDataRow &p = *dataArray.at(i);
+            int index = i * m_columns;
+            for (int j = 0; j < m_columns; j++, index++) {
+                QVector3D &vertex = vertices[index];
+                normalizeVertex(p.at(j), vertex, polar, flipXZ);
+                minY[block] = qMin(vertex.y(), minY[block]);
+                maxY[block] = qMax(vertex.y(), maxY[block]);
+                if (flipXZ) {
+                    vertex.setX(-vertex.x());
+                    vertex.setZ(-vertex.z());
+                }
+                if (changeGeometry)
+                    uvData[index] = QVector2D(GLfloat(j) * uvX, GLfloat(i) * uvY);
+            }
         }
+    });
+
+    m_minY = blockMinY.at(0);
+    m_maxY = blockMaxY.at(0);
+    for (int block = 1; block < blockCount; block++) {
+        m_minY = qMin(blockMinY.at(block), m_minY);
+        m_maxY = qMax(blockMaxY.at(block), m_maxY);
     }
 
     // Create normals
@@ -116,27 +154,32 @@ void SurfaceObject::setUpSmoothData(const QSurfaceDataArray &dataArray, const QR
     if (changeGeometry)
         m_normals.resize(totalSize);
 
-    totalIndex = 0;
-
-    if ((m_dataDimension == BothAscending) || (m_dataDimension == XDescending)) {
-        for (int row = 0; row < rowLimit; row++)
-            createSmoothNormalBodyLine(totalIndex, row * m_columns);
-        createSmoothNormalUpperLine(totalIndex);
-    } else { // BothDescending || ZDescending
-        createSmoothNormalUpperLine(totalIndex);
-        for (int row = 1; row < m_rows; row++)
-            createSmoothNormalBodyLine(totalIndex, row * m_columns);
-    }
+    // All vertices are ready, so the normals of each row can be created independently.
+    // The upper line is the last row when going upwards, otherwise the first one.
+    bool upwards = (m_dataDimension == BothAscending) || (m_dataDimension == XDescending);
+    int firstBodyRow = upwards ? 0 : 1;
+    m_normals.detach();
+    forEachRowBlock(rowLimit, blockCount, [&](int block, int startRow, int endRow) {
+        Q_UNUSED(block)
+        int normalIndex = (startRow + firstBodyRow) * m_columns;
+        for (int row = startRow + firstBodyRow; row < endRow + firstBodyRow; row++)
+            createSmoothNormalBodyLine(normalIndex, row * m_columns);
+    });
+
+    int totalIndex = upwards ? rowLimit * m_columns : 0;
+    createSmoothNormalUpperLine(totalIndex);
 
     // Create indices table
     if (changeGeometry || indicesDirty)
         createSmoothIndices(0, 0, colLimit, rowLimit);
 
     // Create line element indices
-    if (changeGeometry)
+    if (changeGeometry || ringReset)
         createSmoothGridlineIndices(0, 0, colLimit, rowLimit);
 
     createBuffers(m_vertices, uvs, m_normals, 0);
+
+    storeAxisReferences();
 }
 
 void SurfaceObject::createSmoothNormalBodyLine(int &totalIndex, int column)
@@ -233,80 +276,94 @@ void SurfaceObject::createSmoothNormalUpperLine(int &totalIndex)
 
 QVector3D SurfaceObject::createSmoothNormalBodyLineItem(int x, int y)
 {
-    int p = y * m_columns + x;
+    int p = ringIndex(x, y);
     if (m_dataDimension == BothAscending) {
         if (x < m_columns - 1) {
             return normal(m_vertices.at(p), m_vertices.at(p + 1),
-                          m_vertices.at(p + m_columns));
+                          m_vertices.at(ringIndex(x, y + 1)));
         } else {
-            return normal(m_vertices.at(p), m_vertices.at(p + m_columns),
+            return normal(m_vertices.at(p), m_vertices.at(ringIndex(x, y + 1)),
                           m_vertices.at(p - 1));
         }
     } else if (m_dataDimension == XDescending) {
         if (x == 0) {
-            return normal(m_vertices.at(p), m_vertices.at(p + m_columns),
+            return normal(m_vertices.at(p), m_vertices.at(ringIndex(x, y + 1)),
                           m_vertices.at(p + 1));
         } else {
             return normal(m_vertices.at(p), m_vertices.at(p - 1),
-                          m_vertices.at(p + m_columns));
+                          m_vertices.at(ringIndex(x, y + 1)));
         }
     } else if (m_dataDimension == ZDescending) {
         if (x < m_columns - 1) {
             return normal(m_vertices.at(p), m_vertices.at(p + 1),
-                          m_vertices.at(p - m_columns));
+                          m_vertices.at(ringIndex(x, y - 1)));
         } else {
-            return normal(m_vertices.at(p), m_vertices.at(p - m_columns),
+            return normal(m_vertices.at(p), m_vertices.at(ringIndex(x, y - 1)),
                           m_vertices.at(p - 1));
         }
     } else { // BothDescending
         if (x == 0) {
-            return normal(m_vertices.at(p), m_vertices.at(p - m_columns),
+            return normal(m_vertices.at(p), m_vertices.at(ringIndex(x, y - 1)),
                           m_vertices.at(p + 1));
         } else {
             return normal(m_vertices.at(p), m_vertices.at(p - 1),
-                          m_vertices.at(p - m_columns));
+                          m_vertices.at(ringIndex(x, y - 1)));
         }
     }
 }
 
 QVector3D SurfaceObject::createSmoothNormalUpperLineItem(int x, int y)
 {
-    int p = y * m_columns + x;
+    int p = ringIndex(x, y);
     if (m_dataDimension == BothAscending) {
         if (x < m_columns - 1) {
-            return normal(m_vertices.at(p), m_vertices.at(p - m_columns),
+            return normal(m_vertices.at(p), m_vertices.at(ringIndex(x, y - 1)),
                           m_vertices.at(p + 1));
         } else {
             return normal(m_vertices.at(p), m_vertices.at(p - 1),
-                          m_vertices.at(p - m_columns));
+                          m_vertices.at(ringIndex(x, y - 1)));
         }
     } else if (m_dataDimension == XDescending) {
         if (x == 0) {
             return normal(m_vertices.at(p), m_vertices.at(p + 1),
-                          m_vertices.at(p - m_columns));
+                          m_vertices.at(ringIndex(x, y - 1)));
         } else {
-            return normal(m_vertices.at(p), m_vertices.at(p - m_columns),
+            return normal(m_vertices.at(p), m_vertices.at(ringIndex(x, y - 1)),
                           m_vertices.at(p - 1));
         }
     } else if (m_dataDimension == ZDescending) {
         if (x < m_columns - 1) {
-            return normal(m_vertices.at(p), m_vertices.at(p + m_columns),
+            return normal(m_vertices.at(p), m_vertices.at(ringIndex(x, y + 1)),
                           m_vertices.at(p + 1));
         } else {
             return normal(m_vertices.at(p), m_vertices.at(p - 1),
-                          m_vertices.at(p + m_columns));
+                          m_vertices.at(ringIndex(x, y + 1)));
         }
     } else { // BothDescending
         if (x == 0) {
-            return normal(m_vertices.at(0), m_vertices.at(1),
-                          m_vertices.at(m_columns));
+            return normal(m_vertices.at(p), m_vertices.at(p + 1),
+                          m_vertices.at(ringIndex(x, y + 1)));
         } else {
-            return normal(m_vertices.at(p), m_vertices.at(p + m_columns),
+            return normal(m_vertices.at(p), m_vertices.at(ringIndex(x, y + 1)),
                           m_vertices.at(p - 1));
         }
     }
 }
 
+void SurfaceObject::createSmoothNormalRow(int row)
+{
+    bool upwards = (m_dataDimension == BothAscending) || (m_dataDimension == XDescending);
+    bool upperLine = upwards ? (row == m_rows - 1) : (row == 0);
+    int p = ringIndex(0, row);
+    for (int j = 0; j < m_columns; j++) {
+        if (upperLine)
+            m_normals[p + j] = createSmoothNormalUpperLineItem(j, row);
+        else
+            m_normals[p + j] = createSmoothNormalBodyLineItem(j, row);
+    }
+    addDirtyRange(m_dirtyNormalRanges, p, p + m_columns);
+}
+
 void SurfaceObject::smoothUVs(const QSurfaceDataArray &dataArray,
                               const QSurfaceDataArray &modelArray)
 {
@@ -352,42 +409,32 @@ void SurfaceObject::smoothUVs(const QSurfaceDataArray &dataArray,
 void SurfaceObject::updateSmoothRow(const QSurfaceDataArray &dataArray, int rowIndex, bool polar)
 {
     // Update vertices
-    int p = rowIndex * m_columns;
+    int p = ringIndex(0, rowIndex);
     const QSurfaceDataRow &dataRow = *dataArray.at(rowIndex);
 
-    for (int j = 0; j < m_columns; j++)
-        getNormalizedVertex(dataRow.at(j), m_vertices[p++], polar, false);
-
-    // Create normals
-    bool upwards = (m_dataDimension == BothAscending) || (m_dataDimension == XDescending);
-    int startRow = rowIndex;
-    if ((startRow > 0) && upwards)
-        startRow--;
-    int endRow = rowIndex;
-    if (!upwards && (rowIndex < m_rows - 1))
-        endRow++;
-    if ((endRow == m_rows - 1) && upwards)
-        endRow--;
-    int totalIndex = startRow * m_columns;
-
-    if ((startRow == 0) && !upwards) {
-        createSmoothNormalUpperLine(totalIndex);
-        startRow++;
+    for (int j = 0; j < m_columns; j++) {
+        getNormalizedVertex(dataRow.at(j), m_vertices[p + j], polar, false);
+        m_vertices[p + j] -= m_positionOffset;
     }
+    addDirtyRange(m_dirtyVertexRanges, p, p + m_columns);
 
-    for (int row = startRow; row <= endRow; row++)
-       createSmoothNormalBodyLine(totalIndex, row * m_columns);
-
-    if ((rowIndex == m_rows - 1) && upwards)
-        createSmoothNormalUpperLine(totalIndex);
+    // Create normals for the row and the neighbouring row the normals depend on
+    bool upwards = (m_dataDimension == BothAscending) || (m_dataDimension == XDescending);
+    if (upwards && rowIndex > 0)
+        createSmoothNormalRow(rowIndex - 1);
+    createSmoothNormalRow(rowIndex);
+    if (!upwards && rowIndex < m_rows - 1)
+        createSmoothNormalRow(rowIndex + 1);
 }
 
 void SurfaceObject::updateSmoothItem(const QSurfaceDataArray &dataArray, int row, int column,
                                      bool polar)
 {
     // Update a vertice
-    getNormalizedVertex(dataArray.at(row)->at(column),
-                        m_vertices[row * m_columns + column], polar, false);
+    int vertexIndex = ringIndex(column, row);
+    getNormalizedVertex(dataArray.at(row)->at(column), m_vertices[vertexIndex], polar, false);
+    m_vertices[vertexIndex] -= m_positionOffset;
+    addDirtyRange(m_dirtyVertexRanges, vertexIndex, vertexIndex + 1);
 
     // Create normals
     bool upwards = (m_dataDimension == BothAscending) || (m_dataDimension == XDescending);
@@ -409,7 +456,7 @@ void SurfaceObject::updateSmoothItem(const QSurfaceDataArray &dataArray, int row
 
     for (int i = startRow; i <= endRow; i++) {
         for (int j = startCol; j <= endCol; j++) {
-            int p = i * m_columns + j;
+            int p = ringIndex(j, i);
             if ((i == 0) && !upwards)
                 m_normals[p] = createSmoothNormalUpperLineItem(j, i);
             else if ((i == m_rows - 1) && upwards)
@@ -417,6 +464,7 @@ void SurfaceObject::updateSmoothItem(const QSurfaceDataArray &dataArray, int row
             else
                 m_normals[p] = createSmoothNormalBodyLineItem(j, i);
          }
+        addDirtyRange(m_dirtyNormalRanges, ringIndex(startCol, i), ringIndex(endCol, i) + 1);
     }
 }
 
@@ -432,46 +480,7 @@ void SurfaceObject::createSmoothIndices(int x, int y, int endX, int endY)
     if (y > endY)
         y = endY - 1;
 
-    m_indexCount = 6 * (endX - x) * (endY - y);
-    GLint *indices = new GLint[m_indexCount];
-    int p = 0;
-    int rowEnd = endY * m_columns;
-    for (int row = y * m_columns; row < rowEnd; row += m_columns) {
-        for (int j = x; j < endX; j++) {
-            if ((m_dataDimension == BothAscending) || (m_dataDimension == BothDescending)) {
-                // Left triangle
-                indices[p++] = row + j + 1;
-                indices[p++] = row + m_columns + j;
-                indices[p++] = row + j;
-
-                // Right triangle
-                indices[p++] = row + m_columns + j + 1;
-                indices[p++] = row + m_columns + j;
-                indices[p++] = row + j + 1;
-            } else if (m_dataDimension == XDescending) {
-                // Right triangle
-                indices[p++] = row + m_columns + j;
-                indices[p++] = row + m_columns + j + 1;
-                indices[p++] = row + j;
-
-                // Left triangle
-                indices[p++] = row + j;
-                indices[p++] = row + m_columns + j + 1;
-                indices[p++] = row + j + 1;
-            } else {
-                // Left triangle
-                indices[p++] = row + m_columns + j;
-                indices[p++] = row + m_columns + j + 1;
-                indices[p++] = row + j;
-
-                // Right triangle
-                indices[p++] = row + j;
-                indices[p++] = row + m_columns + j + 1;
-                indices[p++] = row + j + 1;
-
-            }
-        }
-    }
+    GLint *indices = createTiledIndices(x, y, endX, endY, m_columns, 1);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCount * sizeof(GLint),
@@ -537,74 +546,93 @@ void SurfaceObject::setUpData(const QSurfaceDataArray &dataArray, const QRect &s
 
     m_surfaceType = SurfaceFlat;
 
+    bool ringReset = resetRing();
+    if (ringReset)
+        indicesDirty = true;
+
     // Create vertix table
     if (changeGeometry)
         m_vertices.resize(totalSize);
 
     QVector<QVector2D> uvs;
-    if (changeGeometry)
+    if (changeGeometry) {
         uvs.resize(totalSize);
+        m_uvRingStart = 0;
+    }
 
-    int totalIndex = 0;
     int rowLimit = m_rows - 1;
     int colLimit = m_columns - 1;
     int doubleColumns = m_columns * 2 - 2;
-    int rowColLimit = rowLimit * doubleColumns;
 
-    // Init min and max to ridiculous values
-    m_minY = 10000000.0;
-    m_maxY = -10000000.0f;
-
-    for (int i = 0; i < m_rows; i++) {
-        const QSurfaceDataRow &row = *dataArray.at(i);
-        for (int j = 0; j < m_columns; j++) {
-            getNormalizedVertex(row.at(j), m_vertices[totalIndex], polar, flipXZ);
-            if (changeGeometry)
-                uvs[totalIndex] = QVector2D(GLfloat(j) * uvX, GLfloat(i) * uvY);
+    int blockCount = rowBlockCount(totalSize);
+    QVector<float> blockMinY(blockCount);
+    QVector<float> blockMaxY(blockCount);
+    float *minY = blockMinY.data();
+    float *maxY = blockMaxY.data();
+    QVector3D *vertices = m_vertices.data();
+    QVector2D *uvData = uvs.data();
+
+    // Each row takes doubleColumns vertices, as inner vertices are duplicated
+    forEachRowBlock(m_rows, blockCount, [&](int block, int startRow, int endRow) {
+        // Init min and max to ridiculous values
+        minY[block] = 10000000.0f;
+        maxY[block] = -10000000.0f;
+        for (int i = startRow; i < endRow; i++) {
+            const QSurfaceDataRow &row = *dataArray.at(i);
+            int index = i * doubleColumns;
+            for (int j = 0; j < m_columns; j++) {
+                QVector3D &vertex = vertices[index];
+                normalizeVertex(row.at(j), vertex, polar, flipXZ);
+                minY[block] = qMin(vertex.y(), minY[block]);
+                maxY[block] = qMax(vertex.y(), maxY[block]);
+                if (flipXZ) {
+                    vertex.setX(-vertex.x());
+                    vertex.setZ(-vertex.z());
+                }
+                if (changeGeometry)
+                    uvData[index] = QVector2D(GLfloat(j) * uvX, GLfloat(i) * uvY);
 
-            totalIndex++;
+                index++;
 
-            if (j > 0 && j < colLimit) {
-                m_vertices[totalIndex] = m_vertices[totalIndex - 1];
-                if (changeGeometry)
-                    uvs[totalIndex] = uvs[totalIndex - 1];
-                totalIndex++;
+                if (j > 0 && j < colLimit) {
+                    vertices[index] = vertices[index - 1];
+                    if (changeGeometry)
+                        uvData[index] = uvData[index - 1];
+                    index++;
+                }
             }
         }
-    }
+    });
 
-    if (flipXZ) {
-        for (int i = 0; i < m_vertices.size(); i++) {
-            m_vertices[i].setX(-m_vertices.at(i).x());
-            m_vertices[i].setZ(-m_vertices.at(i).z());
-        }
+    m_minY = blockMinY.at(0);
+    m_maxY = blockMaxY.at(0);
+    for (int block = 1; block < blockCount; block++) {
+        m_minY = qMin(blockMinY.at(block), m_minY);
+        m_maxY = qMax(blockMaxY.at(block), m_maxY);
     }
 
     // Create normals & indices table
     GLint *indices = 0;
     if (changeGeometry || indicesDirty) {
-        int normalCount = 2 * colLimit * rowLimit;
-        m_indexCount = 3 * normalCount;
-        indices = new GLint[m_indexCount];
-        m_normals.resize(normalCount);
+        m_normals.resize(2 * colLimit * rowLimit);
+        indices = createTiledIndices(0, 0, colLimit, rowLimit, doubleColumns, 2);
     }
 
-    int p = 0;
-    totalIndex = 0;
-    for (int row = 0, upperRow = doubleColumns;
-         row < rowColLimit;
-         row += doubleColumns, upperRow += doubleColumns) {
-        for (int j = 0; j < doubleColumns; j += 2) {
-            createNormals(totalIndex, row, upperRow, j);
-
-            if (changeGeometry || indicesDirty) {
-                createCoarseIndices(indices, p, row, upperRow, j);
-            }
+    // Each row of quads takes doubleColumns normals
+    m_normals.detach();
+    forEachRowBlock(rowLimit, blockCount, [&](int block, int startRow, int endRow) {
+        Q_UNUSED(block)
+        int normalIndex = startRow * doubleColumns;
+        for (int row = startRow * doubleColumns, upperRow = row + doubleColumns;
+             row < endRow * doubleColumns;
+             row += doubleColumns, upperRow += doubleColumns) {
+            for (int j = 0; j < doubleColumns; j += 2)
+                createNormals(normalIndex, row, upperRow, j);
         }
-    }
+    });
 
     // Create grid line element indices
-    if (changeGeometry)
+    if (changeGeometry || ringReset)
         createCoarseGridlineIndices(0, 0, colLimit, rowLimit);
 
     createBuffers(m_vertices, uvs, m_normals, indices);
@@ -674,11 +702,13 @@ void SurfaceObject::updateCoarseRow(const QSurfaceDataArray &dataArray, int rowI
             p++;
         }
     }
+    addDirtyRange(m_dirtyVertexRanges, rowIndex * doubleColumns, p);
 
     // Create normals
     p = rowIndex * doubleColumns;
     if (p > 0)
         p -= doubleColumns;
+    int normalStart = p;
     int rowLimit = (rowIndex + 1) * doubleColumns;
     if (rowIndex == m_rows - 1)
         rowLimit = rowIndex * doubleColumns; //Topmost row, no normals
@@ -688,6 +718,7 @@ void SurfaceObject::updateCoarseRow(const QSurfaceDataArray &dataArray, int rowI
         for (int j = 0; j < doubleColumns; j += 2)
             createNormals(p, row, upperRow, j);
     }
+    addDirtyRange(m_dirtyNormalRanges, normalStart, p);
 }
 
 void SurfaceObject::updateCoarseItem(const QSurfaceDataArray &dataArray, int row, int column,
@@ -698,10 +729,14 @@ void SurfaceObject::updateCoarseItem(const QSurfaceDataArray &dataArray, int row
 
     // Update a vertice
     int p = row * doubleColumns + column * 2 - (column > 0);
+    int vertexStart = p;
     getNormalizedVertex(dataArray.at(row)->at(column), m_vertices[p++], polar, false);
 
-    if (column > 0 && column < colLimit)
+    if (column > 0 && column < colLimit) {
         m_vertices[p] = m_vertices[p - 1];
+        p++;
+    }
+    addDirtyRange(m_dirtyVertexRanges, vertexStart, p);
 
     // Create normals
     int startRow = row;
@@ -720,6 +755,7 @@ void SurfaceObject::updateCoarseItem(const QSurfaceDataArray &dataArray, int row
             p = i * doubleColumns + j * 2;
             createNormals(p, i * doubleColumns, (i + 1) * doubleColumns, j * 2);
         }
+        addDirtyRange(m_dirtyNormalRanges, i * doubleColumns + startCol * 2, p);
     }
 }
 
@@ -756,6 +792,10 @@ void SurfaceObject::createCoarseSubSection(int x, int y, int columns, int rows)
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
     delete[] indices;
+
+    // Indices are not in tile order
+    m_tiles.clear();
+    m_tileColumns = 0;
 }
 
 void SurfaceObject::createCoarseGridlineIndices(int x, int y, int endX, int endY)
@@ -807,10 +847,217 @@ void SurfaceObject::createCoarseGridlineIndices(int x, int y, int endX, int endY
     delete[] gridIndices;
 }
 
+// Creates the triangle indices of quads [x, endX) x [y, endY) ordered tile by tile, so that
+// the triangles of each tile form one range of the element buffer. Stride is the vertex count
+// of a row and columnStep the vertex count of a quad column.
+GLint *SurfaceObject::createTiledIndices(int x, int y, int endX, int endY, int stride,
+                                         int columnStep)
+{
+    int columns = endX - x;
+    int rows = endY - y;
+    m_indexCount = 6 * columns * rows;
+    GLint *indices = new GLint[m_indexCount];
+
+    m_tileColumns = (columns + surfaceTileSize - 1) / surfaceTileSize;
+    int tileRows = (rows + surfaceTileSize - 1) / surfaceTileSize;
+    m_tiles.resize(m_tileColumns * tileRows);
+    SurfaceTile *tiles = m_tiles.data();
+
+    int blockCount = qMin(rowBlockCount(m_indexCount), tileRows);
+    forEachRowBlock(tileRows, blockCount, [&](int block, int startTileRow, int endTileRow) {
+        Q_UNUSED(block)
+        for (int tileRow = startTileRow; tileRow < endTileRow; tileRow++) {
+            int startRow = y + tileRow * surfaceTileSize;
+            int endRow = qMin(startRow + surfaceTileSize, endY);
+            int p = 6 * tileRow * surfaceTileSize * columns;
+            SurfaceTile *tile = &tiles[tileRow * m_tileColumns];
+            for (int startColumn = x; startColumn < endX; startColumn += surfaceTileSize, tile++) {
+                tile->indexOffset = p;
+                tile->startRow = startRow;
+                tile->endRow = endRow;
+                tile->startColumn = startColumn;
+                tile->endColumn = qMin(startColumn + surfaceTileSize, endX);
+                for (int row = startRow; row < endRow; row++) {
+                    for (int j = startColumn; j < tile->endColumn; j++) {
+                        createCoarseIndices(indices, p, row * stride, (row + 1) * stride,
+                                            j * columnStep);
+                    }
+                }
+                tile->indexCount = p - tile->indexOffset;
+            }
+        }
+    });
+
+    return indices;
+}
+
+void SurfaceObject::updateTileBounds(int startTileRow, int endTileRow)
+{
+    bool flat = (m_surfaceType == SurfaceFlat);
+    int stride = flat ? m_columns * 2 - 2 : m_columns;
+    SurfaceTile *tiles = m_tiles.data();
+    const QVector3D *vertices = m_vertices.constData();
+
+    int blockCount = qMin(rowBlockCount(m_vertices.size()), endTileRow - startTileRow);
+    forEachRowBlock(endTileRow - startTileRow, blockCount,
+                    [&](int block, int startRow, int endRow) {
+        Q_UNUSED(block)
+        int end = (startTileRow + endRow) * m_tileColumns;
+        for (int i = (startTileRow + startRow) * m_tileColumns; i < end; i++) {
+            SurfaceTile &tile = tiles[i];
+            // Flat surfaces have two vertices for each inner column, both belong to the tile
+            int first = flat ? qMax(0, tile.startColumn * 2 - 1) : tile.startColumn;
+            int last = flat ? tile.endColumn * 2 - 1 : tile.endColumn;
+            QVector3D minBounds = vertices[tile.startRow * stride + first];
+            QVector3D maxBounds = minBounds;
+            for (int row = tile.startRow; row <= tile.endRow; row++) {
+                const QVector3D *vertex = &vertices[row * stride + first];
+                const QVector3D *rowEnd = &vertices[row * stride + last];
+                for (; vertex <= rowEnd; vertex++) {
+                    minBounds.setX(qMin(vertex->x(), minBounds.x()));
+                    minBounds.setY(qMin(vertex->y(), minBounds.y()));
+                    minBounds.setZ(qMin(vertex->z(), minBounds.z()));
+                    maxBounds.setX(qMax(vertex->x(), maxBounds.x()));
+                    maxBounds.setY(qMax(vertex->y(), maxBounds.y()));
+                    maxBounds.setZ(qMax(vertex->z(), maxBounds.z()));
+                }
+            }
+            tile.minBounds = minBounds;
+            tile.maxBounds = maxBounds;
+        }
+    });
+}
+
+void SurfaceObject::updateDirtyTileBounds()
+{
+    if (m_tiles.isEmpty() || m_dirtyVertexRanges.isEmpty())
+        return;
+
+    int stride = (m_surfaceType == SurfaceFlat) ? m_columns * 2 - 2 : m_columns;
+    int firstRow = m_tiles.first().startRow;
+    int tileRows = m_tiles.size() / m_tileColumns;
+    int startTileRow = tileRows;
+    int endTileRow = 0;
+    foreach (const QPair<int, int> &range, m_dirtyVertexRanges) {
+        // A vertex row is shared by the tiles above and below it
+        int startRow = range.first / stride - firstRow;
+        int endRow = (range.second - 1) / stride - firstRow;
+        startTileRow = qMin(qMax(startRow - 1, 0) / surfaceTileSize, startTileRow);
+        endTileRow = qMax(endRow / surfaceTileSize + 1, endTileRow);
+    }
+    updateTileBounds(startTileRow, qMin(endTileRow, tileRows));
+}
+
+// Returns the element buffer ranges as (offset, count) pairs that contain the triangles of all
+// tiles at least partially inside the view frustum of the given model-view-projection matrix
+const QVector<QPair<int, int> > &SurfaceObject::visibleIndexRanges(const QMatrix4x4 &mvpMatrix)
+{
+    m_visibleIndexRanges.clear();
+    if (m_tiles.isEmpty()) {
+        m_visibleIndexRanges.append(qMakePair(0, int(m_indexCount)));
+        return m_visibleIndexRanges;
+    }
+
+    foreach (const SurfaceTile &tile, m_tiles) {
+        // The tile is outside if all corners of its bounding box are outside the same
+        // clip plane. Boxes crossing a frustum edge diagonally are kept, which is harmless.
+        int outside = 0x3f;
+        for (int corner = 0; corner < 8 && outside; corner++) {
+            QVector4D position = mvpMatrix * QVector4D(
+                        (corner & 1) ? tile.maxBounds.x() : tile.minBounds.x(),
+                        (corner & 2) ? tile.maxBounds.y() : tile.minBounds.y(),
+                        (corner & 4) ? tile.maxBounds.z() : tile.minBounds.z(),
+                        1.0f);
+            float w = position.w();
+            int planes = 0;
+            if (position.x() < -w)
+                planes |= 0x01;
+            if (position.x() > w)
+                planes |= 0x02;
+            if (position.y() < -w)
+                planes |= 0x04;
+            if (position.y() > w)
+                planes |= 0x08;
+            if (position.z() < -w)
+                planes |= 0x10;
+            if (position.z() > w)
+                planes |= 0x20;
+            outside &= planes;
+        }
+        if (outside)
+            continue;
+
+        // Consecutive tiles are consecutive in the element buffer, so merge them
+        if (!m_visibleIndexRanges.isEmpty()) {
+            QPair<int, int> &last = m_visibleIndexRanges.last();
+            if (last.first + last.second == tile.indexOffset) {
+                last.second += tile.indexCount;
+                continue;
+            }
+        }
+        m_visibleIndexRanges.append(qMakePair(tile.indexOffset, tile.indexCount));
+    }
+
+    return m_visibleIndexRanges;
+}
+
 void SurfaceObject::uploadBuffers()
 {
-    QVector<QVector2D> uvs; // Empty dummy
-    createBuffers(m_vertices, uvs, m_normals, 0);
+    if (!m_meshDataLoaded) {
+        QVector<QVector2D> uvs; // Empty dummy
+        createBuffers(m_vertices, uvs, m_normals, 0);
+        return;
+    }
+
+    // Only the parts changed by row and item updates need to be sent
+    updateDirtyTileBounds();
+    uploadDirtyRanges(m_vertexbuffer, m_vertices, m_dirtyVertexRanges);
+    uploadDirtyRanges(m_normalbuffer, m_normals, m_dirtyNormalRanges);
+}
+
+void SurfaceObject::addDirtyRange(QVector<QPair<int, int> > &ranges, int start, int end)
+{
+    if (start >= end)
+        return;
+
+    // Find the first range that is not entirely before the new one
+    int i = 0;
+    while (i < ranges.size() && ranges.at(i).second < start)
+        i++;
+
+    // Merge all ranges that overlap or touch the new one
+    int last = i;
+    while (last < ranges.size() && ranges.at(last).first <= end) {
+        start = qMin(start, ranges.at(last).first);
+        end = qMax(end, ranges.at(last).second);
+        last++;
+    }
+    if (last > i)
+        ranges.remove(i, last - i);
+    ranges.insert(i, qMakePair(start, end));
+
+    if (ranges.size() > maxDirtyRanges) {
+        QPair<int, int> combined(ranges.first().first, ranges.last().second);
+        ranges.clear();
+        ranges.append(combined);
+    }
+}
+
+void SurfaceObject::uploadDirtyRanges(GLuint buffer, const QVector<QVector3D> &data,
+                                      QVector<QPair<int, int> > &ranges)
+{
+    if (ranges.isEmpty())
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    foreach (const QPair<int, int> &range, ranges) {
+        glBufferSubData(GL_ARRAY_BUFFER, range.first * sizeof(QVector3D),
+                        (range.second - range.first) * sizeof(QVector3D),
+                        &data.at(range.first));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    ranges.clear();
 }
 
 void SurfaceObject::createBuffers(const QVector<QVector3D> &vertices, const QVector<QVector2D> &uvs,
@@ -840,9 +1087,272 @@ void SurfaceObject::createBuffers(const QVector<QVector3D> &vertices, const QVec
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+    // Whole arrays were just sent, so any pending partial updates are included
+    m_dirtyVertexRanges.clear();
+    m_dirtyNormalRanges.clear();
+    if (m_tileColumns)
+        updateTileBounds(0, m_tiles.size() / m_tileColumns);
+
     m_meshDataLoaded = true;
 }
 
+bool SurfaceObject::scrollRows(const QSurfaceDataArray &dataArray, int count)
+{
+    if (m_surfaceType != SurfaceSmooth || count <= 0 || count >= m_rows
+            || dataArray.size() != m_rows || m_vertices.size() != m_rows * m_columns) {
+        return false;
+    }
+
+    QVector3D offset;
+    if (!resolveScrollOffset(offset))
+        return false;
+
+    // Triangle winding and normals depend on the data direction
+    DataDimensions dataDimension = m_dataDimension;
+    checkDirections(dataArray);
+    if (m_dataDimension != dataDimension) {
+        m_dataDimension = dataDimension;
+        return false;
+    }
+
+    // Limits need a full rescan only if a dropped row holds the current minimum or maximum
+    bool limitsDropped = false;
+    for (int row = 0; row < count && !limitsDropped; row++) {
+        int p = ringIndex(0, row);
+        for (int j = 0; j < m_columns; j++) {
+            float y = m_vertices.at(p + j).y();
+            if (y <= m_minY || y >= m_maxY) {
+                limitsDropped = true;
+                break;
+            }
+        }
+    }
+
+    int oldSeam = ringSeam();
+    m_ringStart = (m_ringStart + count) % m_rows;
+    m_positionOffset = offset;
+
+    // New rows go to the vertex rows of the dropped ones
+    for (int row = m_rows - count; row < m_rows; row++) {
+        int p = ringIndex(0, row);
+        const QSurfaceDataRow &dataRow = *dataArray.at(row);
+        for (int j = 0; j < m_columns; j++) {
+            getNormalizedVertex(dataRow.at(j), m_vertices[p + j], false, false);
+            m_vertices[p + j] -= m_positionOffset;
+        }
+        addDirtyRange(m_dirtyVertexRanges, p, p + m_columns);
+    }
+
+    // Scrolling never moves vertices along the y-axis, so stored heights can be used as is
+    if (limitsDropped) {
+        m_minY = 10000000.0f;
+        m_maxY = -10000000.0f;
+        for (int i = 0; i < m_vertices.size(); i++) {
+            float y = m_vertices.at(i).y();
+            m_minY = qMin(y, m_minY);
+            m_maxY = qMax(y, m_maxY);
+        }
+    }
+
+    // Normals change for the new rows and at both ends of the retained rows
+    createSmoothNormalRow(0);
+    for (int row = m_rows - count - 1; row < m_rows; row++)
+        createSmoothNormalRow(row);
+
+    if (m_ringLayout)
+        updateRingSeam(oldSeam);
+    else
+        createRingIndices();
+
+    uploadBuffers();
+
+    return true;
+}
+
+bool SurfaceObject::resetRing()
+{
+    bool wasRingLayout = m_ringLayout;
+    m_ringStart = 0;
+    m_ringLayout = false;
+    m_positionOffset = QVector3D();
+    return wasRingLayout;
+}
+
+void SurfaceObject::storeAxisReferences()
+{
+    m_referenceValues[0] = QVector3D(m_axisCacheX.min(), m_axisCacheY.min(), m_axisCacheZ.min());
+    m_referenceValues[2] = QVector3D(m_axisCacheX.max(), m_axisCacheY.max(), m_axisCacheZ.max());
+    m_referenceValues[1] = (m_referenceValues[0] + m_referenceValues[2]) / 2.0f;
+    for (int i = 0; i < 3; i++) {
+        const QVector3D &value = m_referenceValues[i];
+        m_referencePositions[i] = QVector3D(m_axisCacheX.positionAt(value.x()),
+                                            m_axisCacheY.positionAt(value.y()),
+                                            m_axisCacheZ.positionAt(value.z()));
+    }
+}
+
+bool SurfaceObject::resolveScrollOffset(QVector3D &offset)
+{
+    // Existing vertices stay valid only if the axis mappings are unchanged, apart from
+    // a shift along the z-axis, which is applied as a translation when drawing.
+    // Checking three positions catches non-linear mappings, such as logarithmic axes.
+    static const float maxError = 0.0001f;
+    for (int i = 0; i < 3; i++) {
+        const QVector3D &value = m_referenceValues[i];
+        QVector3D delta = QVector3D(m_axisCacheX.positionAt(value.x()),
+                                    m_axisCacheY.positionAt(value.y()),
+                                    m_axisCacheZ.positionAt(value.z()))
+                - m_referencePositions[i];
+        if (qAbs(delta.x()) > maxError || qAbs(delta.y()) > maxError)
+            return false;
+        if (i == 0)
+            offset = QVector3D(0.0f, 0.0f, delta.z());
+        else if (qAbs(delta.z() - offset.z()) > maxError)
+            return false;
+    }
+    return true;
+}
+
+void SurfaceObject::createRingIndices()
+{
+    int stripIndexCount = 6 * (m_columns - 1);
+    int stripGridIndexCount = 4 * m_columns - 2;
+    m_indexCount = stripIndexCount * m_rows;
+    m_gridIndexCount = stripGridIndexCount * m_rows;
+
+    GLint *indices = new GLint[m_indexCount];
+    GLint *gridIndices = new GLint[m_gridIndexCount];
+    for (int strip = 0; strip < m_rows; strip++) {
+        createRingStripIndices(&indices[strip * stripIndexCount], strip);
+        createRingStripGridIndices(&gridIndices[strip * stripGridIndexCount], strip);
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indexCount * sizeof(GLint),
+                 indices, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gridElementbuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_gridIndexCount * sizeof(GLint),
+                 gridIndices, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    delete[] indices;
+    delete[] gridIndices;
+
+    // Strips of the ring layout are not in tile order, so the surface is drawn whole
+    m_tiles.clear();
+    m_tileColumns = 0;
+    m_ringLayout = true;
+}
+
+void SurfaceObject::updateRingSeam(int oldSeam)
+{
+    // Only the strip that used to connect the newest and the oldest row and the strip
+    // that connects them now differ from the previous frame
+    int stripIndexCount = 6 * (m_columns - 1);
+    int stripGridIndexCount = 4 * m_columns - 2;
+    GLint *indices = new GLint[stripIndexCount];
+    GLint *gridIndices = new GLint[stripGridIndexCount];
+    int strips[2] = { oldSeam, ringSeam() };
+
+    for (int i = 0; i < 2; i++) {
+        createRingStripIndices(indices, strips[i]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementbuffer);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                        strips[i] * stripIndexCount * sizeof(GLint),
+                        stripIndexCount * sizeof(GLint), indices);
+
+        createRingStripGridIndices(gridIndices, strips[i]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gridElementbuffer);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                        strips[i] * stripGridIndexCount * sizeof(GLint),
+                        stripGridIndexCount * sizeof(GLint), gridIndices);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    delete[] indices;
+    delete[] gridIndices;
+}
+
+void SurfaceObject::createRingStripIndices(GLint *indices, int strip)
+{
+    int p = 0;
+    int colLimit = m_columns - 1;
+    if (strip == ringSeam()) {
+        // Degenerate triangles, the newest row is not connected to the oldest one
+        for (; p < 6 * colLimit; p++)
+            indices[p] = 0;
+        return;
+    }
+
+    int row = strip * m_columns;
+    int upperRow = ((strip + 1) % m_rows) * m_columns;
+    for (int j = 0; j < colLimit; j++)
+        createCoarseIndices(indices, p, row, upperRow, j);
+}
+
+void SurfaceObject::createRingStripGridIndices(GLint *gridIndices, int strip)
+{
+    int p = 0;
+    int row = strip * m_columns;
+    for (int j = 0; j < m_columns - 1; j++) {
+        gridIndices[p++] = row + j;
+        gridIndices[p++] = row + j + 1;
+    }
+
+    if (strip == ringSeam()) {
+        // No lines between the newest and the oldest row, repeat an existing line instead
+        for (int j = 0; j < m_columns; j++) {
+            gridIndices[p++] = row;
+            gridIndices[p++] = row + 1;
+        }
+        return;
+    }
+
+    int upperRow = ((strip + 1) % m_rows) * m_columns;
+    for (int j = 0; j < m_columns; j++) {
+        gridIndices[p++] = row + j;
+        gridIndices[p++] = upperRow + j;
+    }
+}
+
+void SurfaceObject::createRingUVs()
+{
+    // Selection relies on the UVs matching the data order, which rotates in ring buffer mode
+    GLfloat uvX = 1.0f / GLfloat(m_columns - 1);
+    GLfloat uvY = 1.0f / GLfloat(m_rows - 1);
+    QVector<QVector2D> uvs(m_rows * m_columns);
+    for (int i = 0; i < m_rows; i++) {
+        int p = ringIndex(0, i);
+        for (int j = 0; j < m_columns; j++)
+            uvs[p + j] = QVector2D(GLfloat(j) * uvX, GLfloat(i) * uvY);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_uvbuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, uvs.size() * sizeof(QVector2D), &uvs.at(0));
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    m_uvRingStart = m_ringStart;
+}
+
+int SurfaceObject::rowBlockCount(int itemCount) const
+{
+    // Custom formatters are not required to be thread safe
+    static const QMetaObject *valueFormatter = &QValue3DAxisFormatter::staticMetaObject;
+    static const QMetaObject *logFormatter = &QLogValue3DAxisFormatter::staticMetaObject;
+    const AxisRenderCache *caches[3] = { &m_axisCacheX, &m_axisCacheY, &m_axisCacheZ };
+    for (int i = 0; i < 3; i++) {
+        if (!caches[i]->formatter())
+            return 1;
+        const QMetaObject *formatter = caches[i]->formatter()->metaObject();
+        if (formatter != valueFormatter && formatter != logFormatter)
+            return 1;
+    }
+
+    int blockCount = qMin(QThreadPool::globalInstance()->maxThreadCount() + 1,
+                          itemCount / minItemsPerRowBlock);
+    return qMax(1, blockCount);
+}
+
 void SurfaceObject::checkDirections(const QSurfaceDataArray &array)
 {
     m_dataDimension = BothAscending;
@@ -860,6 +1370,15 @@ void SurfaceObject::checkDirections(const QSurfaceDataArray &array)
 
 void SurfaceObject::getNormalizedVertex(const QSurfaceDataItem &data, QVector3D &vertex,
                                         bool polar, bool flipXZ)
+{
+    normalizeVertex(data, vertex, polar, flipXZ);
+    m_minY = qMin(vertex.y(), m_minY);
+    m_maxY = qMax(vertex.y(), m_maxY);
+}
+
+// Doesn't modify the object, so it can be called from the row block worker threads
+void SurfaceObject::normalizeVertex(const QSurfaceDataItem &data, QVector3D &vertex,
+                                    bool polar, bool flipXZ)
 {
     float normalizedX;
     float normalizedZ;
@@ -876,8 +1395,6 @@ void SurfaceObject::getNormalizedVertex(const QSurfaceDataItem &data, QVector3D
         }
     }
     float normalizedY = m_axisCacheY.positionAt(data.y());
-    m_minY = qMin(normalizedY, m_minY);
-    m_maxY = qMax(normalizedY, m_maxY);
     vertex.setX(normalizedX);
     vertex.setY(normalizedY);
     vertex.setZ(normalizedZ);
@@ -897,8 +1414,10 @@ GLuint SurfaceObject::uvBuf()
 
     if (m_returnTextureBuffer)
         return m_uvTextureBuffer;
-    else
-        return m_uvbuffer;
+
+    if (m_surfaceType == SurfaceSmooth && m_uvRingStart != m_ringStart)
+        createRingUVs();
+    return m_uvbuffer;
 }
 
 GLuint SurfaceObject::gridIndexCount()
@@ -915,8 +1434,16 @@ QVector3D SurfaceObject::vertexAt(int column, int row)
     if (m_surfaceType == SurfaceFlat)
         pos = row * (m_columns * 2 - 2) + column * 2 - (column > 0);
     else
-        pos = row * m_columns + column;
-    return m_vertices.at(pos);
+        pos = ringIndex(column, row);
+    return m_vertices.at(pos) + m_positionOffset;
+}
+
+// Position of a data item that doesn't need to be one of the vertices
+QVector3D SurfaceObject::normalizedVertex(const QSurfaceDataItem &data, bool polar)
+{
+    QVector3D vertex;
+    normalizeVertex(data, vertex, polar, false);
+    return vertex;
 }
 
 void SurfaceObject::clear()
@@ -926,6 +1453,11 @@ void SurfaceObject::clear()
     m_surfaceType = Undefined;
     m_vertices.clear();
     m_normals.clear();
+    m_dirtyVertexRanges.clear();
+    m_dirtyNormalRanges.clear();
+    m_tiles.clear();
+    m_tileColumns = 0;
+    resetRing();
 }
 
 void SurfaceObject::createCoarseIndices(GLint *indices, int &p, int row, int upperRow, int j)
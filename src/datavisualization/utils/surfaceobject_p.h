@@ -45,13 +45,15 @@
 #include "qsurfacedataproxy.h"
 
 #include <QtCore/QRect>
+#include <QtCore/QPair>
+#include <QtGui/QMatrix4x4>
 
 QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 
 class Surface3DRenderer;
 class AxisRenderCache;
 
-class SurfaceObject : public AbstractObjectHelper
+class QT_DATAVISUALIZATION_EXPORT SurfaceObject : public AbstractObjectHelper
 {
 public:
     enum SurfaceType {
@@ -82,6 +84,7 @@ public:
     void updateSmoothRow(const QSurfaceDataArray &dataArray, int startRow, bool polar);
     void updateSmoothItem(const QSurfaceDataArray &dataArray, int row, int column, bool polar);
     void updateCoarseItem(const QSurfaceDataArray &dataArray, int row, int column, bool polar);
+    bool scrollRows(const QSurfaceDataArray &dataArray, int count);
     void createSmoothIndices(int x, int y, int endX, int endY);
     void createCoarseSubSection(int x, int y, int columns, int rows);
     void createSmoothGridlineIndices(int x, int y, int endX, int endY);
@@ -91,10 +94,13 @@ public:
     GLuint uvBuf();
     GLuint gridIndexCount();
     QVector3D vertexAt(int column, int row);
+    QVector3D normalizedVertex(const QSurfaceDataItem &data, bool polar);
     void clear();
     float minYValue() const { return m_minY; }
     float maxYValue() const { return m_maxY; }
     inline void activateSurfaceTexture(bool value) { m_returnTextureBuffer = value; }
+    inline const QVector3D &positionOffset() const { return m_positionOffset; }
+    const QVector<QPair<int, int> > &visibleIndexRanges(const QMatrix4x4 &mvpMatrix);
 
 private:
     void createCoarseIndices(GLint *indices, int &p, int row, int upperRow, int j);
@@ -103,12 +109,36 @@ private:
     void createSmoothNormalUpperLine(int &totalIndex);
     QVector3D createSmoothNormalBodyLineItem(int x, int y);
     QVector3D createSmoothNormalUpperLineItem(int x, int y);
+    void createSmoothNormalRow(int row);
     QVector3D normal(const QVector3D &a, const QVector3D &b, const QVector3D &c);
     void createBuffers(const QVector<QVector3D> &vertices, const QVector<QVector2D> &uvs,
                        const QVector<QVector3D> &normals, const GLint *indices);
     void checkDirections(const QSurfaceDataArray &array);
+    void addDirtyRange(QVector<QPair<int, int> > &ranges, int start, int end);
+    void uploadDirtyRanges(GLuint buffer, const QVector<QVector3D> &data,
+                           QVector<QPair<int, int> > &ranges);
+    bool resetRing();
+    void storeAxisReferences();
+    bool resolveScrollOffset(QVector3D &offset);
+    void createRingIndices();
+    void updateRingSeam(int oldSeam);
+    void createRingStripIndices(GLint *indices, int strip);
+    void createRingStripGridIndices(GLint *gridIndices, int strip);
+    void createRingUVs();
+    int rowBlockCount(int itemCount) const;
+    GLint *createTiledIndices(int x, int y, int endX, int endY, int stride, int columnStep);
+    void updateTileBounds(int startTileRow, int endTileRow);
+    void updateDirtyTileBounds();
+    inline int ringSeam() const { return (m_ringStart + m_rows - 1) % m_rows; }
+    // Index of the vertex at the data position, rows are rotated in ring buffer mode
+    inline int ringIndex(int column, int row) const
+    {
+        return ((row + m_ringStart) % m_rows) * m_columns + column;
+    }
     inline void getNormalizedVertex(const QSurfaceDataItem &data, QVector3D &vertex, bool polar,
                                     bool flipXZ);
+    inline void normalizeVertex(const QSurfaceDataItem &data, QVector3D &vertex, bool polar,
+                                bool flipXZ);
 
 private:
     SurfaceType m_surfaceType;
@@ -118,6 +148,23 @@ private:
     GLuint m_gridIndexCount;
     QVector<QVector3D> m_vertices;
     QVector<QVector3D> m_normals;
+    // Triangles of a block of quads, stored as a contiguous range of the element buffer
+    struct SurfaceTile {
+        int indexOffset;
+        int indexCount;
+        int startRow; // Quad rows and columns [start, end)
+        int endRow;
+        int startColumn;
+        int endColumn;
+        QVector3D minBounds;
+        QVector3D maxBounds;
+    };
+    QVector<SurfaceTile> m_tiles; // Row-major, empty if the surface is not tiled
+    int m_tileColumns;
+    QVector<QPair<int, int> > m_visibleIndexRanges;
+    // Index ranges [start, end) changed since the last upload, sorted and non-overlapping
+    QVector<QPair<int, int> > m_dirtyVertexRanges;
+    QVector<QPair<int, int> > m_dirtyNormalRanges;
     // Caches are not owned
     AxisRenderCache &m_axisCacheX;
     AxisRenderCache &m_axisCacheY;
@@ -129,6 +176,13 @@ private:
     bool m_returnTextureBuffer;
     SurfaceObject::DataDimensions m_dataDimension;
     SurfaceObject::DataDimensions m_oldDataDimension;
+    // Ring buffer state of scrolled smooth surfaces
+    int m_ringStart; // Vertex row holding the first data row
+    bool m_ringLayout; // Index buffers have a strip for each row, the seam strip is degenerate
+    int m_uvRingStart; // Ring start the selection UVs were created for
+    QVector3D m_positionOffset; // Shift of the z-axis range since the vertices were created
+    QVector3D m_referenceValues[3];
+    QVector3D m_referencePositions[3];
 };
 
 QT_END_NAMESPACE_DATAVISUALIZATION
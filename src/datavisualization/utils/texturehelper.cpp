@@ -154,6 +154,144 @@ GLuint TextureHelper::create3DTexture(const QVector<uchar> *data, int width, int
     return textureId;
 }
 
+GLuint TextureHelper::create3DTexture(const QVector<uchar> *data, int lineSize, int frameHeight,
+                                      QImage::Format dataFormat, int x, int y, int z,
+                                      int width, int height, int depth)
+{
+    if (Utils::isOpenGLES() || !data || !width || !height || !depth)
+        return 0;
+
+    GLuint textureId = 0;
+#if defined(QT_OPENGL_ES_2)
+    Q_UNUSED(lineSize)
+    Q_UNUSED(frameHeight)
+    Q_UNUSED(dataFormat)
+    Q_UNUSED(x)
+    Q_UNUSED(y)
+    Q_UNUSED(z)
+#else
+    GLint internalFormat = 4;
+    GLint format = GL_BGRA;
+    int pixelWidth = 4;
+    if (dataFormat == QImage::Format_Indexed8) {
+        internalFormat = 1;
+        format = GL_RED;
+        pixelWidth = 1;
+    }
+    int dataOffset = (z * frameHeight + y) * lineSize + x * pixelWidth;
+    if (dataOffset + ((depth - 1) * frameHeight + height - 1) * lineSize + width * pixelWidth
+            > data->size()) {
+        return 0;
+    }
+
+    glEnable(GL_TEXTURE_3D);
+
+    glGenTextures(1, &textureId);
+    glBindTexture(GL_TEXTURE_3D, textureId);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+
+    GLenum status = glGetError();
+    while (status)
+        status = glGetError();
+
+    // The box is read straight from the volume array, so the rows and images of the source
+    // are strided by the volume dimensions
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, lineSize / pixelWidth);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, frameHeight);
+    m_openGlFunctions_2_1->glTexImage3D(GL_TEXTURE_3D, 0, internalFormat, width, height, depth, 0,
+                                        format, GL_UNSIGNED_BYTE,
+                                        data->constData() + dataOffset);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+    status = glGetError();
+    if (status)
+        qWarning() << __FUNCTION__ << "3D texture creation failed:" << status;
+
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glDisable(GL_TEXTURE_3D);
+#endif
+    return textureId;
+}
+
+void TextureHelper::update3DSubTexture(GLuint textureId, const QVector<uchar> *data,
+                                       int lineSize, int width, int height, int depth,
+                                       QImage::Format dataFormat, Qt::Axis axis,
+                                       int first, int last)
+{
+    if (Utils::isOpenGLES() || !textureId || !data || first < 0 || last < first)
+        return;
+
+#if defined(QT_OPENGL_ES_2)
+    Q_UNUSED(lineSize)
+    Q_UNUSED(width)
+    Q_UNUSED(height)
+    Q_UNUSED(depth)
+    Q_UNUSED(dataFormat)
+    Q_UNUSED(axis)
+#else
+    GLint format = GL_BGRA;
+    int pixelWidth = 4;
+    if (dataFormat == QImage::Format_Indexed8) {
+        format = GL_RED;
+        pixelWidth = 1;
+    }
+    int frameSize = lineSize * height;
+
+    int xOffset = 0;
+    int yOffset = 0;
+    int zOffset = 0;
+    int subWidth = width;
+    int subHeight = height;
+    int subDepth = depth;
+    int dataOffset;
+    if (axis == Qt::XAxis) {
+        xOffset = first;
+        subWidth = last - first + 1;
+        dataOffset = first * pixelWidth;
+    } else if (axis == Qt::YAxis) {
+        yOffset = first;
+        subHeight = last - first + 1;
+        dataOffset = first * lineSize;
+    } else {
+        zOffset = first;
+        subDepth = last - first + 1;
+        dataOffset = first * frameSize;
+    }
+    if (frameSize * depth > data->size())
+        return;
+
+    GLenum status = glGetError();
+    while (status)
+        status = glGetError();
+
+    glEnable(GL_TEXTURE_3D);
+    glBindTexture(GL_TEXTURE_3D, textureId);
+    // The slab is read straight from the full volume array, so rows and images are strided
+    // by the volume dimensions rather than by the slab dimensions
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, lineSize / pixelWidth);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, height);
+    m_openGlFunctions_2_1->glTexSubImage3D(GL_TEXTURE_3D, 0, xOffset, yOffset, zOffset,
+                                           subWidth, subHeight, subDepth, format,
+                                           GL_UNSIGNED_BYTE, data->constData() + dataOffset);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+    status = glGetError();
+    if (status)
+        qWarning() << __FUNCTION__ << "3D texture update failed:" << status;
+
+    glBindTexture(GL_TEXTURE_3D, 0);
+    glDisable(GL_TEXTURE_3D);
+#endif
+}
+
 GLuint TextureHelper::createCubeMapTexture(const QImage &image, bool useTrilinearFiltering)
 {
     if (image.isNull())
@@ -238,31 +376,6 @@ GLuint TextureHelper::createSelectionTexture(const QSize &size, GLuint &frameBuf
     return textureid;
 }
 
-GLuint TextureHelper::createCursorPositionTexture(const QSize &size, GLuint &frameBuffer)
-{
-    GLuint textureid;
-    glGenTextures(1, &textureid);
-    glBindTexture(GL_TEXTURE_2D, textureid);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.width(), size.height(), 0, GL_RGBA,
-                 GL_UNSIGNED_BYTE, NULL);
-    glBindTexture(GL_TEXTURE_2D, 0);
-
-    glGenFramebuffers(1, &frameBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
-                           textureid, 0);
-
-    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-    if (status != GL_FRAMEBUFFER_COMPLETE) {
-        qCritical() << "Cursor position mapper frame buffer creation failed:" << status;
-        glDeleteTextures(1, &textureid);
-        textureid = 0;
-    }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-    return textureid;
-}
-
 GLuint TextureHelper::createUniformTexture(const QColor &color)
 {
     QImage image(QSize(int(uniformTextureWidth), int(uniformTextureHeight)),
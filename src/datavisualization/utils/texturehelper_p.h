@@ -61,10 +61,19 @@ class TextureHelper : protected QOpenGLFunctions
                            bool convert = true, bool smoothScale = true, bool clampY = false);
     GLuint create3DTexture(const QVector<uchar> *data, int width, int height, int depth,
                            QImage::Format dataFormat);
+    // Uploads the inclusive slab of slices first..last along axis into an existing 3D texture
+    // of a volume whose lines are lineSize bytes long
+    void update3DSubTexture(GLuint textureId, const QVector<uchar> *data, int lineSize,
+                            int width, int height, int depth, QImage::Format dataFormat,
+                            Qt::Axis axis, int first, int last);
+    // Creates a texture from the width x height x depth box at x, y, z of a volume whose lines are
+    // lineSize bytes long and whose frames have frameHeight lines
+    GLuint create3DTexture(const QVector<uchar> *data, int lineSize, int frameHeight,
+                           QImage::Format dataFormat, int x, int y, int z,
+                           int width, int height, int depth);
     GLuint createCubeMapTexture(const QImage &image, bool useTrilinearFiltering = false);
     // Returns selection texture and inserts generated framebuffers to framebuffer parameters
     GLuint createSelectionTexture(const QSize &size, GLuint &frameBuffer, GLuint &depthBuffer);
-    GLuint createCursorPositionTexture(const QSize &size, GLuint &frameBuffer);
     GLuint createUniformTexture(const QColor &color);
     GLuint createGradientTexture(const QLinearGradient &gradient);
     GLuint createDepthTexture(const QSize &size, GLuint textureSize);
@@ -43,6 +43,8 @@ QT_BEGIN_NAMESPACE_DATAVISUALIZATION
 static bool staticsResolved = false;
 static GLint maxTextureSize = 0;
 static bool isES = false;
+static bool instancingSupported = false;
+static bool bufferMappingSupported = false;
 
 GLuint Utils::getNearestPowerOfTwo(GLuint value)
 {
@@ -335,6 +337,20 @@ bool Utils::isOpenGLES()
     return isES;
 }
 
+bool Utils::isInstancingSupported()
+{
+    if (!staticsResolved)
+        resolveStatics();
+    return instancingSupported;
+}
+
+bool Utils::isBufferMappingSupported()
+{
+    if (!staticsResolved)
+        resolveStatics();
+    return bufferMappingSupported;
+}
+
 void Utils::resolveStatics()
 {
     QOpenGLContext *ctx = QOpenGLContext::currentContext();
@@ -374,6 +390,16 @@ void Utils::resolveStatics()
     }
 #endif
 
+    // Instanced drawing and attribute divisors are core in OpenGL 3.3 and OpenGL ES 3.0
+    const QSurfaceFormat ctxFormat = ctx->format();
+    if (ctx->isOpenGLES())
+        instancingSupported = (ctxFormat.majorVersion() >= 3);
+    else
+        instancingSupported = (ctxFormat.version() >= qMakePair(3, 3));
+
+    // Buffer range mapping is core in OpenGL 3.0 and OpenGL ES 3.0
+    bufferMappingSupported = (ctxFormat.majorVersion() >= 3);
+
     if (dummySurface) {
         ctx->doneCurrent();
         delete ctx;
@@ -9,7 +9,14 @@ HEADERS += $$PWD/meshloader_p.h \
            $$PWD/surfaceobject_p.h \
            $$PWD/qutils.h \
            $$PWD/scatterobjectbufferhelper_p.h \
-           $$PWD/scatterpointbufferhelper_p.h
+           $$PWD/scatterpointbufferhelper_p.h \
+           $$PWD/barinstancebufferhelper_p.h \
+           $$PWD/scatterinstancebufferhelper_p.h \
+           $$PWD/surfacelodpyramid_p.h \
+           $$PWD/labeltexturecache_p.h \
+           $$PWD/scatterpickindex_p.h \
+           $$PWD/rowblocks_p.h \
+           $$PWD/valuelimits_p.h
 
 SOURCES += $$PWD/meshloader.cpp \
            $$PWD/vertexindexer.cpp \
@@ -21,6 +28,12 @@ SOURCES += $$PWD/meshloader.cpp \
            $$PWD/abstractobjecthelper.cpp \
            $$PWD/surfaceobject.cpp \
            $$PWD/scatterobjectbufferhelper.cpp \
-           $$PWD/scatterpointbufferhelper.cpp
+           $$PWD/scatterpointbufferhelper.cpp \
+           $$PWD/barinstancebufferhelper.cpp \
+           $$PWD/scatterinstancebufferhelper.cpp \
+           $$PWD/surfacelodpyramid.cpp \
+           $$PWD/labeltexturecache.cpp \
+           $$PWD/scatterpickindex.cpp \
+           $$PWD/valuelimits.cpp
 
 INCLUDEPATH += $$PWD
@@ -81,6 +81,8 @@ public:
     static float wrapValue(float value, float min, float max);
     static QQuaternion calculateRotation(const QVector3D &xyzRotations);
     static bool isOpenGLES();
+    static bool isInstancingSupported();
+    static bool isBufferMappingSupported();
     static void resolveStatics();
 
 private:
@@ -0,0 +1,177 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+#include "valuelimits_p.h"
+#include <QtCore/qnumeric.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+static const int maxScannedComponents = 3;
+
+static inline float positiveInfinity()
+{
+    return float(qInf());
+}
+
+void ValueLimits::reset()
+{
+    minPositive = positiveInfinity();
+    minNegative = positiveInfinity();
+    max = -positiveInfinity();
+    hasZero = false;
+}
+
+// Returns the smallest value the axis allows
+bool ValueLimits::minimum(bool allowNegatives, bool allowZero, float &value) const
+{
+    if (allowNegatives && minNegative < 0.0f) {
+        value = minNegative;
+        return true;
+    }
+    if (allowZero && hasZero) {
+        value = 0.0f;
+        return true;
+    }
+    if (minPositive != positiveInfinity()) {
+        value = minPositive;
+        return true;
+    }
+    return false;
+}
+
+bool ValueLimits::hasMaximum() const
+{
+    return max != -positiveInfinity();
+}
+
+static void scanScalar(const float *const *values, int components, int start, int count,
+                       ValueLimits *limits)
+{
+    const int end = start + count;
+    for (int i = start; i < end; i++) {
+        for (int c = 0; c < components; c++) {
+            const float value = values[c][i];
+            if (qIsNaN(value) || qIsInf(value))
+                break;
+            ValueLimits &limit = limits[c];
+            if (value > 0.0f) {
+                if (limit.minPositive > value)
+                    limit.minPositive = value;
+            } else if (value < 0.0f) {
+                if (limit.minNegative > value)
+                    limit.minNegative = value;
+            } else {
+                limit.hasZero = true;
+            }
+            if (limit.max < value)
+                limit.max = value;
+        }
+    }
+}
+
+#if defined(__SSE2__)
+static inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Processes four items at a time. Invalid values are masked out instead of branched on, so
+// the scan runs at the speed of reading the values regardless of the data.
+static int scanSse2(const float *const *values, int components, int count,
+                    ValueLimits *limits)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 infinity = _mm_set1_ps(positiveInfinity());
+    const __m128 negativeInfinity = _mm_set1_ps(-positiveInfinity());
+
+    __m128 minPositive[maxScannedComponents];
+    __m128 minNegative[maxScannedComponents];
+    __m128 max[maxScannedComponents];
+    __m128 zeros[maxScannedComponents];
+    for (int c = 0; c < components; c++) {
+        minPositive[c] = infinity;
+        minNegative[c] = infinity;
+        max[c] = negativeInfinity;
+        zeros[c] = zero;
+    }
+
+    const int vectorCount = count & ~3;
+    for (int i = 0; i < vectorCount; i += 4) {
+        __m128 valid = _mm_cmpeq_ps(zero, zero);
+        for (int c = 0; c < components; c++) {
+            const __m128 value = _mm_loadu_ps(values[c] + i);
+            // NaN and infinity give NaN when subtracted from themselves
+            valid = _mm_and_ps(valid, _mm_cmpeq_ps(_mm_sub_ps(value, value), zero));
+            const __m128 positive = _mm_and_ps(valid, _mm_cmpgt_ps(value, zero));
+            const __m128 negative = _mm_and_ps(valid, _mm_cmplt_ps(value, zero));
+            minPositive[c] = _mm_min_ps(minPositive[c], select(positive, value, infinity));
+            minNegative[c] = _mm_min_ps(minNegative[c], select(negative, value, infinity));
+            zeros[c] = _mm_or_ps(zeros[c], _mm_and_ps(valid, _mm_cmpeq_ps(value, zero)));
+            max[c] = _mm_max_ps(max[c], select(valid, value, negativeInfinity));
+        }
+    }
+
+    for (int c = 0; c < components; c++) {
+        float lanes[4];
+        ValueLimits &limit = limits[c];
+        _mm_storeu_ps(lanes, minPositive[c]);
+        for (int j = 0; j < 4; j++)
+            limit.minPositive = qMin(limit.minPositive, lanes[j]);
+        _mm_storeu_ps(lanes, minNegative[c]);
+        for (int j = 0; j < 4; j++)
+            limit.minNegative = qMin(limit.minNegative, lanes[j]);
+        _mm_storeu_ps(lanes, max[c]);
+        for (int j = 0; j < 4; j++)
+            limit.max = qMax(limit.max, lanes[j]);
+        if (_mm_movemask_ps(zeros[c]))
+            limit.hasZero = true;
+    }
+
+    return vectorCount;
+}
+#endif
+
+void ValueLimits::scan(const float *const *values, int components, int count,
+                       ValueLimits *limits)
+{
+    Q_ASSERT(components > 0 && components <= maxScannedComponents);
+
+    int scanned = 0;
+#if defined(__SSE2__)
+    scanned = scanSse2(values, components, count, limits);
+#endif
+    scanScalar(values, components, scanned, count - scanned, limits);
+}
+
+QT_END_NAMESPACE_DATAVISUALIZATION
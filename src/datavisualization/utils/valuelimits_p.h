@@ -0,0 +1,71 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QtDataVisualization API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+
+#ifndef VALUELIMITS_P_H
+#define VALUELIMITS_P_H
+
+#include "datavisualizationglobal_p.h"
+
+QT_BEGIN_NAMESPACE_DATAVISUALIZATION
+
+// Value limits of a set of finite values along one axis. The minimum is tracked separately for
+// positive, zero, and negative values, as axes may not allow all of them. Missing minimums are
+// positive infinity and a missing maximum is negative infinity.
+struct QT_DATAVISUALIZATION_EXPORT ValueLimits
+{
+    float minPositive;
+    float minNegative;
+    float max;
+    bool hasZero;
+
+    void reset();
+    bool minimum(bool allowNegatives, bool allowZero, float &value) const;
+    bool hasMaximum() const;
+
+    // Scans count items whose coordinates are given in separate arrays, one for each of the
+    // components. An item with an invalid coordinate is ignored for that component and the
+    // components after it. The limits are combined with the existing ones.
+    static void scan(const float *const *values, int components, int count,
+                     ValueLimits *limits);
+};
+
+QT_END_NAMESPACE_DATAVISUALIZATION
+
+#endif
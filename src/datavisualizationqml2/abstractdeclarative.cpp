@@ -350,6 +350,8 @@ void AbstractDeclarative::setSharedController(Abstract3DController *controller)
                      &AbstractDeclarative::queriedGraphPositionChanged);
     QObject::connect(m_controller.data(), &Abstract3DController::marginChanged, this,
                      &AbstractDeclarative::marginChanged);
+    QObject::connect(m_controller.data(), &Abstract3DController::frameRendered, this,
+                     &AbstractDeclarative::frameRendered);
 }
 
 void AbstractDeclarative::activateOpenGLContext(QQuickWindow *window)
@@ -127,8 +127,10 @@ public:
     };
 
     enum OptimizationHint {
-        OptimizationDefault = 0,
-        OptimizationStatic  = 1
+        OptimizationDefault   = 0,
+        OptimizationStatic    = 1,
+        OptimizationInstanced = 2,
+        OptimizationAsyncSelection = 4
     };
     Q_DECLARE_FLAGS(OptimizationHints, OptimizationHint)
 
@@ -279,6 +281,7 @@ Q_SIGNALS:
     Q_REVISION(2) void localeChanged(const QLocale &locale);
     Q_REVISION(2) void queriedGraphPositionChanged(const QVector3D &data);
     Q_REVISION(2) void marginChanged(qreal margin);
+    Q_REVISION(3) void frameRendered();
 
 protected:
     QSharedPointer<QMutex> m_nodeMutex;
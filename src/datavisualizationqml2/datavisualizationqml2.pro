@@ -45,7 +45,7 @@ HEADERS += \
     glstatestore_p.h \
     enumtostringmap_p.h
 
-IMPORT_VERSION = 1.3
+IMPORT_VERSION = 1.4
 QMAKE_QMLPLUGINDUMP_FLAGS += -defaultplatform
 load(qml_plugin)
 
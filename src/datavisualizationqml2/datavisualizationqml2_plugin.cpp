@@ -143,6 +143,19 @@ void QtDataVisualizationQml2Plugin::registerTypes(const char *uri)
 
     // New revisions
     qmlRegisterType<Q3DLight, 1>(uri, 1, 3, "Light3D");
+
+    // QtDataVisualization 1.4
+
+    // New revisions
+    qmlRegisterUncreatableType<AbstractDeclarative, 3>(uri, 1, 4, "AbstractGraph3D",
+                                                       QLatin1String("Trying to create uncreatable: AbstractGraph3D."));
+    qmlRegisterUncreatableType<QSurface3DSeries, 1>(uri, 1, 4, "QSurface3DSeries",
+                                                    QLatin1String("Trying to create uncreatable: QSurface3DSeries, use Surface3DSeries instead."));
+    qmlRegisterType<DeclarativeSurface3DSeries, 1>(uri, 1, 4, "Surface3DSeries");
+    qmlRegisterType<QCustom3DVolume, 1>(uri, 1, 4, "Custom3DVolume");
+    qmlRegisterType<QItemModelBarDataProxy, 2>(uri, 1, 4, "ItemModelBarDataProxy");
+    qmlRegisterType<QItemModelSurfaceDataProxy, 2>(uri, 1, 4, "ItemModelSurfaceDataProxy");
+    qmlRegisterType<QItemModelScatterDataProxy, 2>(uri, 1, 4, "ItemModelScatterDataProxy");
 }
 
 QT_END_NAMESPACE_DATAVISUALIZATION
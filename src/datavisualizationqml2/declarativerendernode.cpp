@@ -45,7 +45,8 @@ DeclarativeRenderNode::DeclarativeRenderNode(AbstractDeclarative *declarative,
       m_multisampledFBO(0),
       m_window(0),
       m_samples(0),
-      m_dirtyFBO(false)
+      m_dirtyFBO(false),
+      m_validFrame(false)
 {
     m_nodeMutex = nodeMutex;
     setMaterial(&m_material);
@@ -116,6 +117,7 @@ void DeclarativeRenderNode::updateFBO()
     m_texture = m_window->createTextureFromId(m_fbo->texture(), m_size);
     m_material.setTexture(m_texture);
     m_materialO.setTexture(m_texture);
+    m_validFrame = false;
 
     m_declarative->doneOpenGLContext(m_window);
 }
@@ -153,6 +155,10 @@ void DeclarativeRenderNode::preprocess()
     if (!m_controller)
         return;
 
+    // The FBO keeps the previous frame, so it is only re-rendered when something has changed
+    if (m_validFrame && !m_controller->isFrameChanged())
+        return;
+
     QOpenGLFramebufferObject *targetFBO;
     if (m_samples > 0)
         targetFBO = m_multisampledFBO;
@@ -170,6 +176,8 @@ void DeclarativeRenderNode::preprocess()
     if (m_samples > 0)
         QOpenGLFramebufferObject::blitFramebuffer(m_fbo, m_multisampledFBO);
 
+    m_validFrame = true;
+
     m_declarative->doneOpenGLContext(m_window);
 }
 
@@ -92,6 +92,7 @@ private:
     int m_samples;
 
     bool m_dirtyFBO;
+    bool m_validFrame;
 
     QSharedPointer<QMutex> m_nodeMutex;
 
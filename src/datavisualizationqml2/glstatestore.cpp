@@ -41,7 +41,7 @@ GLStateStore::GLStateStore(QOpenGLContext *context, QObject *parent) :
     QObject(parent),
     QOpenGLFunctions(context)
   #ifdef VERBOSE_STATE_STORE
-  , m_map(EnumToStringMap::newInstance())
+    m_map(EnumToStringMap::newInstance())
   #endif
 {
     GLint maxVertexAttribs;
@@ -61,14 +61,7 @@ GLStateStore::GLStateStore(QOpenGLContext *context, QObject *parent) :
     }
 #endif
 
-    m_maxVertexAttribs = qMin(maxVertexAttribs, 2); // Datavis only uses 2 attribs max
-    m_vertexAttribArrayEnabledStates.reset(new GLint[maxVertexAttribs]);
-    m_vertexAttribArrayBoundBuffers.reset(new GLint[maxVertexAttribs]);
-    m_vertexAttribArraySizes.reset(new GLint[maxVertexAttribs]);
-    m_vertexAttribArrayTypes.reset(new GLint[maxVertexAttribs]);
-    m_vertexAttribArrayNormalized.reset(new GLint[maxVertexAttribs]);
-    m_vertexAttribArrayStrides.reset(new GLint[maxVertexAttribs]);
-    m_vertexAttribArrayOffsets.reset(new void *[maxVertexAttribs]);
+    m_maxVertexAttribs = qMin(maxVertexAttribs, int(maxTrackedVertexAttribs));
 
     initGLDefaultState();
 }
@@ -87,49 +80,63 @@ void GLStateStore::storeGLState()
     printCurrentState(true);
 #endif
 
+    // The host state is queried at every context switch, as other items may change what the
+    // scene graph leaves bound between frames. Only the state the renderers change is queried.
+    queryGLState(m_state);
+}
+
+void GLStateStore::queryGLState(GLState &state)
+{
 #if !defined(QT_OPENGL_ES_2)
-    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_drawFramebuffer);
-    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &m_readFramebuffer);
-    glGetIntegerv(GL_RENDERBUFFER_BINDING, &m_renderbuffer);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &state.drawFramebuffer);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &state.readFramebuffer);
+    glGetIntegerv(GL_RENDERBUFFER_BINDING, &state.renderbuffer);
 #endif
-    glGetFloatv(GL_COLOR_CLEAR_VALUE, m_clearColor);
-    m_isBlendingEnabled = glIsEnabled(GL_BLEND);
-    m_isDepthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &m_isDepthWriteEnabled);
-    glGetFloatv(GL_DEPTH_CLEAR_VALUE, &m_clearDepth);
-    glGetIntegerv(GL_DEPTH_FUNC, &m_depthFunc);
-    glGetBooleanv(GL_POLYGON_OFFSET_FILL, &m_polygonOffsetFillEnabled);
-    glGetFloatv(GL_POLYGON_OFFSET_FACTOR, &m_polygonOffsetFactor);
-    glGetFloatv(GL_POLYGON_OFFSET_UNITS, &m_polygonOffsetUnits);
-
-    glGetIntegerv(GL_CURRENT_PROGRAM, &m_currentProgram);
-    glGetIntegerv(GL_ACTIVE_TEXTURE, &m_activeTexture);
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &m_texBinding2D);
-    glGetIntegerv(GL_FRONT_FACE, &m_frontFace);
-    m_isCullFaceEnabled = glIsEnabled(GL_CULL_FACE);
-    glGetIntegerv(GL_CULL_FACE_MODE, &m_cullFaceMode);
-    glGetIntegerv(GL_BLEND_EQUATION_RGB, &m_blendEquationRGB);
-    glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &m_blendEquationAlpha);
-    glGetIntegerv(GL_BLEND_DST_ALPHA, &m_blendDestAlpha);
-    glGetIntegerv(GL_BLEND_DST_RGB, &m_blendDestRGB);
-    glGetIntegerv(GL_BLEND_SRC_ALPHA, &m_blendSrcAlpha);
-    glGetIntegerv(GL_BLEND_SRC_RGB, &m_blendSrcRGB);
-    glGetIntegerv(GL_SCISSOR_BOX, m_scissorBox);
-    m_isScissorTestEnabled = glIsEnabled(GL_SCISSOR_TEST);
-
-    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &m_boundArrayBuffer);
-    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &m_boundElementArrayBuffer);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, state.clearColor);
+    state.isBlendingEnabled = glIsEnabled(GL_BLEND);
+    state.isDepthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &state.isDepthWriteEnabled);
+    glGetIntegerv(GL_DEPTH_FUNC, &state.depthFunc);
+    glGetBooleanv(GL_POLYGON_OFFSET_FILL, &state.polygonOffsetFillEnabled);
+    glGetFloatv(GL_POLYGON_OFFSET_FACTOR, &state.polygonOffsetFactor);
+    glGetFloatv(GL_POLYGON_OFFSET_UNITS, &state.polygonOffsetUnits);
+
+    glGetIntegerv(GL_CURRENT_PROGRAM, &state.currentProgram);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &state.activeTexture);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &state.texBinding2D);
+    state.isCullFaceEnabled = glIsEnabled(GL_CULL_FACE);
+    glGetIntegerv(GL_CULL_FACE_MODE, &state.cullFaceMode);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &state.blendDestAlpha);
+    glGetIntegerv(GL_BLEND_DST_RGB, &state.blendDestRGB);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &state.blendSrcAlpha);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &state.blendSrcRGB);
+    glGetIntegerv(GL_SCISSOR_BOX, state.scissorBox);
+    state.isScissorTestEnabled = glIsEnabled(GL_SCISSOR_TEST);
+
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &state.boundArrayBuffer);
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &state.boundElementArrayBuffer);
 
     for (int i = 0; i < m_maxVertexAttribs;i++) {
         glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED,
-                            &m_vertexAttribArrayEnabledStates[i]);
+                            &state.vertexAttribArrayEnabledStates[i]);
         glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING,
-                            &m_vertexAttribArrayBoundBuffers[i]);
-        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &m_vertexAttribArraySizes[i]);
-        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &m_vertexAttribArrayTypes[i]);
+                            &state.vertexAttribArrayBoundBuffers[i]);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &state.vertexAttribArraySizes[i]);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &state.vertexAttribArrayTypes[i]);
         glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED,
-                            &m_vertexAttribArrayNormalized[i]);
-        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &m_vertexAttribArrayStrides[i]);
+                            &state.vertexAttribArrayNormalized[i]);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &state.vertexAttribArrayStrides[i]);
+        glGetVertexAttribPointerv(i, GL_VERTEX_ATTRIB_ARRAY_POINTER,
+                                  &state.vertexAttribArrayOffsets[i]);
+    }
+    for (int i = m_maxVertexAttribs; i < maxTrackedVertexAttribs; i++) {
+        state.vertexAttribArrayEnabledStates[i] = GL_FALSE;
+        state.vertexAttribArrayBoundBuffers[i] = 0;
+        state.vertexAttribArraySizes[i] = 4;
+        state.vertexAttribArrayTypes[i] = GL_FLOAT;
+        state.vertexAttribArrayNormalized[i] = GL_FALSE;
+        state.vertexAttribArrayStrides[i] = 0;
+        state.vertexAttribArrayOffsets[i] = 0;
     }
 }
 
@@ -233,8 +240,8 @@ void GLStateStore::printCurrentState(bool in)
         msg << "    GL_RENDERBUFFER_BINDING " << renderbuffer << endl;
 #endif
         msg << "    GL_SCISSOR_TEST " << bool(isScissorTestEnabled) << endl;
-        msg << "    GL_SCISSOR_BOX " << m_scissorBox[0] << m_scissorBox[1] << m_scissorBox[2]
-            << m_scissorBox[3] << endl;
+        msg << "    GL_SCISSOR_BOX " << scissorBox[0] << scissorBox[1] << scissorBox[2]
+            << scissorBox[3] << endl;
         msg << "    GL_COLOR_CLEAR_VALUE "<< color << endl;
         msg << "    GL_DEPTH_CLEAR_VALUE "<< clearDepth << endl;
         msg << "    GL_BLEND "<< bool(isBlendingEnabled) << endl;
@@ -279,72 +286,69 @@ void GLStateStore::printCurrentState(bool in)
 void GLStateStore::restoreGLState()
 {
 #if !defined(QT_OPENGL_ES_2)
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFramebuffer);
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_drawFramebuffer);
-    glBindRenderbuffer(GL_RENDERBUFFER_BINDING, m_renderbuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_state.readFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_state.drawFramebuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_state.renderbuffer);
 #endif
 
-    if (m_isScissorTestEnabled)
+    if (m_state.isScissorTestEnabled)
         glEnable(GL_SCISSOR_TEST);
     else
         glDisable(GL_SCISSOR_TEST);
 
-    glScissor(m_scissorBox[0], m_scissorBox[1], m_scissorBox[2], m_scissorBox[3]);
-    glClearColor(m_clearColor[0], m_clearColor[1], m_clearColor[2], m_clearColor[3]);
-    glClearDepthf(m_clearDepth);
-    if (m_isBlendingEnabled)
+    glScissor(m_state.scissorBox[0], m_state.scissorBox[1], m_state.scissorBox[2], m_state.scissorBox[3]);
+    glClearColor(m_state.clearColor[0], m_state.clearColor[1], m_state.clearColor[2], m_state.clearColor[3]);
+    if (m_state.isBlendingEnabled)
         glEnable(GL_BLEND);
     else
         glDisable(GL_BLEND);
 
-    if (m_isDepthTestEnabled)
+    if (m_state.isDepthTestEnabled)
         glEnable(GL_DEPTH_TEST);
     else
         glDisable(GL_DEPTH_TEST);
 
-    if (m_isCullFaceEnabled)
+    if (m_state.isCullFaceEnabled)
         glEnable(GL_CULL_FACE);
     else
         glDisable(GL_CULL_FACE);
 
-    glCullFace(m_cullFaceMode);
+    glCullFace(m_state.cullFaceMode);
 
-    glBlendEquationSeparate(m_blendEquationRGB, m_blendEquationAlpha);
-    glBlendFuncSeparate(m_blendSrcRGB, m_blendDestRGB, m_blendSrcAlpha, m_blendDestAlpha);
+    glBlendFuncSeparate(m_state.blendSrcRGB, m_state.blendDestRGB, m_state.blendSrcAlpha, m_state.blendDestAlpha);
 
-    glDepthMask(m_isDepthWriteEnabled);
-    glDepthFunc(m_depthFunc);
-    glFrontFace(m_frontFace);
+    glDepthMask(m_state.isDepthWriteEnabled);
+    glDepthFunc(m_state.depthFunc);
 
-    if (m_polygonOffsetFillEnabled)
+    if (m_state.polygonOffsetFillEnabled)
         glEnable(GL_POLYGON_OFFSET_FILL);
     else
         glDisable(GL_POLYGON_OFFSET_FILL);
 
-    glPolygonOffset(m_polygonOffsetFactor, m_polygonOffsetUnits);
+    glPolygonOffset(m_state.polygonOffsetFactor, m_state.polygonOffsetUnits);
 
-    glUseProgram(m_currentProgram);
+    glUseProgram(m_state.currentProgram);
 
-    glActiveTexture(m_activeTexture);
-    glBindTexture(GL_TEXTURE_2D, m_texBinding2D);
+    glActiveTexture(m_state.activeTexture);
+    glBindTexture(GL_TEXTURE_2D, m_state.texBinding2D);
 
     // Restore bound element array buffer and array buffers
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_boundElementArrayBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_state.boundElementArrayBuffer);
     for (int i = 0; i < m_maxVertexAttribs; i++) {
-        if (m_vertexAttribArrayEnabledStates[i])
+        if (m_state.vertexAttribArrayEnabledStates[i])
             glEnableVertexAttribArray(i);
         else
             glDisableVertexAttribArray(i);
 
-        glBindBuffer(GL_ARRAY_BUFFER, m_vertexAttribArrayBoundBuffers[i]);
-        glVertexAttribPointer(i, m_vertexAttribArraySizes[i],
-                              m_vertexAttribArrayTypes[i],
-                              m_vertexAttribArrayNormalized[i],
-                              m_vertexAttribArrayStrides[i],
-                              m_vertexAttribArrayOffsets[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, m_state.vertexAttribArrayBoundBuffers[i]);
+        glVertexAttribPointer(i, m_state.vertexAttribArraySizes[i],
+                              m_state.vertexAttribArrayTypes[i],
+                              m_state.vertexAttribArrayNormalized[i],
+                              m_state.vertexAttribArrayStrides[i],
+                              m_state.vertexAttribArrayOffsets[i]);
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_boundArrayBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_state.boundArrayBuffer);
 
 #ifdef VERBOSE_STATE_STORE
     printCurrentState(false);
@@ -354,40 +358,43 @@ void GLStateStore::restoreGLState()
 void GLStateStore::initGLDefaultState()
 {
 #if !defined(QT_OPENGL_ES_2)
-    m_drawFramebuffer = 0;
-    m_readFramebuffer = 0;
-    m_renderbuffer = 0;
+    m_state.drawFramebuffer = 0;
+    m_state.readFramebuffer = 0;
+    m_state.renderbuffer = 0;
 #endif
-    m_clearColor[0] = m_clearColor[1] = m_clearColor[2] = m_clearColor[3] = 1.0f;
-    m_clearDepth = 1.0f;
-    m_isBlendingEnabled = GL_FALSE;
-    m_isDepthTestEnabled = GL_FALSE;
-    m_depthFunc = GL_LESS;
-    m_isDepthWriteEnabled = GL_TRUE;
-    m_currentProgram = 0;
-    m_texBinding2D = 0;
-    for (int i = 0; i < m_maxVertexAttribs;i++) {
-        m_vertexAttribArrayEnabledStates[i] = GL_FALSE;
-        m_vertexAttribArrayBoundBuffers[i] = 0;
-        m_vertexAttribArraySizes[i] = 4;
-        m_vertexAttribArrayTypes[i] = GL_FLOAT;
-        m_vertexAttribArrayNormalized[i] = GL_FALSE;
-        m_vertexAttribArrayStrides[i] = 0;
-        m_vertexAttribArrayOffsets[i] = 0;
+    m_state.clearColor[0] = m_state.clearColor[1] = m_state.clearColor[2] = 1.0f;
+    m_state.clearColor[3] = 1.0f;
+    m_state.isBlendingEnabled = GL_FALSE;
+    m_state.isDepthTestEnabled = GL_FALSE;
+    m_state.depthFunc = GL_LESS;
+    m_state.isDepthWriteEnabled = GL_TRUE;
+    m_state.currentProgram = 0;
+    m_state.texBinding2D = 0;
+    for (int i = 0; i < maxTrackedVertexAttribs; i++) {
+        m_state.vertexAttribArrayEnabledStates[i] = GL_FALSE;
+        m_state.vertexAttribArrayBoundBuffers[i] = 0;
+        m_state.vertexAttribArraySizes[i] = 4;
+        m_state.vertexAttribArrayTypes[i] = GL_FLOAT;
+        m_state.vertexAttribArrayNormalized[i] = GL_FALSE;
+        m_state.vertexAttribArrayStrides[i] = 0;
+        m_state.vertexAttribArrayOffsets[i] = 0;
     }
-    m_activeTexture = GL_TEXTURE0;
-    m_frontFace = GL_CCW;
-    m_isCullFaceEnabled = false;
-    m_cullFaceMode = GL_BACK;
-    m_blendEquationRGB = GL_FUNC_ADD;
-    m_blendEquationAlpha = GL_FUNC_ADD;
-    m_scissorBox[0] = 0;
-    m_scissorBox[1] = 0;
-    m_scissorBox[2] = 0;
-    m_scissorBox[3] = 0;
-    m_isScissorTestEnabled = GL_FALSE;
-
-    m_polygonOffsetFillEnabled = GL_FALSE;
-    m_polygonOffsetFactor = 0.0;
-    m_polygonOffsetUnits = 0.0;
+    m_state.activeTexture = GL_TEXTURE0;
+    m_state.isCullFaceEnabled = false;
+    m_state.cullFaceMode = GL_BACK;
+    m_state.blendDestAlpha = GL_ZERO;
+    m_state.blendDestRGB = GL_ZERO;
+    m_state.blendSrcAlpha = GL_ONE;
+    m_state.blendSrcRGB = GL_ONE;
+    m_state.boundArrayBuffer = 0;
+    m_state.boundElementArrayBuffer = 0;
+    m_state.scissorBox[0] = 0;
+    m_state.scissorBox[1] = 0;
+    m_state.scissorBox[2] = 0;
+    m_state.scissorBox[3] = 0;
+    m_state.isScissorTestEnabled = GL_FALSE;
+
+    m_state.polygonOffsetFillEnabled = GL_FALSE;
+    m_state.polygonOffsetFactor = 0.0;
+    m_state.polygonOffsetUnits = 0.0;
 }
@@ -41,7 +41,6 @@
 #define GLSTATESTORE_P_H
 
 #include <QtGui/QOpenGLFunctions>
-#include <QtCore/QScopedArrayPointer>
 #include "enumtostringmap_p.h"
 
 class GLStateStore : public QObject, protected QOpenGLFunctions
@@ -60,46 +59,53 @@ public:
     EnumToStringMap *m_map;
 #endif
 
-    GLint m_scissorBox[4];
-    GLboolean m_isScissorTestEnabled;
+    // Instanced datavis shaders use up to five attributes. Their locations are assigned by the
+    // linker, so a few spare locations are tracked as well.
+    static const int maxTrackedVertexAttribs = 8;
+
+    struct GLState {
+        GLint scissorBox[4];
+        GLboolean isScissorTestEnabled;
 
 #if !defined(QT_OPENGL_ES_2)
-    GLint m_drawFramebuffer;
-    GLint m_readFramebuffer;
-    GLint m_renderbuffer;
+        GLint drawFramebuffer;
+        GLint readFramebuffer;
+        GLint renderbuffer;
 #endif
-    GLfloat m_clearColor[4];
-    GLfloat m_clearDepth;
-    GLboolean m_isBlendingEnabled;
-    GLboolean m_isDepthTestEnabled;
-    GLint m_depthFunc;
-    GLboolean m_isDepthWriteEnabled;
-    GLint m_currentProgram;
+        GLfloat clearColor[4];
+        GLboolean isBlendingEnabled;
+        GLboolean isDepthTestEnabled;
+        GLint depthFunc;
+        GLboolean isDepthWriteEnabled;
+        GLint currentProgram;
+        GLint vertexAttribArrayEnabledStates[maxTrackedVertexAttribs];
+        GLint vertexAttribArrayBoundBuffers[maxTrackedVertexAttribs];
+        GLint vertexAttribArraySizes[maxTrackedVertexAttribs];
+        GLint vertexAttribArrayTypes[maxTrackedVertexAttribs];
+        GLint vertexAttribArrayNormalized[maxTrackedVertexAttribs];
+        GLint vertexAttribArrayStrides[maxTrackedVertexAttribs];
+        void *vertexAttribArrayOffsets[maxTrackedVertexAttribs];
+
+        GLint activeTexture;
+        GLint texBinding2D;
+        GLboolean isCullFaceEnabled;
+        GLint cullFaceMode;
+        GLint blendDestAlpha;
+        GLint blendDestRGB;
+        GLint blendSrcAlpha;
+        GLint blendSrcRGB;
+        GLint boundArrayBuffer;
+        GLint boundElementArrayBuffer;
+        GLboolean polygonOffsetFillEnabled;
+        GLfloat polygonOffsetFactor;
+        GLfloat polygonOffsetUnits;
+    };
+
     GLint m_maxVertexAttribs;
-    QScopedArrayPointer<GLint> m_vertexAttribArrayEnabledStates;
-    QScopedArrayPointer<GLint> m_vertexAttribArrayBoundBuffers;
-    QScopedArrayPointer<GLint> m_vertexAttribArraySizes;
-    QScopedArrayPointer<GLint> m_vertexAttribArrayTypes;
-    QScopedArrayPointer<GLint> m_vertexAttribArrayNormalized;
-    QScopedArrayPointer<GLint> m_vertexAttribArrayStrides;
-    QScopedArrayPointer<void *> m_vertexAttribArrayOffsets;
+    GLState m_state;
 
-    GLint m_activeTexture;
-    GLint m_texBinding2D;
-    GLint m_frontFace;
-    GLboolean m_isCullFaceEnabled;
-    GLint m_cullFaceMode;
-    GLint m_blendEquationRGB;
-    GLint m_blendEquationAlpha;
-    GLint m_blendDestAlpha;
-    GLint m_blendDestRGB;
-    GLint m_blendSrcAlpha;
-    GLint m_blendSrcRGB;
-    GLint m_boundArrayBuffer;
-    GLint m_boundElementArrayBuffer;
-    GLboolean m_polygonOffsetFillEnabled;
-    GLfloat m_polygonOffsetFactor;
-    GLfloat m_polygonOffsetUnits;
+private:
+    void queryGLState(GLState &state);
 };
 
 #endif
@@ -31,6 +31,7 @@
 
 #include <QtGui/private/qguiapplication_p.h>
 #include <QtGui/qpa/qplatformintegration.h>
+#include <QtGui/QImage>
 
 QT_BEGIN_NAMESPACE
 
@@ -41,6 +42,32 @@ static bool isOpenGLSupported()
     return QGuiApplicationPrivate::platformIntegration()->hasCapability(QPlatformIntegration::OpenGL);
 }
 
+// Compares two renderings of the same scene. Different drawing paths may rasterize the edges of
+// the items slightly differently, so a few pixels are allowed to differ.
+static bool imagesMatch(const QImage &image1, const QImage &image2)
+{
+    if (image1.size() != image2.size())
+        return false;
+
+    const QImage rgb1 = image1.convertToFormat(QImage::Format_RGB32);
+    const QImage rgb2 = image2.convertToFormat(QImage::Format_RGB32);
+    const int channelTolerance = 8;
+    const int allowedDifferences = rgb1.width() * rgb1.height() / 100;
+    int differences = 0;
+    for (int y = 0; y < rgb1.height(); y++) {
+        const QRgb *line1 = reinterpret_cast<const QRgb *>(rgb1.constScanLine(y));
+        const QRgb *line2 = reinterpret_cast<const QRgb *>(rgb2.constScanLine(y));
+        for (int x = 0; x < rgb1.width(); x++) {
+            if (qAbs(qRed(line1[x]) - qRed(line2[x])) > channelTolerance
+                    || qAbs(qGreen(line1[x]) - qGreen(line2[x])) > channelTolerance
+                    || qAbs(qBlue(line1[x]) - qBlue(line2[x])) > channelTolerance) {
+                differences++;
+            }
+        }
+    }
+    return differences <= allowedDifferences;
+}
+
 } // CpptestUtil namespace
 
 QT_END_NAMESPACE
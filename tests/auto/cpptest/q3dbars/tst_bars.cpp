@@ -71,6 +71,9 @@ private slots:
     void removeCustomItem();
 
     void renderToImage();
+    void renderToImageAsync();
+    void renderInstanced();
+    void graphPositionQuery();
 
 private:
     Q3DBars *m_graph;
@@ -199,6 +202,13 @@ void tst_bars::initializeProperties()
     QCOMPARE(m_graph->reflectivity(), 0.1);
     QCOMPARE(m_graph->locale(), QLocale("FI"));
     QCOMPARE(m_graph->margin(), 1.0);
+
+    m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationInstanced);
+    QCOMPARE(m_graph->optimizationHints(), QAbstract3DGraph::OptimizationInstanced);
+    m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationInstanced
+                                  | QAbstract3DGraph::OptimizationAsyncSelection);
+    QCOMPARE(m_graph->optimizationHints(), QAbstract3DGraph::OptimizationInstanced
+             | QAbstract3DGraph::OptimizationAsyncSelection);
 }
 
 void tst_bars::invalidProperties()
@@ -420,5 +430,93 @@ void tst_bars::renderToImage()
     */
 }
 
+void tst_bars::renderToImageAsync()
+{
+    m_graph->addSeries(newSeries());
+
+    QSignalSpy spy(m_graph, &QAbstract3DGraph::imageRendered);
+
+    // The third request has to finish the first one, as only two readbacks are kept in flight
+    m_graph->renderToImageAsync(0, QSize(200, 100));
+    m_graph->renderToImageAsync(0, QSize(150, 150));
+    m_graph->renderToImageAsync(0, QSize(100, 200));
+    QCOMPARE(spy.count(), 1);
+
+    // The rest are delivered in order once control returns to the event loop
+    QTRY_COMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(0).at(0).value<QImage>().size(), QSize(200, 100));
+    QCOMPARE(spy.at(1).at(0).value<QImage>().size(), QSize(150, 150));
+    QCOMPARE(spy.at(2).at(0).value<QImage>().size(), QSize(100, 200));
+
+    // The image matches the one rendered synchronously
+    QImage image = m_graph->renderToImage(0, QSize(150, 150));
+    QCOMPARE(spy.at(1).at(0).value<QImage>().convertToFormat(QImage::Format_RGB32),
+             image.convertToFormat(QImage::Format_RGB32));
+}
+
+void tst_bars::renderInstanced()
+{
+    QBar3DSeries *series = newSeries();
+    QBarDataRow *data = new QBarDataRow;
+    *data << 4.0f << -2.5f << 1.0f << 6.0f << 3.5f;
+    series->dataProxy()->addRow(data);
+    m_graph->addSeries(series);
+    m_graph->addSeries(newSeries());
+    m_graph->setMultiSeriesUniform(true);
+
+    const Q3DCamera::CameraPreset presets[] = { Q3DCamera::CameraPresetFront,
+                                                Q3DCamera::CameraPresetBehind,
+                                                Q3DCamera::CameraPresetIsometricRight,
+                                                Q3DCamera::CameraPresetDirectlyBelow };
+    const QSize size(300, 200);
+    for (int i = 0; i < int(sizeof(presets) / sizeof(presets[0])); i++) {
+        m_graph->scene()->activeCamera()->setCameraPreset(presets[i]);
+
+        // Opaque series, with a highlighted bar drawn separately from the instances
+        series->setBaseColor(Qt::darkGreen);
+        series->setSelectedBar(QPoint(1, 3));
+        m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationDefault);
+        QImage image = m_graph->renderToImage(0, size);
+        m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationInstanced);
+        QVERIFY(CpptestUtil::imagesMatch(m_graph->renderToImage(0, size), image));
+
+        // A transparent series is drawn in the camera dependent order
+        series->setBaseColor(QColor(255, 0, 0, 128));
+        series->setSelectedBar(QBar3DSeries::invalidSelectionPosition());
+        m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationDefault);
+        image = m_graph->renderToImage(0, size);
+        m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationInstanced);
+        QVERIFY(CpptestUtil::imagesMatch(m_graph->renderToImage(0, size), image));
+    }
+}
+
+void tst_bars::graphPositionQuery()
+{
+    m_graph->addSeries(newSeries());
+    m_graph->scene()->activeCamera()->setCameraPreset(Q3DCamera::CameraPresetDirectlyAbove);
+    m_graph->resize(400, 400);
+    m_graph->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_graph));
+
+    QSignalSpy spy(m_graph, &QAbstract3DGraph::queriedGraphPositionChanged);
+    const QPoint center(m_graph->width() / 2, m_graph->height() / 2);
+
+    // Bar graphs are queried at the floor level, so the floor center maps to the origin
+    m_graph->scene()->setGraphPositionQuery(center);
+    QVERIFY(spy.wait(5000));
+    QVector3D position = spy.last().at(0).value<QVector3D>();
+    QVERIFY(qAbs(position.x()) < 0.05f);
+    QCOMPARE(position.y(), 0.0f);
+    QVERIFY(qAbs(position.z()) < 0.05f);
+
+    // Outside the floor the position is far outside the graph
+    m_graph->scene()->activeCamera()->setZoomLevel(10.0f);
+    m_graph->scene()->setGraphPositionQuery(QPoint(2, 2));
+    QVERIFY(spy.wait(5000));
+    position = spy.last().at(0).value<QVector3D>();
+    QCOMPARE(position.x(), -20001.0f);
+    QCOMPARE(position.z(), -20001.0f);
+}
+
 QTEST_MAIN(tst_bars)
 #include "tst_bars.moc"
@@ -30,6 +30,8 @@
 #include <QtTest/QtTest>
 
 #include <QtDataVisualization/QCustom3DVolume>
+#include <QtDataVisualization/private/customrenderitem_p.h>
+#include <QtDataVisualization/private/qcustom3dvolume_p.h>
 
 using namespace QtDataVisualization;
 
@@ -49,6 +51,9 @@ private slots:
     void initializeProperties();
     void invalidProperties();
 
+    void bricks();
+    void dirtySubTextures();
+
 private:
     QCustom3DVolume *m_custom;
 };
@@ -132,6 +137,7 @@ void tst_custom::initialProperties()
     QCOMPARE(m_custom->sliceIndexY(), -1);
     QCOMPARE(m_custom->sliceIndexZ(), -1);
     QCOMPARE(m_custom->useHighDefShader(), true);
+    QCOMPARE(m_custom->brickSize(), 0);
 
     // Common (from QCustom3DVolume)
     QCOMPARE(m_custom->meshFile(), QString(":/defaultMeshes/barFull"));
@@ -161,6 +167,7 @@ void tst_custom::initializeProperties()
     m_custom->setSliceIndexY(0);
     m_custom->setSliceIndexZ(0);
     m_custom->setUseHighDefShader(false);
+    m_custom->setBrickSize(64);
 
     QCOMPARE(m_custom->alphaMultiplier(), 0.1f);
     QCOMPARE(m_custom->drawSliceFrames(), true);
@@ -174,6 +181,7 @@ void tst_custom::initializeProperties()
     QCOMPARE(m_custom->sliceIndexY(), 0);
     QCOMPARE(m_custom->sliceIndexZ(), 0);
     QCOMPARE(m_custom->useHighDefShader(), false);
+    QCOMPARE(m_custom->brickSize(), 64);
 
     // Common (from QCustom3DVolume)
     m_custom->setPosition(QVector3D(1.0, 1.0, 1.0));
@@ -207,9 +215,117 @@ void tst_custom::invalidProperties()
     m_custom->setSliceFrameWidths(QVector3D(-0.1f, -0.1f, -0.1f));
     QCOMPARE(m_custom->sliceFrameWidths(), QVector3D(0.01f, 0.01f, 0.01f));
 
+    m_custom->setBrickSize(-1);
+    QCOMPARE(m_custom->brickSize(), 0);
+
     m_custom->setTextureFormat(QImage::Format_ARGB8555_Premultiplied);
     QCOMPARE(m_custom->textureFormat(), QImage::Format_ARGB32);
 }
 
+void tst_custom::bricks()
+{
+    CustomRenderItem item;
+    item.setVolume(true);
+    item.setTextureWidth(100);
+    item.setTextureHeight(70);
+    item.setTextureDepth(33);
+
+    // No bricks without a brick size
+    item.createBricks();
+    QVERIFY(item.bricks().isEmpty());
+
+    item.setBrickSize(32);
+    item.createBricks();
+    QCOMPARE(item.brickCountX(), 4);
+    QCOMPARE(item.brickCountY(), 3);
+    QCOMPARE(item.brickCountZ(), 2);
+    QCOMPARE(item.bricks().size(), 4 * 3 * 2);
+
+    // Bricks are ordered x fastest, and together they cover the volume exactly
+    int texelCount = 0;
+    int index = 0;
+    for (int k = 0; k < item.brickCountZ(); k++) {
+        for (int j = 0; j < item.brickCountY(); j++) {
+            for (int i = 0; i < item.brickCountX(); i++) {
+                const VolumeBrick &brick = item.bricks().at(index++);
+                QCOMPARE(brick.x, i * 32);
+                QCOMPARE(brick.y, j * 32);
+                QCOMPARE(brick.z, k * 32);
+                QCOMPARE(brick.width, i < 3 ? 32 : 4);
+                QCOMPARE(brick.height, j < 2 ? 32 : 6);
+                QCOMPARE(brick.depth, k < 1 ? 32 : 1);
+                QCOMPARE(brick.texture, GLuint(0));
+                QVERIFY(!brick.empty);
+                QVERIFY(!brick.requested);
+                texelCount += brick.width * brick.height * brick.depth;
+            }
+        }
+    }
+    QCOMPARE(texelCount, item.textureSize());
+
+    // A brick size larger than the volume gives a single brick of the whole volume
+    item.setBrickSize(128);
+    item.createBricks();
+    QCOMPARE(item.bricks().size(), 1);
+    QCOMPARE(item.bricks().at(0).width, 100);
+    QCOMPARE(item.bricks().at(0).height, 70);
+    QCOMPARE(item.bricks().at(0).depth, 33);
+
+    item.setBrickSize(0);
+    item.createBricks();
+    QVERIFY(item.bricks().isEmpty());
+    QCOMPARE(item.brickCountX(), 0);
+}
+
+// Exposes the private data the renderer reads when syncing the volume
+class DirtyVolume : public QCustom3DVolume
+{
+public:
+    QCustom3DVolumePrivate *privateData() { return dptr(); }
+};
+
+void tst_custom::dirtySubTextures()
+{
+    // A width of five makes the data lines six bytes long, which is not 32-bit aligned
+    DirtyVolume volume;
+    volume.setTextureFormat(QImage::Format_Indexed8);
+    volume.setTextureDimensions(5, 4, 3);
+    volume.setTextureData(new QVector<uchar>(6 * 4 * 3));
+    QCOMPARE(volume.textureDataWidth(), 6);
+
+    QCustom3DVolumePrivate *d = volume.privateData();
+    d->clearDirtySubTextures();
+    QVERIFY(!d->hasDirtySubTextures());
+
+    // Changed slices along each axis are tracked as one inclusive range
+    QVector<uchar> slice(5 * 4, 1);
+    volume.setSubTextureData(Qt::XAxis, 3, slice.constData());
+    QVERIFY(d->hasDirtySubTextures());
+    QCOMPARE(d->m_dirtySubTextureFirst[0], 3);
+    QCOMPARE(d->m_dirtySubTextureLast[0], 3);
+    volume.setSubTextureData(Qt::XAxis, 1, slice.constData());
+    QCOMPARE(d->m_dirtySubTextureFirst[0], 1);
+    QCOMPARE(d->m_dirtySubTextureLast[0], 3);
+    QCOMPARE(d->m_dirtySubTextureFirst[1], -1);
+    QCOMPARE(d->m_dirtySubTextureFirst[2], -1);
+
+    volume.setSubTextureData(Qt::ZAxis, 2, slice.constData());
+    volume.setSubTextureData(Qt::YAxis, 0, slice.constData());
+    QCOMPARE(d->m_dirtySubTextureFirst[0], 1);
+    QCOMPARE(d->m_dirtySubTextureLast[0], 3);
+    QCOMPARE(d->m_dirtySubTextureFirst[1], 0);
+    QCOMPARE(d->m_dirtySubTextureLast[1], 0);
+    QCOMPARE(d->m_dirtySubTextureFirst[2], 2);
+    QCOMPARE(d->m_dirtySubTextureLast[2], 2);
+
+    d->clearDirtySubTextures();
+    QVERIFY(!d->hasDirtySubTextures());
+
+    // Invalid slices are not marked
+    QTest::ignoreMessage(QtWarningMsg, "setSubTextureData Attempted to set invalid subtexture.");
+    volume.setSubTextureData(Qt::ZAxis, 3, slice.constData());
+    QVERIFY(!d->hasDirtySubTextures());
+}
+
 QTEST_MAIN(tst_custom)
 #include "tst_custom.moc"
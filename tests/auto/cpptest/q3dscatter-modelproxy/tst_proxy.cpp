@@ -51,6 +51,8 @@ private slots:
     void initializeProperties();
 
     void addModel();
+    void addModelInBackground();
+    void multiColumnChanges();
 
 private:
     QItemModelScatterDataProxy *m_proxy;
@@ -120,6 +122,7 @@ void tst_proxy::initialProperties()
     QCOMPARE(m_proxy->zPosRole(), QString());
     QCOMPARE(m_proxy->zPosRolePattern(), QRegExp());
     QCOMPARE(m_proxy->zPosRoleReplace(), QString());
+    QCOMPARE(m_proxy->isBackgroundResolveEnabled(), false);
 
     QCOMPARE(m_proxy->itemCount(), 0);
     QVERIFY(!m_proxy->series());
@@ -203,5 +206,63 @@ void tst_proxy::addModel()
     m_proxy = 0; // proxy gets deleted with series
 }
 
+void tst_proxy::addModelInBackground()
+{
+    QTableWidget table;
+    table.setRowCount(3);
+    table.setColumnCount(1);
+    for (int row = 0; row < 3; row++)
+        table.model()->setData(table.model()->index(row, 0), QString::number(row + 1));
+
+    m_proxy->setBackgroundResolveEnabled(true);
+    QCOMPARE(m_proxy->isBackgroundResolveEnabled(), true);
+    m_proxy->setItemModel(table.model());
+    m_proxy->setYPosRole(table.model()->roleNames().value(Qt::DisplayRole));
+
+    QTRY_COMPARE(m_proxy->itemCount(), 3);
+    QCOMPARE(m_proxy->itemAt(2)->y(), 3.0f);
+
+    // Changes during a background resolve get resolved again
+    table.model()->setData(table.model()->index(2, 0), QStringLiteral("5"));
+    QTRY_COMPARE(m_proxy->itemAt(2)->y(), 5.0f);
+}
+
+void tst_proxy::multiColumnChanges()
+{
+    QTableWidget table;
+    table.setRowCount(2);
+    table.setColumnCount(3);
+    for (int row = 0; row < 2; row++) {
+        for (int col = 0; col < 3; col++)
+            table.model()->setData(table.model()->index(row, col), row * 3 + col);
+    }
+
+    m_proxy->setItemModel(table.model());
+    m_proxy->setYPosRole(table.model()->roleNames().value(Qt::DisplayRole));
+
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_proxy->itemCount(), 6);
+    QCOMPARE(m_proxy->itemAt(4)->y(), 4.0f);
+
+    table.model()->setData(table.model()->index(1, 1), 10);
+    QCOMPARE(m_proxy->itemAt(4)->y(), 10.0f);
+    QCOMPARE(m_proxy->itemAt(3)->y(), 3.0f);
+
+    table.insertRow(1);
+    for (int col = 0; col < 3; col++)
+        table.setItem(1, col, new QTableWidgetItem(QString::number(20 + col)));
+
+    QCOMPARE(m_proxy->itemCount(), 9);
+    QCOMPARE(m_proxy->itemAt(4)->y(), 21.0f);
+    QCOMPARE(m_proxy->itemAt(7)->y(), 10.0f);
+
+    table.removeRow(0);
+
+    QCOMPARE(m_proxy->itemCount(), 6);
+    QCOMPARE(m_proxy->itemAt(0)->y(), 20.0f);
+    QCOMPARE(m_proxy->itemAt(4)->y(), 10.0f);
+}
+
 QTEST_MAIN(tst_proxy)
 #include "tst_proxy.moc"
@@ -1,4 +1,5 @@
-QT += testlib datavisualization
+include(../common/cpptestutil.pri)
+QT += testlib datavisualization datavisualization-private
 
 TARGET = tst_cpptest
 CONFIG += console testcase
@@ -30,6 +30,11 @@
 #include <QtTest/QtTest>
 
 #include <QtDataVisualization/QScatterDataProxy>
+#include <QtDataVisualization/Q3DScatter>
+#include <QtDataVisualization/QLogValue3DAxisFormatter>
+#include <QtDataVisualization/private/valuelimits_p.h>
+
+#include "cpptestutil.h"
 
 using namespace QtDataVisualization;
 
@@ -47,6 +52,9 @@ private slots:
 
     void initialProperties();
     void initializeProperties();
+    void externalArrays();
+    void limits();
+    void valueLimits();
 
 private:
     QScatterDataProxy *m_proxy;
@@ -98,5 +106,294 @@ void tst_proxy::initializeProperties()
     QCOMPARE(m_proxy->itemCount(), 2);
 }
 
+void tst_proxy::externalArrays()
+{
+    QVERIFY(m_proxy);
+
+    float xValues[] = { 0.5f, -0.3f, 0.1f };
+    float yValues[] = { 0.5f, -0.5f, 0.2f };
+    float zValues[] = { 0.5f, -0.4f, 0.3f };
+    const QQuaternion rotations[] = { QQuaternion(), QQuaternion(0.5f, 0.5f, 0.5f, 0.5f),
+                                      QQuaternion() };
+    m_proxy->resetArray(xValues, yValues, zValues, 3, rotations);
+
+    // Items are copies of the external data
+    QCOMPARE(m_proxy->itemCount(), 3);
+    QVERIFY(m_proxy->itemAt(1));
+    QCOMPARE(m_proxy->itemAt(1)->position(), QVector3D(-0.3f, -0.5f, -0.4f));
+    QCOMPARE(m_proxy->itemAt(1)->rotation(), QQuaternion(0.5f, 0.5f, 0.5f, 0.5f));
+    QCOMPARE(m_proxy->itemAt(2)->position(), QVector3D(0.1f, 0.2f, 0.3f));
+
+    const QScatterDataArray *array = m_proxy->array();
+    QCOMPARE(array->size(), 3);
+    QCOMPARE(array->at(0).position(), QVector3D(0.5f, 0.5f, 0.5f));
+    QCOMPARE(array->at(1).rotation(), QQuaternion(0.5f, 0.5f, 0.5f, 0.5f));
+
+    // Changed external values show up in the copies
+    xValues[2] = 0.7f;
+    emit m_proxy->itemsChanged(2, 1);
+    QCOMPARE(m_proxy->itemAt(2)->position(), QVector3D(0.7f, 0.2f, 0.3f));
+    QCOMPARE(m_proxy->array()->at(2).position(), QVector3D(0.7f, 0.2f, 0.3f));
+    xValues[2] = 0.1f;
+    m_proxy->resetArray(xValues, yValues, zValues, 3);
+    QCOMPARE(m_proxy->array()->at(1).rotation(), QQuaternion());
+    QCOMPARE(m_proxy->array()->at(2).position(), QVector3D(0.1f, 0.2f, 0.3f));
+
+    // Modifying items copies the data to the proxy's own array
+    m_proxy->setItem(1, QScatterDataItem(QVector3D(1.0f, 2.0f, 3.0f)));
+    QCOMPARE(m_proxy->itemCount(), 3);
+    QCOMPARE(m_proxy->array()->size(), 3);
+    QCOMPARE(m_proxy->itemAt(0)->position(), QVector3D(0.5f, 0.5f, 0.5f));
+    QCOMPARE(m_proxy->itemAt(1)->position(), QVector3D(1.0f, 2.0f, 3.0f));
+    QCOMPARE(m_proxy->itemAt(2)->position(), QVector3D(0.1f, 0.2f, 0.3f));
+
+    m_proxy->resetArray(xValues, yValues, zValues, 2);
+    QCOMPARE(m_proxy->itemCount(), 2);
+    m_proxy->resetArray(0);
+    QCOMPARE(m_proxy->itemCount(), 0);
+}
+
+static QScatterDataArray newItems(int first, int count)
+{
+    // Spread the values over [-100, 100] in a repeatable order
+    QScatterDataArray items(count);
+    for (int i = 0; i < count; i++) {
+        const int seed = first + i;
+        items[i].setPosition(QVector3D(float(seed * 7919 % 20011) / 100.0f - 100.0f,
+                                       float(seed * 6271 % 20021) / 100.0f - 100.0f,
+                                       float(seed * 5923 % 20023) / 100.0f - 100.0f));
+    }
+    return items;
+}
+
+// Rescans all the items the way the limits were searched for before they were tracked in blocks
+static QVector<float> scannedRanges(const QScatterDataArray &data, bool logY)
+{
+    float minimums[3];
+    float maximums[3];
+    const bool allowZeroOrNegatives[3] = { true, !logY, true };
+    const QVector3D &first = data.at(0).position();
+    for (int axis = 0; axis < 3; axis++)
+        minimums[axis] = maximums[axis] = first[axis];
+
+    for (int i = 1; i < data.size(); i++) {
+        const QVector3D &position = data.at(i).position();
+        for (int axis = 0; axis < 3; axis++) {
+            const float value = position[axis];
+            // An invalid value skips the rest of the item
+            if (qIsNaN(value) || qIsInf(value))
+                break;
+            if (minimums[axis] > value && (value > 0.0f || allowZeroOrNegatives[axis]))
+                minimums[axis] = value;
+            if (maximums[axis] < value)
+                maximums[axis] = value;
+        }
+    }
+
+    return QVector<float>() << minimums[0] << maximums[0] << minimums[1] << maximums[1]
+                            << minimums[2] << maximums[2];
+}
+
+static QVector<float> axisRanges(Q3DScatter *graph)
+{
+    return QVector<float>() << graph->axisX()->min() << graph->axisX()->max()
+                            << graph->axisY()->min() << graph->axisY()->max()
+                            << graph->axisZ()->min() << graph->axisZ()->max();
+}
+
+void tst_proxy::limits()
+{
+    if (!CpptestUtil::isOpenGLSupported())
+        QSKIP("OpenGL not supported on this platform");
+
+    // The auto adjusted axis ranges are the limits of the data, as the data is never flat
+    Q3DScatter graph;
+    QScatterDataProxy *proxy = new QScatterDataProxy;
+    graph.addSeries(new QScatter3DSeries(proxy));
+
+    proxy->addItems(newItems(0, 5000));
+    QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), false));
+
+    // Append to the last block, so that it is split
+    proxy->addItems(newItems(5000, 2300));
+    QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), false));
+
+    // Insert in the middle
+    proxy->insertItems(2500, newItems(7300, 2000));
+    QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), false));
+    proxy->insertItem(1024, QScatterDataItem(QVector3D(150.0f, -150.0f, 150.0f)));
+    QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), false));
+
+    // Sliding window, where the items are added to the end and removed from the front
+    for (int i = 0; i < 20; i++) {
+        proxy->addItems(newItems(9300 + i * 700, 700));
+        proxy->removeItems(0, 700);
+        QCOMPARE(proxy->itemCount(), 9301);
+        QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), false));
+    }
+
+    // Lowering the minimum and raising the maximum with a single item
+    proxy->setItem(3000, QScatterDataItem(QVector3D(-500.0f, 500.0f, -500.0f)));
+    QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), false));
+    QCOMPARE(graph.axisX()->min(), -500.0f);
+    QCOMPARE(graph.axisY()->max(), 500.0f);
+    QCOMPARE(graph.axisZ()->min(), -500.0f);
+
+    // Moving the item holding the limits back inside the data
+    proxy->setItem(3000, QScatterDataItem(QVector3D(0.0f, 0.0f, 0.0f)));
+    QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), false));
+
+    // Items with invalid values are ignored from the invalid coordinate on
+    const float nan = qQNaN();
+    const float inf = qInf();
+    proxy->setItem(4000, QScatterDataItem(QVector3D(nan, 1000.0f, 1000.0f)));
+    proxy->setItem(4001, QScatterDataItem(QVector3D(-1000.0f, inf, 1000.0f)));
+    proxy->setItem(4002, QScatterDataItem(QVector3D(1000.0f, -1000.0f, -inf)));
+    QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), false));
+    QCOMPARE(graph.axisX()->min(), -1000.0f);
+    QCOMPARE(graph.axisX()->max(), 1000.0f);
+    QCOMPARE(graph.axisY()->min(), -1000.0f);
+    QVERIFY(graph.axisZ()->max() < 1000.0f);
+
+    // A logarithmic axis ignores zero and negative values. The first item initializes the limits.
+    graph.axisY()->setFormatter(new QLogValue3DAxisFormatter);
+    proxy->setItem(0, QScatterDataItem(QVector3D(1.0f, 2.0f, 1.0f)));
+    proxy->setItem(5000, QScatterDataItem(QVector3D(1.0f, 0.0f, 1.0f)));
+    proxy->setItem(5001, QScatterDataItem(QVector3D(1.0f, 0.25f, 1.0f)));
+    QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), true));
+    QCOMPARE(graph.axisY()->min(), 0.25f);
+
+    // Removing the smallest valid value
+    proxy->removeItems(5001, 1);
+    QCOMPARE(axisRanges(&graph), scannedRanges(*proxy->array(), true));
+    QVERIFY(graph.axisY()->min() > 0.25f);
+}
+
+// The limits of the items as they were searched for before ValueLimits, one item at a time
+static QVector<float> scalarLimits(const QVector<QVector3D> &items, bool allowNegatives,
+                                   bool allowZero)
+{
+    float minimums[3];
+    float maximums[3];
+    for (int axis = 0; axis < 3; axis++)
+        minimums[axis] = maximums[axis] = items.at(0)[axis];
+
+    for (int i = 1; i < items.size(); i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            const float value = items.at(i)[axis];
+            if (qIsNaN(value) || qIsInf(value))
+                break;
+            if (minimums[axis] > value && (value > 0.0f || (value == 0.0f && allowZero)
+                                           || (value < 0.0f && allowNegatives))) {
+                minimums[axis] = value;
+            }
+            if (maximums[axis] < value)
+                maximums[axis] = value;
+        }
+    }
+
+    return QVector<float>() << minimums[0] << maximums[0] << minimums[1] << maximums[1]
+                            << minimums[2] << maximums[2];
+}
+
+// The limits of the items as the proxy combines them, with the rest of the items scanned in two
+// parts after the first one
+static QVector<float> scannedLimits(const QVector<QVector3D> &items, int split,
+                                    bool allowNegatives, bool allowZero)
+{
+    QVector<float> components[3];
+    for (int axis = 0; axis < 3; axis++) {
+        for (int i = 1; i < items.size(); i++)
+            components[axis].append(items.at(i)[axis]);
+    }
+
+    ValueLimits limits[3];
+    for (int axis = 0; axis < 3; axis++)
+        limits[axis].reset();
+    const float *values[3] = { components[0].constData(), components[1].constData(),
+                               components[2].constData() };
+    ValueLimits::scan(values, 3, split, limits);
+    for (int axis = 0; axis < 3; axis++)
+        values[axis] += split;
+    ValueLimits::scan(values, 3, components[0].size() - split, limits);
+
+    QVector<float> result;
+    for (int axis = 0; axis < 3; axis++) {
+        float minimum = items.at(0)[axis];
+        float maximum = items.at(0)[axis];
+        float limit;
+        if (limits[axis].minimum(allowNegatives, allowZero, limit) && minimum > limit)
+            minimum = limit;
+        if (limits[axis].hasMaximum() && maximum < limits[axis].max)
+            maximum = limits[axis].max;
+        result << minimum << maximum;
+    }
+    return result;
+}
+
+void tst_proxy::valueLimits()
+{
+    const float nan = qQNaN();
+    const float inf = qInf();
+    const float specials[] = { nan, inf, -inf, -0.0f, 0.0f };
+    const int specialCount = int(sizeof(specials) / sizeof(specials[0]));
+    const int counts[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 13, 16, 17, 1031 };
+    const int countCount = int(sizeof(counts) / sizeof(counts[0]));
+
+    for (int countIndex = 0; countIndex < countCount; countIndex++) {
+        const int count = counts[countIndex];
+        QVector<QVector3D> data(count);
+        for (int i = 0; i < count; i++) {
+            data[i] = QVector3D(float(i * 37 % 11) - 5.0f, float(i * 53 % 13) - 4.0f,
+                                float(i * 71 % 7) - 2.0f);
+        }
+
+        // Each special value at each position of each component, including the first item
+        for (int position = 0; position < count; position++) {
+            for (int axis = 0; axis < 3; axis++) {
+                for (int special = 0; special < specialCount; special++) {
+                    if (position == 0 && (qIsNaN(specials[special])
+                                          || qIsInf(specials[special]))) {
+                        continue;
+                    }
+                    QVector<QVector3D> items = data;
+                    items[position][axis] = specials[special];
+                    for (int flags = 0; flags < 4; flags++) {
+                        const bool allowNegatives = flags & 1;
+                        const bool allowZero = flags & 2;
+                        const int split = (position * 5 + axis) % count;
+                        const QByteArray context = QByteArray("count ")
+                                + QByteArray::number(count) + ", position "
+                                + QByteArray::number(position) + ", axis "
+                                + QByteArray::number(axis) + ", value "
+                                + QByteArray::number(specials[special]) + ", flags "
+                                + QByteArray::number(flags);
+                        QVERIFY2(scannedLimits(items, split, allowNegatives, allowZero)
+                                 == scalarLimits(items, allowNegatives, allowZero),
+                                 context.constData());
+                    }
+                }
+            }
+            // Past the first few vectors, sample the positions of the long array
+            if (position > 17)
+                position += 97;
+        }
+    }
+
+    // Only positive values on an axis that allows neither zero nor negatives
+    QVector<QVector3D> items;
+    items << QVector3D(3.0f, 3.0f, 3.0f) << QVector3D(-1.0f, 0.0f, -0.0f)
+          << QVector3D(-2.0f, -2.0f, -2.0f);
+    QCOMPARE(scannedLimits(items, 1, false, false),
+             QVector<float>() << 3.0f << 3.0f << 3.0f << 3.0f << 3.0f << 3.0f);
+    QCOMPARE(scannedLimits(items, 1, false, true),
+             QVector<float>() << 3.0f << 3.0f << 0.0f << 3.0f << 0.0f << 3.0f);
+    QCOMPARE(scannedLimits(items, 1, true, false),
+             QVector<float>() << -2.0f << 3.0f << -2.0f << 3.0f << -2.0f << 3.0f);
+    items << QVector3D(0.5f, 0.5f, 0.5f);
+    QCOMPARE(scannedLimits(items, 2, false, false),
+             QVector<float>() << 0.5f << 3.0f << 0.5f << 3.0f << 0.5f << 3.0f);
+}
+
 QTEST_MAIN(tst_proxy)
 #include "tst_proxy.moc"
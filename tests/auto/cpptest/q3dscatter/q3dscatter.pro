@@ -1,5 +1,5 @@
 include(../common/cpptestutil.pri)
-QT += testlib datavisualization
+QT += testlib datavisualization datavisualization-private
 
 TARGET = tst_cpptest
 CONFIG += console testcase
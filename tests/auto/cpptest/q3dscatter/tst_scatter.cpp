@@ -30,9 +30,19 @@
 #include <QtTest/QtTest>
 
 #include <QtDataVisualization/Q3DScatter>
+#include <QtDataVisualization/private/scatterseriesrendercache_p.h>
+#include <QtDataVisualization/private/scatterpointbufferhelper_p.h>
+#include <QtDataVisualization/private/scatterinstancebufferhelper_p.h>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLExtraFunctions>
 
 #include "cpptestutil.h"
 
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+
 using namespace QtDataVisualization;
 
 class tst_scatter: public QObject
@@ -57,6 +67,11 @@ private slots:
     void removeSeries();
     void removeMultipleSeries();
 
+    void pointBufferUpdates();
+    void instanceBufferUpdates();
+    void renderInstanced();
+    void graphPositionQuery();
+
 private:
     Q3DScatter *m_graph;
 };
@@ -164,6 +179,13 @@ void tst_scatter::initializeProperties()
     QCOMPARE(m_graph->reflectivity(), 0.1);
     QCOMPARE(m_graph->locale(), QLocale("FI"));
     QCOMPARE(m_graph->margin(), 1.0);
+
+    m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationInstanced);
+    QCOMPARE(m_graph->optimizationHints(), QAbstract3DGraph::OptimizationInstanced);
+    m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationStatic
+                                  | QAbstract3DGraph::OptimizationInstanced);
+    QCOMPARE(m_graph->optimizationHints(), QAbstract3DGraph::OptimizationStatic
+             | QAbstract3DGraph::OptimizationInstanced);
 }
 
 void tst_scatter::invalidProperties()
@@ -255,5 +277,247 @@ void tst_scatter::removeMultipleSeries()
     delete series3;
 }
 
+static bool pointBufferMatches(ScatterPointBufferHelper *points,
+                               const ScatterRenderItemArray &renderArray, int hiddenIndex)
+{
+    const QVector3D hiddenPos(-1000.0f, -1000.0f, -1000.0f);
+    const int count = renderArray.size();
+    QOpenGLExtraFunctions *funcs = QOpenGLContext::currentContext()->extraFunctions();
+    funcs->glBindBuffer(GL_ARRAY_BUFFER, points->m_pointbuffer);
+    const QVector3D *buffer = static_cast<const QVector3D *>(
+                funcs->glMapBufferRange(GL_ARRAY_BUFFER, 0, count * sizeof(QVector3D),
+                                        GL_MAP_READ_BIT));
+    bool matches = buffer;
+    for (int i = 0; buffer && i < count; i++) {
+        const ScatterRenderItem &item = renderArray.at(i);
+        const QVector3D expected = (item.isVisible() && i != hiddenIndex) ? item.translation()
+                                                                          : hiddenPos;
+        if (buffer[i] != expected) {
+            qWarning() << "Point" << i << "is" << buffer[i] << "instead of" << expected;
+            matches = false;
+            break;
+        }
+    }
+    if (buffer)
+        funcs->glUnmapBuffer(GL_ARRAY_BUFFER);
+    funcs->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return matches;
+}
+
+void tst_scatter::pointBufferUpdates()
+{
+    QOffscreenSurface surface;
+    surface.create();
+    QOpenGLContext context;
+    QVERIFY(context.create());
+    QVERIFY(context.makeCurrent(&surface));
+    if (context.format().version() < qMakePair(3, 0))
+        QSKIP("Reading buffers back needs OpenGL 3.0 or OpenGL ES 3.0");
+
+    QScatter3DSeries series;
+    ScatterSeriesRenderCache cache(&series, 0);
+    ScatterRenderItemArray &renderArray = cache.renderArray();
+    const int count = 1000;
+    renderArray.resize(count);
+    for (int i = 0; i < count; i++) {
+        renderArray[i].setTranslation(QVector3D(float(i) / count, 0.5f, -0.5f));
+        renderArray[i].setVisible(true);
+    }
+    ScatterPointBufferHelper *points = new ScatterPointBufferHelper();
+    cache.setBufferPoints(points);
+    points->setScaleY(1.0f);
+    points->load(&cache);
+    QCOMPARE(int(points->m_indexCount), count);
+    QVERIFY(pointBufferMatches(points, renderArray, -1));
+
+    // Sparse, unsorted updates with a duplicate and a run of consecutive points
+    renderArray[3].setTranslation(QVector3D(-1.0f, -1.0f, -1.0f));
+    renderArray[500].setVisible(false);
+    renderArray[501].setTranslation(QVector3D(0.2f, 0.3f, 0.4f));
+    renderArray[999].setTranslation(QVector3D(1.0f, 1.0f, 1.0f));
+    cache.updateIndices() << 999 << 3 << 501 << 500 << 3;
+    points->update(&cache);
+    cache.updateIndices().clear();
+    QVERIFY(pointBufferMatches(points, renderArray, -1));
+
+    // Dense updates rewrite the whole span, the pushed point stays hidden
+    points->pushPoint(&cache, 12);
+    QVERIFY(pointBufferMatches(points, renderArray, 12));
+    for (int i = 10; i < 20; i += 2) {
+        renderArray[i].setTranslation(QVector3D(0.0f, float(i) / count, 0.0f));
+        cache.updateIndices() << i;
+    }
+    points->update(&cache);
+    cache.updateIndices().clear();
+    QVERIFY(pointBufferMatches(points, renderArray, 12));
+
+    points->popPoint();
+    QVERIFY(pointBufferMatches(points, renderArray, -1));
+}
+
+static bool instanceBufferMatches(ScatterInstanceBufferHelper *instances,
+                                  const ScatterRenderItemArray &renderArray)
+{
+    const int count = renderArray.size();
+    if (instances->instanceCount() != count)
+        return false;
+
+    QOpenGLExtraFunctions *funcs = QOpenGLContext::currentContext()->extraFunctions();
+    funcs->glBindBuffer(GL_ARRAY_BUFFER, instances->instanceBuf());
+    const ScatterInstance *buffer = static_cast<const ScatterInstance *>(
+                funcs->glMapBufferRange(GL_ARRAY_BUFFER, 0, count * sizeof(ScatterInstance),
+                                        GL_MAP_READ_BIT));
+    bool matches = buffer;
+    for (int i = 0; buffer && i < count; i++) {
+        const ScatterRenderItem &item = renderArray.at(i);
+        const ScatterInstance &instance = buffer[i];
+        const QQuaternion rotation = item.rotation().normalized();
+        if (QVector3D(instance.x, instance.y, instance.z) != item.translation()
+                || instance.scale != (item.isVisible() ? 1.0f : 0.0f)
+                || !qFuzzyCompare(QVector4D(instance.rotationX, instance.rotationY,
+                                            instance.rotationZ, instance.rotationScalar),
+                                  rotation.toVector4D())
+                || instance.index != float(i)) {
+            qWarning() << "Instance" << i << "does not match item" << item.translation()
+                       << item.isVisible() << rotation;
+            matches = false;
+            break;
+        }
+    }
+    if (buffer)
+        funcs->glUnmapBuffer(GL_ARRAY_BUFFER);
+    funcs->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return matches;
+}
+
+void tst_scatter::instanceBufferUpdates()
+{
+    QOffscreenSurface surface;
+    surface.create();
+    QOpenGLContext context;
+    QVERIFY(context.create());
+    QVERIFY(context.makeCurrent(&surface));
+    if (context.format().version() < qMakePair(3, 0))
+        QSKIP("Reading buffers back needs OpenGL 3.0 or OpenGL ES 3.0");
+
+    QScatter3DSeries series;
+    ScatterSeriesRenderCache cache(&series, 0);
+    ScatterRenderItemArray &renderArray = cache.renderArray();
+    const int count = 1000;
+    renderArray.resize(count);
+    for (int i = 0; i < count; i++) {
+        renderArray[i].setTranslation(QVector3D(float(i) / count, 0.5f, -0.5f));
+        renderArray[i].setVisible(true);
+    }
+    ScatterInstanceBufferHelper instances;
+    instances.load(&cache);
+    QVERIFY(instanceBufferMatches(&instances, renderArray));
+
+    // Sparse, unsorted updates with a duplicate and a run of consecutive items
+    renderArray[3].setTranslation(QVector3D(-1.0f, -1.0f, -1.0f));
+    renderArray[500].setVisible(false);
+    renderArray[501].setRotation(QQuaternion::fromAxisAndAngle(0.0f, 1.0f, 0.0f, 45.0f));
+    renderArray[502].setTranslation(QVector3D(0.2f, 0.3f, 0.4f));
+    renderArray[999].setRotation(QQuaternion(2.0f, 0.0f, 0.0f, 2.0f));
+    cache.updateIndices() << 999 << 3 << 500 << 501 << 502 << 3;
+    instances.update(&cache);
+    cache.updateIndices().clear();
+    QVERIFY(instanceBufferMatches(&instances, renderArray));
+
+    // Showing a hidden item only rewrites its slot
+    renderArray[500].setVisible(true);
+    cache.updateIndices() << 500;
+    instances.update(&cache);
+    cache.updateIndices().clear();
+    QVERIFY(instanceBufferMatches(&instances, renderArray));
+
+    // A changed item count reloads the whole buffer
+    renderArray.resize(count + 10);
+    for (int i = count; i < count + 10; i++) {
+        renderArray[i].setTranslation(QVector3D(0.0f, float(i) / count, 0.0f));
+        renderArray[i].setVisible(true);
+    }
+    cache.updateIndices() << count;
+    instances.update(&cache);
+    cache.updateIndices().clear();
+    QVERIFY(instanceBufferMatches(&instances, renderArray));
+}
+
+void tst_scatter::renderInstanced()
+{
+    QScatter3DSeries *series = newSeries();
+    series->setMesh(QAbstract3DSeries::MeshCube);
+    series->setItemSize(0.3f);
+    series->dataProxy()->addItem(QScatterDataItem(QVector3D(-0.4f, 0.3f, 0.4f),
+                                                  QQuaternion::fromAxisAndAngle(
+                                                      1.0f, 1.0f, 0.0f, 30.0f)));
+    // Outside the axis ranges, so hidden
+    series->dataProxy()->addItem(QScatterDataItem(QVector3D(5.0f, 0.0f, 0.0f)));
+    m_graph->addSeries(series);
+    m_graph->axisX()->setRange(-1.0f, 1.0f);
+    m_graph->axisY()->setRange(-1.0f, 1.0f);
+    m_graph->axisZ()->setRange(-1.0f, 1.0f);
+
+    const QSize size(300, 200);
+    const QAbstract3DGraph::OptimizationHints hints[] = {
+        QAbstract3DGraph::OptimizationDefault, QAbstract3DGraph::OptimizationStatic };
+    for (int i = 0; i < 2; i++) {
+        m_graph->setOptimizationHints(hints[i]);
+        QImage image = m_graph->renderToImage(0, size);
+        m_graph->setOptimizationHints(QAbstract3DGraph::OptimizationInstanced);
+        QVERIFY(CpptestUtil::imagesMatch(m_graph->renderToImage(0, size), image));
+
+        // Rotating and hiding items updates only their instances
+        series->dataProxy()->setItem(1, QScatterDataItem(QVector3D(-0.3f, -0.5f, -0.4f),
+                                                         QQuaternion::fromAxisAndAngle(
+                                                             0.0f, 0.0f, 1.0f, 60.0f)));
+        series->dataProxy()->setItem(2, QScatterDataItem(QVector3D(0.0f, -3.0f, 0.2f)));
+        QImage instancedImage = m_graph->renderToImage(0, size);
+        m_graph->setOptimizationHints(hints[i]);
+        QVERIFY(CpptestUtil::imagesMatch(instancedImage, m_graph->renderToImage(0, size)));
+
+        series->dataProxy()->setItem(1, QScatterDataItem(QVector3D(-0.3f, -0.5f, -0.4f)));
+        series->dataProxy()->setItem(2, QScatterDataItem(QVector3D(0.0f, -0.3f, 0.2f)));
+    }
+}
+
+static QVector3D queryGraphPosition(QAbstract3DGraph *graph, const QPoint &point)
+{
+    QSignalSpy spy(graph, &QAbstract3DGraph::queriedGraphPositionChanged);
+    graph->scene()->setGraphPositionQuery(point);
+    if (!spy.wait(5000))
+        return graph->queriedGraphPosition();
+    return spy.last().at(0).value<QVector3D>();
+}
+
+void tst_scatter::graphPositionQuery()
+{
+    m_graph->addSeries(newSeries());
+    m_graph->scene()->activeCamera()->setCameraPreset(Q3DCamera::CameraPresetDirectlyAbove);
+    m_graph->resize(400, 400);
+    m_graph->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_graph));
+
+    const QVector3D outside(-20001.0f, -20001.0f, -20001.0f);
+    const QPoint center(m_graph->width() / 2, m_graph->height() / 2);
+
+    // Looking down, the ray through the center exits the graph box through the floor center
+    QVector3D position = queryGraphPosition(m_graph, center);
+    QVERIFY(qAbs(position.x()) < 0.05f);
+    QCOMPARE(position.y(), -1.0f);
+    QVERIFY(qAbs(position.z()) < 0.05f);
+
+    // Moving right moves along the x-axis on the floor
+    position = queryGraphPosition(m_graph, center + QPoint(50, 0));
+    QVERIFY(position.x() > 0.1f && position.x() < 1.0f);
+    QCOMPARE(position.y(), -1.0f);
+    QVERIFY(qAbs(position.z()) < 0.05f);
+
+    // A ray that misses the box, and a position outside the viewport
+    m_graph->scene()->activeCamera()->setZoomLevel(10.0f);
+    QCOMPARE(queryGraphPosition(m_graph, QPoint(2, 2)), outside);
+    QCOMPARE(queryGraphPosition(m_graph, QPoint(-10, -10)), outside);
+}
+
 QTEST_MAIN(tst_scatter)
 #include "tst_scatter.moc"
@@ -49,6 +49,9 @@ private slots:
     void initializeProperties();
     void invalidProperties();
 
+    void heightData();
+    void grayscaleHeightMap();
+
 private:
     QHeightMapSurfaceDataProxy *m_proxy;
 };
@@ -165,5 +168,78 @@ void tst_proxy::invalidProperties()
     QCOMPARE(m_proxy->minZValue(), 10.0f);
 }
 
+void tst_proxy::heightData()
+{
+    QVector<float> heights;
+    heights << 1.0f << 2.0f << 3.0f
+            << 4.0f << 5.0f << 6.0f;
+    QSignalSpy heightMapSpy(m_proxy, &QHeightMapSurfaceDataProxy::heightMapChanged);
+    m_proxy->setHeightData(heights, 3);
+
+    QCoreApplication::processEvents();
+
+    // Height data does not report a null height map
+    QCOMPARE(heightMapSpy.count(), 0);
+    QCOMPARE(m_proxy->columnCount(), 3);
+    QCOMPARE(m_proxy->rowCount(), 2);
+    // First row of the array is the last row of the height data
+    QCOMPARE(m_proxy->itemAt(0, 0)->y(), 4.0f);
+    QCOMPARE(m_proxy->itemAt(0, 2)->x(), 10.0f);
+    QCOMPARE(m_proxy->itemAt(1, 2)->y(), 3.0f);
+    QCOMPARE(m_proxy->itemAt(1, 2)->z(), 10.0f);
+
+    m_proxy->setHeightData(heights, 4);
+
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_proxy->columnCount(), 3);
+    QCOMPARE(m_proxy->rowCount(), 2);
+
+    m_proxy->setHeightMap(QImage(":/customtexture.jpg"));
+
+    QCoreApplication::processEvents();
+
+    QCOMPARE(heightMapSpy.count(), 1);
+    QCOMPARE(m_proxy->columnCount(), 24);
+    QCOMPARE(m_proxy->rowCount(), 24);
+}
+
+void tst_proxy::grayscaleHeightMap()
+{
+    // Grayscale images are read directly, so the heights are the gray levels
+    QImage image8(3, 2, QImage::Format_Grayscale8);
+    const uchar levels8[2][3] = { { 0, 1, 128 }, { 200, 254, 255 } };
+    for (int i = 0; i < 2; i++)
+        memcpy(image8.scanLine(i), levels8[i], 3);
+    m_proxy->setHeightMap(image8);
+
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_proxy->columnCount(), 3);
+    QCOMPARE(m_proxy->rowCount(), 2);
+    // First row of the array is the last line of the image
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 3; j++)
+            QCOMPARE(m_proxy->itemAt(1 - i, j)->y(), float(levels8[i][j]));
+    }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+    QImage image16(3, 2, QImage::Format_Grayscale16);
+    const quint16 levels16[2][3] = { { 0, 1, 256 }, { 4097, 65534, 65535 } };
+    for (int i = 0; i < 2; i++)
+        memcpy(image16.scanLine(i), levels16[i], 3 * sizeof(quint16));
+    m_proxy->setHeightMap(image16);
+
+    QCoreApplication::processEvents();
+
+    QCOMPARE(m_proxy->columnCount(), 3);
+    QCOMPARE(m_proxy->rowCount(), 2);
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 3; j++)
+            QCOMPARE(m_proxy->itemAt(1 - i, j)->y(), float(levels16[i][j]));
+    }
+#endif
+}
+
 QTEST_MAIN(tst_proxy)
 #include "tst_proxy.moc"
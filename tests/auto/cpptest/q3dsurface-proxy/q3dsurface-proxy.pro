@@ -1,3 +1,4 @@
+include(../common/cpptestutil.pri)
 QT += testlib datavisualization
 
 TARGET = tst_cpptest
@@ -30,6 +30,10 @@
 #include <QtTest/QtTest>
 
 #include <QtDataVisualization/QSurfaceDataProxy>
+#include <QtDataVisualization/Q3DSurface>
+#include <QtDataVisualization/QLogValue3DAxisFormatter>
+
+#include "cpptestutil.h"
 
 using namespace QtDataVisualization;
 
@@ -48,6 +52,9 @@ private slots:
     void initialProperties();
     void initializeProperties();
 
+    void scrollRows();
+    void limits();
+
 private:
     QSurfaceDataProxy *m_proxy;
 };
@@ -105,5 +112,145 @@ void tst_proxy::initializeProperties()
     QCOMPARE(m_proxy->rowCount(), 2);
 }
 
+void tst_proxy::scrollRows()
+{
+    QSurfaceDataArray *data = new QSurfaceDataArray;
+    QSurfaceDataRow *dataRow1 = new QSurfaceDataRow;
+    QSurfaceDataRow *dataRow2 = new QSurfaceDataRow;
+    *dataRow1 << QVector3D(0.0f, 0.1f, 0.5f) << QVector3D(1.0f, 0.5f, 0.5f);
+    *dataRow2 << QVector3D(0.0f, 1.8f, 1.0f) << QVector3D(1.0f, 1.2f, 1.0f);
+    *data << dataRow1 << dataRow2;
+    m_proxy->resetArray(data);
+
+    QSignalSpy spy(m_proxy, &QSurfaceDataProxy::rowsScrolled);
+
+    QSurfaceDataRow *dataRow3 = new QSurfaceDataRow;
+    *dataRow3 << QVector3D(0.0f, 0.3f, 1.5f) << QVector3D(1.0f, 0.7f, 1.5f);
+    m_proxy->scrollRow(dataRow3);
+
+    QCOMPARE(m_proxy->rowCount(), 2);
+    QCOMPARE(m_proxy->itemAt(0, 0)->y(), 1.8f);
+    QCOMPARE(m_proxy->itemAt(1, 1)->y(), 0.7f);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toInt(), 1);
+
+    // Scrolling past the capacity keeps only the last rows
+    QSurfaceDataArray rows;
+    for (int i = 0; i < 3; i++) {
+        QSurfaceDataRow *row = new QSurfaceDataRow;
+        *row << QVector3D(0.0f, float(i), 2.0f + i) << QVector3D(1.0f, float(i) + 0.5f, 2.0f + i);
+        rows << row;
+    }
+    m_proxy->scrollRows(rows);
+
+    QCOMPARE(m_proxy->rowCount(), 2);
+    QCOMPARE(m_proxy->columnCount(), 2);
+    QCOMPARE(m_proxy->itemAt(0, 0)->z(), 3.0f);
+    QCOMPARE(m_proxy->itemAt(0, 1)->y(), 1.5f);
+    QCOMPARE(m_proxy->itemAt(1, 0)->z(), 4.0f);
+    QCOMPARE(m_proxy->itemAt(1, 1)->y(), 2.5f);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).toInt(), 2);
+
+    // Rows with a different column count are rejected
+    QSurfaceDataRow *invalidRow = new QSurfaceDataRow;
+    *invalidRow << QVector3D(0.0f, 5.0f, 5.0f);
+    QTest::ignoreMessage(QtWarningMsg,
+                         "QSurfaceDataProxy: Scrolled row has 1 columns instead of 2, row discarded.");
+    m_proxy->scrollRow(invalidRow);
+
+    QCOMPARE(m_proxy->rowCount(), 2);
+    QCOMPARE(m_proxy->itemAt(0, 0)->z(), 3.0f);
+    QCOMPARE(spy.count(), 2);
+}
+
+// The height limits as they were searched for before ValueLimits, one item at a time
+static QVector<float> scalarHeightLimits(const QSurfaceDataArray &data, bool logarithmic)
+{
+    float min = data.at(0)->at(0).y();
+    float max = data.at(0)->at(0).y();
+    for (int i = 0; i < data.size(); i++) {
+        for (int j = 0; j < data.at(i)->size(); j++) {
+            const float value = data.at(i)->at(j).y();
+            if (qIsNaN(value) || qIsInf(value))
+                continue;
+            if (min > value && (value > 0.0f || !logarithmic))
+                min = value;
+            if (max < value)
+                max = value;
+        }
+    }
+    return QVector<float>() << min << max;
+}
+
+static QVector<float> heightRange(Q3DSurface *graph)
+{
+    return QVector<float>() << graph->axisY()->min() << graph->axisY()->max();
+}
+
+void tst_proxy::limits()
+{
+    if (!CpptestUtil::isOpenGLSupported())
+        QSKIP("OpenGL not supported on this platform");
+
+    const float nan = qQNaN();
+    const float inf = qInf();
+
+    // Row widths that are not multiples of four, and rows scanned in several chunks
+    const int widths[] = { 3, 5, 258, 517 };
+    for (int w = 0; w < int(sizeof(widths) / sizeof(widths[0])); w++) {
+        const int columns = widths[w];
+        Q3DSurface graph;
+        QSurfaceDataProxy *proxy = new QSurfaceDataProxy;
+        graph.addSeries(new QSurface3DSeries(proxy));
+
+        QSurfaceDataArray *data = new QSurfaceDataArray;
+        for (int i = 0; i < 4; i++) {
+            QSurfaceDataRow *row = new QSurfaceDataRow(columns);
+            for (int j = 0; j < columns; j++)
+                (*row)[j].setPosition(QVector3D(float(j), float((i * 31 + j * 17) % 23) - 7.0f,
+                                                float(i)));
+            *data << row;
+        }
+        (*data->at(0))[0].setY(10.0f);
+        proxy->resetArray(data);
+        QCOMPARE(heightRange(&graph), scalarHeightLimits(*proxy->array(), false));
+
+        // Invalid values at the ends of the rows are ignored
+        const int last = columns - 1;
+        proxy->setItem(1, last, QSurfaceDataItem(QVector3D(float(last), nan, 1.0f)));
+        proxy->setItem(2, last, QSurfaceDataItem(QVector3D(float(last), inf, 2.0f)));
+        proxy->setItem(3, last, QSurfaceDataItem(QVector3D(float(last), -inf, 3.0f)));
+        QCOMPARE(heightRange(&graph), scalarHeightLimits(*proxy->array(), false));
+
+        // Limits in the middle and in the remainder of the rows
+        proxy->setItem(1, columns / 2, QSurfaceDataItem(QVector3D(float(columns / 2), -20.0f,
+                                                                  1.0f)));
+        proxy->setItem(2, last - 1, QSurfaceDataItem(QVector3D(float(last - 1), 20.0f, 2.0f)));
+        QCOMPARE(heightRange(&graph), scalarHeightLimits(*proxy->array(), false));
+        QCOMPARE(graph.axisY()->min(), -20.0f);
+        QCOMPARE(graph.axisY()->max(), 20.0f);
+
+        // Negative zero is the minimum when there are no negative values
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < columns; j++) {
+                const float y = proxy->itemAt(i, j)->y();
+                if (y < 0.0f)
+                    proxy->setItem(i, j, QSurfaceDataItem(QVector3D(float(j), -y, float(i))));
+            }
+        }
+        proxy->setItem(3, 1, QSurfaceDataItem(QVector3D(1.0f, -0.0f, 3.0f)));
+        QCOMPARE(heightRange(&graph), scalarHeightLimits(*proxy->array(), false));
+        QCOMPARE(graph.axisY()->min(), 0.0f);
+
+        // A logarithmic axis allows neither zero nor negative values
+        graph.axisY()->setFormatter(new QLogValue3DAxisFormatter);
+        proxy->setItem(1, 1, QSurfaceDataItem(QVector3D(1.0f, -5.0f, 1.0f)));
+        proxy->setItem(2, 2, QSurfaceDataItem(QVector3D(2.0f, 0.125f, 2.0f)));
+        QCOMPARE(heightRange(&graph), scalarHeightLimits(*proxy->array(), true));
+        QCOMPARE(graph.axisY()->min(), 0.125f);
+    }
+}
+
 QTEST_MAIN(tst_proxy)
 #include "tst_proxy.moc"
@@ -1,4 +1,4 @@
-QT += testlib datavisualization
+QT += testlib datavisualization datavisualization-private
 
 TARGET = tst_cpptest
 CONFIG += console testcase
@@ -30,6 +30,7 @@
 #include <QtTest/QtTest>
 
 #include <QtDataVisualization/QSurface3DSeries>
+#include <QtDataVisualization/private/surfacelodpyramid_p.h>
 
 using namespace QtDataVisualization;
 
@@ -49,6 +50,8 @@ private slots:
     void initializeProperties();
     void invalidProperties();
 
+    void levelOfDetailPyramid();
+
 private:
     QSurface3DSeries *m_series;
 };
@@ -94,6 +97,7 @@ void tst_series::initialProperties()
     QCOMPARE(m_series->isFlatShadingEnabled(), true);
     QCOMPARE(m_series->isFlatShadingSupported(), true);
     QCOMPARE(m_series->selectedPoint(), m_series->invalidSelectionPosition());
+    QCOMPARE(m_series->isLevelOfDetailEnabled(), false);
 
     // Common properties. The ones identical between different series are tested in QBar3DSeries tests
     QCOMPARE(m_series->itemLabelFormat(), QString("@xLabel, @yLabel, @zLabel"));
@@ -109,10 +113,12 @@ void tst_series::initializeProperties()
     m_series->setDrawMode(QSurface3DSeries::DrawWireframe);
     m_series->setFlatShadingEnabled(false);
     m_series->setSelectedPoint(QPoint(0, 0));
+    m_series->setLevelOfDetailEnabled(true);
 
     QCOMPARE(m_series->drawMode(), QSurface3DSeries::DrawWireframe);
     QCOMPARE(m_series->isFlatShadingEnabled(), false);
     QCOMPARE(m_series->selectedPoint(), QPoint(0, 0));
+    QCOMPARE(m_series->isLevelOfDetailEnabled(), true);
 
     // Common properties. The ones identical between different series are tested in QBar3DSeries tests
     m_series->setMesh(QAbstract3DSeries::MeshPyramid);
@@ -127,5 +133,69 @@ void tst_series::invalidProperties()
     QCOMPARE(m_series->mesh(), QAbstract3DSeries::MeshSphere);
 }
 
+void tst_series::levelOfDetailPyramid()
+{
+    QSurfaceDataArray array;
+    for (int i = 0; i < 16; i++) {
+        QSurfaceDataRow *row = new QSurfaceDataRow(16);
+        for (int j = 0; j < 16; j++)
+            (*row)[j] = QSurfaceDataItem(QVector3D(float(j), 1.0f, float(i)));
+        array << row;
+    }
+    (*array[5])[6].setY(10.0f);
+    (*array[12])[3].setY(-4.0f);
+
+    SurfaceLodPyramid pyramid;
+    QCOMPARE(pyramid.levelCount(), 1);
+    pyramid.build(array);
+    QVERIFY(pyramid.isValidFor(array));
+    // 8x8, 4x4 and 2x2 cells on top of the data itself
+    QCOMPARE(pyramid.levelCount(), 4);
+
+    // Cells keep the extreme that deviates more from their mean
+    QCOMPARE(pyramid.valueAt(1, 5, 6), 10.0f);
+    QCOMPARE(pyramid.valueAt(1, 4, 7), 10.0f);
+    QCOMPARE(pyramid.valueAt(1, 12, 3), -4.0f);
+    QCOMPARE(pyramid.valueAt(1, 0, 0), 1.0f);
+    QCOMPARE(pyramid.valueAt(2, 0, 0), 1.0f);
+    QCOMPARE(pyramid.valueAt(3, 0, 0), 10.0f);
+    QCOMPARE(pyramid.valueAt(3, 15, 0), -4.0f);
+
+    // The finest level with no more cells than there are pixels is selected
+    QCOMPARE(pyramid.levelFor(16, 100), 0);
+    QCOMPARE(pyramid.levelFor(16, 16), 0);
+    QCOMPARE(pyramid.levelFor(16, 15), 1);
+    QCOMPARE(pyramid.levelFor(16, 8), 1);
+    QCOMPARE(pyramid.levelFor(16, 4), 2);
+    QCOMPARE(pyramid.levelFor(16, 1), 3);
+
+    // Updates reach all levels
+    (*array[5])[6].setY(1.0f);
+    pyramid.update(array, 5, 6, 6, 7);
+    QCOMPARE(pyramid.valueAt(1, 5, 6), 1.0f);
+    QCOMPARE(pyramid.valueAt(3, 0, 0), 1.0f);
+    QCOMPARE(pyramid.valueAt(1, 12, 3), -4.0f);
+
+    // Odd sizes get partial cells at the edges
+    QSurfaceDataArray smallArray;
+    for (int i = 0; i < 5; i++) {
+        QSurfaceDataRow *row = new QSurfaceDataRow(5);
+        for (int j = 0; j < 5; j++)
+            (*row)[j] = QSurfaceDataItem(QVector3D(float(j), float(i * 5 + j), float(i)));
+        smallArray << row;
+    }
+    QVERIFY(!pyramid.isValidFor(smallArray));
+    pyramid.build(smallArray);
+    QCOMPARE(pyramid.levelCount(), 3);
+    QCOMPARE(pyramid.valueAt(1, 4, 4), 24.0f);
+    QCOMPARE(pyramid.valueAt(2, 4, 4), 24.0f);
+
+    pyramid.clear();
+    QCOMPARE(pyramid.levelCount(), 1);
+
+    qDeleteAll(array);
+    qDeleteAll(smallArray);
+}
+
 QTEST_MAIN(tst_series)
 #include "tst_series.moc"
@@ -30,6 +30,11 @@
 #include <QtTest/QtTest>
 
 #include <QtDataVisualization/Q3DSurface>
+#include <QtDataVisualization/private/surface3dcontroller_p.h>
+#include <QtDataVisualization/private/surface3drenderer_p.h>
+#include <QtDataVisualization/private/surfaceobject_p.h>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
 
 #include "cpptestutil.h"
 
@@ -57,6 +62,9 @@ private slots:
     void removeSeries();
     void removeMultipleSeries();
 
+    void scrollRows();
+    void tileCulling();
+
 private:
     Q3DSurface *m_graph;
 };
@@ -265,5 +273,149 @@ void tst_surface::removeMultipleSeries()
     delete series3;
 }
 
+void tst_surface::scrollRows()
+{
+    QSurface3DSeries *series = newSeries();
+    m_graph->addSeries(series);
+
+    QCOMPARE(m_graph->axisY()->min(), 0.1f);
+    QCOMPARE(m_graph->axisY()->max(), 1.8f);
+
+    // Scroll more rows than there are, so that all original rows and their limits drop out
+    QSurfaceDataArray rows;
+    for (int i = 0; i < 3; i++) {
+        QSurfaceDataRow *row = new QSurfaceDataRow;
+        *row << QVector3D(0.0f, 0.3f + i, 2.0f + i) << QVector3D(1.0f, 0.4f + i, 2.0f + i);
+        rows << row;
+    }
+    series->dataProxy()->scrollRows(rows);
+
+    QCOMPARE(series->dataProxy()->rowCount(), 2);
+    QCOMPARE(series->dataProxy()->itemAt(0, 0)->y(), 1.3f);
+    QCOMPARE(series->dataProxy()->itemAt(1, 1)->y(), 2.4f);
+    QCOMPARE(m_graph->axisY()->min(), 1.3f);
+    QCOMPARE(m_graph->axisY()->max(), 2.4f);
+    QCOMPARE(m_graph->axisZ()->min(), 3.0f);
+    QCOMPARE(m_graph->axisZ()->max(), 4.0f);
+
+    // Scrolling the data so that it no longer contains the extremes shrinks the limits
+    QSurfaceDataRow *row = new QSurfaceDataRow;
+    *row << QVector3D(0.0f, 1.5f, 5.0f) << QVector3D(1.0f, 1.6f, 5.0f);
+    series->dataProxy()->scrollRow(row);
+
+    QCOMPARE(series->dataProxy()->itemAt(0, 0)->y(), 2.3f);
+    QCOMPARE(m_graph->axisY()->min(), 1.5f);
+    QCOMPARE(m_graph->axisY()->max(), 2.4f);
+    QCOMPARE(m_graph->axisZ()->min(), 4.0f);
+    QCOMPARE(m_graph->axisZ()->max(), 5.0f);
+}
+
+typedef QVector<QPair<int, int> > IndexRanges;
+
+static void setRowHeight(QSurfaceDataArray &data, int row, float height)
+{
+    QSurfaceDataRow &dataRow = *data[row];
+    for (int column = 0; column < dataRow.size(); column++)
+        dataRow[column].setY(height);
+}
+
+void tst_surface::tileCulling()
+{
+    QOffscreenSurface surface;
+    surface.create();
+    QOpenGLContext context;
+    QVERIFY(context.create());
+    QVERIFY(context.makeCurrent(&surface));
+
+    Surface3DController controller(QRect(0, 0, 400, 400));
+    Surface3DRenderer renderer(&controller);
+    QValue3DAxis axisX;
+    QValue3DAxis axisY;
+    QValue3DAxis axisZ;
+    QValue3DAxis *axes[3] = { &axisX, &axisY, &axisZ };
+    const QAbstract3DAxis::AxisOrientation orientations[3] = {
+        QAbstract3DAxis::AxisOrientationX, QAbstract3DAxis::AxisOrientationY,
+        QAbstract3DAxis::AxisOrientationZ };
+    axisX.setRange(0.0f, 129.0f);
+    axisY.setRange(0.0f, 10.0f);
+    axisZ.setRange(0.0f, 129.0f);
+    for (int i = 0; i < 3; i++) {
+        renderer.updateAxisType(orientations[i], QAbstract3DAxis::AxisTypeValue);
+        renderer.updateAxisRange(orientations[i], axes[i]->min(), axes[i]->max());
+        renderer.updateAxisFormatter(orientations[i], axes[i]->formatter());
+    }
+
+    // 130 x 130 items is 129 x 129 quads, so there are three tiles per side and the last ones
+    // are only one quad wide. Vertex row 64 is shared by the first two tile rows.
+    const int size = 130;
+    const int quads = size - 1;
+    const int tileIndices = 6 * 64 * 64;
+    const int tileRowIndices = 6 * 64 * quads;
+    QSurfaceDataArray data;
+    for (int row = 0; row < size; row++) {
+        QSurfaceDataRow *dataRow = new QSurfaceDataRow(size);
+        for (int column = 0; column < size; column++)
+            (*dataRow)[column].setPosition(QVector3D(float(column), 0.0f, float(row)));
+        data << dataRow;
+    }
+
+    // The surface is at normalized height zero. These only contain space above it.
+    QMatrix4x4 above;
+    above.ortho(-0.1f, 1.1f, 0.5f, 1.5f, -2.0f, 2.0f);
+    QMatrix4x4 aboveFirstColumn;
+    aboveFirstColumn.ortho(-0.1f, 0.3f, 0.5f, 1.5f, -2.0f, 2.0f);
+    QMatrix4x4 aside;
+    aside.ortho(2.0f, 3.0f, -0.5f, 1.5f, -2.0f, 2.0f);
+
+    for (int smooth = 0; smooth < 2; smooth++) {
+        SurfaceObject object(&renderer);
+        if (smooth)
+            object.setUpSmoothData(data, QRect(0, 0, size, size), true, false);
+        else
+            object.setUpData(data, QRect(0, 0, size, size), true, false);
+        QMatrix4x4 offset;
+        offset.translate(object.positionOffset());
+
+        QVERIFY(object.visibleIndexRanges(above * offset).isEmpty());
+        QVERIFY(object.visibleIndexRanges(aside * offset).isEmpty());
+
+        // Raising a row raises the tiles on both sides of it, and only those
+        setRowHeight(data, 64, 10.0f);
+        if (smooth)
+            object.updateSmoothRow(data, 64, false);
+        else
+            object.updateCoarseRow(data, 64, false);
+        object.uploadBuffers();
+        QCOMPARE(object.visibleIndexRanges(above * offset),
+                 IndexRanges() << qMakePair(0, 2 * tileRowIndices));
+        QCOMPARE(object.visibleIndexRanges(aboveFirstColumn * offset),
+                 IndexRanges() << qMakePair(0, tileIndices)
+                 << qMakePair(tileRowIndices, tileIndices));
+        QVERIFY(object.visibleIndexRanges(aside * offset).isEmpty());
+
+        // Raising the last row only touches the last tile row
+        setRowHeight(data, 64, 0.0f);
+        setRowHeight(data, size - 1, 10.0f);
+        if (smooth) {
+            object.updateSmoothRow(data, 64, false);
+            object.updateSmoothRow(data, size - 1, false);
+        } else {
+            object.updateCoarseRow(data, 64, false);
+            object.updateCoarseRow(data, size - 1, false);
+        }
+        object.uploadBuffers();
+        QCOMPARE(object.visibleIndexRanges(above * offset),
+                 IndexRanges() << qMakePair(2 * tileRowIndices, 6 * quads));
+        setRowHeight(data, size - 1, 0.0f);
+
+        // Without tiles, everything is drawn
+        if (!smooth) {
+            object.createCoarseSubSection(10, 10, 100, 100);
+            QCOMPARE(object.visibleIndexRanges(aside * offset),
+                     IndexRanges() << qMakePair(0, int(object.indexCount())));
+        }
+    }
+}
+
 QTEST_MAIN(tst_surface)
 #include "tst_surface.moc"
@@ -0,0 +1,110 @@
+/****************************************************************************
+**
+** Copyright (C) 2016 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Data Visualization module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 or (at your option) any later version
+** approved by the KDE Free Qt Foundation. The licenses are as published by
+** the Free Software Foundation and appearing in the file LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+
+import QtQuick 2.0
+import QtDataVisualization 1.4
+import QtTest 1.0
+
+Item {
+    id: top
+    height: 150
+    width: 150
+
+    property var bars3d: null
+
+    function constructBars() {
+        bars3d = Qt.createQmlObject("
+        import QtQuick 2.2
+        import QtDataVisualization 1.4
+        Bars3D {
+            width: 100
+            height: 100
+            Bar3DSeries {
+                ItemModelBarDataProxy {
+                    itemModel: ListModel {
+                        ListElement { row: \"0\"; col: \"0\"; value: \"1\" }
+                        ListElement { row: \"0\"; col: \"1\"; value: \"2\" }
+                    }
+                    rowRole: \"row\"
+                    columnRole: \"col\"
+                    valueRole: \"value\"
+                }
+            }
+        }", top)
+    }
+
+    Rectangle {
+        id: unrelated
+        x: 110
+        width: 40
+        height: 40
+        color: "red"
+    }
+
+    SignalSpy {
+        id: frameSpy
+        signalName: "frameRendered"
+    }
+
+    TestCase {
+        name: "Bars3D Frame"
+        when: windowShown
+
+        function test_1_initial_frame() {
+            constructBars()
+            frameSpy.target = bars3d
+            frameSpy.wait()
+            verify(frameSpy.count > 0)
+
+            // Let any follow-up frames, such as the ones caused by label texture creation, settle
+            wait(500)
+        }
+
+        function test_2_unrelated_update() {
+            var frames = frameSpy.count
+            unrelated.color = "blue"
+            waitForRendering(top)
+            unrelated.color = "green"
+            waitForRendering(top)
+            wait(100)
+            compare(frameSpy.count, frames)
+        }
+
+        function test_3_graph_update() {
+            var frames = frameSpy.count
+            bars3d.scene.activeCamera.cameraPreset = Camera3D.CameraPresetFront
+            frameSpy.wait()
+            verify(frameSpy.count > frames)
+
+            bars3d.destroy()
+            waitForRendering(top)
+        }
+    }
+}
@@ -7,6 +7,7 @@ OTHER_FILES += bars3d/tst_basic.qml \
                bars3d/tst_bars.qml \
                bars3d/tst_barseries.qml \
                bars3d/tst_proxy.qml \
+               bars3d/tst_frame.qml \
                scatter3d/tst_basic.qml \
                scatter3d/tst_scatter.qml \
                scatter3d/tst_scatterseries.qml \